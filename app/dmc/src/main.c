@@ -6,6 +6,7 @@
 
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <app_version.h>
 #include <tenstorrent/bist.h>
@@ -61,6 +62,29 @@ static dmStaticInfo static_info = {.version = 1, .bl_version = 0, .app_version =
 
 static uint16_t max_power;
 
+/* Jobs run by each chip's worker, see bh_chip_jobs_submit */
+enum chip_job {
+	CHIP_JOB_CM2DM = BIT(0),
+	CHIP_JOB_INIT = BIT(1),
+	CHIP_JOB_FAN_SPEED = BIT(2),
+	CHIP_JOB_BOARD_POWER = BIT(3),
+	CHIP_JOB_FAN_RPM = BIT(4),
+	CHIP_JOB_LOGS = BIT(5),
+};
+
+#ifdef CONFIG_TT_BH_CHIP_WORKER
+static K_THREAD_STACK_ARRAY_DEFINE(chip_worker_stacks, BH_CHIP_COUNT,
+				   CONFIG_TT_BH_CHIP_WORKER_STACK_SIZE);
+#endif
+
+/* Latest values for the CHIP_JOB_FAN_SPEED, CHIP_JOB_BOARD_POWER and CHIP_JOB_FAN_RPM jobs */
+static atomic_t smc_fan_speed;
+static atomic_t board_power;
+static atomic_t fan_rpm;
+
+/* Chip workers update the fan speed on behalf of their chip */
+static K_MUTEX_DEFINE(fan_speed_lock);
+
 /* FIXME: notify_smcs should be automatic, we should notify if the SMCs are ready, otherwise
  * record a notification to be sent once they are. Also it's properly per-SMC state.
  */
@@ -70,6 +94,8 @@ void update_fan_speed(bool notify_smcs)
 		uint8_t fan_speed = 0;
 		uint8_t forced_fan_speed = 0;
 
+		k_mutex_lock(&fan_speed_lock, K_FOREVER);
+
 		ARRAY_FOR_EACH_PTR(BH_CHIPS, chip) {
 			fan_speed = MAX(fan_speed, chip->data.fan_speed);
 			forced_fan_speed =
@@ -84,17 +110,37 @@ void update_fan_speed(bool notify_smcs)
 		uint32_t fan_speed_pwm = DIV_ROUND_UP(fan_speed * UINT8_MAX, 100);
 
 		pwm_set_cycles(max6639_pwm_dev, 0, UINT8_MAX, fan_speed_pwm, 0);
+		atomic_set(&smc_fan_speed, fan_speed);
+
+		k_mutex_unlock(&fan_speed_lock);
 
 		if (notify_smcs) {
-			/* Broadcast final speed to all SMCs for telemetry */
+			/*
+			 * Broadcast final speed to all SMCs for telemetry. Each chip's worker
+			 * writes to its own bus.
+			 */
 			ARRAY_FOR_EACH_PTR(BH_CHIPS, chip) {
-				bharc_smbus_word_data_write(&chip->config.arc, CMFW_SMBUS_FAN_SPEED,
-							    fan_speed);
+				bh_chip_jobs_submit(chip, CHIP_JOB_FAN_SPEED);
 			}
 		}
 	}
 }
 
+static void hold_fan_at_full_speed(struct bh_chip *chip)
+{
+	/* Not undone by an update_fan_speed already running on a chip worker */
+	k_mutex_lock(&fan_speed_lock, K_FOREVER);
+
+	chip->data.fan_speed = 100;
+	chip->data.fan_speed_forced = true;
+
+	if (DT_NODE_HAS_STATUS(DT_ALIAS(fan0), okay)) {
+		pwm_set_cycles(max6639_pwm_dev, 0, UINT8_MAX, UINT8_MAX, 0);
+	}
+
+	k_mutex_unlock(&fan_speed_lock);
+}
+
 static bool process_reset_req(struct bh_chip *chip, uint8_t msg_id, uint32_t msg_data)
 {
 	switch (msg_data) {
@@ -217,20 +263,108 @@ static bool process_led_blink_request(struct bh_chip *chip, uint8_t msg_id, uint
 	return false;
 }
 
+typedef bool (*msg_processor_t)(struct bh_chip *chip, uint8_t msg_id, uint32_t msg_data);
+
+static const msg_processor_t msg_processors[] = {
+	[kCm2DmMsgIdResetReq] = process_reset_req,
+	[kCm2DmMsgIdPing] = process_ping,
+	[kCm2DmMsgIdFanSpeedUpdate] = process_fan_speed_update,
+	[kCm2DmMsgIdForcedFanSpeedUpdate] = process_forced_fan_speed_update,
+	[kCm2DmMsgIdReady] = process_id_ready,
+	[kCm2DmMsgIdAutoResetTimeoutUpdate] = process_auto_reset_timeout_update,
+	[kCm2DmMsgTelemHeartbeatUpdate] = process_heartbeat_update,
+	[kCm2DmMsgIdLedBlink] = process_led_blink_request,
+};
+
+/* Returns true if no further messages should be processed for now */
+static bool dispatch_cm2dm_message(struct bh_chip *chip, const cm2dmMessage *msg)
+{
+	chip->data.last_cm2dm_seq_num_valid = true;
+	chip->data.last_cm2dm_seq_num = msg->seq_num;
+
+	if (msg->msg_id < ARRAY_SIZE(msg_processors) && msg_processors[msg->msg_id]) {
+		return msg_processors[msg->msg_id](chip, msg->msg_id, msg->data);
+	}
+
+	return false;
+}
+
+/* Most CMFW_SMBUS_REQ_WINDOW reads per poll, so that one chip can't hold up the others */
+#define CM2DM_WINDOW_READS_PER_POLL 2
+
+static int process_cm2dm_window(struct bh_chip *chip)
+{
+	cm2dmMessage msgs[CMFW_SMBUS_CM2DM_WINDOW_SIZE];
+	uint8_t count;
+	bool more;
+
+	for (int i = 0; i < CM2DM_WINDOW_READS_PER_POLL; i++) {
+		int ret = bh_chip_get_cm2dm_window(chip, msgs, &count, &more);
+
+		if (ret != 0) {
+			/* Once a read went through, the rest of the messages come with the next poll */
+			return (i == 0) ? ret : 0;
+		}
+
+		for (uint8_t j = 0; j < count; j++) {
+			/* Messages processed before, whose ack hasn't reached the CMFW yet */
+			if (!cm2dm_seq_is_next(chip->data.last_cm2dm_seq_num,
+					       chip->data.last_cm2dm_seq_num_valid,
+					       msgs[j].seq_num)) {
+				continue;
+			}
+
+			/* The rest stay unacked and come again with the next read */
+			if (dispatch_cm2dm_message(chip, &msgs[j])) {
+				return 0;
+			}
+		}
+
+		if (!more) {
+			break;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Refusals in a row before a command is taken as unsupported, so that a NAK the bus happened to
+ * give while the CMFW was answering doesn't switch the chip to the slower fallback for good.
+ */
+#define CMFW_CMD_UNSUPPORTED_REFUSALS 3
+
+static bool cmfw_cmd_unsupported(struct bh_chip *chip, int ret, uint8_t *refusals)
+{
+	if (!bh_chip_cmd_refused(chip, ret)) {
+		*refusals = 0;
+		return false;
+	}
+
+	return ++*refusals >= CMFW_CMD_UNSUPPORTED_REFUSALS;
+}
+
 void process_cm2dm_message(struct bh_chip *chip)
 {
-	typedef bool (*msg_processor_t)(struct bh_chip *chip, uint8_t msg_id, uint32_t msg_data);
+	if (!chip->data.cm2dm_window_unsupported) {
+		int ret = process_cm2dm_window(chip);
+
+		if (ret == 0) {
+			chip->data.cm2dm_window_refusals = 0;
+			return;
+		}
 
-	static const msg_processor_t msg_processors[] = {
-		[kCm2DmMsgIdResetReq] = process_reset_req,
-		[kCm2DmMsgIdPing] = process_ping,
-		[kCm2DmMsgIdFanSpeedUpdate] = process_fan_speed_update,
-		[kCm2DmMsgIdForcedFanSpeedUpdate] = process_forced_fan_speed_update,
-		[kCm2DmMsgIdReady] = process_id_ready,
-		[kCm2DmMsgIdAutoResetTimeoutUpdate] = process_auto_reset_timeout_update,
-		[kCm2DmMsgTelemHeartbeatUpdate] = process_heartbeat_update,
-		[kCm2DmMsgIdLedBlink] = process_led_blink_request,
-	};
+		/* Any other error, the window is tried again with the next poll */
+		if (!cmfw_cmd_unsupported(chip, ret, &chip->data.cm2dm_window_refusals)) {
+			return;
+		}
+
+		/* CMFW from before CMFW_SMBUS_REQ_WINDOW, stay with one message at a time until the
+		 * chip is reset.
+		 */
+		LOG_INF("CMFW doesn't support windowed CM2DM messages");
+		chip->data.cm2dm_window_unsupported = true;
+	}
 
 	for (uint32_t i = 0U; i < kCm2DmMsgCount; i++) {
 		cm2dmMessageRet msg = bh_chip_get_cm2dm_message(chip);
@@ -257,13 +391,8 @@ void process_cm2dm_message(struct bh_chip *chip)
 			continue;
 		}
 
-		chip->data.last_cm2dm_seq_num_valid = true;
-		chip->data.last_cm2dm_seq_num = msg.msg.seq_num;
-
-		if (msg.msg.msg_id < ARRAY_SIZE(msg_processors) && msg_processors[msg.msg.msg_id]) {
-			if (msg_processors[msg.msg.msg_id](chip, msg.msg.msg_id, msg.msg.data)) {
-				break;
-			}
+		if (dispatch_cm2dm_message(chip, &msg.msg)) {
+			break;
 		}
 	}
 }
@@ -276,10 +405,10 @@ void ina228_power_update(void)
 	sensor_channel_get(ina228, SENSOR_CHAN_POWER, &sensor_val);
 
 	/* Only use integer part of sensor value */
-	int16_t power = sensor_val.val1 & 0xFFFF;
+	atomic_set(&board_power, sensor_val.val1 & 0xFFFF);
 
 	ARRAY_FOR_EACH_PTR(BH_CHIPS, chip) {
-		bh_chip_set_input_power(chip, power);
+		bh_chip_jobs_submit(chip, CHIP_JOB_BOARD_POWER);
 	}
 }
 
@@ -359,6 +488,26 @@ static int bh_chip_run_smbus_tests(struct bh_chip *chip)
 		return -EIO;
 	}
 
+	/* Test bulk telemetry by reading TAG_DM_APP_FW_VERSION and TAG_DM_BL_FW_VERSION at once */
+	uint8_t bulk_select[5] = {26, 0x3, 0, 0, 0};
+
+	ret = bharc_smbus_block_write_block_read(&chip->config.arc,
+						 CMFW_SMBUS_TELEMETRY_BULK_READ,
+						 sizeof(bulk_select), bulk_select, &count, data);
+	if (ret < 0) {
+		LOG_DBG("Failed to perform bulk telemetry read");
+		return ret;
+	}
+	if (count != 12 || data[0] != 2 || data[1] != 0U) {
+		LOG_DBG("Bulk telemetry read returned unexpected header");
+		return -EIO;
+	}
+	(void)memcpy(&app_version, &data[4], sizeof(app_version));
+	if (app_version != APPVERSION) {
+		LOG_DBG("Bulk telemetry read returned unexpected value: %08x", app_version);
+		return -EIO;
+	}
+
 	/* Test block write block read call*/
 	uint32_t test_data = 0x1234FEDC;
 
@@ -398,12 +547,10 @@ static void handle_therm_trip(void)
 			}
 
 			/* hold fan at 100% until we hear otherwise from this chip */
-			chip->data.fan_speed = 100;
-			chip->data.fan_speed_forced = true;
+			hold_fan_at_full_speed(chip);
 
-			if (DT_NODE_HAS_STATUS(DT_ALIAS(fan0), okay)) {
-				pwm_set_cycles(max6639_pwm_dev, 0, UINT8_MAX, UINT8_MAX, 0);
-			}
+			/* Waits for the chip's worker, whose bus transfers were cancelled */
+			k_mutex_lock(&chip->lock, K_FOREVER);
 
 			/* Prioritize the system rebooting over the therm trip handler */
 			if (!atomic_get(&chip->data.trigger_reset)) {
@@ -427,6 +574,8 @@ static void handle_therm_trip(void)
 				}
 				chip->data.performing_reset = false;
 			}
+
+			k_mutex_unlock(&chip->lock);
 		}
 	}
 }
@@ -436,6 +585,7 @@ static void handle_watchdog_reset(void)
 	ARRAY_FOR_EACH_PTR(BH_CHIPS, chip) {
 		if (chip->data.arc_wdog_triggered) {
 			chip->data.arc_wdog_triggered = false;
+			k_mutex_lock(&chip->lock, K_FOREVER);
 			bh_chip_cancel_bus_transfer_clear(chip);
 			/* Read PC from ARC and record it */
 			jtag_setup(chip->config.jtag);
@@ -447,12 +597,7 @@ static void handle_watchdog_reset(void)
 			chip->data.auto_reset_timeout = 0;
 
 			/* hold fan at 100% until we hear otherwise from this chip */
-			chip->data.fan_speed = 100;
-			chip->data.fan_speed_forced = true;
-
-			if (DT_NODE_HAS_STATUS(DT_ALIAS(fan0), okay)) {
-				pwm_set_cycles(max6639_pwm_dev, 0, UINT8_MAX, UINT8_MAX, 0);
-			}
+			hold_fan_at_full_speed(chip);
 
 			chip->data.performing_reset = true;
 			bh_chip_reset_chip(chip, true);
@@ -460,6 +605,7 @@ static void handle_watchdog_reset(void)
 			bh_chip_cancel_bus_transfer_clear(chip);
 
 			chip->data.performing_reset = false;
+			k_mutex_unlock(&chip->lock);
 		}
 	}
 }
@@ -468,8 +614,13 @@ static void handle_perst(void)
 {
 	ARRAY_FOR_EACH_PTR(BH_CHIPS, chip) {
 		if (atomic_set(&chip->data.trigger_reset, false)) {
+			k_mutex_lock(&chip->lock, K_FOREVER);
 			chip->data.performing_reset = true;
 			chip->data.last_cm2dm_seq_num_valid = false;
+			chip->data.cm2dm_window_unsupported = false;
+			chip->data.cm2dm_window_refusals = 0;
+			chip->data.dmc_log_bulk_unsupported = false;
+			chip->data.dmc_log_bulk_refusals = 0;
 			/*
 			 * Set the bus cancel following the logic of (reset_triggered &&
 			 * !performing_reset)
@@ -493,6 +644,7 @@ static void handle_perst(void)
 			chip->data.therm_trip_count = 0;
 			chip->data.arc_hang_pc = 0;
 			chip->data.performing_reset = false;
+			k_mutex_unlock(&chip->lock);
 		}
 	}
 }
@@ -500,20 +652,31 @@ static void handle_perst(void)
 static void handle_pgood_change(void)
 {
 	ARRAY_FOR_EACH_PTR(BH_CHIPS, chip) {
-		handle_pgood_event(chip, board_fault_led);
+		if (chip->data.pgood_fall_triggered || chip->data.pgood_rise_triggered) {
+			k_mutex_lock(&chip->lock, K_FOREVER);
+			handle_pgood_event(chip, board_fault_led);
+			k_mutex_unlock(&chip->lock);
+		}
+	}
+}
+
+static void send_init_data(struct bh_chip *chip)
+{
+	if (chip->data.arc_needs_init_msg) {
+		if (bh_chip_set_static_info(chip, &static_info) == 0 &&
+		    bh_chip_set_input_power_lim(chip, max_power) == 0 &&
+		    bh_chip_set_therm_trip_count(chip, chip->data.therm_trip_count) == 0 &&
+		    bh_chip_run_smbus_tests(chip) == 0) {
+			chip->data.arc_needs_init_msg = false;
+		}
 	}
 }
 
-static void send_init_data(void)
+static void schedule_init_data(void)
 {
 	ARRAY_FOR_EACH_PTR(BH_CHIPS, chip) {
 		if (chip->data.arc_needs_init_msg) {
-			if (bh_chip_set_static_info(chip, &static_info) == 0 &&
-			    bh_chip_set_input_power_lim(chip, max_power) == 0 &&
-			    bh_chip_set_therm_trip_count(chip, chip->data.therm_trip_count) == 0 &&
-			    bh_chip_run_smbus_tests(chip) == 0) {
-				chip->data.arc_needs_init_msg = false;
-			}
+			bh_chip_jobs_submit(chip, CHIP_JOB_INIT);
 		}
 	}
 }
@@ -535,9 +698,10 @@ static void fan_rpm_feedback(void)
 		sensor_channel_get(max6639_sensor_dev, MAX6639_CHAN_1_RPM, &data);
 
 		rpm = (uint16_t)data.val1;
+		atomic_set(&fan_rpm, rpm);
 
 		ARRAY_FOR_EACH_PTR(BH_CHIPS, chip) {
-			bh_chip_set_fan_rpm(chip, rpm);
+			bh_chip_jobs_submit(chip, CHIP_JOB_FAN_RPM);
 		}
 	}
 }
@@ -545,11 +709,11 @@ static void fan_rpm_feedback(void)
 static void handle_cm2dm_messages(void)
 {
 	ARRAY_FOR_EACH_PTR(BH_CHIPS, chip) {
-		process_cm2dm_message(chip);
+		bh_chip_jobs_submit(chip, CHIP_JOB_CM2DM);
 	}
 }
 
-static void send_logs_to_smc(void)
+static int send_logs_to_smc_legacy(struct bh_chip *chip)
 {
 	uint8_t *log_data;
 	int ret;
@@ -557,15 +721,115 @@ static void send_logs_to_smc(void)
 	/* Pull up to 32 bytes from the ringbuf log backend */
 	ret = log_backend_ringbuf_get_claim(&log_data, 32);
 	if (ret > 0) {
-		/* Write log data to the first BH chip */
-		if (bh_chip_write_logs(&BH_CHIPS[BH_CHIP_PRIMARY_INDEX], log_data, ret) == 0) {
+		if (bh_chip_write_logs(chip, log_data, ret) == 0) {
 			/* Only finish the claim if the write was successful */
 			log_backend_ringbuf_finish_claim(ret);
 		} else {
 			/* Otherwise, indicate we consumed 0 bytes */
 			log_backend_ringbuf_finish_claim(0);
+			return -EIO;
 		}
 	}
+
+	return ret;
+}
+
+/* The CMFW_SMBUS_DMC_LOG_BULK chunk taken from the log ring buffer, kept until the CMFW takes it */
+static struct {
+	uint8_t data[CMFW_SMBUS_DMC_LOG_CHUNK_SIZE];
+	size_t size;
+	uint32_t dropped;
+} log_chunk;
+
+static void send_logs_to_smc(struct bh_chip *chip)
+{
+	uint8_t *log_data;
+	int ret;
+
+	if (chip->data.dmc_log_bulk_unsupported) {
+		/* The chunk held when the CMFW refused CMFW_SMBUS_DMC_LOG_BULK goes first */
+		if (log_chunk.size > 0) {
+			if (bh_chip_write_logs(chip, (char *)log_chunk.data, log_chunk.size) == 0) {
+				log_chunk.size = 0;
+			}
+			return;
+		}
+
+		send_logs_to_smc_legacy(chip);
+		return;
+	}
+
+	/*
+	 * A chunk that failed goes again as it was, so that the CMFW can tell it's a resend. No
+	 * more than the CMFW has room for, without credits an empty chunk asks for them again.
+	 */
+	if (log_chunk.size == 0) {
+		log_chunk.dropped = log_backend_ringbuf_get_dropped();
+		if (chip->data.dmc_log_seq_num_valid) {
+			log_chunk.size = log_backend_ringbuf_get_claim(
+				&log_data,
+				MIN(chip->data.dmc_log_credits, CMFW_SMBUS_DMC_LOG_CHUNK_SIZE));
+			memcpy(log_chunk.data, log_data, log_chunk.size);
+			log_backend_ringbuf_finish_claim(log_chunk.size);
+		}
+	}
+
+	ret = bh_chip_write_log_chunk(chip, log_chunk.dropped, log_chunk.data, log_chunk.size);
+	if (ret < 0) {
+		/*
+		 * The CMFW may have taken the chunk and only the reply was lost, so the same chunk
+		 * goes again with the same sequence number and credits, never with the 32 byte
+		 * writes, which the CMFW can't tell from new bytes.
+		 */
+		if (cmfw_cmd_unsupported(chip, ret, &chip->data.dmc_log_bulk_refusals)) {
+			/* CMFW from before CMFW_SMBUS_DMC_LOG_BULK, stay with the 32 byte writes
+			 * until the chip is reset.
+			 */
+			LOG_INF("CMFW doesn't support bulk DMC logs");
+			chip->data.dmc_log_bulk_unsupported = true;
+		}
+		return;
+	}
+
+	chip->data.dmc_log_bulk_refusals = 0;
+	log_chunk.size = 0;
+
+	/*
+	 * Send the next chunk on the next pass of the event loop rather than the 20 ms timer, after
+	 * the jobs that came in meanwhile, so that power and thermal updates aren't held up.
+	 */
+	if (chip->data.dmc_log_credits > 0 && log_backend_ringbuf_get_used() > 0) {
+		tt_event_post(TT_EVENT_LOGS_TO_SMC);
+	}
+}
+
+static void run_chip_jobs(struct bh_chip *chip, uint32_t jobs)
+{
+	/* Messages first, the CMFW may be waiting on them */
+	if (jobs & CHIP_JOB_CM2DM) {
+		process_cm2dm_message(chip);
+	}
+
+	if (jobs & CHIP_JOB_INIT) {
+		send_init_data(chip);
+	}
+
+	if (jobs & CHIP_JOB_FAN_SPEED) {
+		bharc_smbus_word_data_write(&chip->config.arc, CMFW_SMBUS_FAN_SPEED,
+					    atomic_get(&smc_fan_speed));
+	}
+
+	if (jobs & CHIP_JOB_BOARD_POWER) {
+		bh_chip_set_input_power(chip, atomic_get(&board_power));
+	}
+
+	if (jobs & CHIP_JOB_FAN_RPM) {
+		bh_chip_set_fan_rpm(chip, atomic_get(&fan_rpm));
+	}
+
+	if (jobs & CHIP_JOB_LOGS) {
+		send_logs_to_smc(chip);
+	}
 }
 
 static void shared_20ms_expired(struct k_timer *timer)
@@ -599,6 +863,7 @@ int main(void)
 
 	ARRAY_FOR_EACH_PTR(BH_CHIPS, chip) {
 		chip->data.fan_speed = INITIAL_FAN_SPEED;
+		bh_chip_jobs_init(chip, run_chip_jobs);
 	}
 
 	update_fan_speed(false);
@@ -673,6 +938,14 @@ int main(void)
 		bh_chip_cancel_bus_transfer_clear(chip);
 	}
 
+#ifdef CONFIG_TT_BH_CHIP_WORKER
+	/* From here on each chip's SMBus traffic runs on its own worker */
+	for (size_t i = 0; i < BH_CHIP_COUNT; i++) {
+		bh_chip_worker_start(&BH_CHIPS[i], chip_worker_stacks[i],
+				     K_THREAD_STACK_SIZEOF(chip_worker_stacks[i]));
+	}
+#endif
+
 	printk("DMFW VERSION " APP_VERSION_STRING "\n");
 
 	/* For manufacturing, keep the red LED solid on so it can be visually inspected. */
@@ -696,7 +969,7 @@ int main(void)
 		handle_pgood_change();
 
 		/* send_init_data only triggers once per chip (per reset). */
-		send_init_data();
+		schedule_init_data();
 
 		if (events & (TT_EVENT_BOARD_POWER_TO_SMC | TT_EVENT_WAKE)) {
 			board_power_update();
@@ -711,7 +984,8 @@ int main(void)
 		}
 
 		if (events & (TT_EVENT_LOGS_TO_SMC | TT_EVENT_WAKE)) {
-			send_logs_to_smc();
+			/* Logs go to the first BH chip */
+			bh_chip_jobs_submit(&BH_CHIPS[BH_CHIP_PRIMARY_INDEX], CHIP_JOB_LOGS);
 		}
 	}
 
@@ -15,6 +15,8 @@
 #include <zephyr/sys/util.h>
 #include <stdint.h>
 
+#include "clock_control_tt_bh_slew.h"
+
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(clock_control_tt_bh);
 
@@ -157,10 +159,16 @@ struct clock_control_tt_bh_config {
 
 struct clock_control_tt_bh_data {
 	struct tt_bh_pll_settings settings;
+	struct clock_control_tt_bh_slew_stats slew_stats;
 
 	struct k_spinlock lock;
 };
 
+struct clock_control_tt_bh_slew_ctx {
+	const struct clock_control_tt_bh_config *config;
+	union tt_bh_pll_cntl_1_reg pll_cntl_1;
+};
+
 static uint32_t clock_control_tt_bh_read_reg(const struct clock_control_tt_bh_config *config,
 					     uint32_t offset)
 {
@@ -358,6 +366,41 @@ static void clock_control_tt_bh_update(const struct clock_control_tt_bh_config *
 	data->settings = *settings;
 }
 
+static void clock_control_tt_bh_slew_write(void *user_data, uint32_t fbdiv, uint32_t settle_ns)
+{
+	struct clock_control_tt_bh_slew_ctx *ctx = user_data;
+
+	ctx->pll_cntl_1.f.fbdiv = fbdiv;
+	clock_control_tt_bh_write_reg(ctx->config, PLL_CNTL_1_OFFSET, ctx->pll_cntl_1.val);
+	k_busy_wait_ns(settle_ns);
+}
+
+/* Slew the feedback divider to target_fbdiv and record how long it took */
+static void clock_control_tt_bh_slew(const struct clock_control_tt_bh_config *config,
+				     struct clock_control_tt_bh_data *data, uint32_t target_fbdiv)
+{
+	struct clock_control_tt_bh_slew_ctx ctx = {.config = config};
+	struct clock_control_tt_bh_slew_stats *stats = &data->slew_stats;
+
+	ctx.pll_cntl_1.val = clock_control_tt_bh_read_reg(config, PLL_CNTL_1_OFFSET);
+	if (ctx.pll_cntl_1.f.fbdiv == target_fbdiv) {
+		return;
+	}
+
+	uint32_t start = k_cycle_get_32();
+	uint32_t steps = tt_bh_pll_slew(ctx.pll_cntl_1.f.fbdiv, target_fbdiv,
+					clock_control_tt_bh_slew_write, &ctx);
+	uint32_t cycles = k_cycle_get_32() - start;
+
+	data->settings.pll_cntl_1.f.fbdiv = target_fbdiv;
+
+	stats->transitions++;
+	stats->steps += steps;
+	stats->last_steps = steps;
+	stats->last_ns = k_cyc_to_ns_floor32(cycles);
+	stats->max_ns = MAX(stats->max_ns, stats->last_ns);
+}
+
 static int clock_control_tt_bh_enable(const struct device *dev, clock_control_subsys_t sys,
 				      uint8_t enable)
 {
@@ -506,17 +549,13 @@ static int clock_control_tt_bh_set_rate(const struct device *dev, clock_control_
 		target_fbdiv =
 			clock_control_tt_bh_calculate_fbdiv(config->refclk_rate, (uint32_t)rate,
 							    pll_cntl_1, pll_cntl_5, use_postdiv, 0);
-
-		while (pll_cntl_1.f.fbdiv != target_fbdiv) {
-			if (target_fbdiv > pll_cntl_1.f.fbdiv) {
-				pll_cntl_1.f.fbdiv += 1;
-			} else {
-				pll_cntl_1.f.fbdiv -= 1;
-			}
-
-			clock_control_tt_bh_write_reg(config, PLL_CNTL_1_OFFSET, pll_cntl_1.val);
-			k_busy_wait_ns(100);
+		/* fbdiv is a 16-bit field */
+		if ((target_fbdiv == 0) || (target_fbdiv > UINT16_MAX)) {
+			k_spin_unlock(&data->lock, key);
+			return -EINVAL;
 		}
+
+		clock_control_tt_bh_slew(config, data, target_fbdiv);
 	} else if (clock == CLOCK_CONTROL_TT_BH_INIT_STATE) {
 		struct tt_bh_pll_settings settings = config->init_settings;
 
@@ -567,6 +606,33 @@ static int clock_control_tt_bh_configure(const struct device *dev, clock_control
 	return -ENOTSUP;
 }
 
+/**
+ * @brief Get the statistics of AICLK frequency transitions
+ *
+ * Like the other entry points of the driver, this doesn't spin on the lock, which set_rate holds
+ * with interrupts masked for the whole of a transition. A caller that finds a transition under
+ * way gets -EBUSY and reads the statistics on its next pass, rather than waiting it out.
+ *
+ * @param dev The PLL device
+ * @param stats Filled with the statistics since boot
+ * @return 0 on success, -EBUSY if the PLL is being reprogrammed
+ */
+int clock_control_tt_bh_get_slew_stats(const struct device *dev,
+				       struct clock_control_tt_bh_slew_stats *stats)
+{
+	struct clock_control_tt_bh_data *data = (struct clock_control_tt_bh_data *)dev->data;
+	k_spinlock_key_t key;
+
+	if (k_spin_trylock(&data->lock, &key) < 0) {
+		return -EBUSY;
+	}
+
+	*stats = data->slew_stats;
+
+	k_spin_unlock(&data->lock, key);
+	return 0;
+}
+
 static int clock_control_tt_bh_init(const struct device *dev)
 {
 	const struct clock_control_tt_bh_config *config =
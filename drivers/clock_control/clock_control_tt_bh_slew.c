@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "clock_control_tt_bh_slew.h"
+
+#include <zephyr/sys/util.h>
+
+/*
+ * The PLL is stepped by one fbdiv per write with 100 ns in between, which at the bottom of the
+ * AICLK range (fbdiv 32) is already a 1/32 step. With CONFIG_CLOCK_CONTROL_TT_BH_SLEW_RANGES,
+ * every range keeps to that relative step and settle time, so larger fbdivs take proportionally
+ * larger steps. max_step must not decrease with fbdiv_max.
+ */
+/* clang-format off */
+const struct tt_bh_pll_slew_range tt_bh_pll_slew_ranges[] = {
+#ifdef CONFIG_CLOCK_CONTROL_TT_BH_SLEW_RANGES
+	{ .fbdiv_max = 63,         .max_step = 1, .settle_ns = 100, },
+	{ .fbdiv_max = 127,        .max_step = 2, .settle_ns = 100, },
+	{ .fbdiv_max = 255,        .max_step = 4, .settle_ns = 100, },
+	{ .fbdiv_max = UINT16_MAX, .max_step = 8, .settle_ns = 100, },
+#else
+	{ .fbdiv_max = UINT16_MAX, .max_step = 1, .settle_ns = 100, },
+#endif
+};
+/* clang-format on */
+
+const size_t tt_bh_pll_slew_num_ranges = ARRAY_SIZE(tt_bh_pll_slew_ranges);
+
+const struct tt_bh_pll_slew_range *tt_bh_pll_slew_range_get(uint32_t fbdiv)
+{
+	for (size_t i = 0; i < tt_bh_pll_slew_num_ranges - 1; i++) {
+		if (fbdiv <= tt_bh_pll_slew_ranges[i].fbdiv_max) {
+			return &tt_bh_pll_slew_ranges[i];
+		}
+	}
+
+	return &tt_bh_pll_slew_ranges[tt_bh_pll_slew_num_ranges - 1];
+}
+
+/**
+ * @brief Find the next fbdiv on the way to target
+ *
+ * A step is limited by the range of its lower end, so that it is never larger relative to the
+ * VCO frequency than the table allows.
+ *
+ * @param fbdiv The current feedback divider
+ * @param target The final feedback divider
+ * @param settle_ns Set to the time to wait after writing the returned fbdiv
+ * @return The next feedback divider, target once it is within one step
+ */
+uint32_t tt_bh_pll_slew_next(uint32_t fbdiv, uint32_t target, uint32_t *settle_ns)
+{
+	const struct tt_bh_pll_slew_range *range;
+	uint32_t next;
+
+	if (target > fbdiv) {
+		range = tt_bh_pll_slew_range_get(fbdiv);
+		next = MIN(target, fbdiv + range->max_step);
+	} else {
+		uint32_t step = tt_bh_pll_slew_range_get(fbdiv)->max_step;
+
+		/* Stepping down into a smaller range, limit the step by that range instead */
+		range = tt_bh_pll_slew_range_get(fbdiv - MIN(step, fbdiv));
+		next = fbdiv - MIN(fbdiv - target, range->max_step);
+	}
+
+	*settle_ns = range->settle_ns;
+
+	return next;
+}
+
+/**
+ * @brief Slew the PLL feedback divider from fbdiv to target in the largest safe steps
+ *
+ * @return The number of writes
+ */
+uint32_t tt_bh_pll_slew(uint32_t fbdiv, uint32_t target, tt_bh_pll_slew_write_t write,
+			void *user_data)
+{
+	uint32_t steps = 0;
+
+	while (fbdiv != target) {
+		uint32_t settle_ns;
+
+		fbdiv = tt_bh_pll_slew_next(fbdiv, target, &settle_ns);
+		write(user_data, fbdiv, settle_ns);
+		steps++;
+	}
+
+	return steps;
+}
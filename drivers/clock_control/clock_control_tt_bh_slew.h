@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_DRIVERS_CLOCK_CONTROL_TT_BH_SLEW_H_
+#define ZEPHYR_DRIVERS_CLOCK_CONTROL_TT_BH_SLEW_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** @brief How far the PLL feedback divider may move in one write, for fbdiv up to fbdiv_max */
+struct tt_bh_pll_slew_range {
+	uint16_t fbdiv_max;
+	/** Largest fbdiv change per write */
+	uint8_t max_step;
+	/** Time for the PLL to settle after a write of up to max_step */
+	uint16_t settle_ns;
+};
+
+/** @brief Table of slew ranges in increasing fbdiv_max order, the last one covers any fbdiv */
+extern const struct tt_bh_pll_slew_range tt_bh_pll_slew_ranges[];
+extern const size_t tt_bh_pll_slew_num_ranges;
+
+/**
+ * @brief Write one fbdiv step and wait for the PLL to settle
+ *
+ * @param user_data As passed to @ref tt_bh_pll_slew
+ * @param fbdiv The next feedback divider
+ * @param settle_ns Time to wait after the write
+ */
+typedef void (*tt_bh_pll_slew_write_t)(void *user_data, uint32_t fbdiv, uint32_t settle_ns);
+
+const struct tt_bh_pll_slew_range *tt_bh_pll_slew_range_get(uint32_t fbdiv);
+uint32_t tt_bh_pll_slew_next(uint32_t fbdiv, uint32_t target, uint32_t *settle_ns);
+uint32_t tt_bh_pll_slew(uint32_t fbdiv, uint32_t target, tt_bh_pll_slew_write_t write,
+			void *user_data);
+
+#endif /* ZEPHYR_DRIVERS_CLOCK_CONTROL_TT_BH_SLEW_H_ */
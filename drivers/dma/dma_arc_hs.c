@@ -604,14 +604,12 @@ static int dma_arc_hs_get_attribute(const struct device *dev, uint32_t type, uin
 	return 0;
 }
 
-int dma_arc_hs_transfer(const struct device *dev, uint32_t channel, const void *src, void *dst,
-			size_t len, k_timeout_t timeout)
+int dma_arc_hs_transfer_start(const struct device *dev, uint32_t channel, const void *src,
+			      void *dst, size_t len)
 {
 	const struct arc_dma_config *dev_config = dev->config;
 	struct arc_dma_data *data = dev->data;
 	struct dma_config cfg = {0};
-	struct dma_status stat;
-	k_timepoint_t end_time;
 	int rc;
 	size_t num_blocks;
 	size_t max_block_size;
@@ -696,12 +694,13 @@ int dma_arc_hs_transfer(const struct device *dev, uint32_t channel, const void *
 		return rc;
 	}
 
-	rc = dma_start(dev, channel);
-	if (rc < 0) {
-		return rc;
-	}
+	return dma_start(dev, channel);
+}
 
-	end_time = sys_timepoint_calc(timeout);
+int dma_arc_hs_transfer_wait(const struct device *dev, uint32_t channel, k_timeout_t timeout)
+{
+	k_timepoint_t end_time = sys_timepoint_calc(timeout);
+	struct dma_status stat;
 
 	do {
 		if (dma_get_status(dev, channel, &stat) == 0 && !stat.busy) {
@@ -723,6 +722,18 @@ int dma_arc_hs_transfer(const struct device *dev, uint32_t channel, const void *
 	return -ETIMEDOUT;
 }
 
+int dma_arc_hs_transfer(const struct device *dev, uint32_t channel, const void *src, void *dst,
+			size_t len, k_timeout_t timeout)
+{
+	int rc = dma_arc_hs_transfer_start(dev, channel, src, dst, len);
+
+	if (rc < 0 || len == 0) {
+		return rc;
+	}
+
+	return dma_arc_hs_transfer_wait(dev, channel, timeout);
+}
+
 #if !DT_ALL_INST_HAS_PROP_STATUS_OKAY(interrupts)
 static void dma_arc_hs_check_completion(const struct device *dev, uint32_t channel)
 {
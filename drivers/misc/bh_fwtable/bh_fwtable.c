@@ -163,7 +163,8 @@ static int tt_bh_fwtable_load(const struct device *dev, enum bh_fwtable_e table)
 		.msg = &_msgtype##_msg,                                                            \
 	}
 
-	uint8_t buffer[256];
+	/* Only used during init, static to keep it off the init stack */
+	static uint8_t buffer[768];
 	size_t bytes_read = 0;
 	struct bh_fwtable_data *data = dev->data;
 	const struct bh_fwtable_config *config = dev->config;
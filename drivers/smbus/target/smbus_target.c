@@ -353,6 +353,13 @@ static int32_t smbus_target_init(const struct device *dev)
 	return 0;
 }
 
+struct i2c_target_config *smbus_target_get_config(const struct device *dev)
+{
+	struct smbus_target_data *data = dev->data;
+
+	return &data->config;
+}
+
 int32_t smbus_target_register_cmd(const struct device *dev, uint8_t cmd_id,
 				  const struct SmbusCmdDef *smbus_cmd)
 {
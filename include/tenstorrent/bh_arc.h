@@ -7,6 +7,7 @@
 #ifndef INCLUDE_TENSTORRENT_LIB_BH_ARC_H_
 #define INCLUDE_TENSTORRENT_LIB_BH_ARC_H_
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include <zephyr/drivers/smbus.h>
@@ -55,6 +56,22 @@ typedef struct cm2dmAck {
 	uint8_t seq_num;
 } __packed cm2dmAck;
 
+/**
+ * @brief Whether a CM2DM message is the next one to process
+ *
+ * Messages are processed strictly in sequence order. Anything else is a repeat of a message
+ * already processed, or arrived ahead of one that was lost, and the CMFW sends it again until
+ * it is acked.
+ *
+ * @param last_seq Sequence number of the last message processed
+ * @param last_seq_valid False if no message was processed since the CMFW was last reset
+ * @param seq Sequence number of the message
+ */
+static inline bool cm2dm_seq_is_next(uint8_t last_seq, bool last_seq_valid, uint8_t seq)
+{
+	return !last_seq_valid || seq == (uint8_t)(last_seq + 1);
+}
+
 union cm2dmAckWire {
 	cm2dmAck f;
 	uint16_t val;
@@ -78,6 +95,7 @@ int bharc_smbus_block_write(const struct bh_arc *dev, uint8_t cmd, uint8_t count
 int bharc_smbus_word_data_write(const struct bh_arc *dev, uint16_t cmd, uint16_t word);
 int bharc_smbus_word_data_read(const struct bh_arc *dev, uint16_t cmd, uint16_t *word);
 int bharc_smbus_byte_data_write(const struct bh_arc *dev, uint8_t cmd, uint8_t word);
+int bharc_smbus_byte_data_read(const struct bh_arc *dev, uint8_t cmd, uint8_t *byte);
 int bharc_smbus_block_write_block_read(const struct bh_arc *dev, uint8_t cmd, uint8_t snd_count,
 				       uint8_t *send_buf, uint8_t *rcv_count, uint8_t *rcv_buf);
 int bharc_enable_i2cbus(const struct bh_arc *dev);
@@ -8,6 +8,7 @@
 #define INCLUDE_TENSTORRENT_LIB_BH_CHIP_H_
 
 #include "bh_arc.h"
+#include "tt_smbus_regs.h"
 
 #include <zephyr/kernel.h>
 #include <zephyr/device.h>
@@ -87,6 +88,20 @@ struct bh_chip_data {
 	/* Last seen CM2DM message sequence number, to know if the current message is a repeat. */
 	uint8_t last_cm2dm_seq_num;
 	bool last_cm2dm_seq_num_valid;
+	/* The CMFW doesn't implement CMFW_SMBUS_REQ_WINDOW, read one message at a time */
+	bool cm2dm_window_unsupported;
+	/* CMFW_SMBUS_REQ_WINDOW requests refused in a row, see bh_chip_cmd_refused() */
+	uint8_t cm2dm_window_refusals;
+
+	/* Sequence number of the next CMFW_SMBUS_DMC_LOG_BULK chunk, once learnt from the CMFW */
+	uint8_t dmc_log_seq_num;
+	bool dmc_log_seq_num_valid;
+	/* Log bytes the CMFW has room for, as of its last reply */
+	uint16_t dmc_log_credits;
+	/* The CMFW doesn't implement CMFW_SMBUS_DMC_LOG_BULK, send logs with CMFW_SMBUS_DMC_LOG */
+	bool dmc_log_bulk_unsupported;
+	/* CMFW_SMBUS_DMC_LOG_BULK requests refused in a row, see bh_chip_cmd_refused() */
+	uint8_t dmc_log_bulk_refusals;
 
 	/* Cable power limit detected at boot, written to scratch register during resets. */
 	uint16_t cable_power_limit;
@@ -102,12 +117,28 @@ struct bh_chip_data {
 	uint32_t arc_start_time;
 };
 
+struct bh_chip;
+
+/* Runs the jobs submitted for a chip, as a bitmask of the application's job flags */
+typedef void (*bh_chip_job_handler_t)(struct bh_chip *chip, uint32_t jobs);
+
 struct bh_chip {
 	const struct bh_chip_config config;
 	struct bh_chip_data data;
 	struct gpio_callback therm_trip_cb;
 	struct gpio_callback pgood_cb;
 	struct k_timer auto_reset_timer;
+
+	/* Held while the chip's jobs run, and by other threads accessing its SMBus or JTAG */
+	struct k_mutex lock;
+	/* Jobs submitted and not run yet */
+	atomic_t jobs;
+	bh_chip_job_handler_t job_handler;
+#ifdef CONFIG_TT_BH_CHIP_WORKER
+	bool worker_started;
+	struct k_work job_work;
+	struct k_work_q worker;
+#endif
 };
 
 #define DT_PHANDLE_OR_CHILD(node_id, name)                                                         \
@@ -164,16 +195,27 @@ int jtag_bootrom_reset_sequence(struct bh_chip *chip, bool force_reset, uint16_t
 void bh_chip_cancel_bus_transfer_set(struct bh_chip *chip);
 void bh_chip_cancel_bus_transfer_clear(struct bh_chip *chip);
 
+bool bh_chip_cmd_refused(struct bh_chip *chip, int req_ret);
 cm2dmMessageRet bh_chip_get_cm2dm_message(struct bh_chip *chip);
+int bh_chip_get_cm2dm_window(struct bh_chip *chip, cm2dmMessage msgs[CMFW_SMBUS_CM2DM_WINDOW_SIZE],
+			     uint8_t *count, bool *more);
 int bh_chip_set_static_info(struct bh_chip *chip, dmStaticInfo *info);
 int bh_chip_set_input_power(struct bh_chip *chip, uint16_t power);
 int bh_chip_set_input_power_lim(struct bh_chip *chip, uint16_t max_power);
 int bh_chip_set_fan_rpm(struct bh_chip *chip, uint16_t rpm);
 int bh_chip_set_therm_trip_count(struct bh_chip *chip, uint16_t therm_trip_count);
 int bh_chip_write_logs(struct bh_chip *chip, char *log_data, size_t log_size);
+int bh_chip_write_log_chunk(struct bh_chip *chip, uint32_t dropped, const uint8_t *log_data,
+			    size_t log_size);
 
 void bh_chip_auto_reset(struct k_timer *timer);
 
+void bh_chip_jobs_init(struct bh_chip *chip, bh_chip_job_handler_t handler);
+void bh_chip_jobs_submit(struct bh_chip *chip, uint32_t jobs);
+#ifdef CONFIG_TT_BH_CHIP_WORKER
+void bh_chip_worker_start(struct bh_chip *chip, k_thread_stack_t *stack, size_t stack_size);
+#endif
+
 void bh_chip_assert_asic_reset(const struct bh_chip *chip);
 void bh_chip_deassert_asic_reset(const struct bh_chip *chip);
 
@@ -41,6 +41,15 @@ void log_backend_ringbuf_clear(void);
  */
 size_t log_backend_ringbuf_get_used(void);
 
+/**
+ * Get the number of bytes of log output lost since boot.
+ *
+ * Counts the bytes dropped in DROP mode and overwritten in OVERWRITE mode. Wraps around.
+ *
+ * @return Number of bytes lost
+ */
+uint32_t log_backend_ringbuf_get_dropped(void);
+
 #ifdef __cplusplus
 }
 #endif
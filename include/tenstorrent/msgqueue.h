@@ -11,8 +11,18 @@
 
 #include <zephyr/sys/iterable_sections.h>
 
-#define NUM_MSG_QUEUES         4
-#define MSG_QUEUE_SIZE         4
+#ifdef CONFIG_TT_BH_ARC_NUM_MSG_QUEUES
+#define NUM_MSG_QUEUES CONFIG_TT_BH_ARC_NUM_MSG_QUEUES
+#else
+#define NUM_MSG_QUEUES 4
+#endif
+
+#ifdef CONFIG_TT_BH_ARC_MSG_QUEUE_SIZE
+#define MSG_QUEUE_SIZE CONFIG_TT_BH_ARC_MSG_QUEUE_SIZE
+#else
+#define MSG_QUEUE_SIZE 4
+#endif
+
 #define MSG_QUEUE_POINTER_WRAP (2 * MSG_QUEUE_SIZE)
 #define REQUEST_MSG_LEN        8
 #define RESPONSE_MSG_LEN       8
@@ -24,6 +34,18 @@
 #define MESSAGE_QUEUE_STATUS_MESSAGE_RECOGNIZED 0xff
 #define MESSAGE_QUEUE_STATUS_SCRATCH_ONLY       0xfe
 
+/*
+ * Message queue layout version, found in message_queue_header::version.
+ *
+ * 0: Fixed 4 queues of depth 4, signalled together with MSI data 0 or the ARC IRQ.
+ * 1: Queue count and depth must be read from the message queue info block. Each queue can also
+ *    be signalled on its own with MSI data MSG_QUEUE_DOORBELL_MSI(n), so that only queues with
+ *    new work are scanned.
+ */
+#define MSG_QUEUE_LAYOUT_VERSION    1
+#define MSG_QUEUE_DOORBELL_MSI_BASE 0x10
+#define MSG_QUEUE_DOORBELL_MSI(n)   (MSG_QUEUE_DOORBELL_MSI_BASE + (n))
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -39,7 +61,7 @@ struct message_queue_header {
 	uint32_t request_queue_rptr;
 	uint32_t response_queue_wptr;
 	uint32_t last_serial;
-	uint32_t unused_3;
+	uint32_t version;
 };
 
 /**
@@ -117,6 +139,307 @@ struct counter_rqst {
 	uint16_t mask;
 };
 
+/** @brief Message queue statistics selectors */
+enum msgqueue_stats_select {
+	/** @brief Message count and summary latencies */
+	MSGQUEUE_STATS_SELECT_SUMMARY,
+	/** @brief Queue-wait time histogram */
+	MSGQUEUE_STATS_SELECT_WAIT_HIST,
+	/** @brief Handler execution time histogram */
+	MSGQUEUE_STATS_SELECT_EXEC_HIST,
+};
+
+/** @brief Clear all message queue statistics after the response has been built */
+#define MSGQUEUE_STATS_FLAG_CLEAR 0x1
+
+/** @brief Host request for message queue latency statistics
+ * @details Times are measured with the ARC cycle counter. Queue-wait time runs from the doorbell
+ * interrupt to the start of the handler, execution time covers the handler itself.
+ *
+ * For @ref MSGQUEUE_STATS_SELECT_SUMMARY the response is:
+ * - data[1]: number of messages handled with code msg_code
+ * - data[2]: maximum queue-wait time in cycles
+ * - data[3]: maximum execution time in cycles
+ * - data[4]: mean queue-wait time in cycles
+ * - data[5]: mean execution time in cycles
+ * - data[6]: milliseconds since statistics were last cleared
+ * - data[7]: cycle counter frequency in kHz
+ *
+ * For the histogram selectors, data[1..7] hold the counts of buckets bucket_offset to
+ * bucket_offset + 6. Bucket 0 counts samples below 64 cycles and each following bucket doubles
+ * the range, with the last of the 24 buckets counting everything above.
+ */
+struct msgqueue_stats_rqst {
+	/** @brief The command code corresponding to @ref TT_SMC_MSG_GET_MSGQUEUE_STATS */
+	uint8_t command_code;
+
+	/** @brief Three bytes of padding */
+	uint8_t pad[3];
+
+	/** @brief The message code to report statistics for */
+	uint8_t msg_code;
+
+	/** @brief The statistics to report, of type @ref msgqueue_stats_select */
+	uint8_t select;
+
+	/** @brief First histogram bucket to report */
+	uint8_t bucket_offset;
+
+	/** @brief Request flags, e.g. @ref MSGQUEUE_STATS_FLAG_CLEAR */
+	uint8_t flags;
+};
+
+/** @brief Stop executing a batch at the first sub-request with a nonzero status */
+#define BATCH_FLAG_STOP_ON_ERROR 0x1
+
+/** @brief Host request to run a list of sub-requests in one round trip
+ * @details Messages of this type are processed by @ref handle_batch.
+ *
+ * The host writes sub-requests into the batch entries of the queue it sends the batch on. The
+ * batch buffer holds the entries of every queue in queue order; its address and the number of
+ * entries per queue are published in words 2 and 3 of the message queue info block. Entries
+ * first_entry to first_entry + num_entries - 1 of the queue are run in order through the regular
+ * message handlers and each response is written to the response field of its entry.
+ *
+ * Sub-requests must not be @ref TT_SMC_MSG_BATCH, @ref TT_SMC_MSG_TEST or
+ * @ref TT_SMC_MSG_SET_LAST_SERIAL; these are answered with an error status.
+ *
+ * Response:
+ * - data[1]: number of sub-requests run
+ * - data[2]: number of sub-requests with a nonzero status
+ */
+struct batch_rqst {
+	/** @brief The command code corresponding to @ref TT_SMC_MSG_BATCH */
+	uint8_t command_code;
+
+	/** @brief Three bytes of padding */
+	uint8_t pad[3];
+
+	/** @brief Index of the first batch entry to run */
+	uint16_t first_entry;
+
+	/** @brief Number of batch entries to run */
+	uint16_t num_entries;
+
+	/** @brief Batch flags, e.g. @ref BATCH_FLAG_STOP_ON_ERROR */
+	uint32_t flags;
+};
+
+/** @brief Host request to configure the telemetry history recorder
+ * @details The history buffer address is published in @ref TAG_TELEM_HISTORY. Reconfiguring the
+ * recorder discards all recorded samples. A period of 0 stops recording.
+ *
+ * Samples are taken by the DVFS control loop, so nothing is recorded while DVFS is disabled.
+ * TAG_AICLK is the measured AICLK, as in the telemetry table, not the DVFS target.
+ *
+ * The response is:
+ * - data[1]: address of the telemetry history buffer
+ * - data[2]: capacity of the buffer in records
+ */
+struct telemetry_history_rqst {
+	/** @brief The command code corresponding to @ref TT_SMC_MSG_CONFIGURE_TELEMETRY_HISTORY */
+	uint8_t command_code;
+
+	/** @brief Number of valid entries in @ref tags */
+	uint8_t num_tags;
+
+	/** @brief Sample period in milliseconds, 0 to stop recording */
+	uint16_t period_ms;
+
+	/** @brief Telemetry tags to record */
+	uint8_t tags[8];
+};
+
+/** @brief Start a new statistics window for the tag after the response has been built */
+#define TELEMETRY_STATS_FLAG_RESET 0x1
+
+/** @brief Host request for the aggregated statistics of a telemetry tag
+ * @details Statistics are collected every control loop iteration (1 ms) for TAG_VCORE, TAG_TDP,
+ * TAG_TDC, TAG_ASIC_TEMPERATURE, TAG_AICLK and TAG_INPUT_POWER, in the encoding of the
+ * telemetry table. Values are compared as signed 32-bit integers.
+ *
+ * Samples are taken by the DVFS control loop, so windows stay empty while DVFS is disabled.
+ * TAG_AICLK is the measured AICLK, as in the telemetry table, not the DVFS target.
+ *
+ * The response is:
+ * - data[1]: minimum value in the window
+ * - data[2]: maximum value in the window
+ * - data[3]: mean value in the window, rounded towards zero
+ * - data[4]: number of samples in the window
+ * - data[5]: length of the window in milliseconds
+ */
+struct telemetry_stats_rqst {
+	/** @brief The command code corresponding to @ref TT_SMC_MSG_GET_TELEMETRY_STATS */
+	uint8_t command_code;
+
+	/** @brief The telemetry tag to report statistics for */
+	uint8_t tag;
+
+	/** @brief Request flags, e.g. @ref TELEMETRY_STATS_FLAG_RESET */
+	uint8_t flags;
+};
+
+/** @brief Enable the telemetry event subscription */
+#define TELEMETRY_EVENT_FLAG_ENABLE  0x1
+/** @brief Raise the event when the value falls to or below the threshold instead of rising to or
+ * above it
+ */
+#define TELEMETRY_EVENT_FLAG_FALLING 0x2
+
+/** @brief Host request to subscribe to threshold events on a telemetry tag
+ * @details The tag is checked every control loop iteration (1 ms), using the encoding of the
+ * telemetry table and comparing values as signed 32-bit integers. When the value crosses the
+ * threshold, the SMC writes a record to the telemetry event ring (address in
+ * @ref TAG_TELEM_EVENTS) and sends the MSI vector. The event is cleared, again with a record and
+ * an MSI, once the value moves back past the threshold by more than the hysteresis.
+ *
+ * For example, the host can watch TAG_ASIC_TEMPERATURE approaching its throttle limit,
+ * TAG_INPUT_POWER approaching the board power limit, or TAG_AICLK_THROTTLE_MASK with a threshold
+ * of 1 to be told when any throttler starts limiting AICLK.
+ *
+ * The check runs in the DVFS control loop, so no events are raised while DVFS is disabled.
+ *
+ * Writing a subscription resets its state. The response is:
+ * - data[1]: address of the telemetry event ring
+ * - data[2]: capacity of the ring in records
+ */
+struct telemetry_event_rqst {
+	/** @brief The command code corresponding to @ref TT_SMC_MSG_TELEMETRY_EVENT_SUBSCRIBE */
+	uint8_t command_code;
+
+	/** @brief Subscription slot to write */
+	uint8_t subscription;
+
+	/** @brief The telemetry tag to watch */
+	uint8_t tag;
+
+	/** @brief Subscription flags, e.g. @ref TELEMETRY_EVENT_FLAG_ENABLE */
+	uint8_t flags;
+
+	/** @brief Threshold value */
+	uint32_t threshold;
+
+	/** @brief Distance past the threshold needed to clear the event */
+	uint32_t hysteresis;
+
+	/** @brief The PCIE instance 0 or 1 to send the MSI on */
+	uint8_t pcie_inst;
+
+	/** @brief MSI vector ID */
+	uint8_t msi_vector;
+};
+
+/** @brief Enable the throttler's AICLK arbiter */
+#define THROTTLER_PARAMS_FLAG_ENABLE   0x1
+/** @brief Disable the throttler's AICLK arbiter */
+#define THROTTLER_PARAMS_FLAG_DISABLE  0x2
+/** @brief Only report the current parameters, all other fields are ignored */
+#define THROTTLER_PARAMS_FLAG_QUERY    0x4
+/** @brief Restore the parameters in effect before the last successful update, all other fields
+ * are ignored
+ */
+#define THROTTLER_PARAMS_FLAG_ROLLBACK 0x8
+
+/** @brief Host request to set the parameters of a throttler
+ * @details The gains and filter coefficient are signed 16.16 fixed point, like telemetry values.
+ * The request is validated as a whole and either applied completely or not at all: alpha_filter
+ * must be in (0, 1], the gains in [0, 2] and the limit within the throttler's supported range.
+ * A limit of 0 keeps the current limit, and the arbiter is left as it is unless
+ * @ref THROTTLER_PARAMS_FLAG_ENABLE or @ref THROTTLER_PARAMS_FLAG_DISABLE is set. The new values
+ * are used from the next throttler iteration (1 ms).
+ *
+ * Each successful update saves the parameters it replaces, so that a single
+ * @ref THROTTLER_PARAMS_FLAG_ROLLBACK request undoes it.
+ *
+ * The response is, after the request has been applied:
+ * - data[1]: limit, in the throttler's units
+ * - data[2]: alpha_filter
+ * - data[3]: p_gain
+ * - data[4]: d_gain
+ * - data[5]: 1 if the throttler's arbiter is enabled, 0 otherwise
+ */
+struct throttler_params_rqst {
+	/** @brief The command code corresponding to @ref TT_SMC_MSG_SET_THROTTLER_PARAMS */
+	uint8_t command_code;
+
+	/** @brief The throttler to configure: 0 TDP, 1 fast TDC, 2 TDC, 3 thermal, 4 board power,
+	 * 5 GDDR thermal, 6 Doppler slow
+	 */
+	uint8_t throttler;
+
+	/** @brief Request flags, e.g. @ref THROTTLER_PARAMS_FLAG_ENABLE */
+	uint8_t flags;
+
+	/** @brief One byte of padding */
+	uint8_t pad;
+
+	/** @brief The limit, in W, A or degC depending on the throttler */
+	uint32_t limit;
+
+	/** @brief Input filter coefficient, 1 for no filtering */
+	uint32_t alpha_filter;
+
+	/** @brief Proportional gain */
+	uint32_t p_gain;
+
+	/** @brief Derivative gain */
+	uint32_t d_gain;
+};
+
+/** @brief Host request to read the VF table used by DVFS
+ * @details The SMC evaluates the VF model once at boot into a table of voltages at evenly spaced
+ * AICLK frequencies, and interpolates between the entries in DVFS. The values read include the
+ * process and board margins.
+ *
+ * The response is:
+ * - data[1]: number of entries in the table
+ * - data[2]: frequency of entry first_entry in MHz
+ * - data[3]: frequency step between entries in MHz
+ * - data[4..7]: voltage of entries first_entry to first_entry + 3 in mV, unsigned 16.16 fixed
+ *   point, 0 past the end of the table
+ */
+struct vf_table_rqst {
+	/** @brief The command code corresponding to @ref TT_SMC_MSG_GET_VF_TABLE */
+	uint8_t command_code;
+
+	/** @brief Three bytes of padding */
+	uint8_t pad[3];
+
+	/** @brief Index of the first entry to read */
+	uint32_t first_entry;
+};
+
+/** @brief Discard the recorded DVFS iterations */
+#define DVFS_TRACE_FLAG_CLEAR 0x1
+/** @brief Stop recording, e.g. to keep the iterations leading up to an event */
+#define DVFS_TRACE_FLAG_STOP  0x2
+/** @brief Resume recording */
+#define DVFS_TRACE_FLAG_START 0x4
+
+/** @brief Host request to locate and control the DVFS decision trace
+ * @details Every DVFS iteration (1 ms) records the target AICLK, the arbiter that chose it, the
+ * requested and target voltage, and the time taken by each stage into a ring buffer, whose
+ * address is also published in @ref TAG_DVFS_TRACE. The flags are applied in the order clear,
+ * stop, start; setting both @ref DVFS_TRACE_FLAG_STOP and @ref DVFS_TRACE_FLAG_START is an
+ * error. A request without flags only reports the location of the buffer.
+ *
+ * The response is, after the flags have been applied:
+ * - data[1]: address of the DVFS trace buffer
+ * - data[2]: capacity of the buffer in records
+ * - data[3]: number of records written since the trace was last cleared
+ * - data[4]: 1 if recording, 0 if stopped
+ */
+struct dvfs_trace_rqst {
+	/** @brief The command code corresponding to @ref TT_SMC_MSG_DVFS_TRACE */
+	uint8_t command_code;
+
+	/** @brief Request flags, e.g. @ref DVFS_TRACE_FLAG_CLEAR */
+	uint8_t flags;
+
+	/** @brief Two bytes of padding */
+	uint8_t pad[2];
+};
+
 /** @brief Host request to force the fan speed */
 struct force_fan_speed_rqst {
 	/** @brief The command code corresponding to @ref TT_SMC_MSG_FORCE_FAN_SPEED*/
@@ -956,6 +1279,30 @@ union request {
 	/** @brief A generic counter request */
 	struct counter_rqst counter;
 
+	/** @brief A batch request */
+	struct batch_rqst batch;
+
+	/** @brief A message queue statistics request */
+	struct msgqueue_stats_rqst msgqueue_stats;
+
+	/** @brief A telemetry history configuration request */
+	struct telemetry_history_rqst telemetry_history;
+
+	/** @brief A telemetry statistics request */
+	struct telemetry_stats_rqst telemetry_stats;
+
+	/** @brief A telemetry event subscription request */
+	struct telemetry_event_rqst telemetry_event;
+
+	/** @brief A throttler parameter request */
+	struct throttler_params_rqst throttler_params;
+
+	/** @brief A VF table request */
+	struct vf_table_rqst vf_table;
+
+	/** @brief A DVFS trace request */
+	struct dvfs_trace_rqst dvfs_trace;
+
 	/** @brief A set watchdog timeout request */
 	struct set_wdt_timeout_rqst set_wdt_timeout;
 
@@ -977,6 +1324,12 @@ struct response {
 	uint32_t data[RESPONSE_MSG_LEN];
 };
 
+/** @brief One sub-request of a @ref batch_rqst, and its response */
+struct msgqueue_batch_entry {
+	union request request;
+	struct response response;
+};
+
 typedef uint8_t (*msgqueue_request_handler_t)(const union request *req, struct response *rsp);
 
 struct msgqueue_handler {
@@ -993,10 +1346,64 @@ struct msgqueue_handler {
 void process_message_queues(void);
 void msgqueue_register_handler(uint32_t msg_code, msgqueue_request_handler_t handler);
 
+/** @brief Identifies a deferred response, see @ref msgqueue_defer_response */
+struct msgqueue_token {
+	uint32_t msgqueue_id;
+	uint32_t generation;
+};
+
+/** @brief Called when a deferred response is cancelled by @ref msgqueue_reset_queue */
+typedef void (*msgqueue_cancel_t)(struct msgqueue_token token, void *user_data);
+
+/**
+ * @brief Defer the response to the message currently being handled
+ *
+ * Must be called from a message handler. The handler's own response and return value are then
+ * discarded and the response is sent when @ref msgqueue_complete_response is called with the
+ * returned token, e.g. from a work item or a DMA completion callback. Other queues keep being
+ * processed in the meantime; later requests in the same queue wait, so that responses stay in
+ * request order.
+ *
+ * @param[out] token Token to pass to @ref msgqueue_complete_response
+ * @param cancel Optional callback, run if the queue is reset before completion
+ * @param user_data Passed to @p cancel
+ *
+ * @retval 0 The response is deferred
+ * @retval -ENOTSUP The message cannot be deferred (e.g. it is part of a batch); the handler must
+ *         complete synchronously
+ */
+int msgqueue_defer_response(struct msgqueue_token *token, msgqueue_cancel_t cancel,
+			    void *user_data);
+
+/**
+ * @brief Send a deferred response
+ *
+ * May be called from any context, including interrupts.
+ *
+ * @param token Token returned by @ref msgqueue_defer_response
+ * @param response Response to send, or NULL for an empty response
+ * @param exit_code Status merged into data[0] of the response, as returned by a handler
+ *
+ * @retval 0 The response was sent
+ * @retval -ECANCELED The response was already sent or the queue was reset
+ * @retval -EINVAL Invalid token
+ */
+int msgqueue_complete_response(struct msgqueue_token token, const struct response *response,
+			       uint8_t exit_code);
+
+/**
+ * @brief Reset a message queue, cancelling its deferred response if there is one
+ *
+ * @retval 0 on success
+ * @retval -EINVAL Invalid queue
+ */
+int msgqueue_reset_queue(uint32_t msgqueue_id);
+
 int msgqueue_request_push(uint32_t msgqueue_id, const union request *request);
 int msgqueue_request_pop(uint32_t msgqueue_id, union request *request);
 int msgqueue_response_push(uint32_t msgqueue_id, const struct response *response);
 int msgqueue_response_pop(uint32_t msgqueue_id, struct response *response);
+struct msgqueue_batch_entry *msgqueue_batch_entries(uint32_t msgqueue_id, uint32_t *num_entries);
 void init_msgqueue(void);
 
 #ifdef __cplusplus
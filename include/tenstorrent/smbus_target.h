@@ -8,6 +8,7 @@
 #define SMBUS_TARGET
 
 #include <stdint.h>
+#include <zephyr/drivers/i2c.h>
 
 /**
  * @brief A list of supported SMBUS transaction types
@@ -55,4 +56,13 @@ struct SmbusCmdDef {
  */
 int32_t smbus_target_register_cmd(const struct device *dev, uint8_t cmd_id,
 				  const struct SmbusCmdDef *smbus_cmd);
+
+/**
+ * @brief Get the I2C target config of the SMBUS target
+ * @details For I2C controllers driven outside of the Zephyr I2C API, which call the
+ *          target callbacks with this config instead of registering it with
+ *          i2c_target_register.
+ * @param dev The SMBUS target device.
+ */
+struct i2c_target_config *smbus_target_get_config(const struct device *dev);
 #endif
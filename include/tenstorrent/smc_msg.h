@@ -94,9 +94,33 @@ enum tt_smc_msg {
 	/** @brief @ref counter_rqst "Generic Counter Request" */
 	TT_SMC_MSG_COUNTER = 0x35,
 
+	/** @brief @ref msgqueue_stats_rqst "Message queue statistics request" */
+	TT_SMC_MSG_GET_MSGQUEUE_STATS = 0x36,
+
+	/** @brief @ref batch_rqst "Batched sub-requests" */
+	TT_SMC_MSG_BATCH = 0x37,
+
+	/** @brief @ref telemetry_history_rqst "Configure telemetry history request" */
+	TT_SMC_MSG_CONFIGURE_TELEMETRY_HISTORY = 0x38,
+
 	/** @brief @ref force_vdd_rqst "Force VDD voltage request" */
 	TT_SMC_MSG_FORCE_VDD = 0x39,
 
+	/** @brief @ref telemetry_stats_rqst "Telemetry statistics request" */
+	TT_SMC_MSG_GET_TELEMETRY_STATS = 0x3A,
+
+	/** @brief @ref telemetry_event_rqst "Telemetry event subscription request" */
+	TT_SMC_MSG_TELEMETRY_EVENT_SUBSCRIBE = 0x3B,
+
+	/** @brief @ref throttler_params_rqst "Set throttler parameters request" */
+	TT_SMC_MSG_SET_THROTTLER_PARAMS = 0x3C,
+
+	/** @brief @ref vf_table_rqst "Read VF table request" */
+	TT_SMC_MSG_GET_VF_TABLE = 0x3D,
+
+	/** @brief @ref dvfs_trace_rqst "DVFS decision trace request" */
+	TT_SMC_MSG_DVFS_TRACE = 0x3E,
+
 	/** @brief @ref aiclk_set_speed_rqst "AI Clock Set Busy Speed Request"*/
 	TT_SMC_MSG_AICLK_GO_BUSY = 0x52,
 
@@ -12,6 +12,25 @@
 
 #include <zephyr/device.h>
 
+/**
+ * @brief Stages of a streamed image transfer
+ *
+ * The producer fills a buffer with the next part of the image, the consumer moves it out. A
+ * consumer with a @ref wait callback may complete asynchronously, and the producer then fills the
+ * next buffer while it does.
+ */
+struct spi_transfer_pipe {
+	/** Read @p len bytes of the image at @p offset into @p buf */
+	int (*read)(void *user_data, size_t offset, uint8_t *buf, size_t len);
+	/** Start moving @p len bytes of the image at @p offset out of @p src */
+	int (*start)(void *user_data, const uint8_t *src, size_t offset, size_t len);
+	/** Wait for the oldest transfer started to complete, NULL if @ref start completes them */
+	int (*wait)(void *user_data);
+	void *user_data;
+};
+
+int spi_transfer_pipelined(const struct spi_transfer_pipe *pipe, size_t image_size, uint8_t *buf,
+			   size_t buf_size, size_t num_bufs);
 int spi_transfer_by_parts(const struct device *dev, size_t spi_address, size_t image_size,
 			  uint8_t *buf, size_t buf_size, uint8_t *tlb_dst,
 			  int (*cb)(const uint8_t *src, uint8_t *dst, size_t len));
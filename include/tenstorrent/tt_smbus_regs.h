@@ -48,6 +48,26 @@ enum CMFWSMBusReg {
 
 	/* RO, 2 bytes. Read data to verify the SMC got this ping request */
 	CMFW_SMBUS_PING_V2 = 0x2A,
+	/* RW, 40 bits in, up to 64 bytes out. Read several telemetry tags in one transaction.
+	 * In: first tag (8 bits), little-endian bitmap of tags first + 0..31 (32 bits).
+	 * Out: tag count (8 bits), status (8 bits), low 16 bits of the telemetry generation,
+	 * then one 32-bit value per selected tag in ascending tag order.
+	 */
+	CMFW_SMBUS_TELEMETRY_BULK_READ = 0x2B,
+	/* RW, 24 bits in, up to 50 bytes out. Read several CM2DM messages, acking earlier ones.
+	 * In: flags (8 bits, CMFW_SMBUS_CM2DM_ACK_VALID), sequence number of the last message
+	 * processed (8 bits), acking it and every message before it, then its complement (8 bits).
+	 * Out: message count (8 bits), flags (8 bits, CMFW_SMBUS_CM2DM_MORE_PENDING), then up to
+	 * CMFW_SMBUS_CM2DM_WINDOW_SIZE cm2dmMessage structs in sequence order.
+	 */
+	CMFW_SMBUS_REQ_WINDOW = 0x2C,
+	/* RW, up to 32 bytes in, 24 bits out. Write a chunk of data to log from DMC side.
+	 * In: sequence number (8 bits), low 16 bits of the count of log bytes the DMC dropped, then
+	 * up to CMFW_SMBUS_DMC_LOG_CHUNK_SIZE log bytes and the CRC-8 of the bytes before it.
+	 * Out: sequence number of the last chunk taken (8 bits), then the number of log bytes the
+	 * CMFW has room for (16 bits). A chunk without log bytes only reads the reply.
+	 */
+	CMFW_SMBUS_DMC_LOG_BULK = 0x2D,
 	/* RO, 8 bits. Issue a test read from CMFW scratch register */
 	CMFW_SMBUS_TEST_READ = 0xD8,
 	/* WO, 8 bits. Write to CMFW scratch register */
@@ -65,6 +85,19 @@ enum CMFWSMBusReg {
 	CMFW_SMBUS_MSG_MAX,
 };
 
+/* Most tags one CMFW_SMBUS_TELEMETRY_BULK_READ can return, bounded by the 64 byte block */
+#define CMFW_SMBUS_TELEMETRY_BULK_MAX_TAGS 15
+
+/* Most CM2DM messages in flight with CMFW_SMBUS_REQ_WINDOW, 2 + 6 * 8 bytes fit in one block */
+#define CMFW_SMBUS_CM2DM_WINDOW_SIZE 8
+/* CMFW_SMBUS_REQ_WINDOW in flags: the sequence number acks the messages up to it */
+#define CMFW_SMBUS_CM2DM_ACK_VALID    0x01
+/* CMFW_SMBUS_REQ_WINDOW out flags: more messages are waiting for space in the window */
+#define CMFW_SMBUS_CM2DM_MORE_PENDING 0x01
+
+/* Most log bytes in one CMFW_SMBUS_DMC_LOG_BULK chunk, with the header and CRC in a 32 byte block */
+#define CMFW_SMBUS_DMC_LOG_CHUNK_SIZE 28
+
 /* Request IDs that the CMFW can issue within the */
 
 #endif /* TT_SMBUS_MSGS_H_ */
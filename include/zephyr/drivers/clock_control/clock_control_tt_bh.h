@@ -7,6 +7,8 @@
 #ifndef ZEPHYR_INCLUDE_DRIVERS_PLL_H_
 #define ZEPHYR_INCLUDE_DRIVERS_PLL_H_
 
+#include <stdint.h>
+
 enum clock_control_tt_bh_clock {
 	CLOCK_CONTROL_TT_BH_CLOCK_AICLK,
 	CLOCK_CONTROL_TT_BH_CLOCK_ARCCLK,
@@ -24,4 +26,23 @@ enum clock_control_tt_bh_clock_config {
 	CLOCK_CONTROL_TT_BH_CONFIG_BYPASS
 };
 
+/** @brief Statistics of AICLK frequency transitions, see @ref clock_control_tt_bh_get_slew_stats */
+struct clock_control_tt_bh_slew_stats {
+	/** Number of frequency changes */
+	uint32_t transitions;
+	/** Total number of feedback divider writes */
+	uint32_t steps;
+	/** Feedback divider writes of the last frequency change */
+	uint32_t last_steps;
+	/** Duration of the last frequency change in ns */
+	uint32_t last_ns;
+	/** Duration of the longest frequency change in ns */
+	uint32_t max_ns;
+};
+
+struct device;
+
+int clock_control_tt_bh_get_slew_stats(const struct device *dev,
+				       struct clock_control_tt_bh_slew_stats *stats);
+
 #endif /* ZEPHYR_INCLUDE_DRIVERS_PLL_H_ */
@@ -20,3 +20,29 @@
 
 int dma_arc_hs_transfer(const struct device *dev, uint32_t channel, const void *src, void *dst,
 			size_t len, k_timeout_t timeout);
+
+/**
+ * @brief Start a memory-to-memory transfer using ARC HS DMA
+ *
+ * Returns once the transfer is started. Complete it with dma_arc_hs_transfer_wait() before
+ * starting another transfer on the same device, the transfer's blocks are kept by the device.
+ *
+ * @param dev     DMA device (from DEVICE_DT_GET)
+ * @param channel DMA channel (0 to N-1)
+ * @param src     Source address (4-byte aligned)
+ * @param dst     Destination address (4-byte aligned)
+ * @param len     Transfer length in bytes
+ * @return 0 on success, negative errno on error
+ */
+int dma_arc_hs_transfer_start(const struct device *dev, uint32_t channel, const void *src,
+			      void *dst, size_t len);
+
+/**
+ * @brief Wait for a transfer started with dma_arc_hs_transfer_start() to complete
+ *
+ * @param dev     DMA device (from DEVICE_DT_GET)
+ * @param channel DMA channel the transfer was started on
+ * @param timeout Timeout for the transfer
+ * @return 0 on success, -ETIMEDOUT if the transfer was stopped on timeout
+ */
+int dma_arc_hs_transfer_wait(const struct device *dev, uint32_t channel, k_timeout_t timeout);
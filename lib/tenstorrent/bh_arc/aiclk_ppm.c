@@ -78,6 +78,8 @@ static bool last_msg_busy;
 static uint32_t final_arbiter_count[aiclk_arb_max_count];
 static uint32_t throttler_frozen_mask;
 static uint32_t throttler_overflow_mask;
+/* Max arbiters that limited AICLK in the last CalculateTargAiclk call */
+static uint32_t throttling_arb_mask;
 
 void SetAiclkArbMax(enum aiclk_arb_max arb_max, float freq)
 {
@@ -124,12 +126,17 @@ void CalculateTargAiclk(void)
 	/* Throttling only if we are below Fmax and busy arbiter is at Fmax */
 	bool throttling = (aiclk_ppm.targ_freq != aiclk_ppm.fmax);
 	bool aiclk_busy = (aiclk_ppm.arbiter_min[aiclk_arb_min_busy].value == aiclk_ppm.fmax);
+	uint32_t arb_mask = 0;
 
 	for (enum aiclk_arb_max i = 0; i < aiclk_arb_max_count; ++i) {
 		bool arbiter_enabled = aiclk_ppm.arbiter_max[i].enabled;
 
 		if (arbiter_enabled && aiclk_ppm.arbiter_max[i].value == aiclk_ppm.targ_freq &&
-		    throttling && aiclk_busy && !(throttler_frozen_mask & BIT(i))) {
+		    throttling && aiclk_busy) {
+			arb_mask |= BIT(i);
+		}
+
+		if ((arb_mask & BIT(i)) && !(throttler_frozen_mask & BIT(i))) {
 			if (final_arbiter_count[i] < UINT32_MAX) {
 				final_arbiter_count[i]++;
 			} else {
@@ -137,6 +144,7 @@ void CalculateTargAiclk(void)
 			}
 		}
 	}
+	throttling_arb_mask = arb_mask;
 
 	/* Make sure target is not below Fmin or host-requested minimum */
 	/* (it will not be above Fmax, since we calculated the max limits last) */
@@ -470,6 +478,18 @@ union aiclk_targ_freq_info get_targ_aiclk_info(void)
 	return aiclk_ppm.lim_arb_info;
 }
 
+/**
+ * @brief Get the max arbiters that are throttling AICLK
+ *
+ * @return Bitmask of @ref aiclk_arb_max arbiters that limited the target frequency in the last
+ * control loop iteration, i.e. those whose final_arbiter_count was incremented (ignoring the
+ * freeze mask)
+ */
+uint32_t get_throttling_arb_mask(void)
+{
+	return throttling_arb_mask;
+}
+
 static uint8_t set_arb_host_fmax_handler(const union request *request, struct response *response)
 {
 	uint32_t new_fmax;
@@ -29,6 +29,7 @@ enum aiclk_arb_max {
 	aiclk_arb_max_doppler_slow,     /**< Doppler slow throttling limit */
 	aiclk_arb_max_doppler_critical, /**< Doppler critical throttling limit */
 	aiclk_arb_max_host_fmax,        /**< Host-adjustable fmax ceiling */
+	aiclk_arb_max_doppler_predict,  /**< Doppler predicted power limit */
 	aiclk_arb_max_count,            /**< Number of max arbiters */
 };
 
@@ -93,6 +94,7 @@ uint32_t get_aiclk_effective_arb_max(enum aiclk_arb_max *effective_max_arb);
 uint32_t get_enabled_arb_min_bitmask(void);
 uint32_t get_enabled_arb_max_bitmask(void);
 union aiclk_targ_freq_info get_targ_aiclk_info(void);
+uint32_t get_throttling_arb_mask(void);
 
 struct response;
 union request;
@@ -9,6 +9,7 @@
 
 #include <tenstorrent/sys_init_defines.h>
 #include <zephyr/init.h>
+#include <zephyr/kernel.h>
 #include <zephyr/sys/util.h>
 #include <zephyr/device.h>
 #include <zephyr/devicetree.h>
@@ -42,7 +43,6 @@ static const struct device *const pll_dev_1 = DEVICE_DT_GET_OR_NULL(DT_NODELABEL
 #define APB2AVSBUS_AVS_CMD_R_OR_W_SHIFT         28
 #define APB2AVSBUS_AVS_READBACK_SLAVE_ACK_SHIFT 30
 
-#define NULL                                 ((void *)0)
 #define GET_AVS_FIELD_SHIFT(REG_NAME, FIELD) APB2AVSBUS_AVS_##REG_NAME##_##FIELD##_SHIFT
 #define GET_AVS_FIELD_MASK(REG_NAME, FIELD)  APB2AVSBUS_AVS_##REG_NAME##_##FIELD##_MASK
 #define AVS_RD_CMD_DATA                      0xffff
@@ -153,6 +153,23 @@ static void SendCmd(uint16_t cmd_data, uint8_t rail_sel, uint8_t cmd_code, uint8
 		 cmd_data_pos | rail_sel_pos | cmd_code_pos | cmd_grp_pos | r_or_w_pos);
 }
 
+/* The AVS bus is shared by the DVFS control loop, telemetry and host message handlers, which
+ * run on separate work queues. Commands and their readback must not interleave.
+ */
+static K_MUTEX_DEFINE(avs_lock);
+
+static AVSStatus AVSTransaction(uint16_t cmd_data, uint8_t rail_sel, uint8_t cmd_code,
+				uint8_t cmd_grp, AVSReadWriteType r_or_w, uint16_t *response)
+{
+	k_mutex_lock(&avs_lock, K_FOREVER);
+	SendCmd(cmd_data, rail_sel, cmd_code, cmd_grp, r_or_w);
+	AVSStatus status = ReadRxFifo(response);
+
+	k_mutex_unlock(&avs_lock);
+
+	return status;
+}
+
 /* Program CFG_0, CFG_1 registers and interrupt settings. */
 /* Use default max_retries, resync_interval, clk_divide_value, and clk_divider_duty_cycle_numerator
  */
@@ -190,14 +207,13 @@ void AVSInit(void)
 
 AVSStatus AVSReadVoltage(uint8_t rail_sel, uint16_t *voltage_in_mV)
 {
-	SendCmd(AVS_RD_CMD_DATA, rail_sel, AVS_CMD_VOLTAGE, AVSRead);
-	return ReadRxFifo(voltage_in_mV);
+	return AVSTransaction(AVS_RD_CMD_DATA, rail_sel, AVS_CMD_VOLTAGE, AVSRead, voltage_in_mV);
 }
 
 AVSStatus AVSWriteVoltage(uint16_t voltage_in_mV, uint8_t rail_sel)
 {
-	SendCmd(voltage_in_mV, rail_sel, AVS_CMD_VOLTAGE, AVSCommitWrite);
-	AVSStatus status = ReadRxFifo(NULL);
+	AVSStatus status =
+		AVSTransaction(voltage_in_mV, rail_sel, AVS_CMD_VOLTAGE, AVSCommitWrite, NULL);
 
 	/* 150us to cover voltage switch from 0.65V to 0.95V with 50us of margin */
 	WaitUs(150);
@@ -206,9 +222,9 @@ AVSStatus AVSWriteVoltage(uint16_t voltage_in_mV, uint8_t rail_sel)
 
 AVSStatus AVSReadVoutTransRate(uint8_t rail_sel, uint8_t *rise_rate, uint8_t *fall_rate)
 {
-	SendCmd(AVS_RD_CMD_DATA, rail_sel, AVS_CMD_VOUT_TRANS_RATE, AVSRead);
 	uint16_t trans_rate;
-	AVSStatus status = ReadRxFifo(&trans_rate);
+	AVSStatus status = AVSTransaction(AVS_RD_CMD_DATA, rail_sel, AVS_CMD_VOUT_TRANS_RATE,
+					  AVSRead, &trans_rate);
 	*rise_rate = trans_rate >> 8;
 	*fall_rate = trans_rate & 0xff;
 	return status;
@@ -218,59 +234,55 @@ AVSStatus AVSWriteVoutTransRate(uint8_t rise_rate, uint8_t fall_rate, uint8_t ra
 {
 	uint16_t trans_rate = (rise_rate << 8) | fall_rate;
 
-	SendCmd(trans_rate, rail_sel, AVS_CMD_VOUT_TRANS_RATE, AVSCommitWrite);
-	return ReadRxFifo(NULL);
+	return AVSTransaction(trans_rate, rail_sel, AVS_CMD_VOUT_TRANS_RATE, AVSCommitWrite, NULL);
 }
 
 /* Returns current in A */
 AVSStatus AVSReadCurrent(uint8_t rail_sel, float *current_in_A)
 {
-	SendCmd(AVS_RD_CMD_DATA, rail_sel, AVS_CMD_CURRENT_READ, AVSRead);
 	uint16_t current_in_10mA;
-	AVSStatus status = ReadRxFifo(&current_in_10mA);
+	AVSStatus status = AVSTransaction(AVS_RD_CMD_DATA, rail_sel, AVS_CMD_CURRENT_READ, AVSRead,
+					  &current_in_10mA);
 	*current_in_A = current_in_10mA * 0.01f;
 	return status;
 }
 
 AVSStatus AVSReadTemp(uint8_t rail_sel, float *temp_in_C)
 {
-	SendCmd(AVS_RD_CMD_DATA, rail_sel, AVS_CMD_TEMP_READ, AVSRead);
 	uint16_t temp; /* 1LSB = 0.1degC  */
-	AVSStatus status = ReadRxFifo(&temp);
+	AVSStatus status =
+		AVSTransaction(AVS_RD_CMD_DATA, rail_sel, AVS_CMD_TEMP_READ, AVSRead, &temp);
 	*temp_in_C = temp * 0.1;
 	return status;
 }
 
 AVSStatus AVSForceVoltageReset(uint8_t rail_sel)
 {
-	SendCmd(AVS_FORCE_RESET_DATA, rail_sel, AVS_CMD_FORCE_RESET, AVSCommitWrite);
-	return ReadRxFifo(NULL);
+	return AVSTransaction(AVS_FORCE_RESET_DATA, rail_sel, AVS_CMD_FORCE_RESET, AVSCommitWrite,
+			      NULL);
 }
 
 /* This command is not supported by MAX20816, but will be ACKed. */
 AVSStatus AVSReadPowerMode(uint8_t rail_sel, AVSPwrMode *power_mode)
 {
-	SendCmd(AVS_RD_CMD_DATA, rail_sel, AVS_CMD_POWER_MODE, AVSRead);
-	return ReadRxFifo((uint16_t *)power_mode);
+	return AVSTransaction(AVS_RD_CMD_DATA, rail_sel, AVS_CMD_POWER_MODE, AVSRead,
+			      (uint16_t *)power_mode);
 }
 
 /* This command is not supported by MAX20816, but will be ACKed. */
 AVSStatus AVSWritePowerMode(AVSPwrMode power_mode, uint8_t rail_sel)
 {
-	SendCmd(power_mode, rail_sel, AVS_CMD_POWER_MODE, AVSCommitWrite);
-	return ReadRxFifo(NULL);
+	return AVSTransaction(power_mode, rail_sel, AVS_CMD_POWER_MODE, AVSCommitWrite, NULL);
 }
 
 AVSStatus AVSReadStatus(uint8_t rail_sel, uint16_t *status)
 {
-	SendCmd(AVS_RD_CMD_DATA, rail_sel, AVS_CMD_STATUS, AVSRead);
-	return ReadRxFifo(status);
+	return AVSTransaction(AVS_RD_CMD_DATA, rail_sel, AVS_CMD_STATUS, AVSRead, status);
 }
 
 AVSStatus AVSWriteStatus(uint16_t status, uint8_t rail_sel)
 {
-	SendCmd(status, rail_sel, AVS_CMD_STATUS, AVSCommitWrite);
-	return ReadRxFifo(NULL);
+	return AVSTransaction(status, rail_sel, AVS_CMD_STATUS, AVSCommitWrite, NULL);
 }
 
 /* For AVSBus version read, the rail_sel is broadcast. */
@@ -278,16 +290,16 @@ AVSStatus AVSWriteStatus(uint16_t status, uint8_t rail_sel)
 /* Any other PMBus versions are not supported by the AVS controller. */
 AVSStatus AVSReadVersion(uint16_t *version)
 {
-	SendCmd(AVS_RD_CMD_DATA, AVS_RAIL_SEL_BROADCAST, AVS_CMD_VERSION_READ, AVSRead);
-	return ReadRxFifo(version);
+	return AVSTransaction(AVS_RD_CMD_DATA, AVS_RAIL_SEL_BROADCAST, AVS_CMD_VERSION_READ,
+			      AVSRead, version);
 }
 
 AVSStatus AVSReadSystemInputCurrent(uint16_t *response)
 {
 	uint8_t rail_sel = 0x0; /* Rail A and Rail B return the same data. */
 
-	SendCmd(AVS_RD_CMD_DATA, rail_sel, AVS_CMD_SYS_INPUT_CURRENT_READ, AVSRead);
-	return ReadRxFifo(response);
+	return AVSTransaction(AVS_RD_CMD_DATA, rail_sel, AVS_CMD_SYS_INPUT_CURRENT_READ, AVSRead,
+			      response);
 	/* TODO: need to figure the formula to calculate the system input current */
 	/* System Input Current (read only) returns the ADC output of voltage at IINSEN pin. */
 	/* The raw ADC data is decoded to determine the VIINSEN voltage: */
@@ -19,6 +19,8 @@
 #include <zephyr/sys/crc.h>
 #include <tenstorrent/smc_msg.h>
 #include <tenstorrent/msgqueue.h>
+#include <tenstorrent/tt_smbus_regs.h>
+#include <tenstorrent/uart_tt_virt.h>
 
 #include "cm2dm_msg.h"
 #include "asic_state.h"
@@ -30,6 +32,11 @@
 
 static const struct device *const fwtable_dev = DEVICE_DT_GET(DT_NODELABEL(fwtable));
 
+/* Served ahead of the others: reset requests and the fan speed the ASIC temperature calls for */
+#define CM2DM_PRIORITY_MESSAGES                                                                    \
+	(BIT(kCm2DmMsgIdResetReq) | BIT(kCm2DmMsgIdFanSpeedUpdate) |                               \
+	 BIT(kCm2DmMsgIdForcedFanSpeedUpdate))
+
 typedef struct {
 	atomic_t pending_messages;
 	uint8_t next_id_rr;
@@ -38,27 +45,47 @@ typedef struct {
 	bool curr_msg_valid;
 	cm2dmMessage curr_msg;
 
+	/* Messages sent with CMFW_SMBUS_REQ_WINDOW and not acked yet, oldest first */
+	cm2dmMessage window[CMFW_SMBUS_CM2DM_WINDOW_SIZE];
+	uint8_t window_count;
+	/* No ack received since reset, the DMC may still be numbering from before it */
+	bool window_sync;
+
 	volatile uint32_t next_msgs[kCm2DmMsgCount];
 } Cm2DmMsgState;
 
-static Cm2DmMsgState cm2dm_msg_state;
+static Cm2DmMsgState cm2dm_msg_state = {.window_sync = true};
 K_SEM_DEFINE(dmfw_ping_sem, 0, 1);
 static uint16_t power;
 static uint16_t telemetry_reg;
+/* Tags selected by the last valid CMFW_SMBUS_TELEMETRY_BULK_READ write */
+static uint8_t bulk_telemetry_tags[CMFW_SMBUS_TELEMETRY_BULK_MAX_TAGS];
+static uint8_t bulk_telemetry_count;
+/* Replaces the selection as a whole, a read sees the old one or the new one */
+static struct k_spinlock bulk_telemetry_lock;
 static struct {
 	uint8_t chip_reset_asic_called: 1;
 	uint8_t chip_reset_dmc_called: 1;
 } chip_reset_state;
 static uint8_t reset_type;
 
+/* Orders posting a message against putting an unacked one back, see requeue_window */
+static struct k_spinlock post_lock;
+
 void PostCm2DmMsg(Cm2DmMsgId msg_id, uint32_t data)
 {
-	cm2dm_msg_state.next_msgs[msg_id] = data;
-	atomic_set_bit(&cm2dm_msg_state.pending_messages, msg_id);
+	K_SPINLOCK(&post_lock) {
+		cm2dm_msg_state.next_msgs[msg_id] = data;
+		atomic_set_bit(&cm2dm_msg_state.pending_messages, msg_id);
+	}
 }
 
 static Cm2DmMsgId next_id_rr(uint32_t pending_messages)
 {
+	if (pending_messages & CM2DM_PRIORITY_MESSAGES) {
+		pending_messages &= CM2DM_PRIORITY_MESSAGES;
+	}
+
 	uint32_t hi_pending = pending_messages & GENMASK(31, cm2dm_msg_state.next_id_rr);
 	uint32_t search_messages = hi_pending ? hi_pending : pending_messages;
 
@@ -72,30 +99,111 @@ static Cm2DmMsgId next_id_rr(uint32_t pending_messages)
 	return (Cm2DmMsgId)next_message_id;
 }
 
+/* Take the next pending message and give it a sequence number, false if none is pending */
+static bool next_message(cm2dmMessage *msg)
+{
+	atomic_val_t pending_messages = atomic_get(&cm2dm_msg_state.pending_messages);
+
+	if (pending_messages == 0) {
+		return false;
+	}
+
+	Cm2DmMsgId next_message_id = next_id_rr(pending_messages);
+
+	atomic_clear_bit(&cm2dm_msg_state.pending_messages, next_message_id);
+	/* atomic_clear_bit must be before reading curr_msg_data.
+	 * A data update may be done by writing data first then setting the bit.
+	 * We might send the same data twice, but we'll always send the final
+	 * value.
+	 */
+
+	msg->msg_id = next_message_id;
+	msg->seq_num = cm2dm_msg_state.next_seq_num++;
+	msg->data = cm2dm_msg_state.next_msgs[next_message_id];
+
+	return true;
+}
+
+/* Queue the messages of the window again, for a DMC that went back to CMFW_SMBUS_REQ */
+static void requeue_window(void)
+{
+	/* Newest first, the window may hold more than one message with the same ID */
+	for (uint8_t i = cm2dm_msg_state.window_count; i-- > 0;) {
+		const cm2dmMessage *msg = &cm2dm_msg_state.window[i];
+
+		K_SPINLOCK(&post_lock) {
+			/* A message posted since, or newer in the window, carries newer data */
+			if (!atomic_test_bit(&cm2dm_msg_state.pending_messages, msg->msg_id)) {
+				cm2dm_msg_state.next_msgs[msg->msg_id] = msg->data;
+				atomic_set_bit(&cm2dm_msg_state.pending_messages, msg->msg_id);
+			}
+		}
+	}
+	cm2dm_msg_state.window_count = 0;
+}
+
+/* Queue the message taken by CMFW_SMBUS_REQ again, for a DMC that went on to the window */
+static void requeue_curr_msg(void)
+{
+	if (!cm2dm_msg_state.curr_msg_valid) {
+		return;
+	}
+
+	K_SPINLOCK(&post_lock) {
+		if (!atomic_test_bit(&cm2dm_msg_state.pending_messages,
+				     cm2dm_msg_state.curr_msg.msg_id)) {
+			cm2dm_msg_state.next_msgs[cm2dm_msg_state.curr_msg.msg_id] =
+				cm2dm_msg_state.curr_msg.data;
+			atomic_set_bit(&cm2dm_msg_state.pending_messages,
+				       cm2dm_msg_state.curr_msg.msg_id);
+		}
+	}
+	cm2dm_msg_state.curr_msg_valid = false;
+	memset(&cm2dm_msg_state.curr_msg, 0, sizeof(cm2dm_msg_state.curr_msg));
+}
+
+/* Fill the window with pending messages, numbered on from the last one in it */
+static void fill_window(void)
+{
+	while (cm2dm_msg_state.window_count < CMFW_SMBUS_CM2DM_WINDOW_SIZE &&
+	       next_message(&cm2dm_msg_state.window[cm2dm_msg_state.window_count])) {
+		cm2dm_msg_state.window_count++;
+	}
+}
+
+/* The DMC acked a window since reset, so it numbers messages on from the window */
+static bool window_session_active(void)
+{
+	return !cm2dm_msg_state.window_sync;
+}
+
+/**
+ * @brief Handle the read of a CMFW_SMBUS_REQ transaction
+ *
+ * While a window session is active, returns the oldest message of the window rather than taking
+ * one of its own, so that a read of CMFW_SMBUS_REQ in between windows neither loses a message nor
+ * leaves a gap in the sequence numbers the window continues from.
+ */
 int32_t Cm2DmMsgReqSmbusHandler(uint8_t *data, uint8_t *size)
 {
 	BUILD_ASSERT(sizeof(cm2dm_msg_state.curr_msg) == 6,
 		     "Unexpected size of cm2dm_msg_state.curr_msg");
 	*size = sizeof(cm2dm_msg_state.curr_msg);
 
-	if (!cm2dm_msg_state.curr_msg_valid) {
-		atomic_val_t pending_messages = atomic_get(&cm2dm_msg_state.pending_messages);
-
-		if (pending_messages != 0) {
-			Cm2DmMsgId next_message_id = next_id_rr(pending_messages);
-
-			atomic_clear_bit(&cm2dm_msg_state.pending_messages, next_message_id);
-			/* atomic_clear_bit must be before reading curr_msg_data.
-			 * A data update may be done by writing data first then setting the bit.
-			 * We might send the same data twice, but we'll always send the final
-			 * value.
-			 */
-
-			cm2dm_msg_state.curr_msg.msg_id = next_message_id;
-			cm2dm_msg_state.curr_msg.seq_num = cm2dm_msg_state.next_seq_num++;
-			cm2dm_msg_state.curr_msg.data = cm2dm_msg_state.next_msgs[next_message_id];
-			cm2dm_msg_state.curr_msg_valid = true;
+	if (window_session_active()) {
+		fill_window();
+		if (cm2dm_msg_state.window_count > 0) {
+			memcpy(data, &cm2dm_msg_state.window[0], sizeof(cm2dmMessage));
+		} else {
+			memset(data, 0, sizeof(cm2dmMessage));
 		}
+		return 0;
+	}
+
+	requeue_window();
+
+	if (!cm2dm_msg_state.curr_msg_valid) {
+		cm2dm_msg_state.curr_msg_valid = next_message(&cm2dm_msg_state.curr_msg);
 	}
 
 	memcpy(data, &cm2dm_msg_state.curr_msg, sizeof(cm2dm_msg_state.curr_msg));
@@ -111,6 +219,19 @@ int32_t Cm2DmMsgAckSmbusHandler(const uint8_t *data, uint8_t size)
 
 	cm2dmAck *ack = (cm2dmAck *)data;
 
+	if (window_session_active()) {
+		/* The ack of the message Cm2DmMsgReqSmbusHandler returned from the window */
+		if (cm2dm_msg_state.window_count > 0 &&
+		    ack->msg_id == cm2dm_msg_state.window[0].msg_id &&
+		    ack->seq_num == cm2dm_msg_state.window[0].seq_num) {
+			cm2dm_msg_state.window_count--;
+			memmove(&cm2dm_msg_state.window[0], &cm2dm_msg_state.window[1],
+				cm2dm_msg_state.window_count * sizeof(cm2dmMessage));
+			return 0;
+		}
+		return -1;
+	}
+
 	if (cm2dm_msg_state.curr_msg_valid && ack->msg_id == cm2dm_msg_state.curr_msg.msg_id &&
 	    ack->seq_num == cm2dm_msg_state.curr_msg.seq_num) {
 		/* Message handled when msg_id and seq_num match the current valid message */
@@ -123,6 +244,68 @@ int32_t Cm2DmMsgAckSmbusHandler(const uint8_t *data, uint8_t size)
 	}
 }
 
+/**
+ * @brief Handle the write of a CMFW_SMBUS_REQ_WINDOW transaction
+ *
+ * Releases the messages in the window up to and including the acked sequence number. An ack
+ * outside of the window is a repeat of an earlier one and ignored, except for the first ack after
+ * reset, which renumbers the window to follow on from the DMC's last sequence number.
+ */
+int32_t Cm2DmMsgWindowAckSmbusHandler(const uint8_t *data, uint8_t size)
+{
+	/* The write half of a block write-block read has no PEC, the ack is sent twice instead */
+	if (size != 3 || data[1] != (uint8_t)~data[2]) {
+		return -1;
+	}
+
+	if (!(data[0] & CMFW_SMBUS_CM2DM_ACK_VALID)) {
+		return 0;
+	}
+
+	uint8_t ack_seq = data[1];
+	uint8_t count = cm2dm_msg_state.window_count;
+	uint8_t acked = (uint8_t)(ack_seq - cm2dm_msg_state.window[0].seq_num) + 1;
+
+	if (count > 0 && acked <= count) {
+		memmove(&cm2dm_msg_state.window[0], &cm2dm_msg_state.window[acked],
+			(count - acked) * sizeof(cm2dmMessage));
+		cm2dm_msg_state.window_count = count - acked;
+		cm2dm_msg_state.window_sync = false;
+	} else if (cm2dm_msg_state.window_sync) {
+		cm2dm_msg_state.next_seq_num = ack_seq + 1;
+		for (uint8_t i = 0; i < count; i++) {
+			cm2dm_msg_state.window[i].seq_num = cm2dm_msg_state.next_seq_num++;
+		}
+		cm2dm_msg_state.window_sync = false;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Handle the read of a CMFW_SMBUS_REQ_WINDOW transaction
+ *
+ * Fills the window with pending messages and returns all of it, so that messages lost on the way
+ * to the DMC are sent again until they are acked. A message taken by a CMFW_SMBUS_REQ read before
+ * the window session started and never acked goes back to the pending ones first.
+ */
+int32_t Cm2DmMsgWindowReqSmbusHandler(uint8_t *data, uint8_t *size)
+{
+	requeue_curr_msg();
+	fill_window();
+
+	uint8_t count = cm2dm_msg_state.window_count;
+
+	data[0] = count;
+	data[1] = atomic_get(&cm2dm_msg_state.pending_messages) != 0
+			  ? CMFW_SMBUS_CM2DM_MORE_PENDING
+			  : 0;
+	memcpy(&data[2], cm2dm_msg_state.window, count * sizeof(cm2dmMessage));
+	*size = 2 + count * sizeof(cm2dmMessage);
+
+	return 0;
+}
+
 void IssueChipReset(Cm2DmResetLevel reset_level)
 {
 	lock_down_for_reset();
@@ -385,16 +568,75 @@ int32_t SMBusTelemRegHandler(const uint8_t *data, uint8_t size)
 int32_t SMBusTelemDataHandler(uint8_t *data, uint8_t *size)
 {
 	uint32_t telemetry_data;
+	uint32_t generation;
+
+	telemetry_data = GetTelemetryTagSnapshot(telemetry_reg, &generation);
 
 	*size = 7U;
 	data[0] = GetTelemetryTagValid(telemetry_reg) ? 0U : 1U;
-	data[1] = 0U;
-	data[2] = 0U;
-	telemetry_data = GetTelemetryTag(telemetry_reg);
+	/* Low bits of the snapshot generation, so that the DMC can match up multi-tag reads */
+	sys_put_le16(generation, &data[1]);
 	memcpy(&data[3], &telemetry_data, sizeof(telemetry_data));
 	return 0;
 }
 
+int32_t SMBusTelemBulkRegHandler(const uint8_t *data, uint8_t size)
+{
+	if (size != 5) {
+		return -1;
+	}
+
+	uint8_t first_tag = data[0];
+	uint32_t bitmap = sys_get_le32(&data[1]);
+	uint8_t tags[CMFW_SMBUS_TELEMETRY_BULK_MAX_TAGS];
+	uint8_t count = 0;
+
+	if (bitmap == 0 || POPCOUNT(bitmap) > CMFW_SMBUS_TELEMETRY_BULK_MAX_TAGS) {
+		return -1;
+	}
+
+	/* An invalid selection leaves the last valid one in place */
+	for (uint32_t i = 0; i < 32; i++) {
+		if (!(bitmap & BIT(i))) {
+			continue;
+		}
+		if (!GetTelemetryTagValid(first_tag + i)) {
+			return -1;
+		}
+		tags[count++] = first_tag + i;
+	}
+
+	K_SPINLOCK(&bulk_telemetry_lock) {
+		memcpy(bulk_telemetry_tags, tags, count);
+		bulk_telemetry_count = count;
+	}
+	return 0;
+}
+
+int32_t SMBusTelemBulkDataHandler(uint8_t *data, uint8_t *size)
+{
+	uint8_t tags[CMFW_SMBUS_TELEMETRY_BULK_MAX_TAGS];
+	uint32_t values[CMFW_SMBUS_TELEMETRY_BULK_MAX_TAGS];
+	uint8_t count;
+	uint32_t generation;
+
+	K_SPINLOCK(&bulk_telemetry_lock) {
+		count = bulk_telemetry_count;
+		memcpy(tags, bulk_telemetry_tags, count);
+	}
+
+	generation = ReadTelemetryTagsSnapshot(tags, count, values);
+
+	*size = 4U + count * sizeof(uint32_t);
+	data[0] = count;
+	data[1] = 0U;
+	sys_put_le16(generation, &data[2]);
+	for (uint8_t i = 0; i < count; i++) {
+		sys_put_le32(values[i], &data[4 + i * sizeof(uint32_t)]);
+	}
+	return 0;
+}
+
 int32_t Dm2CmSendThermTripCountHandler(const uint8_t *data, uint8_t size)
 {
 	if (size != 2) {
@@ -459,3 +701,92 @@ int32_t Dm2CmDMCLogHandler(const uint8_t *data, uint8_t size)
 	}
 	return 0;
 }
+
+static struct {
+	/* Sequence number and dropped count of the last chunk taken, to recognise a resend */
+	bool chunk_valid;
+	uint8_t chunk_seq;
+	uint16_t chunk_dropped;
+	/* Last dropped count reported by the DMC, and the totals for telemetry */
+	bool dropped_valid;
+	uint16_t reported_dropped;
+	uint32_t dropped;
+	uint32_t overrun;
+} dmc_log_state;
+
+/* Room for DMC log in the vUART, the host drains it */
+static uint32_t dmc_log_space(void)
+{
+#if DT_NODE_HAS_COMPAT(DT_ALIAS(dmc_vuart), tenstorrent_vuart)
+	volatile struct tt_vuart *vuart = uart_tt_virt_get(dmc_uart);
+
+	return tt_vuart_buf_space(vuart->tx_head, vuart->tx_tail, vuart->tx_cap);
+#else
+	return 0;
+#endif
+}
+
+/**
+ * @brief Handle the write of a CMFW_SMBUS_DMC_LOG_BULK transaction
+ *
+ * Forwards the log bytes to the DMC vUART. A chunk with the sequence number and dropped count of
+ * the last one taken is a resend after the DMC missed the reply, and is ignored. Log bytes that
+ * don't fit in the vUART are dropped and counted, the DMC only sends more than the credits from
+ * the last reply if it doesn't follow them.
+ */
+int32_t Dm2CmDMCLogBulkHandler(const uint8_t *data, uint8_t size)
+{
+	/* The write half of a block write-block read has no PEC, the chunk carries a CRC instead */
+	if (size < 4 || size > 4 + CMFW_SMBUS_DMC_LOG_CHUNK_SIZE ||
+	    crc8(data, size - 1, 0x7, 0U, false) != data[size - 1]) {
+		return -1;
+	}
+
+	uint8_t seq = data[0];
+	uint16_t dropped = sys_get_le16(&data[1]);
+	uint8_t count = size - 4;
+
+	/* Counted from the first report, the DMC counts from its own reset */
+	if (dmc_log_state.dropped_valid) {
+		dmc_log_state.dropped += (uint16_t)(dropped - dmc_log_state.reported_dropped);
+	} else {
+		dmc_log_state.dropped = dropped;
+		dmc_log_state.dropped_valid = true;
+	}
+	dmc_log_state.reported_dropped = dropped;
+
+	if (count > 0 && !(dmc_log_state.chunk_valid && seq == dmc_log_state.chunk_seq &&
+			   dropped == dmc_log_state.chunk_dropped)) {
+		uint32_t room = MIN(dmc_log_space(), count);
+
+		for (uint8_t i = 0; i < room; i++) {
+			uart_poll_out(dmc_uart, data[3 + i]);
+		}
+		dmc_log_state.overrun += count - room;
+
+		dmc_log_state.chunk_valid = true;
+		dmc_log_state.chunk_seq = seq;
+		dmc_log_state.chunk_dropped = dropped;
+	}
+
+#ifndef CONFIG_TT_SMC_RECOVERY
+	UpdateTelemetryDmcLog(dmc_log_state.dropped, dmc_log_state.overrun);
+#endif
+
+	return 0;
+}
+
+/**
+ * @brief Handle the read of a CMFW_SMBUS_DMC_LOG_BULK transaction
+ *
+ * Returns the sequence number of the last chunk taken and the room left in the vUART, which is
+ * how many log bytes the DMC may send before it reads the reply again.
+ */
+int32_t Dm2CmDMCLogBulkReplyHandler(uint8_t *data, uint8_t *size)
+{
+	data[0] = dmc_log_state.chunk_seq;
+	sys_put_le16(MIN(dmc_log_space(), UINT16_MAX), &data[1]);
+	*size = 3;
+
+	return 0;
+}
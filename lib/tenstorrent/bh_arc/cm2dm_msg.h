@@ -13,6 +13,8 @@
 void PostCm2DmMsg(Cm2DmMsgId msg_id, uint32_t data);
 int32_t Cm2DmMsgReqSmbusHandler(uint8_t *data, uint8_t *size);
 int32_t Cm2DmMsgAckSmbusHandler(const uint8_t *data, uint8_t size);
+int32_t Cm2DmMsgWindowAckSmbusHandler(const uint8_t *data, uint8_t size);
+int32_t Cm2DmMsgWindowReqSmbusHandler(uint8_t *data, uint8_t *size);
 
 void ChipResetRequest(void *arg);
 void UpdateFanSpeedRequest(uint32_t fan_speed);
@@ -31,10 +33,14 @@ uint16_t GetInputPower(void);
 int32_t Dm2CmSendFanRPMHandler(const uint8_t *data, uint8_t size);
 int32_t SMBusTelemRegHandler(const uint8_t *data, uint8_t size);
 int32_t SMBusTelemDataHandler(uint8_t *data, uint8_t *size);
+int32_t SMBusTelemBulkRegHandler(const uint8_t *data, uint8_t size);
+int32_t SMBusTelemBulkDataHandler(uint8_t *data, uint8_t *size);
 int32_t Dm2CmSendThermTripCountHandler(const uint8_t *data, uint8_t size);
 int32_t Dm2CmWriteTelemetry(const uint8_t *data, uint8_t size);
 int32_t Dm2CmReadControlData(uint8_t *data, uint8_t *size);
 int32_t Dm2CmDMCLogHandler(const uint8_t *data, uint8_t size);
+int32_t Dm2CmDMCLogBulkHandler(const uint8_t *data, uint8_t size);
+int32_t Dm2CmDMCLogBulkReplyHandler(uint8_t *data, uint8_t *size);
 int32_t Dm2CmPingV2(uint8_t *data, uint8_t *size);
 
 #endif
@@ -9,14 +9,38 @@
 #include "throttler.h"
 #include "aiclk_ppm.h"
 #include "voltage.h"
+#include "dvfs_trace.h"
+#include "telemetry_events.h"
+#include "telemetry_history.h"
+#include "telemetry_internal.h"
+#include "telemetry_stats.h"
+#include "work_queue.h"
 
 bool dvfs_enabled;
 
+/* DVFSChange runs periodically on the control work queue, but host message handlers (e.g.
+ * ForceVdd) may also call it directly from the host message work queue.
+ */
+static K_MUTEX_DEFINE(dvfs_lock);
+
 void DVFSChange(void)
 {
-	CalculateThrottlers();
+	uint32_t stage_cycles[DVFS_TRACE_STAGE_COUNT + 1];
+	TelemetryInternalData telemetry_internal_data;
+
+	k_mutex_lock(&dvfs_lock, K_FOREVER);
+
+	stage_cycles[DVFS_TRACE_STAGE_THROTTLERS] = k_cycle_get_32();
+	/* Read once for the whole iteration, the waits of the voltage and AICLK changes below can
+	 * outlast the 1 ms staleness.
+	 */
+	ReadTelemetryInternal(1, &telemetry_internal_data);
+	CalculateThrottlers(&telemetry_internal_data);
+
+	stage_cycles[DVFS_TRACE_STAGE_ARBITRATION] = k_cycle_get_32();
 	CalculateTargAiclk();
 
+	stage_cycles[DVFS_TRACE_STAGE_VOLTAGE] = k_cycle_get_32();
 	uint32_t targ_freq = GetAiclkTarg();
 	uint32_t aiclk_voltage = VFCurve(targ_freq);
 
@@ -24,9 +48,19 @@ void DVFSChange(void)
 
 	CalculateTargVoltage();
 
+	stage_cycles[DVFS_TRACE_STAGE_TRANSITION] = k_cycle_get_32();
 	DecreaseAiclk();
 	VoltageChange();
 	IncreaseAiclk();
+
+	stage_cycles[DVFS_TRACE_STAGE_COUNT] = k_cycle_get_32();
+	dvfs_trace_sample(aiclk_voltage, voltage_arbiter.targ_voltage, stage_cycles);
+
+	telemetry_history_sample(&telemetry_internal_data);
+	telemetry_stats_sample(&telemetry_internal_data);
+	telemetry_events_sample(&telemetry_internal_data);
+
+	k_mutex_unlock(&dvfs_lock);
 }
 
 static void dvfs_work_handler(struct k_work *work)
@@ -37,7 +71,7 @@ static K_WORK_DEFINE(dvfs_worker, dvfs_work_handler);
 
 static void dvfs_timer_handler(struct k_timer *timer)
 {
-	k_work_submit(&dvfs_worker);
+	tt_work_submit(TT_WORK_QUEUE_CONTROL, &dvfs_worker);
 }
 static K_TIMER_DEFINE(dvfs_timer, dvfs_timer_handler, NULL);
 
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "dvfs_trace.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/barrier.h>
+#include <zephyr/sys/util.h>
+
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+#include "aiclk_ppm.h"
+
+BUILD_ASSERT(IS_POWER_OF_TWO(CONFIG_TT_BH_ARC_DVFS_TRACE_DEPTH),
+	     "DVFS trace depth must be a power of two");
+BUILD_ASSERT(sizeof(struct dvfs_trace_record) == 20, "Update scripts/dvfs_trace.py");
+
+static struct k_spinlock trace_lock;
+static struct dvfs_trace trace = {
+	.version = DVFS_TRACE_VERSION,
+	.capacity = CONFIG_TT_BH_ARC_DVFS_TRACE_DEPTH,
+	.record_size = sizeof(struct dvfs_trace_record),
+};
+static bool trace_enabled = true;
+
+void dvfs_trace_push(const struct dvfs_trace_record *record)
+{
+	K_SPINLOCK(&trace_lock) {
+		if (!trace_enabled) {
+			K_SPINLOCK_BREAK;
+		}
+
+		trace.records[trace.head & (trace.capacity - 1)] = *record;
+
+		/* The record must be complete before the host can see it */
+		barrier_dmem_fence_full();
+		trace.head++;
+	}
+}
+
+/**
+ * @brief Record a DVFS iteration
+ *
+ * Called at the end of DVFSChange, the target AICLK and the arbiter that chose it are taken from
+ * the last CalculateTargAiclk.
+ *
+ * @param aiclk_voltage Voltage requested for the target AICLK in mV
+ * @param targ_voltage Arbitrated voltage in mV
+ * @param stage_cycles Cycle counter at the start of each stage and at the end of the last one
+ */
+void dvfs_trace_sample(uint32_t aiclk_voltage, uint32_t targ_voltage,
+		       const uint32_t stage_cycles[DVFS_TRACE_STAGE_COUNT + 1])
+{
+	union aiclk_targ_freq_info info = get_targ_aiclk_info();
+	struct dvfs_trace_record record = {
+		.timestamp_us = (uint32_t)k_ticks_to_us_floor64(k_uptime_ticks()),
+		.targ_freq = MIN(GetAiclkTarg(), UINT16_MAX),
+		.aiclk_voltage = MIN(aiclk_voltage, UINT16_MAX),
+		.targ_voltage = MIN(targ_voltage, UINT16_MAX),
+		.reason = info.reason,
+		.arbiter = info.arbiter,
+	};
+
+	for (int i = 0; i < DVFS_TRACE_STAGE_COUNT; i++) {
+		uint32_t us = k_cyc_to_us_floor32(stage_cycles[i + 1] - stage_cycles[i]);
+
+		record.stage_us[i] = MIN(us, UINT16_MAX);
+	}
+
+	dvfs_trace_push(&record);
+}
+
+void dvfs_trace_clear(void)
+{
+	K_SPINLOCK(&trace_lock) {
+		trace.head = 0;
+	}
+}
+
+void dvfs_trace_enable(bool enable)
+{
+	K_SPINLOCK(&trace_lock) {
+		trace_enabled = enable;
+	}
+}
+
+const struct dvfs_trace *dvfs_trace_get(void)
+{
+	return &trace;
+}
+
+uint32_t dvfs_trace_addr(void)
+{
+	return (uint32_t)(uintptr_t)&trace;
+}
+
+/**
+ * @brief Handler for @ref TT_SMC_MSG_DVFS_TRACE
+ * @see dvfs_trace_rqst
+ */
+static uint8_t dvfs_trace_handler(const union request *request, struct response *response)
+{
+	uint8_t flags = request->dvfs_trace.flags;
+
+	if ((flags & DVFS_TRACE_FLAG_STOP) && (flags & DVFS_TRACE_FLAG_START)) {
+		return 1;
+	}
+
+	if (flags & DVFS_TRACE_FLAG_CLEAR) {
+		dvfs_trace_clear();
+	}
+	if (flags & DVFS_TRACE_FLAG_STOP) {
+		dvfs_trace_enable(false);
+	}
+	if (flags & DVFS_TRACE_FLAG_START) {
+		dvfs_trace_enable(true);
+	}
+
+	K_SPINLOCK(&trace_lock) {
+		response->data[3] = trace.head;
+		response->data[4] = trace_enabled;
+	}
+	response->data[1] = dvfs_trace_addr();
+	response->data[2] = trace.capacity;
+
+	return 0;
+}
+
+REGISTER_MESSAGE(TT_SMC_MSG_DVFS_TRACE, dvfs_trace_handler);
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef DVFS_TRACE_H
+#define DVFS_TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define DVFS_TRACE_VERSION 1
+
+/* The stages of DVFSChange, in order */
+enum dvfs_trace_stage {
+	DVFS_TRACE_STAGE_THROTTLERS,  /* CalculateThrottlers */
+	DVFS_TRACE_STAGE_ARBITRATION, /* CalculateTargAiclk */
+	DVFS_TRACE_STAGE_VOLTAGE,     /* VFCurve, VoltageArbRequest and CalculateTargVoltage */
+	DVFS_TRACE_STAGE_TRANSITION,  /* DecreaseAiclk, VoltageChange and IncreaseAiclk */
+	DVFS_TRACE_STAGE_COUNT,
+};
+
+#ifdef CONFIG_TT_BH_ARC_DVFS_TRACE
+
+/* One DVFS iteration. Also decoded by scripts/dvfs_trace.py, keep the two in sync. */
+struct dvfs_trace_record {
+	/* Low 32 bits of the uptime in microseconds at the end of the iteration */
+	uint32_t timestamp_us;
+	/* Target AICLK in MHz chosen by CalculateTargAiclk */
+	uint16_t targ_freq;
+	/* Voltage in mV requested for targ_freq through VoltageArbRequest */
+	uint16_t aiclk_voltage;
+	/* Voltage in mV chosen by CalculateTargVoltage */
+	uint16_t targ_voltage;
+	/* enum targ_freq_reason */
+	uint8_t reason;
+	/* enum aiclk_arb_min or aiclk_arb_max, depending on reason */
+	uint8_t arbiter;
+	/* Time taken by each stage in microseconds, saturated at UINT16_MAX */
+	uint16_t stage_us[DVFS_TRACE_STAGE_COUNT];
+};
+
+/*
+ * Ring buffer of DVFS iterations, published in TAG_DVFS_TRACE.
+ *
+ * head counts the records written since the trace was last cleared, the newest record is
+ * records[(head - 1) % capacity]. As for the telemetry history, the host reads head, copies the
+ * records, then reads head again, and discards records not newer than the second head minus
+ * capacity.
+ */
+struct dvfs_trace {
+	uint32_t version;
+	uint32_t capacity;
+	uint32_t record_size;
+	uint32_t head;
+	struct dvfs_trace_record records[CONFIG_TT_BH_ARC_DVFS_TRACE_DEPTH];
+};
+
+void dvfs_trace_push(const struct dvfs_trace_record *record);
+void dvfs_trace_sample(uint32_t aiclk_voltage, uint32_t targ_voltage,
+		       const uint32_t stage_cycles[DVFS_TRACE_STAGE_COUNT + 1]);
+void dvfs_trace_clear(void);
+void dvfs_trace_enable(bool enable);
+const struct dvfs_trace *dvfs_trace_get(void);
+uint32_t dvfs_trace_addr(void);
+
+#else
+
+static inline void dvfs_trace_sample(uint32_t aiclk_voltage, uint32_t targ_voltage,
+				     const uint32_t stage_cycles[DVFS_TRACE_STAGE_COUNT + 1])
+{
+}
+
+static inline uint32_t dvfs_trace_addr(void)
+{
+	return 0;
+}
+
+#endif
+
+#endif
@@ -4,8 +4,12 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <zephyr/devicetree.h>
 #include <zephyr/drivers/i2c.h>
+#include <zephyr/irq.h>
+#include <zephyr/kernel.h>
 #include <string.h>
+#include <tenstorrent/sys_init_defines.h>
 #include "timer.h"
 #include "dw_apb_i2c.h"
 #include "asic_state.h"
@@ -39,7 +43,11 @@
 #define DW_APB_I2C_IC_SDA_HOLD_REG_OFFSET                   0x0000007C
 #define DW_APB_I2C_IC_FS_SCL_HCNT_REG_OFFSET                0x0000001C
 #define DW_APB_I2C_IC_FS_SCL_LCNT_REG_OFFSET                0x00000020
+#define DW_APB_I2C_IC_INTR_STAT_REG_OFFSET                  0x0000002C
+#define DW_APB_I2C_IC_INTR_MASK_REG_OFFSET                  0x00000030
 #define DW_APB_I2C_IC_RAW_INTR_STAT_REG_OFFSET              0x00000034
+#define DW_APB_I2C_IC_RX_TL_REG_OFFSET                      0x00000038
+#define DW_APB_I2C_IC_TX_TL_REG_OFFSET                      0x0000003C
 #define DW_APB_I2C_IC_CLR_RX_OVER_REG_OFFSET                0x00000048
 #define DW_APB_I2C_IC_CLR_RD_REQ_REG_OFFSET                 0x00000050
 #define DW_APB_I2C_IC_CLR_STOP_DET_REG_OFFSET               0x00000060
@@ -86,6 +94,8 @@
 /* starting from bit21, bit20-0 is reserved. */
 #define IC_ABRT_A3_STATE (0x1 << 21)
 #define IC_VERIFY_FAIL   (0x1 << 22)
+#define IC_INCOMPLETE    (0x1 << 23)
+#define IC_TIMEOUT       (0x1 << 24)
 
 #define GET_I2C_OFFSET(REG_NAME) DW_APB_I2C_##REG_NAME##_REG_OFFSET
 
@@ -174,6 +184,29 @@ bool IsValidI2CMasterId(uint32_t id)
 	return GetI2CBaseAddress(id) != 0;
 }
 
+/* Controllers are shared between work queues of different priorities, so a sequence of
+ * I2CInit and transactions on one controller must be bracketed by I2CLock / I2CUnlock.
+ */
+static K_MUTEX_DEFINE(i2c0_lock);
+static K_MUTEX_DEFINE(i2c1_lock);
+static K_MUTEX_DEFINE(i2c2_lock);
+
+static struct k_mutex *const i2c_locks[] = {&i2c0_lock, &i2c1_lock, &i2c2_lock};
+
+void I2CLock(uint32_t id)
+{
+	if (id < ARRAY_SIZE(i2c_locks)) {
+		k_mutex_lock(i2c_locks[id], K_FOREVER);
+	}
+}
+
+void I2CUnlock(uint32_t id)
+{
+	if (id < ARRAY_SIZE(i2c_locks)) {
+		k_mutex_unlock(i2c_locks[id]);
+	}
+}
+
 static inline uint32_t GetI2CRegAddr(uint32_t id, uint32_t offset)
 {
 	return GetI2CBaseAddress(id) + offset;
@@ -364,7 +397,7 @@ static uint32_t WaitAllTxDone(uint32_t id)
 							(CONFIG_TT_BH_ARC_I2C_TIMEOUT_DURATION),
 							(0))) {
 				I2CRecoverBus(id);
-				return -ETIMEDOUT;
+				return IC_TIMEOUT;
 			}
 		}
 	} while (master_active || tx_fifo_not_empty);
@@ -392,7 +425,7 @@ uint32_t I2CReadRxFifo(uint32_t id, uint8_t *p_read_buf)
 							(CONFIG_TT_BH_ARC_I2C_TIMEOUT_DURATION),
 							(0))) {
 				I2CRecoverBus(id);
-				return -ETIMEDOUT;
+				return IC_TIMEOUT;
 			}
 		}
 	} while ((ic_status & DW_APB_I2C_IC_STATUS_RFNE_MASK) == 0);
@@ -415,6 +448,14 @@ void I2CInitGPIO(uint32_t id)
 	WriteReg(RESET_UNIT_I2C_CNTL_REG_ADDR, i2c_cntl | 1 << id);
 }
 
+/* Configuration last programmed by I2CInit, so that I2CSelectTarget can skip redundant inits */
+static struct {
+	bool valid;
+	I2CMode mode;
+	uint32_t slave_addr;
+	I2CSpeedMode speed;
+} i2c_config[3];
+
 /* Initialize I2C controller by setting up I2C pads and configuration settings. */
 void I2CInit(I2CMode mode, uint32_t slave_addr, I2CSpeedMode speed, uint32_t id)
 {
@@ -422,6 +463,13 @@ void I2CInit(I2CMode mode, uint32_t slave_addr, I2CSpeedMode speed, uint32_t id)
 		return;
 	}
 
+	if (id < ARRAY_SIZE(i2c_config)) {
+		i2c_config[id].valid = true;
+		i2c_config[id].mode = mode;
+		i2c_config[id].slave_addr = slave_addr;
+		i2c_config[id].speed = speed;
+	}
+
 	WaitTxFifoEmpty(id);
 	WaitMasterIdle(id);
 
@@ -476,27 +524,41 @@ void I2CInit(I2CMode mode, uint32_t slave_addr, I2CSpeedMode speed, uint32_t id)
 	Wait(10 * WAIT_1US);
 }
 
+/**
+ * @brief Point a master controller at a target, reinitializing it only if the target or speed
+ * differ from the last I2CInit. Must be called under I2CLock.
+ *
+ * @return true if the controller was reinitialized
+ */
+bool I2CSelectTarget(uint32_t id, uint32_t slave_addr, I2CSpeedMode speed)
+{
+	if (id < ARRAY_SIZE(i2c_config) && i2c_config[id].valid && i2c_config[id].mode == I2CMst &&
+	    i2c_config[id].slave_addr == slave_addr && i2c_config[id].speed == speed) {
+		return false;
+	}
+
+	I2CInit(I2CMst, slave_addr, speed, id);
+	return true;
+}
+
 /* Resets the all I2C controller instances */
 void I2CReset(void)
 {
 	uint32_t i2c_cntl = ReadReg(RESET_UNIT_I2C_CNTL_REG_ADDR);
 
+	for (uint32_t id = 0; id < ARRAY_SIZE(i2c_config); id++) {
+		i2c_config[id].valid = false;
+	}
+
 	WriteReg(RESET_UNIT_I2C_CNTL_REG_ADDR, i2c_cntl | RESET_UNIT_I2C_CNTL_RESET_MASK);
 	Wait(WAIT_1US);
 	WriteReg(RESET_UNIT_I2C_CNTL_REG_ADDR, i2c_cntl & ~RESET_UNIT_I2C_CNTL_RESET_MASK);
 	Wait(WAIT_1US);
 }
 
-/* Generalized transaction function called by I2CWriteBytes and I2CReadBytes, implements SMBUS write
- * bytes and read bytes protocols, returns TX_ABRT error if any, otherwise returns 0.
- */
-uint32_t I2CTransaction(uint32_t id, const uint8_t *write_data, uint32_t write_len,
-			uint8_t *read_data, uint32_t read_len)
+static uint32_t I2CTransactionPolled(uint32_t id, const uint8_t *write_data, uint32_t write_len,
+				    uint8_t *read_data, uint32_t read_len)
 {
-	if (asic_state == A3State) {
-		return IC_ABRT_A3_STATE;
-	}
-
 	/* Writing */
 	for (uint32_t i = 0; i < write_len; i++) {
 		uint32_t last_byte_flag = (read_len == 0 && i == write_len - 1) ? IC_DATA_STOP : 0;
@@ -533,6 +595,328 @@ uint32_t I2CTransaction(uint32_t id, const uint8_t *write_data, uint32_t write_l
 	return ic_error;
 }
 
+/* Indices of the per-source interrupt lines of the controller in devicetree */
+#define DW_APB_I2C_IRQ_IDX_RX_OVER  1
+#define DW_APB_I2C_IRQ_IDX_RX_FULL  2
+#define DW_APB_I2C_IRQ_IDX_TX_EMPTY 4
+#define DW_APB_I2C_IRQ_IDX_RD_REQ   5
+#define DW_APB_I2C_IRQ_IDX_TX_ABRT  6
+#define DW_APB_I2C_IRQ_IDX_STOP_DET 9
+
+#ifdef CONFIG_TT_BH_ARC_I2C_ASYNC
+/* Read commands in flight are limited so that the RX FIFO can't overflow. The FIFO depth is a
+ * synthesis parameter, 8 is the smallest in use.
+ */
+#define I2C_ASYNC_MAX_READS_IN_FLIGHT 8
+
+struct i2c_async_state {
+	struct k_spinlock lock;
+	sys_slist_t pending;
+	struct i2c_async_request *active;
+	/* Data and read commands written to the TX FIFO for the active request */
+	uint32_t tx_count;
+	uint32_t rx_count;
+	uint32_t ic_error;
+	bool enabled;
+};
+
+static struct i2c_async_state i2c_async[3];
+
+static const DW_APB_I2C_IC_RAW_INTR_STAT_reg_u async_base_intr = {
+	.f.rx_full = 1,
+	.f.tx_abrt = 1,
+	.f.stop_det = 1,
+};
+
+/* Queue as much of the active request as the FIFOs allow. TX_EMPTY is only unmasked while the
+ * TX FIFO is what holds us back, as it stays asserted while the FIFO is empty.
+ */
+static void AsyncFillTxFifo(uint32_t id, struct i2c_async_state *state)
+{
+	struct i2c_async_request *req = state->active;
+	uint32_t total = req->write_len + req->read_len;
+	DW_APB_I2C_IC_RAW_INTR_STAT_reg_u intr_mask = async_base_intr;
+
+	while (state->tx_count < total) {
+		uint32_t i = state->tx_count;
+		uint32_t last_byte_flag = (i == total - 1) ? IC_DATA_STOP : 0;
+		uint32_t data;
+
+		if (i < req->write_len) {
+			data = req->write_data[i] | IC_DATA_WRITE;
+		} else if (i - req->write_len - state->rx_count < I2C_ASYNC_MAX_READS_IN_FLIGHT) {
+			data = IC_DATA_READ;
+		} else {
+			/* Continue from RX_FULL once some data has been read */
+			break;
+		}
+
+		if ((ReadReg(GetI2CRegAddr(id, GET_I2C_OFFSET(IC_STATUS))) &
+		     DW_APB_I2C_IC_STATUS_TFNF_MASK) == 0) {
+			intr_mask.f.tx_empty = 1;
+			break;
+		}
+
+		WriteReg(GetI2CRegAddr(id, GET_I2C_OFFSET(IC_DATA_CMD)), data | last_byte_flag);
+		state->tx_count++;
+	}
+
+	WriteReg(GetI2CRegAddr(id, GET_I2C_OFFSET(IC_INTR_MASK)), intr_mask.val);
+}
+
+static void AsyncStart(uint32_t id, struct i2c_async_state *state)
+{
+	state->tx_count = 0;
+	state->rx_count = 0;
+	state->ic_error = 0;
+
+	/* Interrupt as soon as there is one byte to read or the TX FIFO has drained */
+	WriteReg(GetI2CRegAddr(id, GET_I2C_OFFSET(IC_RX_TL)), 0);
+	WriteReg(GetI2CRegAddr(id, GET_I2C_OFFSET(IC_TX_TL)), 0);
+	ReadReg(GetI2CRegAddr(id, GET_I2C_OFFSET(IC_CLR_STOP_DET)));
+
+	AsyncFillTxFifo(id, state);
+}
+
+void I2CAsyncEnable(uint32_t id, bool enable)
+{
+	if (id >= ARRAY_SIZE(i2c_async)) {
+		return;
+	}
+
+	K_SPINLOCK(&i2c_async[id].lock) {
+		i2c_async[id].enabled = enable;
+	}
+}
+
+/**
+ * @brief Queue an interrupt-driven transaction
+ *
+ * Requests on a controller run in order, against the target selected by the last I2CInit.
+ * Callers that switch targets must wait for their requests to complete first.
+ *
+ * @return 0 if the request was queued, -EINVAL if the controller isn't interrupt-driven,
+ * -EIO in A3 state
+ */
+int I2CTransactionAsync(uint32_t id, struct i2c_async_request *req)
+{
+	if (id >= ARRAY_SIZE(i2c_async) || req->write_len + req->read_len == 0) {
+		return -EINVAL;
+	}
+	if (asic_state == A3State) {
+		return -EIO;
+	}
+
+	struct i2c_async_state *state = &i2c_async[id];
+	int ret = 0;
+
+	K_SPINLOCK(&state->lock) {
+		if (!state->enabled) {
+			ret = -EINVAL;
+			K_SPINLOCK_BREAK;
+		}
+
+		if (state->active == NULL) {
+			state->active = req;
+			AsyncStart(id, state);
+		} else {
+			sys_slist_append(&state->pending, &req->node);
+		}
+	}
+
+	return ret;
+}
+
+/* Remove a request that has not completed. Returns false if it already completed. */
+static bool AsyncCancel(uint32_t id, struct i2c_async_request *req)
+{
+	struct i2c_async_state *state = &i2c_async[id];
+	bool found = false;
+
+	K_SPINLOCK(&state->lock) {
+		if (state->active == req) {
+			WriteReg(GetI2CRegAddr(id, GET_I2C_OFFSET(IC_INTR_MASK)), 0);
+			state->active = NULL;
+			found = true;
+
+			sys_snode_t *next = sys_slist_get(&state->pending);
+
+			if (next != NULL) {
+				state->active = CONTAINER_OF(next, struct i2c_async_request, node);
+				AsyncStart(id, state);
+			}
+		} else {
+			found = sys_slist_find_and_remove(&state->pending, &req->node);
+		}
+	}
+
+	return found;
+}
+
+/**
+ * @brief Interrupt handler for a controller running interrupt-driven transactions
+ */
+void I2CAsyncIsr(uint32_t id)
+{
+	struct i2c_async_state *state = &i2c_async[id];
+	struct i2c_async_request *done = NULL;
+	uint32_t ic_error = 0;
+	k_spinlock_key_t key = k_spin_lock(&state->lock);
+	struct i2c_async_request *req = state->active;
+
+	if (req == NULL) {
+		WriteReg(GetI2CRegAddr(id, GET_I2C_OFFSET(IC_INTR_MASK)), 0);
+		k_spin_unlock(&state->lock, key);
+		return;
+	}
+
+	DW_APB_I2C_IC_RAW_INTR_STAT_reg_u intr_stat = {
+		.val = ReadReg(GetI2CRegAddr(id, GET_I2C_OFFSET(IC_INTR_STAT)))};
+
+	if (intr_stat.f.tx_abrt) {
+		/* The controller flushes the TX FIFO and sends a stop, finish on STOP_DET */
+		state->ic_error = CheckTxAbrt(id);
+	}
+
+	if (intr_stat.f.rx_full) {
+		while (ReadReg(GetI2CRegAddr(id, GET_I2C_OFFSET(IC_STATUS))) &
+		       DW_APB_I2C_IC_STATUS_RFNE_MASK) {
+			uint8_t data = ReadReg(GetI2CRegAddr(id, GET_I2C_OFFSET(IC_DATA_CMD)));
+
+			if (state->rx_count < req->read_len) {
+				req->read_data[state->rx_count++] = data;
+			}
+		}
+	}
+
+	if (intr_stat.f.stop_det) {
+		ReadReg(GetI2CRegAddr(id, GET_I2C_OFFSET(IC_CLR_STOP_DET)));
+
+		ic_error = state->ic_error;
+		if (ic_error == 0 && (state->tx_count != req->write_len + req->read_len ||
+				      state->rx_count != req->read_len)) {
+			ic_error = IC_INCOMPLETE;
+		}
+		done = req;
+
+		sys_snode_t *next = sys_slist_get(&state->pending);
+
+		state->active = next != NULL ? CONTAINER_OF(next, struct i2c_async_request, node)
+					     : NULL;
+		if (state->active != NULL) {
+			AsyncStart(id, state);
+		} else {
+			WriteReg(GetI2CRegAddr(id, GET_I2C_OFFSET(IC_INTR_MASK)), 0);
+		}
+	} else if (state->ic_error == 0 && (intr_stat.f.tx_empty || intr_stat.f.rx_full)) {
+		AsyncFillTxFifo(id, state);
+	}
+
+	k_spin_unlock(&state->lock, key);
+
+	if (done != NULL && done->callback != NULL) {
+		done->callback(id, ic_error, done->user_data);
+	}
+}
+
+struct i2c_sync_wait {
+	struct k_sem done;
+	uint32_t ic_error;
+};
+
+static void I2CSyncDone(uint32_t id, uint32_t ic_error, void *user_data)
+{
+	struct i2c_sync_wait *wait = user_data;
+
+	wait->ic_error = ic_error;
+	k_sem_give(&wait->done);
+}
+
+static uint32_t I2CTransactionWait(uint32_t id, const uint8_t *write_data, uint32_t write_len,
+				   uint8_t *read_data, uint32_t read_len)
+{
+	struct i2c_sync_wait wait;
+	struct i2c_async_request req = {
+		.write_data = write_data,
+		.write_len = write_len,
+		.read_data = read_data,
+		.read_len = read_len,
+		.callback = I2CSyncDone,
+		.user_data = &wait,
+	};
+
+	k_sem_init(&wait.done, 0, 1);
+
+	if (I2CTransactionAsync(id, &req) != 0) {
+		return I2CTransactionPolled(id, write_data, write_len, read_data, read_len);
+	}
+
+	k_timeout_t timeout = COND_CODE_1(CONFIG_TT_BH_ARC_I2C_TIMEOUT,
+					  (K_MSEC(CONFIG_TT_BH_ARC_I2C_TIMEOUT_DURATION)),
+					  (K_FOREVER));
+
+	if (k_sem_take(&wait.done, timeout) != 0) {
+		if (AsyncCancel(id, &req)) {
+			I2CRecoverBus(id);
+			return IC_TIMEOUT;
+		}
+		/* Completed while we were timing out, wait for the callback to finish with us */
+		k_sem_take(&wait.done, K_FOREVER);
+	}
+
+	return wait.ic_error;
+}
+
+#ifdef CONFIG_BOARD_TT_BLACKHOLE
+#define PMBUS_MST_ID 1
+
+#define I2C_ASYNC_IRQ_CONNECT(node, idx)                                                           \
+	do {                                                                                       \
+		IRQ_CONNECT(DT_IRQN_BY_IDX(node, idx), 0, I2CAsyncIrqHandler,                      \
+			    (void *)PMBUS_MST_ID, 0);                                              \
+		irq_enable(DT_IRQN_BY_IDX(node, idx));                                             \
+	} while (0)
+
+static void I2CAsyncIrqHandler(const void *arg)
+{
+	I2CAsyncIsr((uint32_t)(uintptr_t)arg);
+}
+
+static int I2CAsyncInit(void)
+{
+	I2C_ASYNC_IRQ_CONNECT(DT_NODELABEL(i2c1), DW_APB_I2C_IRQ_IDX_RX_FULL);
+	I2C_ASYNC_IRQ_CONNECT(DT_NODELABEL(i2c1), DW_APB_I2C_IRQ_IDX_TX_EMPTY);
+	I2C_ASYNC_IRQ_CONNECT(DT_NODELABEL(i2c1), DW_APB_I2C_IRQ_IDX_TX_ABRT);
+	I2C_ASYNC_IRQ_CONNECT(DT_NODELABEL(i2c1), DW_APB_I2C_IRQ_IDX_STOP_DET);
+
+	I2CAsyncEnable(PMBUS_MST_ID, true);
+	return 0;
+}
+SYS_INIT_APP(I2CAsyncInit);
+#endif
+#endif
+
+/* Generalized transaction function called by I2CWriteBytes and I2CReadBytes, implements SMBUS write
+ * bytes and read bytes protocols, returns TX_ABRT error if any, otherwise returns 0.
+ */
+uint32_t I2CTransaction(uint32_t id, const uint8_t *write_data, uint32_t write_len,
+			uint8_t *read_data, uint32_t read_len)
+{
+	if (asic_state == A3State) {
+		return IC_ABRT_A3_STATE;
+	}
+
+#ifdef CONFIG_TT_BH_ARC_I2C_ASYNC
+	/* Sleep instead of polling the FIFOs when the controller runs from interrupts */
+	if (id < ARRAY_SIZE(i2c_async) && i2c_async[id].enabled && !k_is_in_isr() &&
+	    !k_is_pre_kernel()) {
+		return I2CTransactionWait(id, write_data, write_len, read_data, read_len);
+	}
+#endif
+
+	return I2CTransactionPolled(id, write_data, write_len, read_data, read_len);
+}
+
 uint32_t I2CWriteBytes(uint32_t id, uint16_t command, uint32_t command_byte_size,
 		       const uint8_t *p_write_buf, uint32_t data_byte_size)
 {
@@ -603,67 +987,175 @@ uint32_t I2CRMWV(uint32_t id, uint16_t command, uint32_t command_byte_size, cons
 	return 0;
 }
 
+/* Target of each controller in slave mode, set by SetI2CSlaveCallbacks or I2CTargetRegister */
+static struct i2c_target_config *i2c_target[3];
+/* A read request was answered since the master last wrote a byte or sent a stop */
+static bool i2c_target_reading[3];
+
+static const DW_APB_I2C_IC_RAW_INTR_STAT_reg_u target_intr = {
+	.f.rx_over = 1,
+	.f.rx_full = 1,
+	.f.rd_req = 1,
+	.f.tx_abrt = 1,
+	.f.stop_det = 1,
+};
+
 void SetI2CSlaveCallbacks(uint32_t id, const struct i2c_target_callbacks *cb)
 {
 	i2c_target_config[id].callbacks = cb;
+	i2c_target[id] = &i2c_target_config[id];
 }
-/*
- * Keep calling this function in a loop as an alternative to interrupt-based I2C slave handling
- * It uses the Zephyr i2c target callback API.
+
+/**
+ * @brief Run a controller as a target, passing bus events to the callbacks of cfg
+ *
+ * The callbacks are called with cfg itself, so a target driver can hand over the config it
+ * would otherwise register with i2c_target_register. Events are handled by I2CTargetIsr, or
+ * by PollI2CSlave when the controller interrupts aren't connected.
+ *
+ * @return 0 on success, -EINVAL if id isn't a controller
  */
-void PollI2CSlave(uint32_t id)
+int I2CTargetRegister(uint32_t id, struct i2c_target_config *cfg)
 {
-	const struct i2c_target_callbacks *cb = i2c_target_config[id].callbacks;
-
-	if (!cb) {
-		return;
+	if (id >= ARRAY_SIZE(i2c_target)) {
+		return -EINVAL;
 	}
 
-	DW_APB_I2C_IC_RAW_INTR_STAT_reg_u raw_intr_stat = {
-		.val = ReadReg(GetI2CRegAddr(id, GET_I2C_OFFSET(IC_RAW_INTR_STAT)))};
+	I2CInit(I2CSlv, cfg->address, I2CFastMode, id);
+	i2c_target_reading[id] = false;
+	i2c_target[id] = cfg;
 
-	/* Handle error interrupts first */
-	if (raw_intr_stat.f.tx_abrt) {
-		ReadReg(GetI2CRegAddr(id, GET_I2C_OFFSET(IC_CLR_TX_ABRT)));
-		if (cb->stop) {
-			cb->stop(&i2c_target_config[id]);
-		}
-		return;
+	/* RX_FULL as soon as one byte is received */
+	WriteReg(GetI2CRegAddr(id, GET_I2C_OFFSET(IC_RX_TL)), 0);
+	WriteReg(GetI2CRegAddr(id, GET_I2C_OFFSET(IC_INTR_MASK)), target_intr.val);
+
+	return 0;
+}
+
+static void I2CTargetStop(uint32_t id, struct i2c_target_config *cfg)
+{
+	i2c_target_reading[id] = false;
+	if (cfg->callbacks->stop) {
+		cfg->callbacks->stop(cfg);
 	}
+}
 
-	if (raw_intr_stat.f.rx_over) {
-		/* If we get this interrupt, we lost data */
-		ReadReg(GetI2CRegAddr(id, GET_I2C_OFFSET(IC_CLR_RX_OVER)));
-		if (cb->stop) {
-			cb->stop(&i2c_target_config[id]);
-		}
-		return;
+/* Handle every pending target event and return how many there were. Data the master wrote is
+ * passed on before a read request that follows it, and both before the stop. The controller
+ * holds the clock while the RX FIFO is full or a read request is unanswered, so the bus waits
+ * for this function.
+ */
+static uint32_t I2CTargetService(uint32_t id)
+{
+	struct i2c_target_config *cfg = i2c_target[id];
+	const struct i2c_target_callbacks *cb = cfg != NULL ? cfg->callbacks : NULL;
+	uint32_t events = 0;
+
+	if (!cb) {
+		return 0;
 	}
 
 	/* We should never get RX_UNDER/TX_OVER, unless there is a SW bug */
 	/* Don't clear them, so we know if it happens */
+	while (true) {
+		DW_APB_I2C_IC_RAW_INTR_STAT_reg_u raw_intr_stat = {
+			.val = ReadReg(GetI2CRegAddr(id, GET_I2C_OFFSET(IC_RAW_INTR_STAT)))};
+		uint8_t data;
+
+		/* Handle error interrupts first */
+		if (raw_intr_stat.f.tx_abrt) {
+			ReadReg(GetI2CRegAddr(id, GET_I2C_OFFSET(IC_CLR_TX_ABRT)));
+			I2CTargetStop(id, cfg);
+		} else if (raw_intr_stat.f.rx_over) {
+			/* If we get this interrupt, we lost data */
+			ReadReg(GetI2CRegAddr(id, GET_I2C_OFFSET(IC_CLR_RX_OVER)));
+			I2CTargetStop(id, cfg);
+		} else if (raw_intr_stat.f.rx_full) {
+			i2c_target_reading[id] = false;
+			do {
+				data = ReadReg(GetI2CRegAddr(id, GET_I2C_OFFSET(IC_DATA_CMD)));
+				if (cb->write_received) {
+					cb->write_received(cfg, data);
+				}
+				events++;
+			} while (ReadReg(GetI2CRegAddr(id, GET_I2C_OFFSET(IC_STATUS))) &
+				 DW_APB_I2C_IC_STATUS_RFNE_MASK);
+			continue;
+		} else if (raw_intr_stat.f.rd_req) {
+			ReadReg(GetI2CRegAddr(id, GET_I2C_OFFSET(IC_CLR_RD_REQ)));
+
+			/* Zephyr targets get the first byte of a read from read_requested */
+			i2c_target_read_requested_cb_t read_cb = cb->read_requested;
+
+			if (i2c_target_reading[id] && cb->read_processed) {
+				read_cb = cb->read_processed;
+			}
 
-	/* Handle normal interrupts */
-	uint8_t data;
-
-	if (raw_intr_stat.f.rx_full) {
-		data = ReadReg(GetI2CRegAddr(id, GET_I2C_OFFSET(IC_DATA_CMD)));
-		if (cb->write_received) {
-			cb->write_received(&i2c_target_config[id], data);
-		}
-	} else if (raw_intr_stat.f.rd_req) {
-		ReadReg(GetI2CRegAddr(id, GET_I2C_OFFSET(IC_CLR_RD_REQ)));
-		if (cb->read_requested) {
-			if (cb->read_requested(&i2c_target_config[id], &data)) {
+			if (!read_cb || read_cb(cfg, &data)) {
 				/* Error condition, just send 0xFF */
 				data = 0xFF;
 			}
 			WriteTxFifo(id, data);
+			i2c_target_reading[id] = true;
+		} else if (raw_intr_stat.f.stop_det) {
+			ReadReg(GetI2CRegAddr(id, GET_I2C_OFFSET(IC_CLR_STOP_DET)));
+			I2CTargetStop(id, cfg);
+		} else {
+			break;
 		}
-	} else if (raw_intr_stat.f.stop_det) {
-		ReadReg(GetI2CRegAddr(id, GET_I2C_OFFSET(IC_CLR_STOP_DET)));
-		if (cb->stop) {
-			cb->stop(&i2c_target_config[id]);
-		}
+		events++;
 	}
+
+	return events;
+}
+
+/**
+ * @brief Interrupt handler for a controller running as a target
+ *
+ * @return The number of bus events handled
+ */
+uint32_t I2CTargetIsr(uint32_t id)
+{
+	return I2CTargetService(id);
+}
+
+/*
+ * Keep calling this function in a loop as an alternative to interrupt-based I2C slave handling
+ * It uses the Zephyr i2c target callback API.
+ */
+void PollI2CSlave(uint32_t id)
+{
+	if (id < ARRAY_SIZE(i2c_target)) {
+		I2CTargetService(id);
+	}
+}
+
+#if defined(CONFIG_TT_BH_ARC_I2C_TARGET_IRQ) && defined(CONFIG_BOARD_TT_BLACKHOLE)
+/* The DMC facing SMBus target */
+#define CM_I2C_TARGET_ID 0
+
+#define I2C_TARGET_IRQ_CONNECT(node, idx)                                                          \
+	do {                                                                                       \
+		IRQ_CONNECT(DT_IRQN_BY_IDX(node, idx), 0, I2CTargetIrqHandler,                     \
+			    (void *)CM_I2C_TARGET_ID, 0);                                          \
+		irq_enable(DT_IRQN_BY_IDX(node, idx));                                             \
+	} while (0)
+
+static void I2CTargetIrqHandler(const void *arg)
+{
+	I2CTargetIsr((uint32_t)(uintptr_t)arg);
+}
+
+static int I2CTargetIrqInit(void)
+{
+	/* Nothing is unmasked in the controller until I2CTargetRegister */
+	I2C_TARGET_IRQ_CONNECT(DT_NODELABEL(i2c0), DW_APB_I2C_IRQ_IDX_RX_OVER);
+	I2C_TARGET_IRQ_CONNECT(DT_NODELABEL(i2c0), DW_APB_I2C_IRQ_IDX_RX_FULL);
+	I2C_TARGET_IRQ_CONNECT(DT_NODELABEL(i2c0), DW_APB_I2C_IRQ_IDX_RD_REQ);
+	I2C_TARGET_IRQ_CONNECT(DT_NODELABEL(i2c0), DW_APB_I2C_IRQ_IDX_TX_ABRT);
+	I2C_TARGET_IRQ_CONNECT(DT_NODELABEL(i2c0), DW_APB_I2C_IRQ_IDX_STOP_DET);
+
+	return 0;
 }
+SYS_INIT_APP(I2CTargetIrqInit);
+#endif
@@ -8,6 +8,7 @@
 
 #include <stdint.h>
 #include <zephyr/drivers/i2c.h>
+#include <zephyr/sys/slist.h>
 
 #define I2C_WRITE_BIT 0
 #define I2C_READ_BIT  1
@@ -25,6 +26,7 @@ typedef enum {
 bool IsValidI2CMasterId(uint32_t id);
 void I2CInitGPIO(uint32_t id);
 void I2CInit(I2CMode mode, uint32_t slave_addr, I2CSpeedMode speed, uint32_t id);
+bool I2CSelectTarget(uint32_t id, uint32_t slave_addr, I2CSpeedMode speed);
 void I2CReset(void);
 uint32_t I2CReadRxFifo(uint32_t id, uint8_t *p_read_buf);
 uint32_t I2CTransaction(uint32_t id, const uint8_t *write_data, uint32_t write_len,
@@ -36,6 +38,32 @@ uint32_t I2CReadBytes(uint32_t id, uint16_t command, uint32_t command_byte_size,
 uint32_t I2CRMWV(uint32_t id, uint16_t command, uint32_t command_byte_size, const uint8_t *p_data,
 		 const uint8_t *p_mask, uint32_t data_byte_size);
 void SetI2CSlaveCallbacks(uint32_t id, const struct i2c_target_callbacks *cb);
+int I2CTargetRegister(uint32_t id, struct i2c_target_config *cfg);
+uint32_t I2CTargetIsr(uint32_t id);
 void PollI2CSlave(uint32_t id);
 void I2CRecoverBus(uint32_t id);
+void I2CLock(uint32_t id);
+void I2CUnlock(uint32_t id);
+
+typedef void (*I2CAsyncCallback)(uint32_t id, uint32_t ic_error, void *user_data);
+
+/*
+ * An I2C master transaction run from the controller interrupts: write_len bytes are written,
+ * then read_len bytes are read after a restart. The request and its buffers must stay valid
+ * until the callback runs. The callback runs in interrupt context with the TX_ABRT source
+ * (or 0 on success), like the return value of I2CTransaction.
+ */
+struct i2c_async_request {
+	sys_snode_t node;
+	const uint8_t *write_data;
+	uint32_t write_len;
+	uint8_t *read_data;
+	uint32_t read_len;
+	I2CAsyncCallback callback;
+	void *user_data;
+};
+
+void I2CAsyncEnable(uint32_t id, bool enable);
+int I2CTransactionAsync(uint32_t id, struct i2c_async_request *req);
+void I2CAsyncIsr(uint32_t id);
 #endif
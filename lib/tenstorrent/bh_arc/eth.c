@@ -7,6 +7,7 @@
 #include "bh_reset.h"
 #include "functional_efuse.h"
 #include "eth.h"
+#include "fw_dist.h"
 #include "harvesting.h"
 #include "init.h"
 #include "noc.h"
@@ -16,7 +17,6 @@
 #include "serdes_eth.h"
 
 #include <tenstorrent/post_code.h>
-#include <tenstorrent/spi_flash_buf.h>
 #include <tenstorrent/sys_init_defines.h>
 #include <tenstorrent/tt_boot_fs.h>
 #include <zephyr/kernel.h>
@@ -25,7 +25,6 @@
 #include <zephyr/drivers/misc/bh_fwtable.h>
 #include <zephyr/drivers/dma.h>
 #include <zephyr/drivers/dma/dma_tt_bh_noc.h>
-#include <zephyr/drivers/dma/dma_arc_hs.h>
 
 LOG_MODULE_REGISTER(eth, CONFIG_TT_APP_LOG_LEVEL);
 
@@ -53,7 +52,6 @@ LOG_MODULE_REGISTER(eth, CONFIG_TT_APP_LOG_LEVEL);
 
 static const struct device *const fwtable_dev = DEVICE_DT_GET(DT_NODELABEL(fwtable));
 static const struct device *flash = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(spi_flash));
-static const struct device *const arc_dma_dev = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(dma0));
 static const struct device *dma_noc = DEVICE_DT_GET(DT_NODELABEL(dma1));
 
 static uint32_t saved_heartbeat[MAX_ETH_INSTANCES];
@@ -202,6 +200,12 @@ uint64_t GetMacAddressBase(void)
 	return mac_addr_base;
 }
 
+/* Time taken to load the ETH FW and its param table at boot, in microseconds */
+uint32_t GetEthFwLoadTime(void)
+{
+	return fw_dist_get_load_us(ETH_FW_TAG) + fw_dist_get_load_us(ETH_FW_CFG_TAG);
+}
+
 uint32_t GetEthFwVersion(uint32_t ring)
 {
 	/* Look through all the enabled ETH tiles, and grab the FW version from the first
@@ -277,40 +281,79 @@ void ReleaseEthReset(uint32_t eth_inst, uint32_t ring)
 	*soft_reset_0 &= ~(1 << 11); /* Clear bit for RISC0 reset, leave RISC1 in reset still */
 }
 
-int LoadEthFw(uint32_t eth_inst, uint32_t ring, uint8_t *buf, size_t buf_size, size_t spi_address,
-	      size_t image_size)
+static size_t GetEthTargets(uint32_t eth_enabled, uint32_t ring, uint64_t addr,
+			    struct fw_dist_target targets[MAX_ETH_INSTANCES])
+{
+	size_t num_targets = 0;
+
+	for (uint8_t eth_inst = 0; eth_inst < MAX_ETH_INSTANCES; eth_inst++) {
+		if (IS_BIT_SET(eth_enabled, eth_inst)) {
+			uint8_t x, y;
+
+			GetEthNocCoords(eth_inst, ring, &x, &y);
+			targets[num_targets++] = fw_dist_unicast(x, y, addr);
+		}
+	}
+
+	return num_targets;
+}
+
+/**
+ * @brief Load the ETH FW into the L1 memory of all enabled ETH instances
+ *
+ * ETH tiles don't take multicasts, the image is read once and written to each instance in turn.
+ *
+ * @param eth_enabled Bitmask of ETH instances to load
+ * @param ring Load over NOC 0 or NOC 1
+ * @param buf Scratch buffer for reading flash data
+ * @param buf_size Size of @p buf in bytes
+ * @param spi_address SPI flash address of the FW image
+ * @param image_size Size of the FW image in bytes
+ * @return 0 on success, -1 on failure
+ */
+int LoadEthFw(uint32_t eth_enabled, uint32_t ring, uint8_t *buf, size_t buf_size,
+	      size_t spi_address, size_t image_size)
 {
 	/* The shifting is to align the address to the lowest 16 bytes */
 	/* uint32_t fw_load_addr = ((ETH_PARAM_ADDR - fw_size) >> 2) << 2; */
 	uint32_t fw_load_addr = ETH_FW_BASE_ADDR;
+	struct fw_dist_target targets[MAX_ETH_INSTANCES];
+	const struct fw_dist_dest dest = {
+		.targets = targets,
+		.num_targets = GetEthTargets(eth_enabled, ring, fw_load_addr, targets),
+		.ring = ring,
+		.tlb = ETH_SETUP_TLB,
+	};
 
-	SetupEthTlb(eth_inst, ring, fw_load_addr);
-	volatile uint32_t *eth_tlb = GetTlbWindowAddr(ring, ETH_SETUP_TLB, fw_load_addr);
-
-	if (spi_arc_dma_transfer_to_tile(flash, spi_address, image_size, buf, buf_size,
-					 (uint8_t *)eth_tlb)) {
+	if (fw_dist_load(ETH_FW_TAG, flash, spi_address, image_size, &dest, buf, buf_size)) {
 		return -1;
 	}
 
-	SetupEthTlb(eth_inst, ring, ETH_RESET_PC_0);
-	NOC2AXIWrite32(ring, ETH_SETUP_TLB, ETH_RESET_PC_0, fw_load_addr);
-	NOC2AXIWrite32(ring, ETH_SETUP_TLB, ETH_END_PC_0, ETH_PARAM_ADDR - 0x4);
+	for (uint8_t eth_inst = 0; eth_inst < MAX_ETH_INSTANCES; eth_inst++) {
+		if (IS_BIT_SET(eth_enabled, eth_inst)) {
+			SetupEthTlb(eth_inst, ring, ETH_RESET_PC_0);
+			NOC2AXIWrite32(ring, ETH_SETUP_TLB, ETH_RESET_PC_0, fw_load_addr);
+			NOC2AXIWrite32(ring, ETH_SETUP_TLB, ETH_END_PC_0, ETH_PARAM_ADDR - 0x4);
+		}
+	}
 
 	return 0;
 }
 
 /**
- * @brief Load the ETH FW configuration data into ETH L1 memory
- * @param eth_inst ETH instance to load the FW config for
- * @param ring Load over NOC 0 or NOC 1
- * @param buf Scratch buffer for reading flash data
+ * @brief Load the ETH FW configuration data into the L1 memory of all enabled ETH instances
+ *
+ * The configuration is the same for every instance, it is read and patched once.
+ *
  * @param eth_enabled Bitmask of enabled ETH instances
+ * @param ring Load over NOC 0 or NOC 1
+ * @param buf Scratch buffer for reading flash data, must hold the whole image
  * @param spi_address SPI flash address of the FW config image
  * @param image_size Size of the FW config image in bytes
  * @return 0 on success, -1 on failure
  */
-int LoadEthFwCfg(uint32_t eth_inst, uint32_t ring, uint8_t *buf, uint32_t eth_enabled,
-		 size_t spi_address, size_t image_size)
+int LoadEthFwCfg(uint32_t eth_enabled, uint32_t ring, uint8_t *buf, size_t spi_address,
+		 size_t image_size)
 {
 	int rc;
 
@@ -356,12 +399,16 @@ int LoadEthFwCfg(uint32_t eth_inst, uint32_t ring, uint8_t *buf, uint32_t eth_en
 	fw_cfg_32b[40] = tile_enable.eth_enabled;
 
 	/* Write the ETH Param table */
-	SetupEthTlb(eth_inst, ring, ETH_PARAM_ADDR);
-	volatile uint32_t *eth_tlb = GetTlbWindowAddr(ring, ETH_SETUP_TLB, ETH_PARAM_ADDR);
+	struct fw_dist_target targets[MAX_ETH_INSTANCES];
+	const struct fw_dist_dest dest = {
+		.targets = targets,
+		.num_targets = GetEthTargets(eth_enabled, ring, ETH_PARAM_ADDR, targets),
+		.ring = ring,
+		.tlb = ETH_SETUP_TLB,
+	};
 
-	if (dma_arc_hs_transfer(arc_dma_dev, 0, buf, (void *)eth_tlb, image_size, K_MSEC(500)) <
-	    0) {
-		LOG_ERR("DMA transfer failed");
+	if (fw_dist_write(ETH_FW_CFG_TAG, buf, image_size, &dest) < 0) {
+		LOG_ERR("%s() failed", "fw_dist_write");
 		return -1;
 	}
 
@@ -498,11 +545,7 @@ static void EthInit(void)
 	spi_address = tag_fd.spi_addr;
 
 	/* Load fw */
-	for (uint8_t eth_inst = 0; eth_inst < MAX_ETH_INSTANCES; eth_inst++) {
-		if (IS_BIT_SET(tile_enable.eth_enabled, eth_inst)) {
-			LoadEthFw(eth_inst, ring, buf, SCRATCHPAD_SIZE, spi_address, image_size);
-		}
-	}
+	LoadEthFw(tile_enable.eth_enabled, ring, buf, SCRATCHPAD_SIZE, spi_address, image_size);
 
 	rc = tt_boot_fs_find_fd_by_tag(flash, ETH_FW_CFG_TAG, &tag_fd);
 	if (rc < 0) {
@@ -518,10 +561,10 @@ static void EthInit(void)
 		 image_size);
 
 	/* Load param table */
+	LoadEthFwCfg(tile_enable.eth_enabled, ring, buf, spi_address, image_size);
+
 	for (uint8_t eth_inst = 0; eth_inst < MAX_ETH_INSTANCES; eth_inst++) {
 		if (IS_BIT_SET(tile_enable.eth_enabled, eth_inst)) {
-			LoadEthFwCfg(eth_inst, ring, buf, tile_enable.eth_enabled, spi_address,
-				     image_size);
 			ReleaseEthReset(eth_inst, ring);
 		}
 		/* Clear saved heartbeat since we just released reset, so heartbeat starts from 0 */
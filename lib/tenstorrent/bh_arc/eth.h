@@ -14,12 +14,13 @@
 
 void SetupEthSerdesMux(uint32_t eth_enabled);
 uint32_t GetEthFwVersion(uint32_t ring);
+uint32_t GetEthFwLoadTime(void);
 uint32_t GetEthHeartbeatStatus(uint32_t ring);
 uint32_t GetEthLinkStatus(uint32_t ring);
-int LoadEthFw(uint32_t eth_inst, uint32_t ring, uint8_t *buf, size_t buf_size, size_t spi_address,
-	      size_t image_size);
-int LoadEthFwCfg(uint32_t eth_inst, uint32_t ring, uint8_t *buf, uint32_t eth_enabled,
-		 size_t spi_address, size_t image_size);
+int LoadEthFw(uint32_t eth_enabled, uint32_t ring, uint8_t *buf, size_t buf_size,
+	      size_t spi_address, size_t image_size);
+int LoadEthFwCfg(uint32_t eth_enabled, uint32_t ring, uint8_t *buf, size_t spi_address,
+		 size_t image_size);
 void ReleaseEthReset(uint32_t eth_inst, uint32_t ring);
 
 #endif
@@ -6,16 +6,20 @@
 
 #include "fan_ctrl.h"
 
+#include <math.h>
+
 #include "cm2dm_msg.h"
 #include "gddr.h"
 #include "telemetry_internal.h"
 #include "telemetry.h"
 #include "timer.h"
 #include "harvesting.h"
+#include "work_queue.h"
 
 #include <tenstorrent/msgqueue.h>
 #include <tenstorrent/smc_msg.h>
 #include <zephyr/kernel.h>
+#include <zephyr/sys/barrier.h>
 #include <zephyr/sys/util.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/drivers/misc/bh_fwtable.h>
@@ -28,9 +32,25 @@
 
 LOG_MODULE_REGISTER(fan_ctrl, CONFIG_TT_APP_LOG_LEVEL);
 
+/* The fan speed request is resent at least this often even if the speed hasn't changed */
+#define FAN_SPEED_REFRESH_INTERVAL 1000 /* ms */
+
+/* Range of update intervals accepted from the FW table, the DMC reports the RPM every 20 ms */
+#define FAN_CTRL_MIN_UPDATE_INTERVAL 20   /* ms */
+#define FAN_CTRL_MAX_UPDATE_INTERVAL 1000 /* ms */
+
+BUILD_ASSERT(ARRAY_SIZE(((FwTable_FanTable *)0)->asic_curve) == FAN_CURVE_MAX_POINTS,
+	     "Update FAN_CURVE_MAX_POINTS or fw_table.options");
+BUILD_ASSERT(ARRAY_SIZE(((FwTable_FanTable *)0)->gddr_curve) == FAN_CURVE_MAX_POINTS,
+	     "Update FAN_CURVE_MAX_POINTS or fw_table.options");
+
 static struct k_timer fan_ctrl_update_timer;
 static struct k_work fan_ctrl_update_worker;
-static int fan_ctrl_update_interval = 1000;
+static uint32_t fan_ctrl_update_interval = CONFIG_TT_BH_ARC_FAN_CTRL_UPDATE_INTERVAL; /* ms */
+
+static int64_t last_update_time;  /* ms */
+static int64_t last_request_time; /* ms */
+static uint32_t last_request_speed;
 
 static uint16_t fan_rpm;   /* Fan RPM from tach */
 static uint32_t fan_speed; /* % */
@@ -40,59 +60,229 @@ static uint32_t fan_speed_feedback; /* %, feedback from DMC for telemetry */
 
 static float max_gddr_temp;
 static float max_asic_temp;
+/* Weight of a new temperature sample per second, the filter is scaled to the update interval */
 static float alpha = CONFIG_TT_BH_ARC_FAN_CTRL_ALPHA / 100.0f;
 
+/* Curves and PID gains from the FW table, an empty curve selects the built-in P150 curve */
+static FwTable_FanTable fan_table;
+
+static struct {
+	float integral; /* % */
+	float prev_error;
+	bool primed;
+} fan_pid_state;
+
+#ifdef CONFIG_TT_BH_ARC_FAN_CTRL_HISTORY
+BUILD_ASSERT(IS_POWER_OF_TWO(CONFIG_TT_BH_ARC_FAN_CTRL_HISTORY_DEPTH),
+	     "Fan history depth must be a power of two");
+BUILD_ASSERT(sizeof(struct fan_history_record) == 12, "Update the fan history readers");
+
+static struct k_spinlock history_lock;
+static struct fan_history history = {
+	.version = FAN_HISTORY_VERSION,
+	.capacity = CONFIG_TT_BH_ARC_FAN_CTRL_HISTORY_DEPTH,
+	.record_size = sizeof(struct fan_history_record),
+};
+#endif
+
 static const struct device *const fwtable_dev = DEVICE_DT_GET(DT_NODELABEL(fwtable));
 
+static uint32_t p150_asic_curve(float temp)
+{
+	if (temp < 49) {
+		return 35;
+	} else if (temp < 90) {
+		return (uint32_t)(0.03867f * (temp - 49.0f) * (temp - 49.0f)) + 35;
+	} else {
+		return 100;
+	}
+}
+
+static uint32_t p150_gddr_curve(float temp)
+{
+	if (temp < 43) {
+		return 35;
+	} else if (temp < 82) {
+		return (uint32_t)(0.04274f * (temp - 43.0f) * (temp - 43.0f)) + 35;
+	} else {
+		return 100;
+	}
+}
+
+/* Linear interpolation between the points, held flat outside of them. NaN maps to the last. */
+static uint32_t piecewise_curve(const FwTable_FanCurvePoint *points, size_t count, float temp)
+{
+	if (!(temp < points[count - 1].temperature)) {
+		return points[count - 1].speed;
+	}
+	if (temp <= points[0].temperature) {
+		return points[0].speed;
+	}
+
+	size_t i = 1;
+
+	while (temp > points[i].temperature) {
+		i++;
+	}
+
+	const FwTable_FanCurvePoint *lo = &points[i - 1];
+	const FwTable_FanCurvePoint *hi = &points[i];
+	float t = (temp - lo->temperature) / (hi->temperature - lo->temperature);
+
+	return lo->speed + (uint32_t)(t * (float)(hi->speed - lo->speed));
+}
+
 STATIC uint32_t fan_curve(float max_asic_temp, float max_gddr_temp)
 {
-	/* P150 fan curve: could be a part of device tree once added to the driver model */
+	/* The P150 curves apply unless the FW table of the board has its own */
 	uint32_t fan_speed1;
 	uint32_t fan_speed2;
 
-	if (max_asic_temp < 49) {
-		fan_speed1 = 35;
-	} else if (max_asic_temp < 90) {
-		fan_speed1 =
-			(uint32_t)(0.03867f * (max_asic_temp - 49.0f) * (max_asic_temp - 49.0f)) +
-			35;
+	if (fan_table.asic_curve_count > 0) {
+		fan_speed1 = piecewise_curve(fan_table.asic_curve, fan_table.asic_curve_count,
+					     max_asic_temp);
 	} else {
-		fan_speed1 = 100;
+		fan_speed1 = p150_asic_curve(max_asic_temp);
 	}
 
-	if (max_gddr_temp < 43) {
-		fan_speed2 = 35;
-	} else if (max_gddr_temp < 82) {
-		fan_speed2 =
-			(uint32_t)(0.04274f * (max_gddr_temp - 43.0f) * (max_gddr_temp - 43.0f)) +
-			35;
+	if (fan_table.gddr_curve_count > 0) {
+		fan_speed2 = piecewise_curve(fan_table.gddr_curve, fan_table.gddr_curve_count,
+					     max_gddr_temp);
 	} else {
-		fan_speed2 = 100;
+		fan_speed2 = p150_gddr_curve(max_gddr_temp);
 	}
 
 	return MAX(fan_speed1, fan_speed2);
 }
 
-static void update_fan_speed(void)
+static bool fan_pid_enabled(void)
 {
-	TelemetryInternalData telemetry_internal_data;
+	return fan_table.pid_p_gain > 0 || fan_table.pid_i_gain > 0 || fan_table.pid_d_gain > 0;
+}
+
+/*
+ * Fan speed in % to add to the curve to hold the ASIC at the target temperature. The curve sets
+ * the steady state speed, the PID only adds to it while the ASIC is over the target.
+ */
+static float fan_pid(float asic_temp, uint32_t dt_ms)
+{
+	if (!fan_pid_enabled() || !isfinite(asic_temp) || dt_ms == 0) {
+		return 0;
+	}
+
+	float dt = dt_ms / 1000.0f;
+	float error = asic_temp - fan_table.pid_target_temp;
+	float derivative = fan_pid_state.primed ? (error - fan_pid_state.prev_error) / dt : 0;
+
+	fan_pid_state.integral =
+		CLAMP(fan_pid_state.integral + fan_table.pid_i_gain * error * dt, 0.0f, 100.0f);
+	fan_pid_state.prev_error = error;
+	fan_pid_state.primed = true;
+
+	return MAX(fan_table.pid_p_gain * error + fan_pid_state.integral +
+			   fan_table.pid_d_gain * derivative,
+		   0.0f);
+}
+
+static void fan_history_push(uint32_t flags)
+{
+#ifdef CONFIG_TT_BH_ARC_FAN_CTRL_HISTORY
+	struct fan_history_record record = {
+		.timestamp_ms = (uint32_t)k_uptime_get(),
+		.asic_temp = CLAMP(max_asic_temp * 10.0f, INT16_MIN, INT16_MAX),
+		.gddr_temp = CLAMP(max_gddr_temp * 10.0f, INT16_MIN, INT16_MAX),
+		.rpm = fan_rpm,
+		.speed = fan_speed,
+		.flags = flags,
+	};
+
+	K_SPINLOCK(&history_lock) {
+		history.records[history.head & (history.capacity - 1)] = record;
+
+		/* The record must be complete before the host can see it */
+		barrier_dmem_fence_full();
+		history.head++;
+	}
+#endif
+}
+
+/**
+ * @brief Run one fan control update
+ *
+ * @param asic_temp ASIC temperature in degC
+ * @param gddr_temp GDDR temperature in degC
+ * @param dt_ms Time since the last update in ms
+ *
+ * @return The fan speed in %
+ */
+STATIC uint32_t fan_ctrl_step(float asic_temp, float gddr_temp, uint32_t dt_ms)
+{
+	float a = 1.0f - powf(1.0f - alpha, dt_ms / 1000.0f);
+	uint32_t flags = 0;
 
 	/* Telemetry & computations continue to run even when speed is forced so that they stay
 	 * up-to-date.
 	 */
-	ReadTelemetryInternal(1, &telemetry_internal_data);
-	max_asic_temp =
-		alpha * telemetry_internal_data.asic_temperature + (1 - alpha) * max_asic_temp;
+	max_asic_temp = a * asic_temp + (1 - a) * max_asic_temp;
 
 	if (IS_ENABLED(CONFIG_TT_BH_ARC_FAN_CTRL_GDDR_TEMP)) {
-		max_gddr_temp = alpha * GetMaxGDDRTemp() + (1 - alpha) * max_gddr_temp;
+		max_gddr_temp = a * gddr_temp + (1 - a) * max_gddr_temp;
 	} else {
 		max_gddr_temp = 0;
 	}
 
-	if (!fan_speed_forced) {
-		fan_speed = fan_curve(max_asic_temp, max_gddr_temp);
+	uint32_t speed = fan_curve(max_asic_temp, max_gddr_temp);
+	float pid_speed = fan_pid(max_asic_temp, dt_ms);
+
+	if (pid_speed >= 1.0f) {
+		speed = MIN(speed + (uint32_t)MIN(pid_speed, 100.0f), 100);
+		flags |= FAN_HISTORY_FLAG_PID;
+	}
+
+	if (fan_speed_forced) {
+		flags |= FAN_HISTORY_FLAG_FORCED;
+	} else {
+		fan_speed = speed;
+	}
+
+	fan_history_push(flags);
+
+	return fan_speed;
+}
+
+/* Restart the filters from the given temperatures and clear the PID */
+STATIC void fan_ctrl_reset(float asic_temp, float gddr_temp)
+{
+	max_asic_temp = asic_temp;
+	max_gddr_temp = IS_ENABLED(CONFIG_TT_BH_ARC_FAN_CTRL_GDDR_TEMP) ? gddr_temp : 0;
+	fan_pid_state.integral = 0;
+	fan_pid_state.prev_error = 0;
+	fan_pid_state.primed = false;
+}
+
+static void update_fan_speed(void)
+{
+	TelemetryInternalData telemetry_internal_data;
+	int64_t now = k_uptime_get();
+	uint32_t dt = now - last_update_time;
+
+	/* Both the timer and the RPM reports from the DMC trigger updates, skip the late one */
+	if (dt < fan_ctrl_update_interval / 2) {
+		return;
+	}
+	last_update_time = now;
+
+	ReadTelemetryInternal(1, &telemetry_internal_data);
+	fan_ctrl_step(telemetry_internal_data.asic_temperature,
+		      IS_ENABLED(CONFIG_TT_BH_ARC_FAN_CTRL_GDDR_TEMP) ? GetMaxGDDRTemp() : 0,
+		      MIN(dt, FAN_CTRL_MAX_UPDATE_INTERVAL));
+
+	/* Only send the speed to the DMC when it changes, plus a periodic refresh */
+	if (!fan_speed_forced && (fan_speed != last_request_speed ||
+				  now - last_request_time >= FAN_SPEED_REFRESH_INTERVAL)) {
 		UpdateFanSpeedRequest(fan_speed);
+		last_request_speed = fan_speed;
+		last_request_time = now;
 	}
 }
 
@@ -104,6 +294,12 @@ uint16_t GetFanRPM(void)
 void SetFanRPM(uint16_t rpm)
 {
 	fan_rpm = rpm;
+
+	/* A new tach reading is a good time for an update, if one is due */
+	if (k_uptime_get() - last_update_time >= fan_ctrl_update_interval &&
+	    k_timer_remaining_ticks(&fan_ctrl_update_timer) != 0) {
+		tt_work_submit(TT_WORK_QUEUE_BACKGROUND, &fan_ctrl_update_worker);
+	}
 }
 
 uint32_t GetFanSpeed(void)
@@ -111,6 +307,86 @@ uint32_t GetFanSpeed(void)
 	return fan_speed_feedback ? fan_speed_feedback : fan_speed;
 }
 
+static bool valid_fan_curve(const FwTable_FanCurvePoint *points, size_t count)
+{
+	if (count > FAN_CURVE_MAX_POINTS) {
+		return false;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		if (!isfinite(points[i].temperature) || points[i].speed > 100) {
+			return false;
+		}
+		if (i > 0 && (points[i].temperature <= points[i - 1].temperature ||
+			      points[i].speed < points[i - 1].speed)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @brief Load the fan curves, PID gains and update interval of the FW table
+ *
+ * Curves must have strictly increasing temperatures and non-decreasing speeds of at most 100%.
+ * The table is applied as a whole or not at all, an invalid one keeps the built-in P150 curve
+ * without the PID.
+ *
+ * @return 0 on success, -EINVAL if the table is invalid
+ */
+int LoadFanTable(const FwTable_FanTable *table)
+{
+	bool pid = table->pid_p_gain != 0 || table->pid_i_gain != 0 || table->pid_d_gain != 0;
+
+	if (!valid_fan_curve(table->asic_curve, table->asic_curve_count) ||
+	    !valid_fan_curve(table->gddr_curve, table->gddr_curve_count)) {
+		LOG_ERR("Ignoring invalid FW table fan curves");
+		return -EINVAL;
+	}
+
+	if (!(table->pid_p_gain >= 0 && isfinite(table->pid_p_gain)) ||
+	    !(table->pid_i_gain >= 0 && isfinite(table->pid_i_gain)) ||
+	    !(table->pid_d_gain >= 0 && isfinite(table->pid_d_gain)) ||
+	    (pid && !(table->pid_target_temp > 0 && table->pid_target_temp < 125))) {
+		LOG_ERR("Ignoring FW table fan PID gains %f %f %f, target %f",
+			(double)table->pid_p_gain, (double)table->pid_i_gain,
+			(double)table->pid_d_gain, (double)table->pid_target_temp);
+		return -EINVAL;
+	}
+
+	fan_table = *table;
+	fan_pid_state.integral = 0;
+	fan_pid_state.primed = false;
+
+	if (table->update_interval_ms != 0) {
+		fan_ctrl_update_interval = CLAMP(table->update_interval_ms,
+						 FAN_CTRL_MIN_UPDATE_INTERVAL,
+						 FAN_CTRL_MAX_UPDATE_INTERVAL);
+	} else {
+		fan_ctrl_update_interval = CONFIG_TT_BH_ARC_FAN_CTRL_UPDATE_INTERVAL;
+	}
+
+	return 0;
+}
+
+#ifdef CONFIG_TT_BH_ARC_FAN_CTRL_HISTORY
+const struct fan_history *fan_history_get(void)
+{
+	return &history;
+}
+
+uint32_t fan_history_addr(void)
+{
+	return (uint32_t)(uintptr_t)&history;
+}
+#else
+uint32_t fan_history_addr(void)
+{
+	return 0;
+}
+#endif
+
 static void fan_ctrl_work_handler(struct k_work *work)
 {
 	/* do the processing that needs to be done periodically */
@@ -120,7 +396,7 @@ static K_WORK_DEFINE(fan_ctrl_update_worker, fan_ctrl_work_handler);
 
 static void fan_ctrl_timer_handler(struct k_timer *timer)
 {
-	k_work_submit(&fan_ctrl_update_worker);
+	tt_work_submit(TT_WORK_QUEUE_BACKGROUND, &fan_ctrl_update_worker);
 }
 static K_TIMER_DEFINE(fan_ctrl_update_timer, fan_ctrl_timer_handler, NULL);
 
@@ -129,8 +405,11 @@ void init_fan_ctrl(void)
 	/* Get initial asic temp */
 	TelemetryInternalData telemetry_internal_data;
 
+	LoadFanTable(&tt_bh_fwtable_get_fw_table(fwtable_dev)->fan_table);
+
 	ReadTelemetryInternal(1, &telemetry_internal_data);
-	max_asic_temp = telemetry_internal_data.asic_temperature;
+	fan_ctrl_reset(telemetry_internal_data.asic_temperature, 0);
+	last_update_time = k_uptime_get();
 
 	/* start a periodic timer that expires once every fan_ctrl_update_interval */
 	k_timer_start(&fan_ctrl_update_timer, K_MSEC(fan_ctrl_update_interval),
@@ -157,6 +436,8 @@ static uint8_t force_fan_speed(const union request *request, struct response *re
 		UpdateForcedFanSpeedRequest(fan_speed);
 	} else {
 		UpdateFanSpeedRequest(fan_speed);
+		last_request_speed = fan_speed;
+		last_request_time = k_uptime_get();
 	}
 
 	return 0;
@@ -8,10 +8,55 @@
 
 #include <stdint.h>
 
+#include <zephyr/drivers/misc/bh_fwtable.h>
+#include <zephyr/sys/util.h>
+
+/* Keep in sync with the max_count of the curves in fw_table.options */
+#define FAN_CURVE_MAX_POINTS 8
+
+#define FAN_HISTORY_VERSION 1
+
+/* flags of struct fan_history_record */
+#define FAN_HISTORY_FLAG_FORCED BIT(0) /* speed was forced by the host */
+#define FAN_HISTORY_FLAG_PID    BIT(1) /* the PID added to the curve speed */
+
+/* One fan control update. The temperatures are the filtered ones the fan speed was based on. */
+struct fan_history_record {
+	/* Low 32 bits of the uptime in milliseconds */
+	uint32_t timestamp_ms;
+	/* ASIC and GDDR temperature in 1/10 degC */
+	int16_t asic_temp;
+	int16_t gddr_temp;
+	/* Fan RPM last reported by the DMC */
+	uint16_t rpm;
+	/* Requested fan speed in % */
+	uint8_t speed;
+	uint8_t flags;
+};
+
+#ifdef CONFIG_TT_BH_ARC_FAN_CTRL_HISTORY
+/*
+ * Ring buffer of fan control updates, published in TAG_FAN_HISTORY. Read the same way as the
+ * telemetry history: head counts the records written, the newest is records[(head - 1) %
+ * capacity].
+ */
+struct fan_history {
+	uint32_t version;
+	uint32_t capacity;
+	uint32_t record_size;
+	uint32_t head;
+	struct fan_history_record records[CONFIG_TT_BH_ARC_FAN_CTRL_HISTORY_DEPTH];
+};
+
+const struct fan_history *fan_history_get(void);
+#endif
+
 void init_fan_ctrl(void);
+int LoadFanTable(const FwTable_FanTable *table);
 uint32_t GetFanSpeed(void);
 uint16_t GetFanRPM(void);
 void SetFanRPM(uint16_t rpm);
 void DmcFanSpeedFeedback(uint32_t speed_percentage);
+uint32_t fan_history_addr(void);
 
 #endif
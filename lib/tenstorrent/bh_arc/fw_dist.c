@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "fw_dist.h"
+#include "noc2axi.h"
+
+#include <string.h>
+
+#include <tenstorrent/spi_flash_buf.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/drivers/dma/dma_arc_hs.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(fw_dist, CONFIG_TT_APP_LOG_LEVEL);
+
+#ifdef CONFIG_DMA_ARC_HS
+static const struct device *const arc_dma_dev = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(dma0));
+#endif
+
+#ifdef CONFIG_TT_BH_ARC_DMA_PIPELINED
+/* The transfer of a part to the last target runs while the next part is read */
+#define FW_DIST_NUM_BUFS 2
+#else
+#define FW_DIST_NUM_BUFS 1
+#endif
+
+struct fw_dist_pipe_data {
+	const struct device *flash;
+	size_t spi_address;
+	const struct fw_dist_dest *dest;
+	uint32_t flash_reads;
+	uint32_t read_cycles;
+};
+
+static struct fw_dist_stats fw_dist_stats[FW_DIST_MAX_IMAGES];
+
+static volatile void *fw_dist_setup_tlb(const struct fw_dist_dest *dest,
+					const struct fw_dist_target *target, uint64_t addr)
+{
+	if (target->multicast) {
+		NOC2AXIMulticastTlbSetup(dest->ring, dest->tlb, target->x_start, target->y_start,
+					 target->x_end, target->y_end, addr,
+					 kNoc2AxiOrderingStrict);
+	} else {
+		NOC2AXITlbSetup(dest->ring, dest->tlb, target->x_end, target->y_end, addr);
+	}
+
+	return GetTlbWindowAddr(dest->ring, dest->tlb, addr);
+}
+
+#ifndef CONFIG_DMA_ARC_HS
+/* A partial word at the end of the image is padded with zeros */
+static void fw_dist_write_words(const struct fw_dist_dest *dest, uint64_t addr, const uint8_t *src,
+				size_t len)
+{
+	for (size_t i = 0; i < len; i += sizeof(uint32_t)) {
+		uint32_t word = 0;
+
+		memcpy(&word, src + i, MIN(sizeof(word), len - i));
+		NOC2AXIWrite32(dest->ring, dest->tlb, addr + i, word);
+	}
+}
+#endif
+
+/* Write a part of the image to every target. With async, the transfer to the last target is left
+ * running and completed by fw_dist_pipe_wait().
+ */
+static int fw_dist_fan_out(const struct fw_dist_dest *dest, const uint8_t *src, size_t offset,
+			   size_t len, bool async)
+{
+	for (size_t i = 0; i < dest->num_targets; i++) {
+		const struct fw_dist_target *target = &dest->targets[i];
+		uint64_t addr = target->addr + offset;
+
+		/* The TLB is set up for each part, a part must not cross the end of its window */
+		if ((addr & NOC_TLB_WINDOW_ADDR_MASK) + len > BIT64(NOC_TLB_LOG_SIZE)) {
+			return -EINVAL;
+		}
+
+		volatile void *dst = fw_dist_setup_tlb(dest, target, addr);
+
+#ifdef CONFIG_DMA_ARC_HS
+		int rc;
+
+		if (async && (i == dest->num_targets - 1)) {
+			rc = dma_arc_hs_transfer_start(arc_dma_dev, 0, src, (void *)dst, len);
+		} else {
+			rc = dma_arc_hs_transfer(arc_dma_dev, 0, src, (void *)dst, len, K_MSEC(500));
+		}
+		if (rc < 0) {
+			LOG_ERR("%s() failed: %d", "dma_arc_hs_transfer", rc);
+			return -EIO;
+		}
+#else
+		ARG_UNUSED(dst);
+		ARG_UNUSED(async);
+		fw_dist_write_words(dest, addr, src, len);
+#endif
+	}
+
+	return 0;
+}
+
+static int fw_dist_pipe_read(void *user_data, size_t offset, uint8_t *buf, size_t len)
+{
+	struct fw_dist_pipe_data *data = user_data;
+	uint32_t start = k_cycle_get_32();
+	int rc = flash_read(data->flash, data->spi_address + offset, buf, len);
+
+	data->read_cycles += k_cycle_get_32() - start;
+	data->flash_reads++;
+
+	if (rc < 0) {
+		LOG_ERR("%s() failed: %d", "flash_read", rc);
+	}
+	return rc;
+}
+
+static int fw_dist_pipe_start(void *user_data, const uint8_t *src, size_t offset, size_t len)
+{
+	struct fw_dist_pipe_data *data = user_data;
+
+	return fw_dist_fan_out(data->dest, src, offset, len, FW_DIST_NUM_BUFS > 1);
+}
+
+#ifdef CONFIG_TT_BH_ARC_DMA_PIPELINED
+static int fw_dist_pipe_wait(void *user_data)
+{
+	ARG_UNUSED(user_data);
+
+	int rc = dma_arc_hs_transfer_wait(arc_dma_dev, 0, K_MSEC(500));
+
+	if (rc < 0) {
+		LOG_ERR("%s() failed: %d", "dma_arc_hs_transfer_wait", rc);
+		return -EIO;
+	}
+	return 0;
+}
+#endif
+
+static void fw_dist_record(const char *tag, size_t image_size, const struct fw_dist_dest *dest,
+			   uint32_t flash_reads, uint32_t read_cycles, uint32_t start)
+{
+	uint32_t total_us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+	uint32_t read_us = k_cyc_to_us_floor32(read_cycles);
+
+	LOG_DBG("%s: %zu bytes to %zu targets in %u us, %u us reading flash", tag, image_size,
+		dest->num_targets, total_us, read_us);
+
+	for (size_t i = 0; i < ARRAY_SIZE(fw_dist_stats); i++) {
+		struct fw_dist_stats *stats = &fw_dist_stats[i];
+
+		if ((stats->tag == NULL) || (strcmp(stats->tag, tag) == 0)) {
+			stats->tag = tag;
+			stats->image_size = image_size;
+			stats->num_targets = dest->num_targets;
+			stats->flash_reads = flash_reads;
+			stats->read_us = read_us;
+			stats->total_us = total_us;
+			return;
+		}
+	}
+
+	LOG_WRN("No room for the stats of %s, FW_DIST_MAX_IMAGES is %d", tag, FW_DIST_MAX_IMAGES);
+}
+
+/**
+ * @brief Load an image from SPI flash to all targets
+ *
+ * Each part of the image is read from flash once and written to every target of @p dest before
+ * the next part is read, so the flash is read once however many targets there are. With
+ * CONFIG_TT_BH_ARC_DMA_PIPELINED, the next part is read while the previous one is written to the
+ * last target by the ARC DMA.
+ *
+ * @param tag Tag of the image the timings are recorded under, must outlive the stats
+ * @param flash SPI flash device
+ * @param spi_address Address of the image in flash
+ * @param image_size Size of the image in bytes
+ * @param dest Targets to write the image to
+ * @param buf Buffer for the parts of the image
+ * @param buf_size Size of @p buf in bytes
+ *
+ * @return 0 on success, or a negative error code
+ */
+int fw_dist_load(const char *tag, const struct device *flash, size_t spi_address,
+		 size_t image_size, const struct fw_dist_dest *dest, uint8_t *buf, size_t buf_size)
+{
+	uint32_t start = k_cycle_get_32();
+	struct fw_dist_pipe_data data = {
+		.flash = flash,
+		.spi_address = spi_address,
+		.dest = dest,
+	};
+	const struct spi_transfer_pipe pipe = {
+		.read = fw_dist_pipe_read,
+		.start = fw_dist_pipe_start,
+#ifdef CONFIG_TT_BH_ARC_DMA_PIPELINED
+		.wait = fw_dist_pipe_wait,
+#endif
+		.user_data = &data,
+	};
+	int rc;
+
+	if (dest->num_targets == 0) {
+		return 0;
+	}
+
+	/* Every part starts on a word */
+	rc = spi_transfer_pipelined(&pipe, image_size, buf, ROUND_DOWN(buf_size, sizeof(uint32_t)),
+				    FW_DIST_NUM_BUFS);
+	if (rc < 0) {
+		return rc;
+	}
+
+	fw_dist_record(tag, image_size, dest, data.flash_reads, data.read_cycles, start);
+	return 0;
+}
+
+/**
+ * @brief Write an image that is already in memory to all targets
+ *
+ * Used for images that are patched after they are read from flash.
+ *
+ * @param tag Tag of the image the timings are recorded under, must outlive the stats
+ * @param image Image, 4-byte aligned
+ * @param image_size Size of the image in bytes
+ * @param dest Targets to write the image to
+ *
+ * @return 0 on success, or a negative error code
+ */
+int fw_dist_write(const char *tag, const uint8_t *image, size_t image_size,
+		  const struct fw_dist_dest *dest)
+{
+	uint32_t start = k_cycle_get_32();
+	int rc;
+
+	if ((dest->num_targets == 0) || (image_size == 0)) {
+		return 0;
+	}
+
+	rc = fw_dist_fan_out(dest, image, 0, image_size, false);
+	if (rc < 0) {
+		return rc;
+	}
+
+	fw_dist_record(tag, image_size, dest, 0, 0, start);
+	return 0;
+}
+
+/**
+ * @brief Get the timings of the last load of an image
+ *
+ * @param tag Tag of the image
+ *
+ * @return The timings, or NULL if the image was not loaded
+ */
+const struct fw_dist_stats *fw_dist_get_stats(const char *tag)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(fw_dist_stats); i++) {
+		if ((fw_dist_stats[i].tag != NULL) && (strcmp(fw_dist_stats[i].tag, tag) == 0)) {
+			return &fw_dist_stats[i];
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Get the time the last load of an image took
+ *
+ * @param tag Tag of the image
+ *
+ * @return The time in microseconds, or 0 if the image was not loaded
+ */
+uint32_t fw_dist_get_load_us(const char *tag)
+{
+	const struct fw_dist_stats *stats = fw_dist_get_stats(tag);
+
+	return (stats == NULL) ? 0 : stats->total_us;
+}
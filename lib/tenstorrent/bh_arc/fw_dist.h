@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef FW_DIST_H
+#define FW_DIST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zephyr/device.h>
+
+#define FW_DIST_MAX_IMAGES 8
+
+/**
+ * @brief A tile, or a rectangle of tiles, that an image is written to
+ *
+ * A multicast target covers the tiles from (x_start, y_start) to (x_end, y_end) with one write.
+ * Only tiles that take broadcasts can be reached this way, NocInit excludes the GDDR and the
+ * ETH and PCIe tiles, so those are unicast targets, one per instance. No firmware load has a
+ * multicast target yet, only the tests go through the multicast TLB setup.
+ */
+struct fw_dist_target {
+	uint64_t addr;
+	uint8_t x_start;
+	uint8_t y_start;
+	uint8_t x_end;
+	uint8_t y_end;
+	bool multicast;
+};
+
+/** @brief The targets of an image and the TLB used to write to them */
+struct fw_dist_dest {
+	const struct fw_dist_target *targets;
+	size_t num_targets;
+	uint8_t ring;
+	uint8_t tlb;
+};
+
+/** @brief Timings of the last load of an image */
+struct fw_dist_stats {
+	const char *tag;
+	uint32_t image_size;
+	uint32_t num_targets;
+	/* Parts read from flash, each is written to all targets */
+	uint32_t flash_reads;
+	uint32_t read_us;
+	uint32_t total_us;
+};
+
+static inline struct fw_dist_target fw_dist_unicast(uint8_t x, uint8_t y, uint64_t addr)
+{
+	return (struct fw_dist_target){
+		.addr = addr,
+		.x_start = x,
+		.y_start = y,
+		.x_end = x,
+		.y_end = y,
+	};
+}
+
+int fw_dist_load(const char *tag, const struct device *flash, size_t spi_address,
+		 size_t image_size, const struct fw_dist_dest *dest, uint8_t *buf, size_t buf_size);
+int fw_dist_write(const char *tag, const uint8_t *image, size_t image_size,
+		  const struct fw_dist_dest *dest);
+const struct fw_dist_stats *fw_dist_get_stats(const char *tag);
+uint32_t fw_dist_get_load_us(const char *tag);
+
+#endif
@@ -5,6 +5,7 @@
  */
 
 #include "bh_reset.h"
+#include "fw_dist.h"
 #include "gddr.h"
 #include "harvesting.h"
 #include "init.h"
@@ -17,7 +18,6 @@
 #include <tenstorrent/msgqueue.h>
 #include <tenstorrent/post_code.h>
 #include <tenstorrent/smc_msg.h>
-#include <tenstorrent/spi_flash_buf.h>
 #include <tenstorrent/sys_init_defines.h>
 #include <tenstorrent/tt_boot_fs.h>
 #include <zephyr/drivers/misc/bh_fwtable.h>
@@ -63,6 +63,11 @@ struct gddr_bist_info get_gddr_bist_info(void)
 	return gddr_bist;
 }
 
+uint32_t get_mrisc_fw_load_time(void)
+{
+	return fw_dist_get_load_us(MRISC_FW_TAG) + fw_dist_get_load_us(MRISC_FW_CFG_TAG);
+}
+
 static uint32_t GetGddrSpeedFromCfg(uint8_t *fw_cfg_image)
 {
 	/* GDDR speed is the second DWORD of the MRISC FW Config table */
@@ -179,36 +184,73 @@ static void SetAxiEnable(uint8_t gddr_inst, uint8_t noc2axi_port, bool axi_enabl
 	}
 }
 
-static int LoadMriscFw(uint8_t gddr_inst, uint8_t *buf, size_t buf_size, size_t spi_address,
+static size_t GetMriscL1Targets(uint32_t dram_mask, uint32_t offset,
+				struct fw_dist_target targets[NUM_GDDR])
+{
+	size_t num_targets = 0;
+
+	for (uint8_t gddr_inst = 0; gddr_inst < NUM_GDDR; gddr_inst++) {
+		if (IS_BIT_SET(dram_mask, gddr_inst)) {
+			uint8_t x, y;
+
+			GetGddrNocCoords(gddr_inst, MRISC_FW_NOC2AXI_PORT, 0, &x, &y);
+			targets[num_targets++] = fw_dist_unicast(x, y, MRISC_L1_ADDR + offset);
+		}
+	}
+
+	return num_targets;
+}
+
+/* GDDR tiles don't take multicasts, the image is read once and written to each MRISC in turn */
+static int LoadMriscFw(uint32_t dram_mask, uint8_t *buf, size_t buf_size, size_t spi_address,
 		       size_t image_size)
 {
-	volatile uint32_t *mrisc_l1 = SetupMriscL1Tlb(gddr_inst);
-	int rc = spi_arc_dma_transfer_to_tile(flash, spi_address, image_size, buf, buf_size,
-					      (uint8_t *)mrisc_l1);
+	struct fw_dist_target targets[NUM_GDDR];
+	const struct fw_dist_dest dest = {
+		.targets = targets,
+		.num_targets = GetMriscL1Targets(dram_mask, 0, targets),
+		.ring = 0,
+		.tlb = MRISC_SETUP_TLB,
+	};
 
-	return rc;
+	return fw_dist_load(MRISC_FW_TAG, flash, spi_address, image_size, &dest, buf, buf_size);
 }
-static int LoadMriscFwCfg(uint8_t gddr_inst, uint8_t *buf, size_t buf_size, size_t spi_address,
-			  size_t image_size)
+
+static int LoadMriscFwCfg(uint32_t dram_mask, const uint8_t *fw_cfg_image, size_t image_size)
 {
-	volatile uint32_t *mrisc_l1 = SetupMriscL1Tlb(gddr_inst);
-	int rc = spi_arc_dma_transfer_to_tile(flash, spi_address, image_size, buf, buf_size,
-					      (uint8_t *)mrisc_l1 + MRISC_FW_CFG_OFFSET);
-
-	if (rc == 0) {
-		/* Set the controller_id field to the GDDR instance */
-		volatile gddr_params_table_t *params_table =
-			(volatile gddr_params_table_t *)((uint8_t *)mrisc_l1 + MRISC_FW_CFG_OFFSET);
-		if (params_table->params_table_version >= 6) {
+	struct fw_dist_target targets[NUM_GDDR];
+	const struct fw_dist_dest dest = {
+		.targets = targets,
+		.num_targets = GetMriscL1Targets(dram_mask, MRISC_FW_CFG_OFFSET, targets),
+		.ring = 0,
+		.tlb = MRISC_SETUP_TLB,
+	};
+	const gddr_params_table_t *params = (const gddr_params_table_t *)fw_cfg_image;
+	int rc = fw_dist_write(MRISC_FW_CFG_TAG, fw_cfg_image, image_size, &dest);
+
+	if (rc < 0) {
+		return rc;
+	}
+
+	if (params->params_table_version < 6) {
+		LOG_WRN_ONCE("MRISC params table version %d does not support controller_id "
+			     "field (>= 6 required)",
+			     params->params_table_version);
+		return 0;
+	}
+
+	/* Set the controller_id field to the GDDR instance */
+	for (uint8_t gddr_inst = 0; gddr_inst < NUM_GDDR; gddr_inst++) {
+		if (IS_BIT_SET(dram_mask, gddr_inst)) {
+			volatile uint8_t *mrisc_l1 = SetupMriscL1Tlb(gddr_inst);
+			volatile gddr_params_table_t *params_table =
+				(volatile gddr_params_table_t *)(mrisc_l1 + MRISC_FW_CFG_OFFSET);
+
 			params_table->controller_id = gddr_inst;
-		} else {
-			LOG_WRN_ONCE("MRISC params table version %d does not support controller_id "
-				     "field (>= 6 required)",
-				     params_table->params_table_version);
 		}
 	}
 
-	return rc;
+	return 0;
 }
 
 static uint32_t GetDramMask(void)
@@ -402,13 +444,9 @@ static int InitMrisc(void)
 	image_size = tag_fd.flags.f.image_size;
 	spi_address = tag_fd.spi_addr;
 
-	for (uint8_t gddr_inst = 0; gddr_inst < NUM_GDDR; gddr_inst++) {
-		if (IS_BIT_SET(dram_mask, gddr_inst)) {
-			if (LoadMriscFw(gddr_inst, buf, SCRATCHPAD_SIZE, spi_address, image_size)) {
-				LOG_ERR("%s(%d) failed: %d", "LoadMriscFw", gddr_inst, -EIO);
-				return -EIO;
-			}
-		}
+	if (LoadMriscFw(dram_mask, buf, SCRATCHPAD_SIZE, spi_address, image_size)) {
+		LOG_ERR("%s() failed: %d", "LoadMriscFw", -EIO);
+		return -EIO;
 	}
 
 	rc = tt_boot_fs_find_fd_by_tag(flash, MRISC_FW_CFG_TAG, &tag_fd);
@@ -444,13 +482,13 @@ static int InitMrisc(void)
 		return -EIO;
 	}
 
+	if (LoadMriscFwCfg(dram_mask, buf, image_size)) {
+		LOG_ERR("%s() failed: %d", "LoadMriscFwCfg", -EIO);
+		return -EIO;
+	}
+
 	for (uint8_t gddr_inst = 0; gddr_inst < NUM_GDDR; gddr_inst++) {
 		if (IS_BIT_SET(dram_mask, gddr_inst)) {
-			if (LoadMriscFwCfg(gddr_inst, buf, SCRATCHPAD_SIZE, spi_address,
-					   image_size)) {
-				LOG_ERR("%s(%d) failed: %d", "LoadMriscFwCfg", gddr_inst, -EIO);
-				return -EIO;
-			}
 			MriscRegWrite32(gddr_inst, MRISC_INIT_STATUS, MRISC_INIT_BEFORE);
 			ReleaseMriscReset(gddr_inst);
 		}
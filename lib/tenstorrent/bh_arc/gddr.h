@@ -51,6 +51,13 @@
 
 int read_gddr_telemetry_table(uint8_t gddr_inst, gddr_telemetry_table_t *gddr_telemetry);
 
+/**
+ * @brief Get the time taken to load the MRISC FW and its config at boot
+ *
+ * @return The time in microseconds, 0 if no MRISC FW was loaded
+ */
+uint32_t get_mrisc_fw_load_time(void);
+
 /** @brief BIST status bitmasks (one bit per GDDR instance). */
 struct gddr_bist_info {
 	uint8_t complete;
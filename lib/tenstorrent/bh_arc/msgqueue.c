@@ -18,6 +18,8 @@
 #include "status_reg.h"
 #include "reg.h"
 #include "irqnum.h"
+#include "msgqueue_stats.h"
+#include "work_queue.h"
 
 #define MSGHANDLER_COMPAT_MASK 0x1
 
@@ -94,8 +96,49 @@ static struct message_queue message_queues[NUM_MSG_QUEUES];
 /* All message handlers */
 static void *message_handlers[CONFIG_TT_BH_ARC_NUM_MSG_CODES];
 
+#define ALL_MSG_QUEUES BIT_MASK(NUM_MSG_QUEUES)
+
+/* Pointer arithmetic on the double-wrapped queue pointers relies on unsigned wrap-around. */
+BUILD_ASSERT(IS_POWER_OF_TWO(MSG_QUEUE_SIZE), "Message queue size must be a power of two");
+BUILD_ASSERT(MSG_QUEUE_SIZE <= UINT8_MAX && NUM_MSG_QUEUES <= 8,
+	     "Message queue geometry must fit the message queue info block");
+
+/* Queues signalled by the host since they were last scanned */
+static atomic_t doorbell_mask;
+/* Cycle count of the first doorbell since the queues were last scanned */
+static uint32_t doorbell_cycles;
+/* Queues left with requests by the last scan, e.g. because their response queue was full */
+static uint32_t rescan_mask;
+
+/* State of a response that a handler has deferred with msgqueue_defer_response(). */
+struct deferred_response {
+	bool pending;
+	/* Incremented on every deferral and reset so that stale tokens are rejected */
+	uint32_t generation;
+	msgqueue_cancel_t cancel;
+	void *user_data;
+};
+
+static struct deferred_response deferred_responses[NUM_MSG_QUEUES];
+static struct k_spinlock deferred_lock;
+
+/* Serializes queue processing, which may run from several threads in tests and on completion */
+static K_MUTEX_DEFINE(msgqueue_lock);
+
+/* Queue whose message is being dispatched, NULL where deferral is not allowed */
+static struct message_queue *dispatch_queue;
+static bool dispatch_deferred;
+
+/*
+ * Sub-requests and responses for TT_SMC_MSG_BATCH, written by the host. Each queue has its own
+ * entries, so that hosts batching on different queues don't overwrite each other's.
+ */
+static struct msgqueue_batch_entry batch_entries[NUM_MSG_QUEUES]
+						[CONFIG_TT_BH_ARC_MSGQUEUE_BATCH_ENTRIES];
+
 __attribute__((used)) static const uintptr_t message_queue_info[] = {
-	(uintptr_t)&message_queues, MSG_QUEUE_SIZE | (NUM_MSG_QUEUES << 8), 0, 0};
+	(uintptr_t)&message_queues, MSG_QUEUE_SIZE | (NUM_MSG_QUEUES << 8),
+	(uintptr_t)&batch_entries, ARRAY_SIZE(batch_entries[0])};
 
 static inline void *mask_voidp(void *x, uintptr_t mask)
 {
@@ -111,6 +154,16 @@ static inline void *unmask_voidp(void *x, uintptr_t mask)
 	return (void *)y;
 }
 
+/* Called when the host signals new requests, as the start of the queue-wait time. */
+static void msgqueue_doorbell(atomic_val_t queues)
+{
+	uint32_t now = k_cycle_get_32();
+
+	if (atomic_or(&doorbell_mask, queues) == 0) {
+		doorbell_cycles = now;
+	}
+}
+
 static union request *request_entry(struct message_queue *queue, uint32_t ptr)
 {
 	return &queue->request_queue[ptr % MSG_QUEUE_SIZE];
@@ -133,10 +186,17 @@ int msgqueue_request_push(uint32_t msgqueue_id, const union request *request)
 		return -1;
 	}
 
+	if ((queue->header.request_queue_wptr - queue->header.request_queue_rptr) %
+		    MSG_QUEUE_POINTER_WRAP ==
+	    MSG_QUEUE_SIZE) {
+		return -1;
+	}
+
 	*request_entry(queue, queue->header.request_queue_wptr) = *request;
 	atomic_thread_fence(memory_order_acquire);
 	queue->header.request_queue_wptr += 1;
 	queue->header.request_queue_wptr %= MSG_QUEUE_POINTER_WRAP;
+	msgqueue_doorbell(BIT(msgqueue_id));
 
 	return 0;
 }
@@ -193,6 +253,10 @@ int msgqueue_response_pop(uint32_t msgqueue_id, struct response *response)
 		return -1;
 	}
 
+	if (queue->header.response_queue_rptr == queue->header.response_queue_wptr) {
+		return -1;
+	}
+
 	*response = *response_entry(queue, queue->header.response_queue_rptr);
 	atomic_thread_fence(memory_order_seq_cst);
 	queue->header.response_queue_rptr += 1;
@@ -201,6 +265,17 @@ int msgqueue_response_pop(uint32_t msgqueue_id, struct response *response)
 	return 0;
 }
 
+struct msgqueue_batch_entry *msgqueue_batch_entries(uint32_t msgqueue_id, uint32_t *num_entries)
+{
+	if (msgqueue_id >= NUM_MSG_QUEUES) {
+		return NULL;
+	}
+
+	*num_entries = ARRAY_SIZE(batch_entries[msgqueue_id]);
+
+	return batch_entries[msgqueue_id];
+}
+
 static bool start_next_message(struct message_queue *queue, uint32_t *request_rptr_out,
 			       uint32_t *response_wptr_out)
 {
@@ -291,6 +366,59 @@ static void handle_test(struct message_queue *queue, const union request *reques
 	response->data[2] = queue->header.last_serial + 1;
 }
 
+/**
+ * @brief Handler for @ref TT_SMC_MSG_BATCH
+ * @param[in] queue The message queue processing this request, whose batch entries are run
+ * @param[in] request The request, of type @ref batch_rqst
+ * @param[out] response The response to the host, with the number of sub-requests run and failed
+ *
+ * Sub-requests are dispatched straight to the message handlers, so they cannot nest batches or
+ * touch the queue serial number.
+ */
+static void handle_batch(struct message_queue *queue, const union request *request,
+			 struct response *response)
+{
+	struct msgqueue_batch_entry *entries = batch_entries[queue - message_queues];
+	uint32_t first = request->batch.first_entry;
+	uint32_t count = request->batch.num_entries;
+	uint32_t run = 0;
+	uint32_t failed = 0;
+
+	if (first >= ARRAY_SIZE(batch_entries[0]) || count > ARRAY_SIZE(batch_entries[0]) - first) {
+		response->data[0] = 1;
+		return;
+	}
+
+	/* A deferred sub-response could not be written back before the batch completes */
+	dispatch_queue = NULL;
+	atomic_thread_fence(memory_order_acquire);
+
+	while (run < count) {
+		struct msgqueue_batch_entry *entry = &entries[first + run];
+		union request sub_request = entry->request;
+		struct response sub_response = (struct response){0};
+
+		process_l2_message_queue(&sub_request, &sub_response);
+		entry->response = sub_response;
+		run++;
+
+		if (sub_response.data[0] != 0) {
+			failed++;
+			if (request->batch.flags & BATCH_FLAG_STOP_ON_ERROR) {
+				break;
+			}
+		}
+	}
+
+	/* Responses must be visible before the batch completion is pushed */
+	atomic_thread_fence(memory_order_release);
+	dispatch_queue = queue;
+
+	response->data[0] = 0;
+	response->data[1] = run;
+	response->data[2] = failed;
+}
+
 /**
  * @brief Handler for @ref TT_SMC_MSG_REPORT_SCRATCH_ONLY
  * @see report_scratch_only_rqst
@@ -314,25 +442,56 @@ static void process_queued_message(struct message_queue *queue, const union requ
 	case TT_SMC_MSG_REPORT_SCRATCH_ONLY:
 		report_scratch_only_message(response);
 		break;
+	case TT_SMC_MSG_BATCH:
+		handle_batch(queue, request, response);
+		break;
 	default:
 		process_l2_message_queue(request, response);
 		break;
 	}
 }
 
+static bool response_deferred(struct message_queue *queue)
+{
+	bool pending;
+
+	K_SPINLOCK(&deferred_lock) {
+		pending = deferred_responses[queue - message_queues].pending;
+	}
+
+	return pending;
+}
+
 /* Run all the outstanding messages in a single queue. */
-static void process_message_queue(struct message_queue *queue)
+static void process_message_queue(struct message_queue *queue, uint32_t arrival_cycles)
 {
 
 	uint32_t request_rptr;
 	uint32_t response_wptr;
 
-	while (start_next_message(queue, &request_rptr, &response_wptr)) {
+	/* Responses are in request order, so a deferred response holds up the rest of its queue. */
+	while (!response_deferred(queue) &&
+	       start_next_message(queue, &request_rptr, &response_wptr)) {
 		union request request = (union request){0};
 		struct response response = (struct response){0};
 
 		msgqueue_request_pop(queue - message_queues, &request);
+
+		uint32_t start_cycles = k_cycle_get_32();
+
+		dispatch_queue = queue;
+		dispatch_deferred = false;
 		process_queued_message(queue, &request, &response);
+		dispatch_queue = NULL;
+
+		msgqueue_stats_record(request.command_code, start_cycles - arrival_cycles,
+				      k_cycle_get_32() - start_cycles);
+
+		if (dispatch_deferred) {
+			/* The response slot stays reserved until msgqueue_complete_response() */
+			break;
+		}
+
 		msgqueue_response_push(queue - message_queues, &response);
 
 		advance_serial(queue, &request);
@@ -349,15 +508,148 @@ void clear_msg_irq(void)
 #endif
 }
 
-/* Run all messages in all queues. */
+static bool request_queue_empty(struct message_queue *queue)
+{
+	return queue->header.request_queue_wptr == queue->header.request_queue_rptr;
+}
+
+/* Run all messages in the queues that have been signalled, or in all queues without a doorbell. */
 void process_message_queues(void)
 {
+	atomic_val_t queues = atomic_clear(&doorbell_mask);
+	/* Without a doorbell, requests are picked up by a scan triggered for another reason. */
+	uint32_t arrival_cycles = queues != 0 ? doorbell_cycles : k_cycle_get_32();
+
+	if (queues == 0) {
+		queues = ALL_MSG_QUEUES;
+	}
+
+	k_mutex_lock(&msgqueue_lock, K_FOREVER);
+	queues |= rescan_mask;
+	rescan_mask = 0;
+
 	SetPostCode(POST_CODE_SRC_CMFW, POST_CODE_ARC_MSG_HANDLE_START);
 	for (unsigned int i = 0; i < NUM_MSG_QUEUES; i++) {
+		if (!(queues & BIT(i))) {
+			continue;
+		}
+
 		SetPostCode(POST_CODE_SRC_CMFW, POST_CODE_ARG_MSG_QUEUE_START + i);
-		process_message_queue(&message_queues[i]);
+		process_message_queue(&message_queues[i], arrival_cycles);
+
+		if (!request_queue_empty(&message_queues[i])) {
+			rescan_mask |= BIT(i);
+		}
 	}
 	SetPostCode(POST_CODE_SRC_CMFW, POST_CODE_ARC_MSG_HANDLE_DONE);
+	k_mutex_unlock(&msgqueue_lock);
+}
+
+static void msgqueue_work_handler(struct k_work *work)
+{
+	process_message_queues();
+}
+
+static K_WORK_DEFINE(msgqueue_work, msgqueue_work_handler);
+
+int msgqueue_defer_response(struct msgqueue_token *token, msgqueue_cancel_t cancel,
+			    void *user_data)
+{
+	if (dispatch_queue == NULL || dispatch_deferred || token == NULL) {
+		return -ENOTSUP;
+	}
+
+	uint32_t msgqueue_id = dispatch_queue - message_queues;
+	struct deferred_response *deferred = &deferred_responses[msgqueue_id];
+
+	K_SPINLOCK(&deferred_lock) {
+		deferred->pending = true;
+		deferred->generation++;
+		deferred->cancel = cancel;
+		deferred->user_data = user_data;
+
+		token->msgqueue_id = msgqueue_id;
+		token->generation = deferred->generation;
+	}
+
+	dispatch_deferred = true;
+
+	return 0;
+}
+
+int msgqueue_complete_response(struct msgqueue_token token, const struct response *response,
+			       uint8_t exit_code)
+{
+	struct response rsp = (struct response){0};
+	int ret = 0;
+
+	if (token.msgqueue_id >= NUM_MSG_QUEUES) {
+		return -EINVAL;
+	}
+
+	if (response != NULL) {
+		rsp = *response;
+	}
+	rsp.data[0] |= exit_code;
+
+	struct deferred_response *deferred = &deferred_responses[token.msgqueue_id];
+
+	K_SPINLOCK(&deferred_lock) {
+		if (!deferred->pending || deferred->generation != token.generation) {
+			ret = -ECANCELED;
+			K_SPINLOCK_BREAK;
+		}
+
+		/* The slot was reserved by start_next_message() when the request was taken. */
+		msgqueue_response_push(token.msgqueue_id, &rsp);
+		/* Only handler messages can be deferred, and none of them writes the serial. */
+		message_queues[token.msgqueue_id].header.last_serial++;
+		deferred->pending = false;
+	}
+
+	if (ret == 0) {
+		/* Pick up requests that queued up behind the deferred one */
+		msgqueue_doorbell(BIT(token.msgqueue_id));
+		tt_work_submit(TT_WORK_QUEUE_HOST_MSG, &msgqueue_work);
+	}
+
+	return ret;
+}
+
+int msgqueue_reset_queue(uint32_t msgqueue_id)
+{
+	struct msgqueue_token token;
+	msgqueue_cancel_t cancel = NULL;
+	void *user_data = NULL;
+
+	if (msgqueue_id >= NUM_MSG_QUEUES) {
+		return -EINVAL;
+	}
+
+	struct deferred_response *deferred = &deferred_responses[msgqueue_id];
+
+	k_mutex_lock(&msgqueue_lock, K_FOREVER);
+	K_SPINLOCK(&deferred_lock) {
+		if (deferred->pending) {
+			cancel = deferred->cancel;
+			user_data = deferred->user_data;
+			token.msgqueue_id = msgqueue_id;
+			token.generation = deferred->generation;
+		}
+
+		deferred->pending = false;
+		deferred->generation++;
+		memset(&message_queues[msgqueue_id].header, 0,
+		       sizeof(message_queues[msgqueue_id].header));
+		message_queues[msgqueue_id].header.version = MSG_QUEUE_LAYOUT_VERSION;
+	}
+	k_mutex_unlock(&msgqueue_lock);
+
+	if (cancel != NULL) {
+		cancel(token, user_data);
+	}
+
+	return 0;
 }
 
 void msgqueue_register_handler(uint32_t msg_code, msgqueue_request_handler_t handler)
@@ -371,9 +663,9 @@ void msgqueue_register_handler(uint32_t msg_code, msgqueue_request_handler_t han
 
 static void prepare_msg_queue(void)
 {
-	/* clear message queue headers */
+	/* clear message queue headers, cancelling any deferred responses */
 	for (unsigned int i = 0; i < NUM_MSG_QUEUES; i++) {
-		memset(&message_queues[i].header, 0, sizeof(message_queues[i].header));
+		msgqueue_reset_queue(i);
 	}
 
 	/* populate address of message queue info */
@@ -393,18 +685,12 @@ SYS_INIT_APP(register_interrupt_handlers);
 #endif
 
 #ifdef CONFIG_BOARD_TT_BLACKHOLE
-static void msgqueue_work_handler(struct k_work *work)
-{
-	process_message_queues();
-}
-
-static K_WORK_DEFINE(msgqueue_work, msgqueue_work_handler);
-
 static void msgqueue_interrupt_handler(void *arg)
 {
 	(void)(arg);
 	clear_msg_irq();
-	k_work_submit(&msgqueue_work);
+	msgqueue_doorbell(ALL_MSG_QUEUES);
+	tt_work_submit(TT_WORK_QUEUE_HOST_MSG, &msgqueue_work);
 }
 
 static bool msi_catcher_nonempty(void)
@@ -429,19 +715,24 @@ static void msgqueue_msi_interrupt_handler(void *arg)
 {
 	(void)(arg);
 
-	bool msi_for_msgqueue = false;
+	atomic_val_t queues = 0;
 
 	/* MSI catcher generates SLVERR if you read from an empty FIFO. */
 	while (msi_catcher_nonempty()) {
 		uint32_t msi_data = msi_catcher_pop();
 
 		if (msi_data == 0) {
-			msi_for_msgqueue = true;
+			/* Legacy doorbell, scan every queue */
+			queues |= ALL_MSG_QUEUES;
+		} else if (msi_data >= MSG_QUEUE_DOORBELL_MSI_BASE &&
+			   msi_data < MSG_QUEUE_DOORBELL_MSI(NUM_MSG_QUEUES)) {
+			queues |= BIT(msi_data - MSG_QUEUE_DOORBELL_MSI_BASE);
 		}
 	}
 
-	if (msi_for_msgqueue) {
-		k_work_submit(&msgqueue_work);
+	if (queues != 0) {
+		msgqueue_doorbell(queues);
+		tt_work_submit(TT_WORK_QUEUE_HOST_MSG, &msgqueue_work);
 	}
 }
 
@@ -449,8 +740,10 @@ static void msgqueue_msi_overflow_handler(void *arg)
 {
 	(void)(arg);
 
+	/* Doorbells in the FIFO are lost, so scan every queue */
 	msi_catcher_flush();
-	k_work_submit(&msgqueue_work);
+	msgqueue_doorbell(ALL_MSG_QUEUES);
+	tt_work_submit(TT_WORK_QUEUE_HOST_MSG, &msgqueue_work);
 }
 #endif
 
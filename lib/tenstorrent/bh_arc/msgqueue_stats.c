@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "msgqueue_stats.h"
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+
+#define RESPONSE_HIST_WORDS (RESPONSE_MSG_LEN - 1)
+
+BUILD_ASSERT(CONFIG_TT_BH_ARC_MSGQUEUE_STATS_SLOTS <= UINT8_MAX);
+
+static struct k_spinlock stats_lock;
+
+/* Statistics are only kept for message codes that have been seen, to bound memory use. */
+static struct msgqueue_stats stats_slots[CONFIG_TT_BH_ARC_MSGQUEUE_STATS_SLOTS];
+/* Slot index + 1 for each message code, 0 if no slot has been assigned */
+static uint8_t stats_slot_map[CONFIG_TT_BH_ARC_NUM_MSG_CODES];
+static unsigned int stats_slots_used;
+/* Samples not recorded because all slots were taken */
+static uint32_t stats_dropped;
+static int64_t stats_start_ms;
+
+unsigned int msgqueue_stats_bucket(uint32_t cycles)
+{
+	if (cycles < BIT(MSGQUEUE_STATS_BUCKET_SHIFT)) {
+		return 0;
+	}
+
+	unsigned int bucket = LOG2(cycles) - MSGQUEUE_STATS_BUCKET_SHIFT + 1;
+
+	return MIN(bucket, MSGQUEUE_STATS_NUM_BUCKETS - 1);
+}
+
+static void record_sample(struct msgqueue_stats *stats, enum msgqueue_stats_hist hist,
+			  uint32_t cycles)
+{
+	stats->hist[hist][msgqueue_stats_bucket(cycles)]++;
+	stats->total_cycles[hist] += cycles;
+	stats->max_cycles[hist] = MAX(stats->max_cycles[hist], cycles);
+}
+
+void msgqueue_stats_record(uint32_t msg_code, uint32_t wait_cycles, uint32_t exec_cycles)
+{
+	if (msg_code >= CONFIG_TT_BH_ARC_NUM_MSG_CODES) {
+		return;
+	}
+
+	k_spinlock_key_t key = k_spin_lock(&stats_lock);
+
+	if (stats_slot_map[msg_code] == 0) {
+		if (stats_slots_used == ARRAY_SIZE(stats_slots)) {
+			stats_dropped++;
+			k_spin_unlock(&stats_lock, key);
+			return;
+		}
+		stats_slot_map[msg_code] = ++stats_slots_used;
+	}
+
+	struct msgqueue_stats *stats = &stats_slots[stats_slot_map[msg_code] - 1];
+
+	stats->count++;
+	record_sample(stats, MSGQUEUE_STATS_HIST_WAIT, wait_cycles);
+	record_sample(stats, MSGQUEUE_STATS_HIST_EXEC, exec_cycles);
+
+	k_spin_unlock(&stats_lock, key);
+}
+
+bool msgqueue_stats_get(uint32_t msg_code, struct msgqueue_stats *stats)
+{
+	bool found = false;
+
+	memset(stats, 0, sizeof(*stats));
+
+	if (msg_code >= CONFIG_TT_BH_ARC_NUM_MSG_CODES) {
+		return false;
+	}
+
+	K_SPINLOCK(&stats_lock) {
+		if (stats_slot_map[msg_code] != 0) {
+			*stats = stats_slots[stats_slot_map[msg_code] - 1];
+			found = true;
+		}
+	}
+
+	return found;
+}
+
+uint32_t msgqueue_stats_dropped(void)
+{
+	return stats_dropped;
+}
+
+uint32_t msgqueue_stats_elapsed_ms(void)
+{
+	return (uint32_t)(k_uptime_get() - stats_start_ms);
+}
+
+void msgqueue_stats_clear(void)
+{
+	K_SPINLOCK(&stats_lock) {
+		memset(stats_slots, 0, sizeof(stats_slots));
+		memset(stats_slot_map, 0, sizeof(stats_slot_map));
+		stats_slots_used = 0;
+		stats_dropped = 0;
+		stats_start_ms = k_uptime_get();
+	}
+}
+
+static uint32_t mean_cycles(const struct msgqueue_stats *stats, enum msgqueue_stats_hist hist)
+{
+	if (stats->count == 0) {
+		return 0;
+	}
+
+	return (uint32_t)(stats->total_cycles[hist] / stats->count);
+}
+
+/**
+ * @brief Handler for @ref TT_SMC_MSG_GET_MSGQUEUE_STATS
+ * @see msgqueue_stats_rqst
+ */
+static uint8_t msgqueue_stats_handler(const union request *request, struct response *response)
+{
+	const struct msgqueue_stats_rqst *rqst = &request->msgqueue_stats;
+	struct msgqueue_stats stats;
+
+	if (rqst->bucket_offset >= MSGQUEUE_STATS_NUM_BUCKETS) {
+		return 1;
+	}
+
+	msgqueue_stats_get(rqst->msg_code, &stats);
+
+	switch (rqst->select) {
+	case MSGQUEUE_STATS_SELECT_SUMMARY:
+		response->data[1] = stats.count;
+		response->data[2] = stats.max_cycles[MSGQUEUE_STATS_HIST_WAIT];
+		response->data[3] = stats.max_cycles[MSGQUEUE_STATS_HIST_EXEC];
+		response->data[4] = mean_cycles(&stats, MSGQUEUE_STATS_HIST_WAIT);
+		response->data[5] = mean_cycles(&stats, MSGQUEUE_STATS_HIST_EXEC);
+		response->data[6] = msgqueue_stats_elapsed_ms();
+		response->data[7] = sys_clock_hw_cycles_per_sec() / 1000;
+		break;
+	case MSGQUEUE_STATS_SELECT_WAIT_HIST:
+	case MSGQUEUE_STATS_SELECT_EXEC_HIST: {
+		enum msgqueue_stats_hist hist = rqst->select == MSGQUEUE_STATS_SELECT_WAIT_HIST
+							? MSGQUEUE_STATS_HIST_WAIT
+							: MSGQUEUE_STATS_HIST_EXEC;
+		unsigned int n = MIN(RESPONSE_HIST_WORDS,
+				     MSGQUEUE_STATS_NUM_BUCKETS - rqst->bucket_offset);
+
+		for (unsigned int i = 0; i < n; i++) {
+			response->data[1 + i] = stats.hist[hist][rqst->bucket_offset + i];
+		}
+		break;
+	}
+	default:
+		return 1;
+	}
+
+	if (rqst->flags & MSGQUEUE_STATS_FLAG_CLEAR) {
+		msgqueue_stats_clear();
+	}
+
+	return 0;
+}
+
+REGISTER_MESSAGE(TT_SMC_MSG_GET_MSGQUEUE_STATS, msgqueue_stats_handler);
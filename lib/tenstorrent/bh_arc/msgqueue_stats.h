@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef MSGQUEUE_STATS_H
+#define MSGQUEUE_STATS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Histogram buckets are log2-spaced in cycles. Bucket 0 holds samples below
+ * 2^MSGQUEUE_STATS_BUCKET_SHIFT cycles, bucket i holds [2^(SHIFT + i - 1), 2^(SHIFT + i)) and
+ * the last bucket holds everything above.
+ */
+#define MSGQUEUE_STATS_BUCKET_SHIFT 6
+#define MSGQUEUE_STATS_NUM_BUCKETS  24
+
+enum msgqueue_stats_hist {
+	MSGQUEUE_STATS_HIST_WAIT,
+	MSGQUEUE_STATS_HIST_EXEC,
+	MSGQUEUE_STATS_HIST_COUNT,
+};
+
+struct msgqueue_stats {
+	uint32_t count;
+	uint32_t max_cycles[MSGQUEUE_STATS_HIST_COUNT];
+	uint64_t total_cycles[MSGQUEUE_STATS_HIST_COUNT];
+	uint32_t hist[MSGQUEUE_STATS_HIST_COUNT][MSGQUEUE_STATS_NUM_BUCKETS];
+};
+
+unsigned int msgqueue_stats_bucket(uint32_t cycles);
+
+#ifdef CONFIG_TT_BH_ARC_MSGQUEUE_STATS
+void msgqueue_stats_record(uint32_t msg_code, uint32_t wait_cycles, uint32_t exec_cycles);
+bool msgqueue_stats_get(uint32_t msg_code, struct msgqueue_stats *stats);
+uint32_t msgqueue_stats_dropped(void);
+uint32_t msgqueue_stats_elapsed_ms(void);
+void msgqueue_stats_clear(void);
+#else
+static inline void msgqueue_stats_record(uint32_t msg_code, uint32_t wait_cycles,
+					 uint32_t exec_cycles)
+{
+}
+
+static inline bool msgqueue_stats_get(uint32_t msg_code, struct msgqueue_stats *stats)
+{
+	return false;
+}
+
+static inline uint32_t msgqueue_stats_dropped(void)
+{
+	return 0;
+}
+
+static inline uint32_t msgqueue_stats_elapsed_ms(void)
+{
+	return 0;
+}
+
+static inline void msgqueue_stats_clear(void)
+{
+}
+#endif
+
+#endif
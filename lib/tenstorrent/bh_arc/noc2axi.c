@@ -90,6 +90,24 @@ static inline void WriteTlbSetup(const uint8_t ring, const uint8_t tlb_num, NOC2
 	noc2axi_tlb[tlb_num + NOC2AXI_NUM_TLB_PER_RING * 3] = tlb3.val;
 }
 
+/* Decode the current setup of a TLB, e.g. to find where a write to its window lands */
+void NOC2AXIReadTlbSetup(const uint8_t ring, const uint8_t tlb_num, Noc2AxiTlbSetup *setup)
+{
+	uint32_t volatile *noc2axi_tlb = GetTlbRegStartAddr(ring);
+	NOC2AXITlb0RegU tlb0 = {.val = noc2axi_tlb[tlb_num * 2]};
+	NOC2AXITlb1RegU tlb1 = {.val = noc2axi_tlb[tlb_num * 2 + 1]};
+	NOC2AXITlb2RegU tlb2 = {.val = noc2axi_tlb[tlb_num + NOC2AXI_NUM_TLB_PER_RING * 2]};
+
+	setup->addr = ((uint64_t)tlb1.f.middle_addr_bits << 32) |
+		      ((uint64_t)tlb0.f.lower_addr_bits << NOC_TLB_LOG_SIZE);
+	setup->x_start = tlb2.f.x_start;
+	setup->y_start = tlb2.f.y_start;
+	setup->x_end = tlb2.f.x_end;
+	setup->y_end = tlb2.f.y_end;
+	setup->multicast = tlb2.f.multicast_en;
+	setup->ordering = tlb2.f.ordering_mode;
+}
+
 void NOC2AXITlbSetup(const uint8_t ring, const uint8_t tlb_num, const uint8_t x, const uint8_t y,
 		     const uint64_t addr)
 {
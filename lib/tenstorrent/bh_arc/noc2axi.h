@@ -6,6 +6,7 @@
 #ifndef NOC2AXI_H
 #define NOC2AXI_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <zephyr/sys/util.h>
 #include "reg.h"
@@ -23,6 +24,16 @@ typedef enum {
 	kNoc2AxiOrderingPostedStrict = 3,
 } Noc2AxiOrdering;
 
+typedef struct {
+	uint64_t addr; /* Base of the window, aligned to the window size */
+	uint8_t x_start;
+	uint8_t y_start;
+	uint8_t x_end;
+	uint8_t y_end;
+	bool multicast;
+	Noc2AxiOrdering ordering;
+} Noc2AxiTlbSetup;
+
 void NOC2AXITlbSetup(const uint8_t ring, const uint8_t tlb_num, const uint8_t x, const uint8_t y,
 		     const uint64_t addr);
 void NOC2AXIMulticastTlbSetup(const uint8_t ring, const uint8_t tlb_num, const uint8_t x_start,
@@ -30,6 +41,7 @@ void NOC2AXIMulticastTlbSetup(const uint8_t ring, const uint8_t tlb_num, const u
 			      const uint64_t addr, Noc2AxiOrdering ordering);
 void NOC2AXITensixBroadcastTlbSetup(const uint8_t ring, const uint8_t tlb_num, const uint64_t addr,
 				    Noc2AxiOrdering ordering);
+void NOC2AXIReadTlbSetup(const uint8_t ring, const uint8_t tlb_num, Noc2AxiTlbSetup *setup);
 
 static inline void volatile *GetTlbWindowAddr(const uint8_t noc_id, const uint8_t tlb_entry,
 					      const uint64_t addr)
@@ -10,6 +10,7 @@
 #include <tenstorrent/msgqueue.h>
 
 #include "pcie.h"
+#include "pcie_msi.h"
 
 #define BH_PCIE_DWC_PCIE_USP_PF0_MSI_CAP_PCI_MSI_CAP_ID_NEXT_CTRL_REG_REG_ADDR 0x00000050
 #define BH_PCIE_DWC_PCIE_USP_PF0_MSI_CAP_MSI_CAP_OFF_04H_REG_REG_ADDR          0x00000054
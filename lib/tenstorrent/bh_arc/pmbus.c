@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "pmbus.h"
+
+#include <string.h>
+#include <zephyr/kernel.h>
+
+#include "dw_apb_i2c.h"
+
+/* Protected by I2CLock(PMBUS_MST_ID) */
+static struct pmbus_stats stats;
+
+static void select_target(uint8_t addr)
+{
+	if (I2CSelectTarget(PMBUS_MST_ID, addr, I2CFastMode)) {
+		stats.target_switches++;
+	}
+}
+
+/**
+ * @brief Read a PMBus command, reinitializing the controller only when switching targets
+ *
+ * @return The TX_ABRT source, 0 on success
+ */
+uint32_t PMBusRead(uint8_t addr, uint8_t cmd, uint8_t *data, uint32_t size)
+{
+	I2CLock(PMBUS_MST_ID);
+	select_target(addr);
+	stats.transactions++;
+	uint32_t ic_error = I2CReadBytes(PMBUS_MST_ID, cmd, PMBUS_CMD_BYTE_SIZE, data, size, 0);
+
+	I2CUnlock(PMBUS_MST_ID);
+
+	return ic_error;
+}
+
+/**
+ * @brief Write a PMBus command, reinitializing the controller only when switching targets
+ *
+ * @return The TX_ABRT source, 0 on success
+ */
+uint32_t PMBusWrite(uint8_t addr, uint8_t cmd, const uint8_t *data, uint32_t size)
+{
+	I2CLock(PMBUS_MST_ID);
+	select_target(addr);
+	stats.transactions++;
+	uint32_t ic_error = I2CWriteBytes(PMBUS_MST_ID, cmd, PMBUS_CMD_BYTE_SIZE, data, size);
+
+	I2CUnlock(PMBUS_MST_ID);
+
+	return ic_error;
+}
+
+/* Whether a sensor is expected to be asked for before the next sweep, which is due in horizon
+ * ms. Sensors that have not been asked for in two of their periods are no longer polled.
+ */
+static bool sensor_due(const struct pmbus_sensor *sensor, int64_t now, int64_t horizon)
+{
+	int64_t next = sensor->used + sensor->period;
+
+	return sensor->period > 0 && next < now + horizon &&
+	       now - sensor->used < 2 * sensor->period;
+}
+
+static void sweep(struct pmbus_regulator *reg, uint32_t requested, int64_t now)
+{
+	int64_t horizon = reg->sensors[requested].period;
+
+	select_target(reg->addr);
+	stats.sweeps++;
+
+	for (uint32_t i = 0; i < reg->num_sensors; i++) {
+		struct pmbus_sensor *sensor = &reg->sensors[i];
+		uint16_t raw = 0;
+
+		if (i != requested && ((sensor->valid && sensor->updated == now) ||
+				       !sensor_due(sensor, now, horizon))) {
+			continue;
+		}
+
+		stats.transactions++;
+		if (I2CReadBytes(PMBUS_MST_ID, sensor->cmd, PMBUS_CMD_BYTE_SIZE, (uint8_t *)&raw,
+				 sensor->size, 0) == 0) {
+			sensor->raw = raw;
+			sensor->updated = now;
+			sensor->valid = true;
+		} else {
+			/* Keep the last value, but read again next time */
+			sensor->valid = false;
+		}
+	}
+}
+
+/**
+ * @brief Read a regulator sensor, using the cached value if it is recent enough
+ *
+ * A stale sensor is read together with the other sensors of the same regulator that are expected
+ * to be asked for before the next read, judging by how often each of them has been asked for.
+ * The periodic readers of a regulator, e.g. DVFS and telemetry, then share one pass over the bus
+ * instead of each selecting the target.
+ *
+ * @param reg The regulator
+ * @param sensor Index of the sensor in reg->sensors
+ * @param max_staleness Maximum age of the value in milliseconds, 0 to always read the bus
+ * @return The raw value of the PMBus command
+ */
+uint16_t PMBusReadSensor(struct pmbus_regulator *reg, uint32_t sensor, int64_t max_staleness)
+{
+	struct pmbus_sensor *s = &reg->sensors[sensor];
+	int64_t now = k_uptime_get();
+
+	I2CLock(PMBUS_MST_ID);
+
+	if (s->used != 0 && now > s->used) {
+		s->period = now - s->used;
+	}
+	s->used = now;
+
+	if (!s->valid || now - s->updated >= max_staleness) {
+		sweep(reg, sensor, now);
+	}
+
+	uint16_t raw = s->raw;
+
+	I2CUnlock(PMBUS_MST_ID);
+
+	return raw;
+}
+
+/* Drop the cached values of a regulator, e.g. after changing its output */
+void PMBusInvalidate(struct pmbus_regulator *reg)
+{
+	I2CLock(PMBUS_MST_ID);
+	for (uint32_t i = 0; i < reg->num_sensors; i++) {
+		reg->sensors[i].valid = false;
+	}
+	I2CUnlock(PMBUS_MST_ID);
+}
+
+void PMBusGetStats(struct pmbus_stats *out)
+{
+	I2CLock(PMBUS_MST_ID);
+	*out = stats;
+	I2CUnlock(PMBUS_MST_ID);
+}
+
+void PMBusResetStats(void)
+{
+	I2CLock(PMBUS_MST_ID);
+	memset(&stats, 0, sizeof(stats));
+	I2CUnlock(PMBUS_MST_ID);
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef PMBUS_H
+#define PMBUS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PMBUS_MST_ID        1
+#define PMBUS_CMD_BYTE_SIZE 1
+
+/* A value read periodically from a regulator, e.g. READ_VOUT */
+struct pmbus_sensor {
+	uint8_t cmd;
+	uint8_t size; /* data bytes, at most 2 */
+	bool valid;
+	uint16_t raw;
+	int64_t updated; /* uptime in ms of the last successful read */
+	int64_t used;    /* uptime in ms when the value was last asked for, 0 if never */
+	int64_t period;  /* ms between the last two requests, 0 if unknown */
+};
+
+/* A regulator and the sensors that are refreshed together in one pass over the bus */
+struct pmbus_regulator {
+	uint8_t addr;
+	uint8_t num_sensors;
+	struct pmbus_sensor *sensors;
+};
+
+#define PMBUS_SENSOR(_cmd, _size) {.cmd = (_cmd), .size = (_size)}
+
+struct pmbus_stats {
+	uint32_t transactions;
+	uint32_t target_switches;
+	uint32_t sweeps;
+};
+
+uint32_t PMBusRead(uint8_t addr, uint8_t cmd, uint8_t *data, uint32_t size);
+uint32_t PMBusWrite(uint8_t addr, uint8_t cmd, const uint8_t *data, uint32_t size);
+uint16_t PMBusReadSensor(struct pmbus_regulator *reg, uint32_t sensor, int64_t max_staleness);
+void PMBusInvalidate(struct pmbus_regulator *reg);
+void PMBusGetStats(struct pmbus_stats *stats);
+void PMBusResetStats(void);
+
+#endif
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "power_model.h"
+
+#include <math.h>
+
+#include <zephyr/sys/util.h>
+
+#include "aiclk_ppm.h"
+#include "vf_curve.h"
+
+/*
+ * Predicts the board input power at a given AICLK, so that the Doppler throttler can cap AICLK
+ * before a burst of activity takes the input power over the limit, rather than after it has.
+ *
+ * Vcore power is modelled as C * f * V^2 + leakage(V, T). The effective switched capacitance C
+ * stands for the recent activity: it is measured from the Vcore power on every iteration and
+ * held at its recent peak, so that a workload that has been bursting is expected to burst
+ * again. Input power is modelled as a * Vcore power + b, where a (the inverse of the regulator
+ * efficiency) and b (the rest of the board) are fitted online by recursive least squares.
+ *
+ * Only the board side is fitted because a change of activity and a change of AICLK can't be
+ * told apart from the input power alone, a fit over both drifts without bound.
+ */
+
+/* Estimates, not yet measured on silicon, see TT_BH_ARC_DOPPLER_PREDICT */
+#define kLeakage25C       15.0F  /* W at 0.8 V and 25 degC, typical part */
+#define kLeakageTempCoeff 0.02F  /* 1/degC */
+#define kActivityDecay    0.999F /* per iteration, ~1 s time constant at 1 ms */
+#define kForgettingFactor 0.995F /* ~200 iterations of memory */
+
+/* Priors for the fit: 90% regulator efficiency and 40 W for the rest of the board */
+#define kPriorGain        1.1F
+#define kPriorOffset      40.0F
+#define kPriorGainVar     1.0F
+#define kPriorOffsetVar   1000.0F
+
+static struct {
+	float theta[2];  /* a, b */
+	float cov[2][2]; /* covariance of theta */
+	float activity;  /* W/(GHz V^2) */
+} model = {
+	.theta = {kPriorGain, kPriorOffset},
+	.cov = {{kPriorGainVar, 0}, {0, kPriorOffsetVar}},
+};
+
+static void reset_covariance(void)
+{
+	model.cov[0][0] = kPriorGainVar;
+	model.cov[0][1] = 0;
+	model.cov[1][0] = 0;
+	model.cov[1][1] = kPriorOffsetVar;
+}
+
+void power_model_reset(void)
+{
+	model.theta[0] = kPriorGain;
+	model.theta[1] = kPriorOffset;
+	model.activity = 0;
+	reset_covariance();
+}
+
+static float leakage_temp_factor(float temperature)
+{
+	return expf(kLeakageTempCoeff * (temperature - 25.0F));
+}
+
+static float vcore_power_model(float aiclk, float voltage, float activity, float temp_factor)
+{
+	return activity * aiclk / 1000.0F * voltage * voltage +
+	       kLeakage25C * voltage / 0.8F * temp_factor;
+}
+
+/**
+ * @brief Fit the model to the measurements of one DVFS iteration
+ *
+ * @param aiclk AICLK the measurements were taken at in MHz
+ * @param vcore_voltage Vcore in mV
+ * @param temperature ASIC temperature in degC
+ * @param vcore_power Vcore power in W
+ * @param input_power Board input power in W
+ */
+void power_model_update(float aiclk, float vcore_voltage, float temperature, float vcore_power,
+			float input_power)
+{
+	float voltage = vcore_voltage / 1000.0F;
+
+	if (aiclk <= 0 || voltage <= 0) {
+		return;
+	}
+
+	/* Recent activity, with the leakage taken out of the measured Vcore power */
+	float leakage = vcore_power_model(aiclk, voltage, 0, leakage_temp_factor(temperature));
+	float activity = MAX(0.0F, (vcore_power - leakage) / (aiclk / 1000.0F * voltage * voltage));
+
+	model.activity = MAX(activity, model.activity * kActivityDecay);
+
+	/* Recursive least squares of input_power = a * vcore_power + b */
+	const float x[2] = {vcore_power, 1.0F};
+	float px[2];
+	float denom = kForgettingFactor;
+	float error = input_power;
+
+	for (int i = 0; i < 2; i++) {
+		px[i] = model.cov[i][0] * x[0] + model.cov[i][1] * x[1];
+		denom += x[i] * px[i];
+		error -= x[i] * model.theta[i];
+	}
+
+	for (int i = 0; i < 2; i++) {
+		model.theta[i] += px[i] / denom * error;
+	}
+
+	/* Updated symmetrically, single precision loses positive definiteness otherwise */
+	for (int i = 0; i < 2; i++) {
+		for (int j = i; j < 2; j++) {
+			float cov = model.cov[i][j] - px[i] * px[j] / denom;
+
+			model.cov[i][j] = cov / kForgettingFactor;
+			model.cov[j][i] = model.cov[i][j];
+		}
+	}
+
+	if (!isfinite(model.theta[0]) || !isfinite(model.theta[1])) {
+		power_model_reset();
+	} else if (!(model.cov[0][0] > 0 && model.cov[0][0] <= kPriorGainVar * 100 &&
+		     model.cov[1][1] > 0 && model.cov[1][1] <= kPriorOffsetVar * 100)) {
+		/* Vcore power has been flat for long enough that forgetting winds the covariance
+		 * up, or rounding has broken it. Fall back to the prior confidence.
+		 */
+		reset_covariance();
+	}
+}
+
+static float predict(uint32_t aiclk, float temp_factor)
+{
+	float voltage = VFCurve(aiclk) / 1000.0F;
+	float vcore_power = vcore_power_model(aiclk, voltage, model.activity, temp_factor);
+
+	return model.theta[0] * vcore_power + model.theta[1];
+}
+
+/**
+ * @brief Predict the input power in W at the recent peak activity
+ *
+ * @param aiclk AICLK in MHz, the voltage is taken from the VF curve
+ * @param temperature ASIC temperature in degC
+ */
+float power_model_predict(uint32_t aiclk, float temperature)
+{
+	return predict(aiclk, leakage_temp_factor(temperature));
+}
+
+/**
+ * @brief Highest AICLK in MHz at which the predicted input power stays within a limit
+ *
+ * Returns fmin if even fmin is predicted to be over the limit.
+ */
+uint32_t power_model_max_aiclk(float input_power_limit, float temperature)
+{
+	float temp_factor = leakage_temp_factor(temperature);
+	uint32_t lo = GetAiclkFmin();
+	uint32_t hi = GetAiclkFmax();
+
+	if (predict(hi, temp_factor) <= input_power_limit) {
+		return hi;
+	}
+
+	/* Predicted power increases with AICLK, lo is within the limit and hi is over it */
+	while (hi - lo > 1) {
+		uint32_t mid = lo + (hi - lo) / 2;
+
+		if (predict(mid, temp_factor) <= input_power_limit) {
+			lo = mid;
+		} else {
+			hi = mid;
+		}
+	}
+
+	return lo;
+}
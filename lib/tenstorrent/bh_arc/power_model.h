@@ -0,0 +1,17 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef POWER_MODEL_H
+#define POWER_MODEL_H
+
+#include <stdint.h>
+
+void power_model_reset(void);
+void power_model_update(float aiclk, float vcore_voltage, float temperature, float vcore_power,
+			float input_power);
+float power_model_predict(uint32_t aiclk, float temperature);
+uint32_t power_model_max_aiclk(float input_power_limit, float temperature);
+
+#endif
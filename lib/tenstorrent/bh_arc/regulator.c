@@ -6,6 +6,7 @@
 
 #include "avs.h"
 #include "dw_apb_i2c.h"
+#include "pmbus.h"
 #include "regulator.h"
 #include "regulator_config.h"
 #include "status_reg.h"
@@ -27,9 +28,6 @@
 #define LINEAR_FORMAT_CONSTANT (1 << 9)
 #define SCALE_LOOP             0.335f
 
-/* I2C constants */
-#define PMBUS_MST_ID 1
-
 /* PMBus Spec constants */
 #define MFR_CTRL_OPS                   0xD2
 #define MFR_CTRL_OPS_DATA_BYTE_SIZE    1
@@ -45,7 +43,6 @@
 #define READ_POUT_DATA_BYTE_SIZE       2
 #define OPERATION                      0x1
 #define OPERATION_DATA_BYTE_SIZE       1
-#define PMBUS_CMD_BYTE_SIZE            1
 #define PMBUS_FLIP_BYTES               0
 
 /* VR feedback resistors */
@@ -56,6 +53,9 @@
 #define SCRAPPY_GDDR_VDDR_FB1 1.07
 #define SCRAPPY_GDDR_VDDR_FB2 3.48
 
+/* The control loop runs every 1 ms, readers within the same iteration share one bus read */
+#define SENSOR_MAX_STALENESS_MS 1
+
 struct OperationBits {
 	uint8_t reserved: 1;
 	uint8_t transition_control: 1;
@@ -83,36 +83,54 @@ static float ConvertLinear11ToFloat(uint16_t value)
 	return ldexp(mantissa, exponent);
 }
 
+enum {
+	VcoreVout,
+	VcoreIout,
+	VcorePout,
+};
+
+static struct pmbus_sensor vcore_sensors[] = {
+	[VcoreVout] = PMBUS_SENSOR(READ_VOUT, READ_VOUT_DATA_BYTE_SIZE),
+	[VcoreIout] = PMBUS_SENSOR(READ_IOUT, READ_IOUT_DATA_BYTE_SIZE),
+	[VcorePout] = PMBUS_SENSOR(READ_POUT, READ_POUT_DATA_BYTE_SIZE),
+};
+
+static struct pmbus_regulator vcore_regulator = {
+	.addr = P0V8_VCORE_ADDR,
+	.num_sensors = ARRAY_SIZE(vcore_sensors),
+	.sensors = vcore_sensors,
+};
+
+static struct pmbus_sensor vcorem_sensors[] = {
+	PMBUS_SENSOR(READ_VOUT, READ_VOUT_DATA_BYTE_SIZE),
+};
+
+static struct pmbus_regulator vcorem_regulator = {
+	.addr = P0V8_VCOREM_ADDR,
+	.num_sensors = ARRAY_SIZE(vcorem_sensors),
+	.sensors = vcorem_sensors,
+};
+
 /* The function returns the core current in A. */
 float GetVcoreCurrent(void)
 {
-	I2CInit(I2CMst, P0V8_VCORE_ADDR, I2CFastMode, PMBUS_MST_ID);
-	uint16_t iout;
-
-	I2CReadBytes(PMBUS_MST_ID, READ_IOUT, PMBUS_CMD_BYTE_SIZE, (uint8_t *)&iout,
-		     READ_IOUT_DATA_BYTE_SIZE, PMBUS_FLIP_BYTES);
-	return ConvertLinear11ToFloat(iout);
+	return ConvertLinear11ToFloat(
+		PMBusReadSensor(&vcore_regulator, VcoreIout, SENSOR_MAX_STALENESS_MS));
 }
 
 /* The function returns the core power in W. */
 float GetVcorePower(void)
 {
-	I2CInit(I2CMst, P0V8_VCORE_ADDR, I2CFastMode, PMBUS_MST_ID);
-	uint16_t pout;
-
-	I2CReadBytes(PMBUS_MST_ID, READ_POUT, PMBUS_CMD_BYTE_SIZE, (uint8_t *)&pout,
-		     READ_POUT_DATA_BYTE_SIZE, PMBUS_FLIP_BYTES);
-	return ConvertLinear11ToFloat(pout);
+	return ConvertLinear11ToFloat(
+		PMBusReadSensor(&vcore_regulator, VcorePout, SENSOR_MAX_STALENESS_MS));
 }
 
 static void set_max20730(uint32_t slave_addr, uint32_t voltage_in_mv, float rfb1, float rfb2)
 {
-	I2CInit(I2CMst, slave_addr, I2CFastMode, PMBUS_MST_ID);
 	float vref = voltage_in_mv / (1 + rfb1 / rfb2);
 	uint16_t vout_cmd = vref * LINEAR_FORMAT_CONSTANT * 0.001f;
 
-	I2CWriteBytes(PMBUS_MST_ID, VOUT_COMMAND, PMBUS_CMD_BYTE_SIZE, (uint8_t *)&vout_cmd,
-		      VOUT_COMMAND_DATA_BYTE_SIZE);
+	PMBusWrite(slave_addr, VOUT_COMMAND, (uint8_t *)&vout_cmd, VOUT_COMMAND_DATA_BYTE_SIZE);
 
 	/* delay to flush i2c transaction and voltage change */
 	WaitUs(250);
@@ -120,65 +138,58 @@ static void set_max20730(uint32_t slave_addr, uint32_t voltage_in_mv, float rfb1
 
 static void set_mpm3695(uint32_t slave_addr, uint32_t voltage_in_mv, float rfb1, float rfb2)
 {
-	I2CInit(I2CMst, slave_addr, I2CFastMode, PMBUS_MST_ID);
 	uint16_t vout_cmd = voltage_in_mv * 0.5f / SCALE_LOOP / (1 + rfb1 / rfb2);
 
-	I2CWriteBytes(PMBUS_MST_ID, VOUT_COMMAND, PMBUS_CMD_BYTE_SIZE, (uint8_t *)&vout_cmd,
-		      VOUT_COMMAND_DATA_BYTE_SIZE);
+	PMBusWrite(slave_addr, VOUT_COMMAND, (uint8_t *)&vout_cmd, VOUT_COMMAND_DATA_BYTE_SIZE);
 
 	/* delay to flush i2c transaction and voltage change */
 	WaitUs(250);
 }
 
 /* Set MAX20816 voltage using I2C, MAX20816 is used for Vcore and Vcorem */
-static void i2c_set_max20816(uint32_t slave_addr, uint32_t voltage_in_mv)
+static void i2c_set_max20816(struct pmbus_regulator *reg, uint32_t voltage_in_mv)
 {
-	I2CInit(I2CMst, slave_addr, I2CFastMode, PMBUS_MST_ID);
 	uint16_t vout_cmd = 2 * voltage_in_mv;
 
-	I2CWriteBytes(PMBUS_MST_ID, VOUT_COMMAND, PMBUS_CMD_BYTE_SIZE, (uint8_t *)&vout_cmd,
-		      VOUT_COMMAND_DATA_BYTE_SIZE);
+	PMBusWrite(reg->addr, VOUT_COMMAND, (uint8_t *)&vout_cmd, VOUT_COMMAND_DATA_BYTE_SIZE);
 
 	/* 100us to flush the tx of i2c + 150us to cover voltage switch from 0.65V to 0.95V with
-	 * 50us of margin
+	 * 50us of margin. The bus is free meanwhile, readings taken during the switch are dropped
+	 * below.
 	 */
 	WaitUs(250);
+	PMBusInvalidate(reg);
 }
 
 /* Returns MAX20816 output volage in mV. */
-static float i2c_get_max20816(uint32_t slave_addr)
+static float i2c_get_max20816(struct pmbus_regulator *reg)
 {
-	I2CInit(I2CMst, slave_addr, I2CFastMode, PMBUS_MST_ID);
-	uint16_t vout_cmd = 0;
-
-	I2CReadBytes(PMBUS_MST_ID, READ_VOUT, PMBUS_CMD_BYTE_SIZE, (uint8_t *)&vout_cmd,
-		     READ_VOUT_DATA_BYTE_SIZE, PMBUS_FLIP_BYTES);
-
-	return vout_cmd * 0.5f;
+	return PMBusReadSensor(reg, 0, SENSOR_MAX_STALENESS_MS) * 0.5f;
 }
 
 void set_vcore(uint32_t voltage_in_mv)
 {
 	if (vout_cmd_source == AVSVoutCommand) {
 		AVSWriteVoltage(voltage_in_mv, AVS_VCORE_RAIL);
+		PMBusInvalidate(&vcore_regulator);
 	} else {
-		i2c_set_max20816(P0V8_VCORE_ADDR, voltage_in_mv);
+		i2c_set_max20816(&vcore_regulator, voltage_in_mv);
 	}
 }
 
 uint32_t get_vcore(void)
 {
-	return i2c_get_max20816(P0V8_VCORE_ADDR);
+	return i2c_get_max20816(&vcore_regulator);
 }
 
 void set_vcorem(uint32_t voltage_in_mv)
 {
-	i2c_set_max20816(P0V8_VCOREM_ADDR, voltage_in_mv);
+	i2c_set_max20816(&vcorem_regulator, voltage_in_mv);
 }
 
 uint32_t get_vcorem(void)
 {
-	return i2c_get_max20816(P0V8_VCOREM_ADDR);
+	return i2c_get_max20816(&vcorem_regulator);
 }
 
 /* Set GDDR VDDR voltage for corner parts before DRAM training */
@@ -196,7 +207,8 @@ void set_gddr_vddr(PcbType board_type, uint32_t voltage_in_mv)
 
 void SwitchVoutControl(enum VoltageCmdSource source)
 {
-	I2CInit(I2CMst, P0V8_VCORE_ADDR, I2CFastMode, PMBUS_MST_ID);
+	I2CLock(PMBUS_MST_ID);
+	I2CSelectTarget(PMBUS_MST_ID, P0V8_VCORE_ADDR, I2CFastMode);
 	struct OperationBits operation;
 
 	I2CReadBytes(PMBUS_MST_ID, OPERATION, PMBUS_CMD_BYTE_SIZE, (uint8_t *)&operation,
@@ -206,6 +218,7 @@ void SwitchVoutControl(enum VoltageCmdSource source)
 	operation.voltage_command_source = source;
 	I2CWriteBytes(PMBUS_MST_ID, OPERATION, PMBUS_CMD_BYTE_SIZE, (uint8_t *)&operation,
 		      OPERATION_DATA_BYTE_SIZE);
+	I2CUnlock(PMBUS_MST_ID);
 
 	/* 100us to flush the tx of i2c */
 	WaitUs(100);
@@ -240,7 +253,8 @@ uint32_t RegulatorInit(PcbType board_type)
 			const struct regulator_config *regulator_config =
 				regulators_config->regulator_config + i;
 
-			I2CInit(I2CMst, regulator_config->address, I2CFastMode, PMBUS_MST_ID);
+			I2CLock(PMBUS_MST_ID);
+			I2CSelectTarget(PMBUS_MST_ID, regulator_config->address, I2CFastMode);
 
 			for (uint32_t j = 0; j < regulator_config->count; j++) {
 				const struct regulator_data *regulator_data =
@@ -277,6 +291,8 @@ uint32_t RegulatorInit(PcbType board_type)
 					}
 				}
 			}
+
+			I2CUnlock(PMBUS_MST_ID);
 		}
 	}
 	return aggregate_i2c_errors;
@@ -128,6 +128,14 @@ static const struct SmbusCmdDef smbus_req_cmd_def = {
 static const struct SmbusCmdDef smbus_ack_cmd_def = {
 	.pec = 1U, .trans_type = kSmbusTransWriteWord, .rcv_handler = &Cm2DmMsgAckSmbusHandler};
 
+BUILD_ASSERT(2 + CMFW_SMBUS_CM2DM_WINDOW_SIZE * sizeof(cm2dmMessage) <=
+	     CONFIG_SMBUS_MAX_MSG_SIZE);
+static const struct SmbusCmdDef smbus_req_window_cmd_def = {
+	.pec = 1U,
+	.trans_type = kSmbusTransBlockWriteBlockRead,
+	.rcv_handler = &Cm2DmMsgWindowAckSmbusHandler,
+	.send_handler = &Cm2DmMsgWindowReqSmbusHandler};
+
 static const struct SmbusCmdDef smbus_update_arc_state_cmd_def = {
 	.pec = 0U, .trans_type = kSmbusTransBlockWrite, .rcv_handler = &UpdateArcStateHandler};
 
@@ -168,6 +176,14 @@ static const struct SmbusCmdDef smbus_telem_reg_cmd_def = {
 static const struct SmbusCmdDef smbus_telem_data_cmd_def = {
 	.pec = 1U, .trans_type = kSmbusTransBlockRead, .send_handler = &SMBusTelemDataHandler};
 
+BUILD_ASSERT(4 + CMFW_SMBUS_TELEMETRY_BULK_MAX_TAGS * sizeof(uint32_t) <=
+	     CONFIG_SMBUS_MAX_MSG_SIZE);
+static const struct SmbusCmdDef smbus_telem_bulk_read_cmd_def = {
+	.pec = 1U,
+	.trans_type = kSmbusTransBlockWriteBlockRead,
+	.rcv_handler = &SMBusTelemBulkRegHandler,
+	.send_handler = &SMBusTelemBulkDataHandler};
+
 static const struct SmbusCmdDef smbus_therm_trip_count_cmd_def = {
 	.pec = 1U,
 	.trans_type = kSmbusTransWriteWord,
@@ -177,6 +193,13 @@ static const struct SmbusCmdDef smbus_therm_trip_count_cmd_def = {
 static const struct SmbusCmdDef smbus_dmc_log_cmd_def = {
 	.pec = 1U, .trans_type = kSmbusTransBlockWrite, .rcv_handler = &Dm2CmDMCLogHandler};
 
+BUILD_ASSERT(4 + CMFW_SMBUS_DMC_LOG_CHUNK_SIZE <= 32);
+static const struct SmbusCmdDef smbus_dmc_log_bulk_cmd_def = {
+	.pec = 1U,
+	.trans_type = kSmbusTransBlockWriteBlockRead,
+	.rcv_handler = &Dm2CmDMCLogBulkHandler,
+	.send_handler = &Dm2CmDMCLogBulkReplyHandler};
+
 static const struct SmbusCmdDef smbus_test_read_byte_cmd_def = {
 	.pec = 1U, .trans_type = kSmbusTransReadByte, .send_handler = &ReadByteTest};
 
@@ -217,13 +240,17 @@ static int InitSmbusTarget(void)
 		return 0;
 	}
 
-	if (i2c_target_driver_register(smbus_target) < 0) {
+	/* The controller is only there on the ARC, elsewhere the target stays on the Zephyr bus */
+	if (IS_ENABLED(CONFIG_TT_BH_ARC_I2C_TARGET_IRQ) && IS_ENABLED(CONFIG_ARC)) {
+		I2CTargetRegister(CM_I2C_DM_TARGET_INST, smbus_target_get_config(smbus_target));
+	} else if (i2c_target_driver_register(smbus_target) < 0) {
 		printk("Failed to register i2c target driver\n");
 		return 0;
 	}
 
 	smbus_target_register_cmd(smbus_target, CMFW_SMBUS_REQ, &smbus_req_cmd_def);
 	smbus_target_register_cmd(smbus_target, CMFW_SMBUS_ACK, &smbus_ack_cmd_def);
+	smbus_target_register_cmd(smbus_target, CMFW_SMBUS_REQ_WINDOW, &smbus_req_window_cmd_def);
 	smbus_target_register_cmd(smbus_target, CMFW_SMBUS_UPDATE_ARC_STATE,
 				  &smbus_update_arc_state_cmd_def);
 	smbus_target_register_cmd(smbus_target, CMFW_SMBUS_DM_STATIC_INFO,
@@ -241,10 +268,14 @@ static int InitSmbusTarget(void)
 				  &smbus_power_instant_cmd_def);
 	smbus_target_register_cmd(smbus_target, 0x26, &smbus_telem_reg_cmd_def);
 	smbus_target_register_cmd(smbus_target, 0x27, &smbus_telem_data_cmd_def);
+	smbus_target_register_cmd(smbus_target, CMFW_SMBUS_TELEMETRY_BULK_READ,
+				  &smbus_telem_bulk_read_cmd_def);
 	smbus_target_register_cmd(smbus_target, CMFW_SMBUS_THERM_TRIP_COUNT,
 				  &smbus_therm_trip_count_cmd_def);
 #endif
 	smbus_target_register_cmd(smbus_target, CMFW_SMBUS_DMC_LOG, &smbus_dmc_log_cmd_def);
+	smbus_target_register_cmd(smbus_target, CMFW_SMBUS_DMC_LOG_BULK,
+				  &smbus_dmc_log_bulk_cmd_def);
 	smbus_target_register_cmd(smbus_target, CMFW_SMBUS_TEST_READ,
 				  &smbus_test_read_byte_cmd_def);
 	smbus_target_register_cmd(smbus_target, CMFW_SMBUS_TEST_WRITE,
@@ -267,6 +298,11 @@ SYS_INIT_APP(InitSmbusTarget);
 
 void PollSmbusTarget(void)
 {
+	if (IS_ENABLED(CONFIG_TT_BH_ARC_I2C_TARGET_IRQ) && IS_ENABLED(CONFIG_ARC)) {
+		/* Served from the controller interrupts */
+		return;
+	}
+
 	PollI2CSlave(CM_I2C_DM_TARGET_INST);
 	WriteReg(I2C0_TARGET_DEBUG_STATE_2_REG_ADDR, 0xfaca);
 }
@@ -7,6 +7,7 @@
 #include "reg.h"
 #include "status_reg.h"
 #include "util.h"
+#include "work_queue.h"
 
 #include <stdbool.h>
 #include <string.h>
@@ -38,6 +39,16 @@ static uint8_t spi_page_buf[SPI_BUFFER_SIZE];
 static uint8_t spi_global_buffer[SPI_BUFFER_SIZE];
 static struct flash_pages_info page_info;
 static bool flash_locked = true;
+/* Protects spi_page_buf between synchronous and deferred writes */
+static K_MUTEX_DEFINE(spi_write_lock);
+
+/* EEPROM write running in the background with its response deferred */
+static struct {
+	struct msgqueue_token token;
+	uint32_t spi_address;
+	const uint8_t *data;
+	uint32_t num_bytes;
+} eeprom_write;
 
 static const struct device *flash = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(spi_flash));
 
@@ -192,6 +203,32 @@ static uint8_t read_eeprom_handler(const union request *request, struct response
 	return SpiBlockRead(spi_address, num_bytes, csm_addr);
 }
 
+static int SpiLockedWrite(uint32_t address, const uint8_t *data, uint32_t num_bytes)
+{
+	int rc;
+
+	k_mutex_lock(&spi_write_lock, K_FOREVER);
+	rc = SpiSmartWrite(address, data, num_bytes);
+	k_mutex_unlock(&spi_write_lock);
+
+	return rc;
+}
+
+static void eeprom_write_work_handler(struct k_work *work)
+{
+	int rc = SpiLockedWrite(eeprom_write.spi_address, eeprom_write.data,
+				eeprom_write.num_bytes);
+
+	msgqueue_complete_response(eeprom_write.token, NULL, rc);
+}
+static K_WORK_DEFINE(eeprom_write_work, eeprom_write_work_handler);
+
+static void eeprom_write_cancel(struct msgqueue_token token, void *user_data)
+{
+	/* A write that has already started runs to completion; its response is dropped. */
+	k_work_cancel(&eeprom_write_work);
+}
+
 static uint8_t write_eeprom_handler(const union request *request, struct response *response)
 {
 	uint8_t buffer_mem_type = request->eeprom.buffer_mem_type;
@@ -218,7 +255,17 @@ static uint8_t write_eeprom_handler(const union request *request, struct respons
 		return 1;
 	}
 
-	return SpiSmartWrite(spi_address, csm_addr, num_bytes);
+	/* Sector erases take milliseconds, so write in the background when possible. */
+	if (k_work_busy_get(&eeprom_write_work) == 0 &&
+	    msgqueue_defer_response(&eeprom_write.token, eeprom_write_cancel, NULL) == 0) {
+		eeprom_write.spi_address = spi_address;
+		eeprom_write.data = csm_addr;
+		eeprom_write.num_bytes = num_bytes;
+		tt_work_submit(TT_WORK_QUEUE_FLASH, &eeprom_write_work);
+		return 0;
+	}
+
+	return SpiLockedWrite(spi_address, csm_addr, num_bytes);
 }
 
 /**
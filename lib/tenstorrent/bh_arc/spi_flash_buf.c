@@ -18,10 +18,43 @@ LOG_MODULE_REGISTER(spi_flash_buf, CONFIG_TT_APP_LOG_LEVEL);
 
 static const struct device *const arc_dma_dev = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(dma0));
 
-int spi_transfer_by_parts(const struct device *dev, size_t spi_address, size_t image_size,
-			  uint8_t *buf, size_t buf_size, uint8_t *tlb_dst,
-			  int (*cb)(const uint8_t *src, uint8_t *dst, size_t len))
+#ifdef CONFIG_TT_BH_ARC_DMA_PIPELINED
+/* The ARC DMA completes one transfer before the next is started, so two buffers keep it busy */
+#define ARC_DMA_NUM_BUFS 2
+#else
+#define ARC_DMA_NUM_BUFS 1
+#endif
+
+struct spi_flash_pipe_data {
+	const struct device *dev;
+	size_t spi_address;
+	uint8_t *dst;
+	int (*cb)(const uint8_t *src, uint8_t *dst, size_t len);
+};
+
+/**
+ * @brief Stream an image through a buffer from a producer to a consumer
+ *
+ * @p buf is split into @p num_bufs parts of equal size, rounded down to a multiple of 4 bytes.
+ * The consumer may have up to @p num_bufs - 1 transfers in flight while the producer fills the
+ * next part. A consumer without a wait callback moves each part out before the next is read, and
+ * the whole of @p buf is used for each part.
+ *
+ * @param pipe Producer and consumer
+ * @param image_size Size of the image in bytes
+ * @param buf Buffer for the parts of the image
+ * @param buf_size Size of @p buf in bytes
+ * @param num_bufs Number of parts @p buf is split into, at least 2 with a wait callback
+ *
+ * @return 0 on success, or the first error from @p pipe
+ */
+int spi_transfer_pipelined(const struct spi_transfer_pipe *pipe, size_t image_size, uint8_t *buf,
+			   size_t buf_size, size_t num_bufs)
 {
+	size_t part_size;
+	size_t in_flight = 0;
+	int rc = 0;
+
 	if ((buf == NULL) || (buf_size == 0)) {
 		return -EINVAL;
 	}
@@ -30,29 +63,120 @@ int spi_transfer_by_parts(const struct device *dev, size_t spi_address, size_t i
 		return -E2BIG;
 	}
 
-	int rc = 0;
+	if (pipe->wait == NULL) {
+		num_bufs = 1;
+	} else if (num_bufs < 2) {
+		return -EINVAL;
+	}
 
-	for (size_t offset = 0, len = MIN(buf_size, image_size); len > 0;
-	     image_size -= len, offset += len, len = MIN(buf_size, image_size)) {
+	part_size = (num_bufs == 1) ? buf_size : ROUND_DOWN(buf_size / num_bufs, sizeof(uint32_t));
+	if (part_size == 0) {
+		return -EINVAL;
+	}
 
-		rc = flash_read(dev, spi_address + offset, buf, len);
+	for (size_t offset = 0, i = 0, len = MIN(part_size, image_size); len > 0;
+	     offset += len, i++, len = MIN(part_size, image_size - offset)) {
+		uint8_t *part = buf + (i % num_bufs) * part_size;
+
+		/* None of the transfers in flight is out of this part */
+		rc = pipe->read(pipe->user_data, offset, part, len);
 		if (rc < 0) {
-			LOG_ERR("%s() failed: %d", "flash_read", rc);
 			break;
 		}
 
-		rc = cb(buf, tlb_dst + offset, len);
+		if ((in_flight > 0) && (in_flight == num_bufs - 1)) {
+			in_flight--;
+			rc = pipe->wait(pipe->user_data);
+			if (rc < 0) {
+				break;
+			}
+		}
+
+		rc = pipe->start(pipe->user_data, part, offset, len);
 		if (rc < 0) {
 			break;
 		}
+
+		if (pipe->wait != NULL) {
+			in_flight++;
+		}
 	}
+
+	/* Even after an error, the consumer mustn't be left reading from buf */
+	for (; in_flight > 0; in_flight--) {
+		int ret = pipe->wait(pipe->user_data);
+
+		if (rc >= 0) {
+			rc = ret;
+		}
+	}
+
 	return rc;
 }
 
-static int arc_dma_transfer_wrapper(const uint8_t *src, uint8_t *dst, size_t len)
+static int spi_flash_pipe_read(void *user_data, size_t offset, uint8_t *buf, size_t len)
 {
-	if (dma_arc_hs_transfer(arc_dma_dev, 0, src, dst, len, K_MSEC(500)) < 0) {
-		LOG_ERR("%s() failed: %d", "dma_arc_hs_transfer", -EIO);
+	struct spi_flash_pipe_data *data = user_data;
+	int rc = flash_read(data->dev, data->spi_address + offset, buf, len);
+
+	if (rc < 0) {
+		LOG_ERR("%s() failed: %d", "flash_read", rc);
+	}
+	return rc;
+}
+
+static int spi_flash_pipe_cb(void *user_data, const uint8_t *src, size_t offset, size_t len)
+{
+	struct spi_flash_pipe_data *data = user_data;
+
+	return data->cb(src, data->dst + offset, len);
+}
+
+int spi_transfer_by_parts(const struct device *dev, size_t spi_address, size_t image_size,
+			  uint8_t *buf, size_t buf_size, uint8_t *tlb_dst,
+			  int (*cb)(const uint8_t *src, uint8_t *dst, size_t len))
+{
+	struct spi_flash_pipe_data data = {
+		.dev = dev,
+		.spi_address = spi_address,
+		.dst = tlb_dst,
+		.cb = cb,
+	};
+	const struct spi_transfer_pipe pipe = {
+		.read = spi_flash_pipe_read,
+		.start = spi_flash_pipe_cb,
+		.user_data = &data,
+	};
+
+	return spi_transfer_pipelined(&pipe, image_size, buf, buf_size, 1);
+}
+
+static int arc_dma_pipe_start(void *user_data, const uint8_t *src, size_t offset, size_t len)
+{
+	struct spi_flash_pipe_data *data = user_data;
+	int rc;
+
+	if (IS_ENABLED(CONFIG_TT_BH_ARC_DMA_PIPELINED)) {
+		rc = dma_arc_hs_transfer_start(arc_dma_dev, 0, src, data->dst + offset, len);
+	} else {
+		rc = dma_arc_hs_transfer(arc_dma_dev, 0, src, data->dst + offset, len, K_MSEC(500));
+	}
+
+	if (rc < 0) {
+		LOG_ERR("%s() failed: %d", "dma_arc_hs_transfer", rc);
+		return -EIO;
+	}
+	return 0;
+}
+
+static int arc_dma_pipe_wait(void *user_data)
+{
+	ARG_UNUSED(user_data);
+
+	int rc = dma_arc_hs_transfer_wait(arc_dma_dev, 0, K_MSEC(500));
+
+	if (rc < 0) {
+		LOG_ERR("%s() failed: %d", "dma_arc_hs_transfer_wait", rc);
 		return -EIO;
 	}
 	return 0;
@@ -61,6 +185,17 @@ static int arc_dma_transfer_wrapper(const uint8_t *src, uint8_t *dst, size_t len
 int spi_arc_dma_transfer_to_tile(const struct device *dev, size_t spi_address, size_t image_size,
 				 uint8_t *buf, size_t buf_size, uint8_t *tlb_dst)
 {
-	return spi_transfer_by_parts(dev, spi_address, image_size, buf, buf_size, tlb_dst,
-				     arc_dma_transfer_wrapper);
+	struct spi_flash_pipe_data data = {
+		.dev = dev,
+		.spi_address = spi_address,
+		.dst = tlb_dst,
+	};
+	const struct spi_transfer_pipe pipe = {
+		.read = spi_flash_pipe_read,
+		.start = arc_dma_pipe_start,
+		.wait = IS_ENABLED(CONFIG_TT_BH_ARC_DMA_PIPELINED) ? arc_dma_pipe_wait : NULL,
+		.user_data = &data,
+	};
+
+	return spi_transfer_pipelined(&pipe, image_size, buf, buf_size, ARC_DMA_NUM_BUFS);
 }
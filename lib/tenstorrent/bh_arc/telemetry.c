@@ -7,6 +7,7 @@
 #include "aiclk_ppm.h"
 #include "cat.h"
 #include "cm2dm_msg.h"
+#include "dvfs_trace.h"
 #include "fan_ctrl.h"
 #include "functional_efuse.h"
 #include "harvesting.h"
@@ -14,9 +15,12 @@
 #include "regulator.h"
 #include "status_reg.h"
 #include "telemetry.h"
+#include "telemetry_events.h"
+#include "telemetry_history.h"
 #include "telemetry_internal.h"
 #include "gddr.h"
 #include "eth.h"
+#include "work_queue.h"
 
 #include <float.h> /* for FLT_MAX */
 #include <math.h>  /* for floor */
@@ -30,6 +34,15 @@
 #include <zephyr/devicetree.h>
 #include <zephyr/drivers/clock_control/clock_control_tt_bh.h>
 #include <zephyr/drivers/clock_control.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/barrier.h>
+
+#ifdef CONFIG_ZTEST
+#define STATIC
+#else
+#define STATIC static
+#endif
 
 LOG_MODULE_REGISTER(telemetry, CONFIG_TT_APP_LOG_LEVEL);
 
@@ -170,6 +183,16 @@ static struct telemetry_table telemetry_table = {
 		[63] = {TAG_ENABLED_MAX_ARB, TELEM_OFFSET(TAG_ENABLED_MAX_ARB)},
 		[64] = {TAG_AICLK_PPM_INFO, TELEM_OFFSET(TAG_AICLK_PPM_INFO)},
 		[65] = {TAG_HOST_AICLK_LIMIT, TELEM_OFFSET(TAG_HOST_AICLK_LIMIT)},
+		[66] = {TAG_TELEM_GENERATION, TELEM_OFFSET(TAG_TELEM_GENERATION)},
+		[67] = {TAG_TELEM_HISTORY, TELEM_OFFSET(TAG_TELEM_HISTORY)},
+		[68] = {TAG_AICLK_THROTTLE_MASK, TELEM_OFFSET(TAG_AICLK_THROTTLE_MASK)},
+		[69] = {TAG_TELEM_EVENTS, TELEM_OFFSET(TAG_TELEM_EVENTS)},
+		[70] = {TAG_DVFS_TRACE, TELEM_OFFSET(TAG_DVFS_TRACE)},
+		[71] = {TAG_FAN_HISTORY, TELEM_OFFSET(TAG_FAN_HISTORY)},
+		[72] = {TAG_DMC_LOG_DROPPED, TELEM_OFFSET(TAG_DMC_LOG_DROPPED)},
+		[73] = {TAG_DMC_LOG_OVERRUN, TELEM_OFFSET(TAG_DMC_LOG_OVERRUN)},
+		[74] = {TAG_GDDR_FW_LOAD_TIME, TELEM_OFFSET(TAG_GDDR_FW_LOAD_TIME)},
+		[75] = {TAG_ETH_FW_LOAD_TIME, TELEM_OFFSET(TAG_ETH_FW_LOAD_TIME)},
 	},
 };
 /* clang-format on */
@@ -184,10 +207,80 @@ static uint32_t *telemetry = &telemetry_table.telemetry[0];
 
 /** @} */ /* end of telemetry_table group */
 
+/* Serializes writers of the published telemetry buffer. Readers outside the SMC (host, DMC) use
+ * TAG_TELEM_GENERATION as a seqlock instead.
+ */
+static struct k_spinlock telemetry_lock;
+
+/* Values collected by update_telemetry, published together once the update completes */
+static uint32_t staged[TAG_COUNT];
+static ATOMIC_DEFINE(staged_tags, TAG_COUNT);
+
 static struct k_timer telem_update_timer;
 static struct k_work telem_update_worker;
 static int telem_update_interval = 100;
 
+static inline uint32_t telemetry_generation(void)
+{
+	return *(volatile uint32_t *)&telemetry[TAG_TELEM_GENERATION];
+}
+
+STATIC k_spinlock_key_t telemetry_write_begin(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&telemetry_lock);
+
+	/* Odd generation: an update is in progress */
+	telemetry[TAG_TELEM_GENERATION]++;
+	barrier_dmem_fence_full();
+
+	return key;
+}
+
+STATIC void telemetry_write_end(k_spinlock_key_t key)
+{
+	barrier_dmem_fence_full();
+	telemetry[TAG_TELEM_GENERATION]++;
+
+	k_spin_unlock(&telemetry_lock, key);
+}
+
+/* Start a lockless read, the values read are only valid if telemetry_read_retry() is false */
+STATIC uint32_t telemetry_read_begin(void)
+{
+	uint32_t start = telemetry_generation();
+
+	barrier_dmem_fence_full();
+
+	return start;
+}
+
+/* True if an update was in progress or published since telemetry_read_begin() returned start */
+STATIC bool telemetry_read_retry(uint32_t start)
+{
+	barrier_dmem_fence_full();
+
+	return (start & 1) != 0 || start != telemetry_generation();
+}
+
+static void stage_telemetry(uint16_t tag, uint32_t value)
+{
+	staged[tag] = value;
+	atomic_set_bit(staged_tags, tag);
+}
+
+static void publish_telemetry(void)
+{
+	k_spinlock_key_t key = telemetry_write_begin();
+
+	for (uint16_t tag = 0; tag < TAG_COUNT; tag++) {
+		if (atomic_test_and_clear_bit(staged_tags, tag)) {
+			telemetry[tag] = staged[tag];
+		}
+	}
+
+	telemetry_write_end(key);
+}
+
 uint32_t ConvertFloatToTelemetry(float value)
 {
 	/* Convert float to signed int 16.16 format */
@@ -226,7 +319,7 @@ static void UpdateEthTelemetry(void)
 	uint32_t heartbeat_status = GetEthHeartbeatStatus(0);
 	uint32_t link_status = GetEthLinkStatus(0);
 
-	telemetry[TAG_ETH_LIVE_STATUS] = (link_status << 16) | (heartbeat_status & 0xFFFF);
+	stage_telemetry(TAG_ETH_LIVE_STATUS, (link_status << 16) | (heartbeat_status & 0xFFFF));
 }
 
 static void UpdateGddrTelemetry(void)
@@ -235,7 +328,7 @@ static void UpdateGddrTelemetry(void)
 	uint32_t corr_errs[NUM_GDDR / 2] = {0};
 	uint32_t uncorr_errs = 0;
 	uint32_t status = 0;
-	uint32_t speed = telemetry[TAG_GDDR_SPEED];
+	uint32_t speed = staged[TAG_GDDR_SPEED];
 
 	for (int i = 0; i < NUM_GDDR; i++) {
 		gddr_telemetry_table_t gddr_telemetry;
@@ -291,23 +384,22 @@ static void UpdateGddrTelemetry(void)
 		status |= (uint32_t)IS_BIT_SET(bist.failed, i) << (17 + i * 2);
 	}
 
-	/* Update telemetry atomically after accumulation. */
 	for (int i = 0; i < NUM_GDDR / 2; i++) {
-		telemetry[TAG_GDDR_0_1_TEMP + i] = temperature[i];
-		telemetry[TAG_GDDR_0_1_CORR_ERRS + i] = corr_errs[i];
+		stage_telemetry(TAG_GDDR_0_1_TEMP + i, temperature[i]);
+		stage_telemetry(TAG_GDDR_0_1_CORR_ERRS + i, corr_errs[i]);
 	}
-	telemetry[TAG_GDDR_UNCORR_ERRS] = uncorr_errs;
-	telemetry[TAG_GDDR_STATUS] = status;
-	telemetry[TAG_GDDR_SPEED] = speed;
+	stage_telemetry(TAG_GDDR_UNCORR_ERRS, uncorr_errs);
+	stage_telemetry(TAG_GDDR_STATUS, status);
+	stage_telemetry(TAG_GDDR_SPEED, speed);
 }
 
-int GetMaxGDDRTemp(void)
+static int max_gddr_temp(const uint32_t *values)
 {
 	int max_gddr_temp = 0;
 
 	for (int i = 0; i < NUM_GDDR; i++) {
 		int shift_val = (i % 2) * 16;
-		int gddr_temp = telemetry[TAG_GDDR_0_1_TEMP + i / 2];
+		int gddr_temp = values[TAG_GDDR_0_1_TEMP + i / 2];
 
 		max_gddr_temp = MAX(max_gddr_temp, (gddr_temp >> shift_val) & 0xFF);
 		max_gddr_temp = MAX(max_gddr_temp, (gddr_temp >> (shift_val + 8)) & 0xFF);
@@ -316,6 +408,12 @@ int GetMaxGDDRTemp(void)
 	return max_gddr_temp;
 }
 
+int GetMaxGDDRTemp(void)
+{
+	return max_gddr_temp(telemetry);
+}
+
+/* Runs before the telemetry buffer address is published, so it writes the buffer directly. */
 static void write_static_telemetry(uint32_t app_version)
 {
 	telemetry_table.version = TELEMETRY_VERSION; /* v0.1.0 - Only update when redefining the
@@ -362,6 +460,9 @@ static void write_static_telemetry(uint32_t app_version)
 				gddr_telemetry.mrisc_fw_version_minor;
 		}
 	}
+	/* The FWs are loaded by SYS_INIT, before init_telemetry */
+	telemetry[TAG_GDDR_FW_LOAD_TIME] = get_mrisc_fw_load_time();
+	telemetry[TAG_ETH_FW_LOAD_TIME] = GetEthFwLoadTime();
 	/* DM_APP_FW_VERSION and DM_BL_FW_VERSION assumes zero-init, it might be
 	 * initialized by bh_chip_set_static_info in dmfw already, must not clear.
 	 */
@@ -382,6 +483,19 @@ static void write_static_telemetry(uint32_t app_version)
 	 */
 
 	telemetry[TAG_ASIC_LOCATION] = tt_bh_fwtable_get_asic_location(fwtable_dev);
+	telemetry[TAG_TELEM_HISTORY] = telemetry_history_addr();
+	telemetry[TAG_TELEM_EVENTS] = telemetry_events_addr();
+	telemetry[TAG_DVFS_TRACE] = dvfs_trace_addr();
+	telemetry[TAG_FAN_HISTORY] = fan_history_addr();
+}
+
+static void stage_clock_rate(uint16_t tag, const struct device *pll_dev, uint32_t clock)
+{
+	/* Keep the previous value if the rate cannot be read */
+	uint32_t rate = staged[tag];
+
+	clock_control_get_rate(pll_dev, (clock_control_subsys_t)clock, &rate);
+	stage_telemetry(tag, rate);
 }
 
 static void update_telemetry(void)
@@ -392,74 +506,57 @@ static void update_telemetry(void)
 	ReadTelemetryInternal(telem_update_interval, &telemetry_internal_data);
 
 	/* Get all dynamically updated values */
-	telemetry[TAG_VCORE] =
-		telemetry_internal_data
-			.vcore_voltage; /* reported in mV, will be truncated to uint32_t */
-	telemetry[TAG_TDP] =
-		telemetry_internal_data
-			.vcore_power; /* reported in W, will be truncated to uint32_t */
-	telemetry[TAG_TDC] =
-		telemetry_internal_data
-			.vcore_current; /* reported in A, will be truncated to uint32_t */
-	telemetry[TAG_ASIC_TEMPERATURE] = ConvertFloatToTelemetry(
-		telemetry_internal_data.asic_temperature); /* ASIC temperature - reported in
-							    * signed int 16.16 format
-							    */
-	telemetry[TAG_VREG_TEMPERATURE] = 0x000000;        /* VREG temperature - need I2C line */
-	telemetry[TAG_BOARD_TEMPERATURE] = 0x000000;       /* Board temperature - need I2C line */
-	clock_control_get_rate(pll_dev_0, (clock_control_subsys_t)CLOCK_CONTROL_TT_BH_CLOCK_AICLK,
-			       &telemetry[TAG_AICLK]);
+	stage_telemetry(TAG_VCORE,
+			telemetry_internal_data
+				.vcore_voltage); /* reported in mV, will be truncated to uint32_t */
+	stage_telemetry(TAG_TDP,
+			telemetry_internal_data
+				.vcore_power); /* reported in W, will be truncated to uint32_t */
+	stage_telemetry(TAG_TDC,
+			telemetry_internal_data
+				.vcore_current); /* reported in A, will be truncated to uint32_t */
+	/* ASIC temperature - reported in signed int 16.16 format */
+	stage_telemetry(TAG_ASIC_TEMPERATURE,
+			ConvertFloatToTelemetry(telemetry_internal_data.asic_temperature));
+	stage_telemetry(TAG_VREG_TEMPERATURE, 0x000000);  /* VREG temperature - need I2C line */
+	stage_telemetry(TAG_BOARD_TEMPERATURE, 0x000000); /* Board temperature - need I2C line */
 	/* first 16 bits - MAX ASIC FREQ (Not Available yet), lower 16 bits - current AICLK */
+	stage_clock_rate(TAG_AICLK, pll_dev_0, CLOCK_CONTROL_TT_BH_CLOCK_AICLK);
 	enum aiclk_arb_min effective_min_arb;
 	enum aiclk_arb_max effective_max_arb;
 
 	uint32_t arb_min_freq = get_aiclk_effective_arb_min(&effective_min_arb);
 	uint32_t arb_max_freq = get_aiclk_effective_arb_max(&effective_max_arb);
 
-	telemetry[TAG_AICLK_ARB_MIN] = arb_min_freq | (effective_min_arb << 16U);
-	telemetry[TAG_AICLK_ARB_MAX] = arb_max_freq | (effective_max_arb << 16U);
-	telemetry[TAG_ENABLED_MIN_ARB] = get_enabled_arb_min_bitmask();
-	telemetry[TAG_ENABLED_MAX_ARB] = get_enabled_arb_max_bitmask();
-	telemetry[TAG_AICLK_PPM_INFO] = get_targ_aiclk_info().u32_all;
-
-	clock_control_get_rate(
-		pll_dev_1, (clock_control_subsys_t)CLOCK_CONTROL_TT_BH_CLOCK_AXICLK,
-		&telemetry[TAG_AXICLK]); /* first 16 bits - MAX AXI FREQ (Not Available yet),
-					  * lower 16 bits - current AXICLK
-					  */
-	clock_control_get_rate(
-		pll_dev_1, (clock_control_subsys_t)CLOCK_CONTROL_TT_BH_CLOCK_ARCCLK,
-		&telemetry[TAG_ARCCLK]); /* first 16 bits - MAX ARC FREQ (Not Available yet),
-					  * lower 16 bits - current ARCCLK
-					  */
-	clock_control_get_rate(
-		pll_dev_4, (clock_control_subsys_t)CLOCK_CONTROL_TT_BH_CLOCK_L2CPUCLK_0,
-		&telemetry[TAG_L2CPUCLK0]); /* first 16 bits - MAX L2CPUCLK0 FREQ (Not Available
-					     * yet), lower 16 bits - current L2CPUCLK0
-					     */
-	clock_control_get_rate(
-		pll_dev_4, (clock_control_subsys_t)CLOCK_CONTROL_TT_BH_CLOCK_L2CPUCLK_1,
-		&telemetry[TAG_L2CPUCLK1]); /* first 16 bits - MAX L2CPUCLK1 FREQ (Not Available
-					     * yet), lower 16 bits - current L2CPUCLK1
-					     */
-	clock_control_get_rate(
-		pll_dev_4, (clock_control_subsys_t)CLOCK_CONTROL_TT_BH_CLOCK_L2CPUCLK_2,
-		&telemetry[TAG_L2CPUCLK2]); /* first 16 bits - MAX L2CPUCLK2 FREQ (Not Available
-					     * yet), lower 16 bits - current L2CPUCLK2
-					     */
-	clock_control_get_rate(
-		pll_dev_4, (clock_control_subsys_t)CLOCK_CONTROL_TT_BH_CLOCK_L2CPUCLK_3,
-		&telemetry[TAG_L2CPUCLK3]); /* first 16 bits - MAX L2CPUCLK3 FREQ (Not Available
-					     * yet), lower 16 bits - current L2CPUCLK3
-					     */
-
-	telemetry[TAG_FAN_SPEED] = GetFanSpeed(); /* Target fan speed - reported in percentage */
-	telemetry[TAG_FAN_RPM] = GetFanRPM();     /* Actual fan RPM */
+	stage_telemetry(TAG_AICLK_ARB_MIN, arb_min_freq | (effective_min_arb << 16U));
+	stage_telemetry(TAG_AICLK_ARB_MAX, arb_max_freq | (effective_max_arb << 16U));
+	stage_telemetry(TAG_ENABLED_MIN_ARB, get_enabled_arb_min_bitmask());
+	stage_telemetry(TAG_ENABLED_MAX_ARB, get_enabled_arb_max_bitmask());
+	stage_telemetry(TAG_AICLK_PPM_INFO, get_targ_aiclk_info().u32_all);
+	stage_telemetry(TAG_AICLK_THROTTLE_MASK, get_throttling_arb_mask());
+
+	/* For the clocks below, first 16 bits - MAX FREQ (Not Available yet), lower 16 bits -
+	 * current frequency
+	 */
+	stage_clock_rate(TAG_AXICLK, pll_dev_1, CLOCK_CONTROL_TT_BH_CLOCK_AXICLK);
+	stage_clock_rate(TAG_ARCCLK, pll_dev_1, CLOCK_CONTROL_TT_BH_CLOCK_ARCCLK);
+	stage_clock_rate(TAG_L2CPUCLK0, pll_dev_4, CLOCK_CONTROL_TT_BH_CLOCK_L2CPUCLK_0);
+	stage_clock_rate(TAG_L2CPUCLK1, pll_dev_4, CLOCK_CONTROL_TT_BH_CLOCK_L2CPUCLK_1);
+	stage_clock_rate(TAG_L2CPUCLK2, pll_dev_4, CLOCK_CONTROL_TT_BH_CLOCK_L2CPUCLK_2);
+	stage_clock_rate(TAG_L2CPUCLK3, pll_dev_4, CLOCK_CONTROL_TT_BH_CLOCK_L2CPUCLK_3);
+
+	/* Target fan speed - reported in percentage */
+	stage_telemetry(TAG_FAN_SPEED, GetFanSpeed());
+	stage_telemetry(TAG_FAN_RPM, GetFanRPM()); /* Actual fan RPM */
 	UpdateEthTelemetry();
 	UpdateGddrTelemetry();
-	telemetry[TAG_MAX_GDDR_TEMP] = GetMaxGDDRTemp();
-	telemetry[TAG_INPUT_POWER] = GetInputPower(); /* Input power - reported in W */
-	telemetry[TAG_TIMER_HEARTBEAT]++; /* Incremented every time the timer is called */
+	stage_telemetry(TAG_MAX_GDDR_TEMP, max_gddr_temp(staged));
+	stage_telemetry(TAG_INPUT_POWER, GetInputPower()); /* Input power - reported in W */
+	/* Incremented every time the timer is called */
+	stage_telemetry(TAG_TIMER_HEARTBEAT, staged[TAG_TIMER_HEARTBEAT] + 1);
+
+	/* Publish all of the above as a single snapshot */
+	publish_telemetry();
 	SetPostCode(POST_CODE_SRC_CMFW, POST_CODE_TELEMETRY_END);
 }
 
@@ -471,11 +568,11 @@ static void telemetry_work_handler(struct k_work *work)
 }
 static void telemetry_timer_handler(struct k_timer *timer)
 {
-	k_work_submit(&telem_update_worker);
+	tt_work_submit(TT_WORK_QUEUE_BACKGROUND, &telem_update_worker);
 }
 
-/* Zephyr timer object submits a work item to the system work queue whose thread performs the task
- * on a periodic basis.
+/* Zephyr timer object submits a work item to the background work queue whose thread performs the
+ * task on a periodic basis.
  */
 /* See:
  * https://docs.zephyrproject.org/latest/kernel/services/timing/timers.html#using-a-timer-expiry-function
@@ -507,34 +604,61 @@ void StartTelemetryTimer(void)
 
 void UpdateDmFwVersion(uint32_t bl_version, uint32_t app_version)
 {
+	k_spinlock_key_t key = telemetry_write_begin();
+
 	telemetry[TAG_DM_BL_FW_VERSION] = bl_version;
 	telemetry[TAG_DM_APP_FW_VERSION] = app_version;
+	telemetry_write_end(key);
 }
 
 void UpdateTelemetryNocTranslation(bool translation_enabled)
 {
 	/* Note that this may be called before init_telemetry. */
+	k_spinlock_key_t key = telemetry_write_begin();
+
 	telemetry[TAG_NOC_TRANSLATION] = translation_enabled;
+	telemetry_write_end(key);
 }
 
 void UpdateTelemetryBoardPowerLimit(uint32_t power_limit)
 {
+	k_spinlock_key_t key = telemetry_write_begin();
+
 	telemetry[TAG_BOARD_POWER_LIMIT] = power_limit;
+	telemetry_write_end(key);
 }
 
 void UpdateTelemetryTdpLimit(uint32_t tdp_limit)
 {
+	k_spinlock_key_t key = telemetry_write_begin();
+
 	telemetry[TAG_TDP_LIMIT_MAX] = tdp_limit;
+	telemetry_write_end(key);
 }
 
 void UpdateTelemetryThermTripCount(uint16_t therm_trip_count)
 {
+	k_spinlock_key_t key = telemetry_write_begin();
+
 	telemetry[TAG_THERM_TRIP_COUNT] = therm_trip_count;
+	telemetry_write_end(key);
 }
 
 void UpdateTelemetryHostAiclkLimit(uint32_t fmax)
 {
+	k_spinlock_key_t key = telemetry_write_begin();
+
 	telemetry[TAG_HOST_AICLK_LIMIT] = fmax;
+	telemetry_write_end(key);
+}
+
+void UpdateTelemetryDmcLog(uint32_t dropped, uint32_t overrun)
+{
+	k_spinlock_key_t key = telemetry_write_begin();
+
+	telemetry[TAG_DMC_LOG_DROPPED] = dropped;
+	telemetry[TAG_DMC_LOG_OVERRUN] = overrun;
+	telemetry_write_end(key);
 }
 
 bool GetTelemetryTagValid(uint16_t tag)
@@ -549,3 +673,63 @@ uint32_t GetTelemetryTag(uint16_t tag)
 	}
 	return telemetry[tag];
 }
+
+/**
+ * @brief Read a telemetry tag together with the generation it was published in.
+ *
+ * Callers that read several tags one at a time (e.g. the DMC over SMBus) can compare the
+ * generations to tell whether the values belong to the same telemetry update.
+ */
+uint32_t GetTelemetryTagSnapshot(uint16_t tag, uint32_t *generation)
+{
+	uint32_t value;
+	uint32_t start;
+
+	do {
+		start = telemetry_read_begin();
+		value = GetTelemetryTag(tag);
+	} while (telemetry_read_retry(start));
+
+	*generation = start;
+	return value;
+}
+
+/**
+ * @brief Copy a consistent snapshot of the whole telemetry buffer.
+ *
+ * @param values Buffer receiving @ref TAG_COUNT telemetry values, indexed by tag
+ * @return The generation of the copied snapshot
+ */
+uint32_t ReadTelemetrySnapshot(uint32_t values[TAG_COUNT])
+{
+	uint32_t start;
+
+	do {
+		start = telemetry_read_begin();
+		memcpy(values, telemetry, TAG_COUNT * sizeof(uint32_t));
+	} while (telemetry_read_retry(start));
+
+	return start;
+}
+
+/**
+ * @brief Read a consistent snapshot of a list of telemetry tags.
+ *
+ * @param tags Valid telemetry tags to read
+ * @param count Number of entries in @p tags
+ * @param values Buffer receiving @p count values, in the order of @p tags
+ * @return The generation of the snapshot
+ */
+uint32_t ReadTelemetryTagsSnapshot(const uint8_t *tags, uint32_t count, uint32_t *values)
+{
+	uint32_t start;
+
+	do {
+		start = telemetry_read_begin();
+		for (uint32_t i = 0; i < count; i++) {
+			values[i] = telemetry[tags[i]];
+		}
+	} while (telemetry_read_retry(start));
+
+	return start;
+}
@@ -314,12 +314,88 @@
  */
 #define TAG_HOST_AICLK_LIMIT 70
 
+/**
+ * @brief Telemetry snapshot generation counter.
+ *
+ * The firmware increments this counter before and after publishing new telemetry values, so it
+ * is odd while an update is in progress. A reader that needs several tags from the same update
+ * reads the counter, then the tags, then the counter again, and retries if the counter was odd
+ * or changed in between.
+ */
+#define TAG_TELEM_GENERATION 71
+
+/**
+ * @brief Address of the telemetry history buffer.
+ *
+ * 0 if the firmware was built without telemetry history.
+ *
+ * @see @ref telemetry_history_rqst
+ */
+#define TAG_TELEM_HISTORY 72
+
+/**
+ * @brief Bitmask of the AICLK max arbiters currently throttling AICLK.
+ *
+ * Bit n is set if arbiter n (see @ref aiclk_arb_max) limited AICLK in the last control loop
+ * iteration while the chip was busy, i.e. when its throttler counter was incremented.
+ */
+#define TAG_AICLK_THROTTLE_MASK 73
+
+/**
+ * @brief Address of the telemetry event ring.
+ *
+ * 0 if the firmware was built without telemetry events.
+ *
+ * @see @ref telemetry_event_rqst
+ */
+#define TAG_TELEM_EVENTS 74
+
+/**
+ * @brief Address of the DVFS decision trace buffer.
+ *
+ * 0 if the firmware was built without the DVFS trace.
+ *
+ * @see @ref dvfs_trace_rqst
+ */
+#define TAG_DVFS_TRACE 75
+
+/**
+ * @brief Address of the fan control history buffer.
+ *
+ * 0 if the firmware was built without the fan control history. Each record holds the filtered
+ * ASIC and GDDR temperatures, the fan RPM and the requested fan speed of one fan control update,
+ * see struct fan_history in fan_ctrl.h.
+ */
+#define TAG_FAN_HISTORY 76
+
+/**
+ * @brief Bytes of DMC log the DMC dropped before sending them.
+ *
+ * As reported with CMFW_SMBUS_DMC_LOG_BULK, counted from the first report after CMFW reset.
+ */
+#define TAG_DMC_LOG_DROPPED 77
+
+/**
+ * @brief Bytes of DMC log the CMFW received and dropped, for lack of room in the DMC vUART.
+ */
+#define TAG_DMC_LOG_OVERRUN 78
+
+/**
+ * @brief Time taken to load the MRISC FW and its config into the GDDR instances, in us.
+ */
+#define TAG_GDDR_FW_LOAD_TIME 79
+
+/**
+ * @brief Time taken to load the ETH FW and its param table into the ETH instances, in us.
+ */
+#define TAG_ETH_FW_LOAD_TIME 80
+
 /** @} */ /* end of telemetry_tag group */
 
 /* Not a real tag, signifies the last tag in the list.
  * MUST be incremented if new tags are defined.
  */
-#define TAG_COUNT 71
+#define TAG_COUNT 81
 
 /* Telemetry tags are at offset `tag` in the telemetry buffer */
 #define TELEM_OFFSET(tag) (tag)
@@ -335,7 +411,11 @@ void UpdateTelemetryBoardPowerLimit(uint32_t power_limit);
 void UpdateTelemetryTdpLimit(uint32_t tdp_limit);
 void UpdateTelemetryThermTripCount(uint16_t therm_trip_count);
 void UpdateTelemetryHostAiclkLimit(uint32_t fmax);
+void UpdateTelemetryDmcLog(uint32_t dropped, uint32_t overrun);
 bool GetTelemetryTagValid(uint16_t tag);
 uint32_t GetTelemetryTag(uint16_t tag);
+uint32_t GetTelemetryTagSnapshot(uint16_t tag, uint32_t *generation);
+uint32_t ReadTelemetrySnapshot(uint32_t values[TAG_COUNT]);
+uint32_t ReadTelemetryTagsSnapshot(const uint8_t *tags, uint32_t count, uint32_t *values);
 
 #endif
@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "telemetry_events.h"
+
+#include <errno.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/barrier.h>
+#include <zephyr/sys/util.h>
+
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+#include "pcie_msi.h"
+#include "telemetry.h"
+#include "work_queue.h"
+
+#define NUM_SUBSCRIPTIONS CONFIG_TT_BH_ARC_TELEMETRY_EVENT_SUBSCRIPTIONS
+
+BUILD_ASSERT(IS_POWER_OF_TWO(CONFIG_TT_BH_ARC_TELEMETRY_EVENT_RING_SIZE),
+	     "Telemetry event ring size must be a power of two");
+BUILD_ASSERT(NUM_SUBSCRIPTIONS <= ATOMIC_BITS);
+
+static struct k_spinlock events_lock;
+static struct telemetry_event_subscription subscriptions[NUM_SUBSCRIPTIONS];
+static struct telemetry_event_ring ring = {
+	.version = TELEMETRY_EVENTS_VERSION,
+	.capacity = CONFIG_TT_BH_ARC_TELEMETRY_EVENT_RING_SIZE,
+	.record_size = sizeof(struct telemetry_event_record),
+};
+
+/* Subscriptions with an MSI to send */
+static atomic_t pending_msi;
+static telemetry_event_notify_t notify = SendPcieMsi;
+
+static void msi_work_handler(struct k_work *work)
+{
+	atomic_val_t pending = atomic_clear(&pending_msi);
+
+	for (uint32_t i = 0; i < NUM_SUBSCRIPTIONS; i++) {
+		if (pending & BIT(i)) {
+			notify(subscriptions[i].pcie_inst, subscriptions[i].msi_vector);
+		}
+	}
+}
+/* MSIs are sent from the host message queue, which also owns the NOC TLB used by SendPcieMsi
+ * for TT_SMC_MSG_SEND_PCIE_MSI, and keeps the NOC writes out of the control loop.
+ */
+static K_WORK_DEFINE(msi_work, msi_work_handler);
+
+int telemetry_events_subscribe(uint32_t index, const struct telemetry_event_subscription *sub)
+{
+	if (index >= NUM_SUBSCRIPTIONS || !GetTelemetryTagValid(sub->tag)) {
+		return -EINVAL;
+	}
+
+	K_SPINLOCK(&events_lock) {
+		subscriptions[index] = *sub;
+		subscriptions[index].asserted = false;
+	}
+
+	return 0;
+}
+
+static void push_event(uint32_t index, uint32_t value, bool asserted)
+{
+	struct telemetry_event_record *record = &ring.records[ring.head & (ring.capacity - 1)];
+	uint64_t timestamp_us = k_ticks_to_us_floor64(k_uptime_ticks());
+
+	record->timestamp_lo = (uint32_t)timestamp_us;
+	record->timestamp_hi = (uint32_t)(timestamp_us >> 32);
+	record->tag = subscriptions[index].tag;
+	record->subscription = index;
+	record->flags = asserted ? TELEMETRY_EVENT_RECORD_ASSERTED : 0;
+	record->value = value;
+
+	/* The record must be complete before the host can see it */
+	barrier_dmem_fence_full();
+	ring.head++;
+}
+
+static bool crossed(const struct telemetry_event_subscription *sub, int32_t value)
+{
+	int64_t v = value;
+	int64_t threshold = sub->threshold;
+
+	if (sub->flags & TELEMETRY_EVENT_FLAG_FALLING) {
+		return sub->asserted ? v <= threshold + sub->hysteresis : v <= threshold;
+	}
+
+	return sub->asserted ? v >= threshold - sub->hysteresis : v >= threshold;
+}
+
+/**
+ * @brief Check a new value of a tag against all subscriptions to it
+ */
+void telemetry_events_check(uint16_t tag, uint32_t value)
+{
+	bool notify_host = false;
+
+	K_SPINLOCK(&events_lock) {
+		for (uint32_t i = 0; i < NUM_SUBSCRIPTIONS; i++) {
+			struct telemetry_event_subscription *sub = &subscriptions[i];
+
+			if (!(sub->flags & TELEMETRY_EVENT_FLAG_ENABLE) || sub->tag != tag) {
+				continue;
+			}
+
+			bool asserted = crossed(sub, (int32_t)value);
+
+			if (asserted != sub->asserted) {
+				sub->asserted = asserted;
+				push_event(i, value, asserted);
+				atomic_set_bit(&pending_msi, i);
+				notify_host = true;
+			}
+		}
+	}
+
+	if (notify_host) {
+		tt_work_submit(TT_WORK_QUEUE_HOST_MSG, &msi_work);
+	}
+}
+
+/**
+ * @brief Check all subscribed tags
+ *
+ * Called once per control loop iteration (1 ms) with the values the control loop used.
+ */
+void telemetry_events_sample(const TelemetryInternalData *data)
+{
+	uint8_t tags[NUM_SUBSCRIPTIONS];
+	uint32_t num_tags = 0;
+
+	K_SPINLOCK(&events_lock) {
+		for (uint32_t i = 0; i < NUM_SUBSCRIPTIONS; i++) {
+			if (subscriptions[i].flags & TELEMETRY_EVENT_FLAG_ENABLE) {
+				tags[num_tags++] = subscriptions[i].tag;
+			}
+		}
+	}
+
+	for (uint32_t i = 0; i < num_tags; i++) {
+		bool seen = false;
+
+		/* Each tag is read once and checked against all of its subscriptions */
+		for (uint32_t j = 0; j < i; j++) {
+			seen |= tags[j] == tags[i];
+		}
+
+		if (!seen) {
+			telemetry_events_check(tags[i], GetTelemetryInternalTag(tags[i], data));
+		}
+	}
+}
+
+void telemetry_events_set_notify(telemetry_event_notify_t new_notify)
+{
+	notify = new_notify != NULL ? new_notify : SendPcieMsi;
+}
+
+const struct telemetry_event_ring *telemetry_events_get(void)
+{
+	return &ring;
+}
+
+uint32_t telemetry_events_addr(void)
+{
+	return (uint32_t)(uintptr_t)&ring;
+}
+
+/**
+ * @brief Handler for @ref TT_SMC_MSG_TELEMETRY_EVENT_SUBSCRIBE
+ * @see telemetry_event_rqst
+ */
+static uint8_t telemetry_event_handler(const union request *request, struct response *response)
+{
+	const struct telemetry_event_rqst *rqst = &request->telemetry_event;
+	struct telemetry_event_subscription sub = {
+		.tag = rqst->tag,
+		.flags = rqst->flags,
+		.pcie_inst = rqst->pcie_inst,
+		.msi_vector = rqst->msi_vector,
+		.threshold = (int32_t)rqst->threshold,
+		.hysteresis = rqst->hysteresis,
+	};
+
+	if (telemetry_events_subscribe(rqst->subscription, &sub) != 0) {
+		return 1;
+	}
+
+	response->data[1] = telemetry_events_addr();
+	response->data[2] = ring.capacity;
+
+	return 0;
+}
+
+REGISTER_MESSAGE(TT_SMC_MSG_TELEMETRY_EVENT_SUBSCRIBE, telemetry_event_handler);
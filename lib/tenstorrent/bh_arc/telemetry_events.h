@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef TELEMETRY_EVENTS_H
+#define TELEMETRY_EVENTS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "telemetry_internal.h"
+
+#define TELEMETRY_EVENTS_VERSION 1
+
+/* Set in telemetry_event_record.flags when the event is raised, clear when it is cleared */
+#define TELEMETRY_EVENT_RECORD_ASSERTED 0x1
+
+#ifdef CONFIG_TT_BH_ARC_TELEMETRY_EVENTS
+
+struct telemetry_event_record {
+	/* Uptime in microseconds when the threshold was crossed */
+	uint32_t timestamp_lo;
+	uint32_t timestamp_hi;
+	uint8_t tag;
+	uint8_t subscription;
+	uint16_t flags;
+	uint32_t value;
+};
+
+/*
+ * Ring of telemetry events, published in TAG_TELEM_EVENTS.
+ *
+ * head counts the records written since boot, the newest record is
+ * records[(head - 1) % capacity]. The host keeps its own read count and reads the records up to
+ * head after each MSI. If head has moved more than capacity past the host's count, the oldest
+ * events were lost.
+ */
+struct telemetry_event_ring {
+	uint32_t version;
+	uint32_t capacity;
+	uint32_t record_size;
+	uint32_t head;
+	struct telemetry_event_record records[CONFIG_TT_BH_ARC_TELEMETRY_EVENT_RING_SIZE];
+};
+
+struct telemetry_event_subscription {
+	uint8_t tag;
+	uint8_t flags;
+	uint8_t pcie_inst;
+	uint8_t msi_vector;
+	int32_t threshold;
+	uint32_t hysteresis;
+	bool asserted;
+};
+
+typedef void (*telemetry_event_notify_t)(uint8_t pcie_inst, uint32_t vector_id);
+
+int telemetry_events_subscribe(uint32_t index, const struct telemetry_event_subscription *sub);
+void telemetry_events_check(uint16_t tag, uint32_t value);
+void telemetry_events_sample(const TelemetryInternalData *data);
+void telemetry_events_set_notify(telemetry_event_notify_t notify);
+const struct telemetry_event_ring *telemetry_events_get(void);
+uint32_t telemetry_events_addr(void);
+
+#else
+
+static inline void telemetry_events_sample(const TelemetryInternalData *data)
+{
+}
+
+static inline uint32_t telemetry_events_addr(void)
+{
+	return 0;
+}
+
+#endif
+
+#endif
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "telemetry_history.h"
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/barrier.h>
+#include <zephyr/sys/util.h>
+
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+#include "telemetry.h"
+
+#define MAX_TAGS CONFIG_TT_BH_ARC_TELEMETRY_HISTORY_MAX_TAGS
+
+BUILD_ASSERT(IS_POWER_OF_TWO(CONFIG_TT_BH_ARC_TELEMETRY_HISTORY_DEPTH),
+	     "Telemetry history depth must be a power of two");
+BUILD_ASSERT(MAX_TAGS <= ARRAY_SIZE(((struct telemetry_history_rqst *)0)->tags));
+
+static struct k_spinlock history_lock;
+/* By default, record the power delivery transients that drive throttling at the control loop
+ * rate.
+ */
+static struct telemetry_history history = {
+	.version = TELEMETRY_HISTORY_VERSION,
+	.capacity = CONFIG_TT_BH_ARC_TELEMETRY_HISTORY_DEPTH,
+	.record_size = sizeof(struct telemetry_history_record),
+	.period_ms = 1,
+	.num_tags = 4,
+	.tags = {TAG_TDP, TAG_TDC, TAG_AICLK, TAG_VCORE},
+};
+/* Control loop ticks since the last recorded sample */
+static uint32_t ticks_since_sample;
+
+int telemetry_history_configure(const uint8_t *tags, uint32_t num_tags, uint32_t period_ms)
+{
+	if (num_tags > MAX_TAGS) {
+		return -EINVAL;
+	}
+
+	for (uint32_t i = 0; i < num_tags; i++) {
+		if (!GetTelemetryTagValid(tags[i])) {
+			return -EINVAL;
+		}
+	}
+
+	K_SPINLOCK(&history_lock) {
+		/* Invalidate the old records before changing their meaning */
+		history.head = 0;
+		barrier_dmem_fence_full();
+
+		memset(history.tags, 0, sizeof(history.tags));
+		for (uint32_t i = 0; i < num_tags; i++) {
+			history.tags[i] = tags[i];
+		}
+		history.num_tags = num_tags;
+		history.period_ms = period_ms;
+		ticks_since_sample = 0;
+	}
+
+	return 0;
+}
+
+void telemetry_history_push(uint64_t timestamp_us, const uint32_t *values)
+{
+	K_SPINLOCK(&history_lock) {
+		struct telemetry_history_record *record =
+			&history.records[history.head & (history.capacity - 1)];
+
+		record->timestamp_lo = (uint32_t)timestamp_us;
+		record->timestamp_hi = (uint32_t)(timestamp_us >> 32);
+		memcpy(record->values, values, history.num_tags * sizeof(uint32_t));
+
+		/* The record must be complete before the host can see it */
+		barrier_dmem_fence_full();
+		history.head++;
+	}
+}
+
+/**
+ * @brief Record a sample if the history period has elapsed
+ *
+ * Called once per control loop iteration (1 ms) with the values the control loop used.
+ */
+void telemetry_history_sample(const TelemetryInternalData *data)
+{
+	uint32_t tags[MAX_TAGS];
+	uint32_t values[MAX_TAGS];
+	uint32_t num_tags = 0;
+
+	K_SPINLOCK(&history_lock) {
+		if (history.period_ms == 0 || ++ticks_since_sample < history.period_ms) {
+			K_SPINLOCK_BREAK;
+		}
+		ticks_since_sample = 0;
+		num_tags = history.num_tags;
+		memcpy(tags, history.tags, sizeof(tags));
+	}
+
+	if (num_tags == 0) {
+		return;
+	}
+
+	for (uint32_t i = 0; i < num_tags; i++) {
+		values[i] = GetTelemetryInternalTag(tags[i], data);
+	}
+
+	telemetry_history_push(k_ticks_to_us_floor64(k_uptime_ticks()), values);
+}
+
+const struct telemetry_history *telemetry_history_get(void)
+{
+	return &history;
+}
+
+uint32_t telemetry_history_addr(void)
+{
+	return (uint32_t)(uintptr_t)&history;
+}
+
+/**
+ * @brief Handler for @ref TT_SMC_MSG_CONFIGURE_TELEMETRY_HISTORY
+ * @see telemetry_history_rqst
+ */
+static uint8_t telemetry_history_handler(const union request *request,
+					 struct response *response)
+{
+	const struct telemetry_history_rqst *rqst = &request->telemetry_history;
+
+	if (telemetry_history_configure(rqst->tags, rqst->num_tags, rqst->period_ms) != 0) {
+		return 1;
+	}
+
+	response->data[1] = telemetry_history_addr();
+	response->data[2] = history.capacity;
+
+	return 0;
+}
+
+REGISTER_MESSAGE(TT_SMC_MSG_CONFIGURE_TELEMETRY_HISTORY, telemetry_history_handler);
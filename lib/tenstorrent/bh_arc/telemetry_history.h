@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef TELEMETRY_HISTORY_H
+#define TELEMETRY_HISTORY_H
+
+#include <stdint.h>
+
+#include "telemetry_internal.h"
+
+#define TELEMETRY_HISTORY_VERSION 1
+
+#ifdef CONFIG_TT_BH_ARC_TELEMETRY_HISTORY
+
+/* One sample of all recorded tags. Values use the same encoding as the telemetry table. */
+struct telemetry_history_record {
+	/* Uptime in microseconds when the sample was taken */
+	uint32_t timestamp_lo;
+	uint32_t timestamp_hi;
+	uint32_t values[CONFIG_TT_BH_ARC_TELEMETRY_HISTORY_MAX_TAGS];
+};
+
+/*
+ * Ring buffer of telemetry samples, published in TAG_TELEM_HISTORY.
+ *
+ * head counts the records written since the recorder was last configured, the newest record is
+ * records[(head - 1) % capacity]. To read the buffer in bulk (e.g. with a PCIe DMA transfer),
+ * the host reads head, copies the records, then reads head again. Records not newer than the
+ * second head minus capacity may have been overwritten during the copy and must be discarded.
+ */
+struct telemetry_history {
+	uint32_t version;
+	uint32_t capacity;
+	uint32_t record_size;
+	uint32_t period_ms;
+	uint32_t num_tags;
+	uint32_t tags[CONFIG_TT_BH_ARC_TELEMETRY_HISTORY_MAX_TAGS];
+	uint32_t head;
+	struct telemetry_history_record records[CONFIG_TT_BH_ARC_TELEMETRY_HISTORY_DEPTH];
+};
+
+int telemetry_history_configure(const uint8_t *tags, uint32_t num_tags, uint32_t period_ms);
+void telemetry_history_push(uint64_t timestamp_us, const uint32_t *values);
+void telemetry_history_sample(const TelemetryInternalData *data);
+const struct telemetry_history *telemetry_history_get(void);
+uint32_t telemetry_history_addr(void);
+
+#else
+
+static inline void telemetry_history_sample(const TelemetryInternalData *data)
+{
+}
+
+static inline uint32_t telemetry_history_addr(void)
+{
+	return 0;
+}
+
+#endif
+
+#endif
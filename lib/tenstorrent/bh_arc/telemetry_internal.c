@@ -4,18 +4,26 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include "aiclk_ppm.h"
 #include "avs.h"
+#include "cm2dm_msg.h"
+#include "telemetry.h"
 #include "telemetry_internal.h"
 #include "regulator.h"
 
 #include <zephyr/kernel.h>
+#include <zephyr/drivers/clock_control.h>
+#include <zephyr/drivers/clock_control/clock_control_tt_bh.h>
 #include <zephyr/drivers/sensor.h>
 #include <zephyr/drivers/sensor/tenstorrent/pvt_tt_bh.h>
 
 static int64_t last_update_time;
 static TelemetryInternalData internal_data;
+/* Shared by the DVFS, telemetry and fan control work queues */
+static K_MUTEX_DEFINE(internal_data_lock);
 
 static const struct device *const pvt = DEVICE_DT_GET(DT_NODELABEL(pvt));
+static const struct device *const pll_dev_0 = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(pll0));
 
 SENSOR_DT_READ_IODEV(ts_avg_iodev, DT_NODELABEL(pvt), {SENSOR_CHAN_PVT_TT_BH_TS_AVG, 0});
 
@@ -34,6 +42,8 @@ static uint8_t ts_avg_buf[sizeof(struct pvt_tt_bh_rtio_data)];
  */
 void ReadTelemetryInternal(int64_t max_staleness, TelemetryInternalData *data)
 {
+	k_mutex_lock(&internal_data_lock, K_FOREVER);
+
 	int64_t reftime = last_update_time;
 
 	if (k_uptime_delta(&reftime) >= max_staleness) {
@@ -59,4 +69,43 @@ void ReadTelemetryInternal(int64_t max_staleness, TelemetryInternalData *data)
 	}
 
 	*data = internal_data;
+
+	k_mutex_unlock(&internal_data_lock);
+}
+
+/**
+ * @brief Get the current value of a telemetry tag
+ *
+ * Tags that the telemetry table only refreshes every 100 ms are read from their source, using
+ * the encoding of the telemetry table. All other tags are read from the telemetry table.
+ *
+ * @param tag The telemetry tag
+ * @param data Values from ReadTelemetryInternal
+ */
+uint32_t GetTelemetryInternalTag(uint16_t tag, const TelemetryInternalData *data)
+{
+	switch (tag) {
+	case TAG_VCORE:
+		return data->vcore_voltage;
+	case TAG_TDP:
+		return data->vcore_power;
+	case TAG_TDC:
+		return data->vcore_current;
+	case TAG_ASIC_TEMPERATURE:
+		return ConvertFloatToTelemetry(data->asic_temperature);
+	case TAG_AICLK: {
+		/* The measured clock, as in the telemetry table, not the DVFS target */
+		uint32_t rate = 0;
+
+		clock_control_get_rate(pll_dev_0,
+				       (clock_control_subsys_t)CLOCK_CONTROL_TT_BH_CLOCK_AICLK, &rate);
+		return rate;
+	}
+	case TAG_INPUT_POWER:
+		return GetInputPower();
+	case TAG_AICLK_THROTTLE_MASK:
+		return get_throttling_arb_mask();
+	default:
+		return GetTelemetryTag(tag);
+	}
 }
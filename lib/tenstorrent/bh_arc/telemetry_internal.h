@@ -16,5 +16,6 @@ typedef struct {
 } TelemetryInternalData;
 
 void ReadTelemetryInternal(int64_t max_staleness, TelemetryInternalData *data);
+uint32_t GetTelemetryInternalTag(uint16_t tag, const TelemetryInternalData *data);
 
 #endif
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "telemetry_stats.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+#include "telemetry.h"
+
+/* Tags that change faster than the 100 ms telemetry update */
+static const uint8_t stats_tags[] = {
+	TAG_VCORE, TAG_TDP, TAG_TDC, TAG_ASIC_TEMPERATURE, TAG_AICLK, TAG_INPUT_POWER,
+};
+
+static struct k_spinlock stats_lock;
+/* The first window of each tag starts at boot */
+static struct telemetry_stats stats[ARRAY_SIZE(stats_tags)];
+
+static int stats_slot(uint16_t tag)
+{
+	for (int i = 0; i < ARRAY_SIZE(stats_tags); i++) {
+		if (stats_tags[i] == tag) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+static void reset_slot(struct telemetry_stats *s, int64_t now_ms)
+{
+	*s = (struct telemetry_stats){.start_ms = now_ms};
+}
+
+/**
+ * @brief Add a sample to the current window of a tag
+ *
+ * @return false if statistics are not kept for the tag
+ */
+bool telemetry_stats_record(uint16_t tag, uint32_t value)
+{
+	int slot = stats_slot(tag);
+	int32_t v = (int32_t)value;
+
+	if (slot < 0) {
+		return false;
+	}
+
+	K_SPINLOCK(&stats_lock) {
+		struct telemetry_stats *s = &stats[slot];
+
+		s->min = s->count == 0 ? v : MIN(s->min, v);
+		s->max = s->count == 0 ? v : MAX(s->max, v);
+		s->sum += v;
+		s->count++;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Get the statistics of the current window of a tag
+ *
+ * @param reset Start a new window after reading
+ * @return false if statistics are not kept for the tag
+ */
+bool telemetry_stats_get(uint16_t tag, struct telemetry_stats *out, bool reset)
+{
+	int slot = stats_slot(tag);
+
+	if (slot < 0) {
+		return false;
+	}
+
+	int64_t now_ms = k_uptime_get();
+
+	K_SPINLOCK(&stats_lock) {
+		*out = stats[slot];
+		if (reset) {
+			reset_slot(&stats[slot], now_ms);
+		}
+	}
+
+	return true;
+}
+
+int32_t telemetry_stats_mean(const struct telemetry_stats *s)
+{
+	if (s->count == 0) {
+		return 0;
+	}
+
+	return (int32_t)(s->sum / s->count);
+}
+
+void telemetry_stats_reset(void)
+{
+	int64_t now_ms = k_uptime_get();
+
+	K_SPINLOCK(&stats_lock) {
+		for (int i = 0; i < ARRAY_SIZE(stats); i++) {
+			reset_slot(&stats[i], now_ms);
+		}
+	}
+}
+
+/**
+ * @brief Add a sample of every tracked tag
+ *
+ * Called once per control loop iteration (1 ms) with the values the control loop used.
+ */
+void telemetry_stats_sample(const TelemetryInternalData *data)
+{
+	for (int i = 0; i < ARRAY_SIZE(stats_tags); i++) {
+		telemetry_stats_record(stats_tags[i], GetTelemetryInternalTag(stats_tags[i], data));
+	}
+}
+
+/**
+ * @brief Handler for @ref TT_SMC_MSG_GET_TELEMETRY_STATS
+ * @see telemetry_stats_rqst
+ */
+static uint8_t telemetry_stats_handler(const union request *request, struct response *response)
+{
+	const struct telemetry_stats_rqst *rqst = &request->telemetry_stats;
+	struct telemetry_stats s;
+
+	if (!telemetry_stats_get(rqst->tag, &s, rqst->flags & TELEMETRY_STATS_FLAG_RESET)) {
+		return 1;
+	}
+
+	response->data[1] = s.min;
+	response->data[2] = s.max;
+	response->data[3] = telemetry_stats_mean(&s);
+	response->data[4] = s.count;
+	response->data[5] = (uint32_t)(k_uptime_get() - s.start_ms);
+
+	return 0;
+}
+
+REGISTER_MESSAGE(TT_SMC_MSG_GET_TELEMETRY_STATS, telemetry_stats_handler);
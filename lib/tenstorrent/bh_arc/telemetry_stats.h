@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef TELEMETRY_STATS_H
+#define TELEMETRY_STATS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "telemetry_internal.h"
+
+/* min and max are only valid when count is nonzero */
+struct telemetry_stats {
+	int32_t min;
+	int32_t max;
+	int64_t sum;
+	uint32_t count;
+	/* Uptime in milliseconds when the window started */
+	int64_t start_ms;
+};
+
+bool telemetry_stats_record(uint16_t tag, uint32_t value);
+bool telemetry_stats_get(uint16_t tag, struct telemetry_stats *stats, bool reset);
+int32_t telemetry_stats_mean(const struct telemetry_stats *stats);
+void telemetry_stats_reset(void);
+
+#ifdef CONFIG_TT_BH_ARC_TELEMETRY_STATS
+void telemetry_stats_sample(const TelemetryInternalData *data);
+#else
+static inline void telemetry_stats_sample(const TelemetryInternalData *data)
+{
+}
+#endif
+
+#endif
@@ -4,6 +4,10 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <math.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
 #include <zephyr/sys/util.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/sys/byteorder.h>
@@ -17,6 +21,7 @@
 #include "telemetry_internal.h"
 #include "telemetry.h"
 #include "noc2axi.h"
+#include "power_model.h"
 #include "tensix_state_msg.h"
 
 static uint32_t power_limit;
@@ -26,25 +31,17 @@ static bool doppler_slow;
 static bool doppler_t2;
 static bool doppler_t3;
 static const bool thermal_throttling = true;
+/* Throttlers the FW table allows to run, see LoadThrottlerTable */
+static uint32_t fwtable_enable_mask = BIT_MASK(kThrottlerCount);
 
 #define kThrottlerAiclkScaleFactor 500.0F
 #define DEFAULT_BOARD_POWER_LIMIT  150
+#define kThrottlerMaxGain          2.0F
 
 LOG_MODULE_REGISTER(throttler);
 
 static const struct device *const fwtable_dev = DEVICE_DT_GET(DT_NODELABEL(fwtable));
 
-typedef enum {
-	kThrottlerTDP,
-	kThrottlerFastTDC,
-	kThrottlerTDC,
-	kThrottlerThm,
-	kThrottlerBoardPower,
-	kThrottlerGDDRThm,
-	kThrottlerDopplerSlow,
-	kThrottlerCount,
-} ThrottlerId;
-
 typedef struct {
 	float min;
 	float max;
@@ -64,16 +61,10 @@ static const ThrottlerLimitRange throttler_limit_ranges[kThrottlerCount] = {
 };
 /* clang-format on */
 
-typedef struct {
-	float alpha_filter;
-	float p_gain;
-	float d_gain;
-} ThrottlerParams;
-
 typedef struct {
 	const enum aiclk_arb_max arb_max; /* The arbiter associated with this throttler */
 
-	const ThrottlerParams params;
+	ThrottlerParams params;
 	float limit;
 	float value;
 	float error;
@@ -142,17 +133,75 @@ static Throttler throttler[kThrottlerCount] = {
 };
 /* clang-format on */
 
+/* Protects the params and limit of each throttler, which are changed by host messages */
+static struct k_spinlock throttler_lock;
+
+/* The values replaced by the last successful TT_SMC_MSG_SET_THROTTLER_PARAMS, for rollback */
+static struct {
+	bool valid;
+	ThrottlerParams params;
+	float limit;
+	bool enabled;
+} saved_params[kThrottlerCount];
+
 static float get_throttler_clamped_limit(ThrottlerId id, float limit)
 {
 	return CLAMP(limit, throttler_limit_ranges[id].min, throttler_limit_ranges[id].max);
 }
 
-static void SetThrottlerLimit(ThrottlerId id, float limit)
+void SetThrottlerLimit(ThrottlerId id, float limit)
 {
 	float clamped_limit = get_throttler_clamped_limit(id, limit);
 
 	LOG_INF("Throttler %d limit set to %d", id, (uint32_t)clamped_limit);
-	throttler[id].limit = clamped_limit;
+	K_SPINLOCK(&throttler_lock) {
+		throttler[id].limit = clamped_limit;
+	}
+}
+
+float GetThrottlerLimit(ThrottlerId id)
+{
+	return throttler[id].limit;
+}
+
+void SetThrottlerParams(ThrottlerId id, const ThrottlerParams *params)
+{
+	K_SPINLOCK(&throttler_lock) {
+		throttler[id].params = *params;
+	}
+}
+
+void GetThrottlerParams(ThrottlerId id, ThrottlerParams *params)
+{
+	K_SPINLOCK(&throttler_lock) {
+		*params = throttler[id].params;
+	}
+}
+
+/* Whether the parameters keep the controller stable enough to be used on silicon */
+bool ValidThrottlerParams(const ThrottlerParams *params)
+{
+	return isfinite(params->alpha_filter) && params->alpha_filter > 0 &&
+	       params->alpha_filter <= 1 && isfinite(params->p_gain) && params->p_gain >= 0 &&
+	       params->p_gain <= kThrottlerMaxGain && isfinite(params->d_gain) &&
+	       params->d_gain >= 0 && params->d_gain <= kThrottlerMaxGain;
+}
+
+static void ResetDoppler(void);
+
+/* Clear the filter and controller state, e.g. before replaying a workload in simulation */
+void ResetThrottlers(void)
+{
+	for (ThrottlerId i = 0; i < kThrottlerCount; i++) {
+		Throttler *t = &throttler[i];
+
+		t->value = 0;
+		t->error = 0;
+		t->prev_error = 0;
+		t->output = 0;
+	}
+
+	ResetDoppler();
 }
 
 static uint32_t throttle_counter;
@@ -205,13 +254,54 @@ static void doppler_tensix_state_callback(const struct zbus_channel *chan)
 ZBUS_LISTENER_DEFINE(doppler_tensix_state_listener, doppler_tensix_state_callback);
 ZBUS_CHAN_ADD_OBS(tensix_state_chan, doppler_tensix_state_listener, 0);
 
-void InitThrottlers(void)
+/* Whether the Doppler setting runs a throttler, before the FW table enable mask */
+static bool throttler_mode_enabled(ThrottlerId id)
+{
+	switch (id) {
+	case kThrottlerTDP:
+	case kThrottlerFastTDC:
+	case kThrottlerTDC:
+	case kThrottlerBoardPower:
+		return !doppler;
+	case kThrottlerDopplerSlow:
+		return doppler_slow;
+	default:
+		return thermal_throttling;
+	}
+}
+
+static void enable_throttler_arbs(void)
 {
-	doppler = tt_bh_fwtable_get_fw_table(fwtable_dev)->feature_enable.doppler_en;
+	for (ThrottlerId i = 0; i < kThrottlerCount; i++) {
+		EnableArbMax(throttler[i].arb_max,
+			     (fwtable_enable_mask & BIT(i)) && throttler_mode_enabled(i));
+	}
+}
+
+/**
+ * @brief Switch the board power throttling between Doppler and the TDP, TDC and board power
+ * throttlers
+ *
+ * Throttlers disabled by the FW table enable mask stay disabled.
+ */
+void EnableDoppler(bool enable)
+{
+	doppler = enable;
 	doppler_slow = doppler;
 	doppler_t2 = doppler;
 	doppler_t3 = doppler;
 
+	enable_throttler_arbs();
+	EnableArbMax(aiclk_arb_max_doppler_critical, false); /* enabled when limit triggered */
+
+	power_model_reset();
+	SetAiclkArbMax(aiclk_arb_max_doppler_predict, GetAiclkFmax());
+	EnableArbMax(aiclk_arb_max_doppler_predict,
+		     doppler && IS_ENABLED(CONFIG_TT_BH_ARC_DOPPLER_PREDICT));
+}
+
+void InitThrottlers(void)
+{
 	SetThrottlerLimit(kThrottlerTDP,
 			  tt_bh_fwtable_get_fw_table(fwtable_dev)->chip_limits.tdp_limit);
 	SetThrottlerLimit(kThrottlerFastTDC,
@@ -228,27 +318,91 @@ void InitThrottlers(void)
 
 	InitKernelThrottling();
 
-	EnableArbMax(throttler[kThrottlerTDP].arb_max, !doppler);
-	EnableArbMax(throttler[kThrottlerFastTDC].arb_max, !doppler);
-	EnableArbMax(throttler[kThrottlerTDC].arb_max, !doppler);
-	EnableArbMax(throttler[kThrottlerBoardPower].arb_max, !doppler);
+	SetAiclkArbMax(aiclk_arb_max_doppler_critical, GetAiclkFmin());
+	EnableDoppler(tt_bh_fwtable_get_fw_table(fwtable_dev)->feature_enable.doppler_en);
+
+	LoadThrottlerTable(&tt_bh_fwtable_get_fw_table(fwtable_dev)->throttler_table);
+}
+
+static const FwTable_ThrottlerParams *
+get_fwtable_throttler_params(const FwTable_ThrottlerTable *table, ThrottlerId id)
+{
+	switch (id) {
+	case kThrottlerTDP:
+		return &table->tdp;
+	case kThrottlerFastTDC:
+		return &table->fast_tdc;
+	case kThrottlerTDC:
+		return &table->tdc;
+	case kThrottlerThm:
+		return &table->thm;
+	case kThrottlerBoardPower:
+		return &table->board_power;
+	case kThrottlerGDDRThm:
+		return &table->gddr_thm;
+	case kThrottlerDopplerSlow:
+		return &table->doppler_slow;
+	default:
+		return NULL;
+	}
+}
 
-	EnableArbMax(throttler[kThrottlerThm].arb_max, thermal_throttling);
-	EnableArbMax(throttler[kThrottlerGDDRThm].arb_max, thermal_throttling);
+/**
+ * @brief Apply the throttler overrides of the FW table on top of the defaults
+ *
+ * Throttlers without params_en keep their built-in gains, and a limit of 0 keeps the limit from
+ * chip_limits. Invalid gains are ignored with an error, so that a bad table can't make the
+ * throttlers unstable.
+ *
+ * The enable mask can only disable throttlers: a throttler runs if the mask allows it and the
+ * Doppler setting selects it, whichever of the two is applied first.
+ */
+void LoadThrottlerTable(const FwTable_ThrottlerTable *table)
+{
+	for (ThrottlerId i = 0; i < kThrottlerCount; i++) {
+		const FwTable_ThrottlerParams *fw_params = get_fwtable_throttler_params(table, i);
 
-	EnableArbMax(throttler[kThrottlerDopplerSlow].arb_max, doppler_slow);
+		if (!fw_params->params_en) {
+			continue;
+		}
 
-	SetAiclkArbMax(aiclk_arb_max_doppler_critical, GetAiclkFmin());
-	EnableArbMax(aiclk_arb_max_doppler_critical, false); /* enabled when limit triggered */
+		ThrottlerParams params = {
+			.alpha_filter = fw_params->alpha_filter,
+			.p_gain = fw_params->p_gain,
+			.d_gain = fw_params->d_gain,
+		};
+
+		if (ValidThrottlerParams(&params)) {
+			SetThrottlerParams(i, &params);
+		} else {
+			LOG_ERR("Ignoring invalid FW table params for throttler %d", i);
+		}
+
+		if (fw_params->limit != 0) {
+			SetThrottlerLimit(i, fw_params->limit);
+		}
+	}
+
+	if (table->enable_mask_en) {
+		fwtable_enable_mask = table->enable_mask;
+		enable_throttler_arbs();
+	}
 }
 
 static void UpdateThrottler(ThrottlerId id, float value)
 {
 	Throttler *t = &throttler[id];
+	ThrottlerParams params;
+	float limit;
+
+	K_SPINLOCK(&throttler_lock) {
+		params = t->params;
+		limit = t->limit;
+	}
 
-	t->value = t->params.alpha_filter * value + (1 - t->params.alpha_filter) * t->value;
-	t->error = (t->limit - t->value) / t->limit;
-	t->output = t->params.p_gain * t->error + t->params.d_gain * (t->error - t->prev_error);
+	t->value = params.alpha_filter * value + (1 - params.alpha_filter) * t->value;
+	t->error = (limit - t->value) / limit;
+	t->output = params.p_gain * t->error + params.d_gain * (t->error - t->prev_error);
 	t->prev_error = t->error;
 }
 
@@ -287,18 +441,50 @@ static uint16_t UpdateMovingAveragePower(uint16_t current_power)
 	return board_power_sum / ARRAY_SIZE(board_power_history);
 }
 
+/* The kernel throttling state is left alone, it has to stay in sync with the tensixes */
+static void ResetDoppler(void)
+{
+	memset(board_power_history, 0, sizeof(board_power_history));
+	board_power_history_cursor = board_power_history;
+	board_power_sum = 0;
+	t2_count = 0;
+	t3_count = 0;
+
+	power_model_reset();
+}
+
 static bool DopplerActive(void)
 {
 	return doppler && power_limit > 0;
 }
 
-static void UpdateDoppler(const TelemetryInternalData *telemetry)
+#ifdef CONFIG_TT_BH_ARC_DOPPLER_PREDICT
+/* Cap AICLK where the input power at the recent peak activity is predicted to reach the limit
+ * times the headroom. The headroom is below the T2 threshold, so that a burst is throttled before
+ * it can trigger critical throttling, and above 1, so that the slow loop still sets the average.
+ */
+static void UpdateDopplerPredict(const ThrottlerInputs *inputs)
+{
+	float limit = power_limit * CONFIG_TT_BH_ARC_DOPPLER_PREDICT_HEADROOM / 100.0F;
+
+	power_model_update(inputs->aiclk, inputs->vcore_voltage, inputs->asic_temperature,
+			   inputs->vcore_power, inputs->input_power);
+	SetAiclkArbMax(aiclk_arb_max_doppler_predict,
+		       power_model_max_aiclk(limit, inputs->asic_temperature));
+}
+#endif
+
+static void UpdateDoppler(const ThrottlerInputs *inputs)
 {
-	uint16_t current_power = GetInputPower();
+	uint16_t current_power = inputs->input_power;
 	uint16_t average_power = UpdateMovingAveragePower(current_power);
 
 	UpdateThrottler(kThrottlerDopplerSlow, average_power);
 
+#ifdef CONFIG_TT_BH_ARC_DOPPLER_PREDICT
+	UpdateDopplerPredict(inputs);
+#endif
+
 	/* Doppler T2 throttler: 2x power limit for 10 consecutive samples */
 	uint32_t t2_power_limit = power_limit * 2;
 
@@ -342,45 +528,68 @@ static void UpdateDoppler(const TelemetryInternalData *telemetry)
 	EnableArbMax(aiclk_arb_max_doppler_critical, critical_throttling);
 }
 
-void CalculateThrottlers(void)
+/**
+ * @brief Run one iteration of the throttlers and update their AICLK arbiters
+ *
+ * This is the part of CalculateThrottlers that doesn't touch hardware, so that it can be driven
+ * by a plant model in simulation.
+ */
+void UpdateThrottlers(const ThrottlerInputs *inputs)
 {
-	TelemetryInternalData telemetry_internal_data;
-
-	ReadTelemetryInternal(1, &telemetry_internal_data);
-
 	if (DopplerActive()) {
-		UpdateDoppler(&telemetry_internal_data);
+		UpdateDoppler(inputs);
 	} else {
-		UpdateThrottler(kThrottlerTDP, telemetry_internal_data.vcore_power);
-		UpdateThrottler(kThrottlerFastTDC, telemetry_internal_data.vcore_current);
-		UpdateThrottler(kThrottlerTDC, telemetry_internal_data.vcore_current);
-		UpdateThrottler(kThrottlerBoardPower, GetInputPower());
+		UpdateThrottler(kThrottlerTDP, inputs->vcore_power);
+		UpdateThrottler(kThrottlerFastTDC, inputs->vcore_current);
+		UpdateThrottler(kThrottlerTDC, inputs->vcore_current);
+		UpdateThrottler(kThrottlerBoardPower, inputs->input_power);
 	}
 
-	UpdateThrottler(kThrottlerThm, telemetry_internal_data.asic_temperature);
-	UpdateThrottler(kThrottlerGDDRThm, GetMaxGDDRTemp());
+	UpdateThrottler(kThrottlerThm, inputs->asic_temperature);
+	UpdateThrottler(kThrottlerGDDRThm, inputs->gddr_temperature);
 
 	for (ThrottlerId i = 0; i < kThrottlerCount; i++) {
 		UpdateThrottlerArb(i);
 	}
 }
 
-int32_t Dm2CmSetBoardPowerLimit(const uint8_t *data, uint8_t size)
+void CalculateThrottlers(const TelemetryInternalData *telemetry_internal_data)
 {
-	if (size != 2) {
-		return -1;
-	}
-
-	power_limit = sys_get_le16(data);
+	ThrottlerInputs inputs = {
+		.vcore_power = telemetry_internal_data->vcore_power,
+		.vcore_current = telemetry_internal_data->vcore_current,
+		.asic_temperature = telemetry_internal_data->asic_temperature,
+		.input_power = GetInputPower(),
+		.gddr_temperature = GetMaxGDDRTemp(),
+		.aiclk = GetAiclkTarg(),
+		.vcore_voltage = telemetry_internal_data->vcore_voltage,
+	};
+
+	UpdateThrottlers(&inputs);
+}
 
-	LOG_INF("Cable Power Limit: %u", power_limit);
-	power_limit = MIN(power_limit,
-			  tt_bh_fwtable_get_fw_table(fwtable_dev)->chip_limits.board_power_limit);
+/* Board input power limit in W, 0 turns Doppler off */
+void SetBoardPowerLimit(uint32_t limit)
+{
+	power_limit = limit;
 
 	SetThrottlerLimit(kThrottlerBoardPower, power_limit);
 	SetThrottlerLimit(kThrottlerDopplerSlow, power_limit);
 
 	UpdateTelemetryBoardPowerLimit(power_limit);
+}
+
+int32_t Dm2CmSetBoardPowerLimit(const uint8_t *data, uint8_t size)
+{
+	if (size != 2) {
+		return -1;
+	}
+
+	uint32_t limit = sys_get_le16(data);
+
+	LOG_INF("Cable Power Limit: %u", limit);
+	SetBoardPowerLimit(
+		MIN(limit, tt_bh_fwtable_get_fw_table(fwtable_dev)->chip_limits.board_power_limit));
 
 	return 0;
 }
@@ -414,3 +623,96 @@ static uint8_t set_tdp_limit_handler(const union request *request, struct respon
 }
 
 REGISTER_MESSAGE(TT_SMC_MSG_SET_TDP_LIMIT, set_tdp_limit_handler);
+
+static bool throttler_arb_enabled(ThrottlerId id)
+{
+	return get_enabled_arb_max_bitmask() & BIT(throttler[id].arb_max);
+}
+
+static void apply_throttler_params(ThrottlerId id, const ThrottlerParams *params, float limit,
+				   bool enabled)
+{
+	/* Together, so that no iteration sees the new gains with the old limit */
+	K_SPINLOCK(&throttler_lock) {
+		throttler[id].params = *params;
+		throttler[id].limit = get_throttler_clamped_limit(id, limit);
+	}
+	EnableArbMax(throttler[id].arb_max, enabled);
+
+	if (id == kThrottlerTDP) {
+		UpdateTelemetryTdpLimit(throttler[kThrottlerTDP].limit);
+	}
+}
+
+/**
+ * @brief Handler for @ref TT_SMC_MSG_SET_THROTTLER_PARAMS
+ *
+ * The whole request is validated before anything is changed, so a rejected request leaves the
+ * throttler as it was.
+ */
+static uint8_t throttler_params_handler(const union request *request, struct response *response)
+{
+	const struct throttler_params_rqst *rqst = &request->throttler_params;
+	ThrottlerId id = rqst->throttler;
+
+	if (id >= kThrottlerCount) {
+		return 1;
+	}
+
+	ThrottlerParams params;
+
+	GetThrottlerParams(id, &params);
+	float limit = GetThrottlerLimit(id);
+	bool enabled = throttler_arb_enabled(id);
+
+	if (rqst->flags & THROTTLER_PARAMS_FLAG_ROLLBACK) {
+		if (!saved_params[id].valid) {
+			return 1;
+		}
+
+		apply_throttler_params(id, &saved_params[id].params, saved_params[id].limit,
+				       saved_params[id].enabled);
+		saved_params[id].valid = false;
+	} else if (!(rqst->flags & THROTTLER_PARAMS_FLAG_QUERY)) {
+		ThrottlerParams new_params = {
+			.alpha_filter = ConvertTelemetryToFloat(rqst->alpha_filter),
+			.p_gain = ConvertTelemetryToFloat(rqst->p_gain),
+			.d_gain = ConvertTelemetryToFloat(rqst->d_gain),
+		};
+		float new_limit = rqst->limit != 0 ? rqst->limit : limit;
+		bool new_enabled = enabled;
+
+		if ((rqst->flags & THROTTLER_PARAMS_FLAG_ENABLE) &&
+		    (rqst->flags & THROTTLER_PARAMS_FLAG_DISABLE)) {
+			return 1;
+		} else if (rqst->flags & THROTTLER_PARAMS_FLAG_ENABLE) {
+			new_enabled = true;
+		} else if (rqst->flags & THROTTLER_PARAMS_FLAG_DISABLE) {
+			new_enabled = false;
+		}
+
+		if (!ValidThrottlerParams(&new_params)) {
+			return 1;
+		} else if (get_throttler_clamped_limit(id, new_limit) != new_limit) {
+			return 1;
+		}
+
+		saved_params[id].valid = true;
+		saved_params[id].params = params;
+		saved_params[id].limit = limit;
+		saved_params[id].enabled = enabled;
+
+		apply_throttler_params(id, &new_params, new_limit, new_enabled);
+	}
+
+	GetThrottlerParams(id, &params);
+	response->data[1] = GetThrottlerLimit(id);
+	response->data[2] = ConvertFloatToTelemetry(params.alpha_filter);
+	response->data[3] = ConvertFloatToTelemetry(params.p_gain);
+	response->data[4] = ConvertFloatToTelemetry(params.d_gain);
+	response->data[5] = throttler_arb_enabled(id);
+
+	return 0;
+}
+
+REGISTER_MESSAGE(TT_SMC_MSG_SET_THROTTLER_PARAMS, throttler_params_handler);
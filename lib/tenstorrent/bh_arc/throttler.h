@@ -6,8 +6,53 @@
 #ifndef THROTTLER_H
 #define THROTTLER_H
 
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zephyr/drivers/misc/bh_fwtable.h>
+
+#include "telemetry_internal.h"
+
+typedef enum {
+	kThrottlerTDP,
+	kThrottlerFastTDC,
+	kThrottlerTDC,
+	kThrottlerThm,
+	kThrottlerBoardPower,
+	kThrottlerGDDRThm,
+	kThrottlerDopplerSlow,
+	kThrottlerCount,
+} ThrottlerId;
+
+typedef struct {
+	float alpha_filter;
+	float p_gain;
+	float d_gain;
+} ThrottlerParams;
+
+/* The measurements the throttlers act on, sampled once per DVFS iteration */
+typedef struct {
+	float vcore_power;      /* W */
+	float vcore_current;    /* A */
+	float asic_temperature; /* degC */
+	float input_power;      /* W */
+	float gddr_temperature; /* degC */
+	float aiclk;            /* MHz, the AICLK the other inputs were measured at */
+	float vcore_voltage;    /* mV */
+} ThrottlerInputs;
+
 void InitThrottlers(void);
-void CalculateThrottlers(void);
+void EnableDoppler(bool enable);
+void SetBoardPowerLimit(uint32_t limit);
+void CalculateThrottlers(const TelemetryInternalData *telemetry_internal_data);
+void UpdateThrottlers(const ThrottlerInputs *inputs);
+void ResetThrottlers(void);
+void SetThrottlerLimit(ThrottlerId id, float limit);
+float GetThrottlerLimit(ThrottlerId id);
+void SetThrottlerParams(ThrottlerId id, const ThrottlerParams *params);
+void GetThrottlerParams(ThrottlerId id, ThrottlerParams *params);
+bool ValidThrottlerParams(const ThrottlerParams *params);
+void LoadThrottlerTable(const FwTable_ThrottlerTable *table);
 int32_t Dm2CmSetBoardPowerLimit(const uint8_t *data, uint8_t size);
 
 #endif
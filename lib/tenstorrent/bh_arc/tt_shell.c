@@ -15,6 +15,7 @@
 #include "gddr.h"
 #include "asic_state.h"
 #include "noc_init.h"
+#include "msgqueue_stats.h"
 LOG_MODULE_REGISTER(tt_shell, CONFIG_LOG_DEFAULT_LEVEL);
 
 static int l2cpu_enable_handler(const struct shell *sh, size_t argc, char **argv)
@@ -148,12 +149,65 @@ static int telem_handler(const struct shell *sh, size_t argc, char **argv)
 	return 0;
 }
 
+static void msgstats_print_hist(const struct shell *sh, const char *name, const uint32_t *hist)
+{
+	shell_fprintf(sh, SHELL_NORMAL, "  %s:", name);
+	for (int i = 0; i < MSGQUEUE_STATS_NUM_BUCKETS; i++) {
+		if (hist[i] != 0) {
+			/* Print the lower bound of each non-empty bucket in cycles */
+			uint32_t lower = i == 0 ? 0 : BIT(MSGQUEUE_STATS_BUCKET_SHIFT + i - 1);
+
+			shell_fprintf(sh, SHELL_NORMAL, " %u:%u", lower, hist[i]);
+		}
+	}
+	shell_fprintf(sh, SHELL_NORMAL, "\n");
+}
+
+static int msgstats_handler(const struct shell *sh, size_t argc, char **argv)
+{
+	struct msgqueue_stats stats;
+
+	if (argc == 2) {
+		if (strcmp(argv[1], "clear") != 0) {
+			shell_error(sh, "Invalid argument");
+			return -EINVAL;
+		}
+		msgqueue_stats_clear();
+		shell_print(sh, "OK");
+		return 0;
+	}
+
+	shell_print(sh, "%u ms, %u dropped, %u cycles/us", msgqueue_stats_elapsed_ms(),
+		    msgqueue_stats_dropped(), sys_clock_hw_cycles_per_sec() / USEC_PER_SEC);
+	shell_print(sh, "code  count      wait max/mean (us)   exec max/mean (us)");
+
+	for (uint32_t code = 0; code < CONFIG_TT_BH_ARC_NUM_MSG_CODES; code++) {
+		if (!msgqueue_stats_get(code, &stats) || stats.count == 0) {
+			continue;
+		}
+
+		shell_print(sh, "0x%02X  %-9u  %8u/%-8u    %8u/%-8u", code, stats.count,
+			    k_cyc_to_us_floor32(stats.max_cycles[MSGQUEUE_STATS_HIST_WAIT]),
+			    k_cyc_to_us_floor32(stats.total_cycles[MSGQUEUE_STATS_HIST_WAIT] /
+						stats.count),
+			    k_cyc_to_us_floor32(stats.max_cycles[MSGQUEUE_STATS_HIST_EXEC]),
+			    k_cyc_to_us_floor32(stats.total_cycles[MSGQUEUE_STATS_HIST_EXEC] /
+						stats.count));
+		msgstats_print_hist(sh, "wait", stats.hist[MSGQUEUE_STATS_HIST_WAIT]);
+		msgstats_print_hist(sh, "exec", stats.hist[MSGQUEUE_STATS_HIST_EXEC]);
+	}
+
+	return 0;
+}
+
 SHELL_STATIC_SUBCMD_SET_CREATE(
 	sub_tt_commands, SHELL_CMD_ARG(mrisc_power, NULL, "[off|on]", mrisc_power_handler, 2, 0),
 	SHELL_CMD_ARG(tensix_power, NULL, "[off|on]", tensix_enable_handler, 2, 0),
 	SHELL_CMD_ARG(l2cpu_power, NULL, "[off|on]", l2cpu_enable_handler, 2, 0),
 	SHELL_CMD_ARG(asic_state, NULL, "[|0|3]", asic_state_handler, 1, 1),
 	SHELL_CMD_ARG(telem, NULL, "<Telemetry Index> [|x|f|d]", telem_handler, 2, 1),
+	SHELL_COND_CMD_ARG(CONFIG_TT_BH_ARC_MSGQUEUE_STATS, msgstats, NULL, "[clear]",
+			   msgstats_handler, 1, 1),
 	SHELL_SUBCMD_SET_END);
 
 SHELL_CMD_REGISTER(tt, &sub_tt_commands, "Tensorrent commands", NULL);
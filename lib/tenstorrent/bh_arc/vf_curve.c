@@ -4,6 +4,8 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <math.h>
+
 #include <zephyr/sys/util.h>
 #include "aiclk_ppm.h"
 #include "vf_curve.h"
@@ -12,6 +14,12 @@
 #include <tenstorrent/smc_msg.h>
 #include "functional_efuse.h"
 
+#ifdef CONFIG_ZTEST
+#define STATIC
+#else
+#define STATIC static
+#endif
+
 /* Bounds checks for frequency and voltage margin */
 #define FREQ_MARGIN_MAX    300.0F
 #define FREQ_MARGIN_MIN    -300.0F
@@ -44,6 +52,18 @@
 #define VF_LINEAR_COEFF    -0.43953F
 #define VF_CONSTANT        828.83F
 
+/* The VF table covers the AICLK range in steps of 1 << VF_TABLE_STEP_SHIFT MHz, with one extra
+ * entry so that VF_TABLE_FMAX_MHZ can be interpolated.
+ */
+#define VF_TABLE_FMIN_MHZ   200
+#define VF_TABLE_FMAX_MHZ   1400
+#define VF_TABLE_STEP_SHIFT 4
+#define VF_TABLE_STEP_MHZ   BIT(VF_TABLE_STEP_SHIFT)
+#define VF_TABLE_ENTRIES    (((VF_TABLE_FMAX_MHZ - VF_TABLE_FMIN_MHZ) >> VF_TABLE_STEP_SHIFT) + 2)
+
+/* Table voltages are unsigned 16.16 fixed point mV */
+#define VF_TABLE_FRAC_BITS 16
+
 static float freq_margin_mhz = FREQ_MARGIN_MAX;
 static float voltage_margin_mv = VOLTAGE_MARGIN_MAX;
 static uint32_t process_RO;
@@ -57,15 +77,95 @@ static bool process_is_ss;
 static float vf_ro_base;
 static float vf_freq_linear;
 
+/* The smooth part of the model at VF_TABLE_FMIN_MHZ + i * VF_TABLE_STEP_MHZ. The FF margin step
+ * is added after interpolation, as interpolating across it would be off by up to the whole step.
+ */
+static uint32_t vf_table[VF_TABLE_ENTRIES];
+static uint32_t vf_step_freq_mhz;
+static uint32_t vf_step_mv;
+static bool vf_table_valid;
+
 static const struct device *const fwtable_dev = DEVICE_DT_GET(DT_NODELABEL(fwtable));
 
-void InitVFCurve(void)
+/* Evaluations of the float model, for the tests to check which paths avoid it */
+STATIC uint32_t vf_model_evals;
+
+/* The model without the margin step of FF parts, which is smooth in freq_mhz */
+static float vf_model_smooth(float freq_mhz)
 {
-	process_RO = READ_FUNCTIONAL_EFUSE(PROCESS_RO);
+	vf_model_evals++;
 
-	uint8_t board_type = tt_bh_fwtable_get_board_type(fwtable_dev);
+	if (!use_process_vf_curve) {
+		float freq_with_margin_mhz = freq_mhz + freq_margin_mhz;
+		float voltage_mv =
+			VF_QUADRATIC_COEFF * freq_with_margin_mhz * freq_with_margin_mhz +
+			VF_LINEAR_COEFF * freq_with_margin_mhz + VF_CONSTANT;
+
+		return voltage_mv + voltage_margin_mv;
+	}
+
+	float voltage_margin = process_is_ss ? SS_MARGIN_MV : FF_LOW_FREQ_MARGIN_MV;
+	float freq_n = (freq_mhz - FREQ_NORM_MEAN) / FREQ_NORM_STD;
+
+	float voltage_mv =
+		vf_ro_base + vf_freq_linear * freq_n + VF_COEFF_FREQ_SQ * freq_n * freq_n;
+
+	return voltage_mv + voltage_margin;
+}
+
+static bool vf_model_has_step(void)
+{
+	return use_process_vf_curve && !process_is_ss;
+}
+
+/**
+ * @brief Evaluate the VF model directly, without the table
+ *
+ * @param freq_mhz The frequency in MHz
+ * @return The voltage in mV
+ */
+float VFCurveModel(float freq_mhz)
+{
+	float voltage_mv = vf_model_smooth(freq_mhz);
+
+	if (vf_model_has_step() && freq_mhz >= FREQ_THRESHOLD_MHZ) {
+		voltage_mv += FF_HIGH_FREQ_MARGIN_MV - FF_LOW_FREQ_MARGIN_MV;
+	}
+
+	return voltage_mv;
+}
+
+static void build_vf_table(void)
+{
+	vf_table_valid = false;
+
+	for (uint32_t i = 0; i < VF_TABLE_ENTRIES; i++) {
+		float voltage_mv = vf_model_smooth(VF_TABLE_FMIN_MHZ + i * VF_TABLE_STEP_MHZ);
+
+		/* Round up, the table must not ask for less voltage than the model */
+		vf_table[i] = MAX(ceilf(voltage_mv * BIT(VF_TABLE_FRAC_BITS)), 0.0F);
+	}
+
+	if (vf_model_has_step()) {
+		vf_step_freq_mhz = FREQ_THRESHOLD_MHZ;
+		vf_step_mv = FF_HIGH_FREQ_MARGIN_MV - FF_LOW_FREQ_MARGIN_MV;
+	} else {
+		vf_step_freq_mhz = UINT32_MAX;
+		vf_step_mv = 0;
+	}
+
+	vf_table_valid = true;
+}
 
-	use_process_vf_curve = (process_RO != 0) && (board_type != BOARDTYPE_P300C);
+/**
+ * @brief Select the VF model for the process corner of the chip and rebuild the VF table
+ *
+ * @param process_ro The PROCESS_RO efuse value, 0 to use the legacy curve
+ */
+void SetVFCurveProcess(uint32_t process_ro)
+{
+	process_RO = process_ro;
+	use_process_vf_curve = process_RO != 0;
 	process_is_ss = process_RO < RO_SS_THRESHOLD;
 
 	if (use_process_vf_curve) {
@@ -75,59 +175,74 @@ void InitVFCurve(void)
 		vf_freq_linear = VF_COEFF_FREQ + VF_COEFF_RO_FREQ * ro_n;
 	}
 
-	freq_margin_mhz =
-		CLAMP(tt_bh_fwtable_get_fw_table(fwtable_dev)->chip_limits.frequency_margin,
-		      FREQ_MARGIN_MIN, FREQ_MARGIN_MAX);
-	voltage_margin_mv =
-		CLAMP(tt_bh_fwtable_get_fw_table(fwtable_dev)->chip_limits.voltage_margin,
-		      VOLTAGE_MARGIN_MIN, VOLTAGE_MARGIN_MAX);
+	build_vf_table();
+}
+
+/**
+ * @brief Set the VF margins and rebuild the VF table
+ *
+ * The table isn't synchronized with DVFSChange, so this must run before DVFS starts or on the
+ * control work queue.
+ *
+ * @param freq_margin The frequency margin in MHz, clamped to +-300 MHz
+ * @param voltage_margin The voltage margin in mV, clamped to +-150 mV
+ */
+void SetVFCurveMargins(float freq_margin, float voltage_margin)
+{
+	freq_margin_mhz = CLAMP(freq_margin, FREQ_MARGIN_MIN, FREQ_MARGIN_MAX);
+	voltage_margin_mv = CLAMP(voltage_margin, VOLTAGE_MARGIN_MIN, VOLTAGE_MARGIN_MAX);
+
+	build_vf_table();
+}
+
+void InitVFCurve(void)
+{
+	uint32_t process_ro = READ_FUNCTIONAL_EFUSE(PROCESS_RO);
+	uint8_t board_type = tt_bh_fwtable_get_board_type(fwtable_dev);
+
+	/* P300C uses the legacy curve */
+	SetVFCurveProcess(board_type != BOARDTYPE_P300C ? process_ro : 0);
+	SetVFCurveMargins(tt_bh_fwtable_get_fw_table(fwtable_dev)->chip_limits.frequency_margin,
+			  tt_bh_fwtable_get_fw_table(fwtable_dev)->chip_limits.voltage_margin);
 }
 
 /**
  * @brief Calculate the voltage based on the frequency
  *
+ * Interpolates the VF table in fixed point, only frequencies outside of the AICLK range fall
+ * back to the model. Interpolating the convex model errs high, by less than 0.1 mV.
+ *
  * @param freq_mhz The frequency in MHz
- * @return The voltage in mV
+ * @return The voltage in mV, rounded up
  */
-float VFCurve(float freq_mhz)
+uint32_t VFCurve(uint32_t freq_mhz)
 {
-	if (!use_process_vf_curve) {
-		float freq_with_margin_mhz = freq_mhz + freq_margin_mhz;
-		float voltage_mv =
-			VF_QUADRATIC_COEFF * freq_with_margin_mhz * freq_with_margin_mhz +
-			VF_LINEAR_COEFF * freq_with_margin_mhz + VF_CONSTANT;
+	if (!vf_table_valid || freq_mhz < VF_TABLE_FMIN_MHZ || freq_mhz > VF_TABLE_FMAX_MHZ) {
+		float voltage_mv = VFCurveModel(freq_mhz);
 
-		return voltage_mv + voltage_margin_mv;
+		return voltage_mv > 0.0F ? (uint32_t)ceilf(voltage_mv) : 0U;
 	}
 
-	float voltage_margin;
-
-	if (process_is_ss) {
-		voltage_margin = SS_MARGIN_MV;
-	} else {
-		voltage_margin = (freq_mhz >= FREQ_THRESHOLD_MHZ) ? FF_HIGH_FREQ_MARGIN_MV
-								  : FF_LOW_FREQ_MARGIN_MV;
-	}
+	uint32_t offset = freq_mhz - VF_TABLE_FMIN_MHZ;
+	uint32_t i = offset >> VF_TABLE_STEP_SHIFT;
+	uint32_t frac = offset & (VF_TABLE_STEP_MHZ - 1);
+	/* The curve has its minimum within the AICLK range, so the slope can be negative */
+	int32_t slope = (int32_t)(vf_table[i + 1] - vf_table[i]);
+	uint32_t voltage = vf_table[i] + slope * (int32_t)frac / (int32_t)VF_TABLE_STEP_MHZ;
 
-	float freq_n = (freq_mhz - FREQ_NORM_MEAN) / FREQ_NORM_STD;
+	voltage = DIV_ROUND_UP(voltage, BIT(VF_TABLE_FRAC_BITS));
 
-	float voltage_mv =
-		vf_ro_base + vf_freq_linear * freq_n + VF_COEFF_FREQ_SQ * freq_n * freq_n;
+	if (freq_mhz >= vf_step_freq_mhz) {
+		voltage += vf_step_mv;
+	}
 
-	return voltage_mv + voltage_margin;
+	return voltage;
 }
 
 static uint8_t get_voltage_curve_from_freq_handler(const union request *request,
 						   struct response *response)
 {
-	float input_freq_mhz = (float)request->get_voltage_curve_from_freq.input_freq_mhz;
-	float voltage_mv = VFCurve(input_freq_mhz);
-
-	if (voltage_mv < 0.0F) {
-		response->data[1] = 0U;
-	} else {
-		response->data[1] = (uint32_t)(voltage_mv);
-	}
+	response->data[1] = VFCurve(request->get_voltage_curve_from_freq.input_freq_mhz);
 
 	return 0;
 }
@@ -143,5 +258,31 @@ static uint8_t get_freq_curve_from_voltage_handler(const union request *request,
 	return 0;
 }
 
+static uint8_t get_vf_table_handler(const union request *request, struct response *response)
+{
+	uint32_t first_entry = request->vf_table.first_entry;
+
+	if (!vf_table_valid || first_entry >= VF_TABLE_ENTRIES) {
+		return 1;
+	}
+
+	response->data[1] = VF_TABLE_ENTRIES;
+	response->data[2] = VF_TABLE_FMIN_MHZ + first_entry * VF_TABLE_STEP_MHZ;
+	response->data[3] = VF_TABLE_STEP_MHZ;
+
+	for (uint32_t i = 0; i < 4 && first_entry + i < VF_TABLE_ENTRIES; i++) {
+		uint32_t freq_mhz = response->data[2] + i * VF_TABLE_STEP_MHZ;
+		uint32_t voltage = vf_table[first_entry + i];
+
+		if (freq_mhz >= vf_step_freq_mhz) {
+			voltage += vf_step_mv << VF_TABLE_FRAC_BITS;
+		}
+		response->data[4 + i] = voltage;
+	}
+
+	return 0;
+}
+
 REGISTER_MESSAGE(TT_SMC_MSG_GET_VOLTAGE_CURVE_FROM_FREQ, get_voltage_curve_from_freq_handler);
 REGISTER_MESSAGE(TT_SMC_MSG_GET_FREQ_CURVE_FROM_VOLTAGE, get_freq_curve_from_voltage_handler);
+REGISTER_MESSAGE(TT_SMC_MSG_GET_VF_TABLE, get_vf_table_handler);
@@ -6,6 +6,11 @@
 #ifndef VF_CURVE_H
 #define VF_CURVE_H
 
+#include <stdint.h>
+
 void InitVFCurve(void);
-float VFCurve(float freq_mhz);
+void SetVFCurveProcess(uint32_t process_ro);
+void SetVFCurveMargins(float freq_margin, float voltage_margin);
+uint32_t VFCurve(uint32_t freq_mhz);
+float VFCurveModel(float freq_mhz);
 #endif
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "work_queue.h"
+
+#include <tenstorrent/sys_init_defines.h>
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+
+#ifdef CONFIG_TT_BH_ARC_WORK_QUEUES
+
+K_THREAD_STACK_DEFINE(control_wq_stack, CONFIG_TT_BH_ARC_WORK_QUEUE_CONTROL_STACK_SIZE);
+K_THREAD_STACK_DEFINE(host_msg_wq_stack, CONFIG_TT_BH_ARC_WORK_QUEUE_HOST_MSG_STACK_SIZE);
+K_THREAD_STACK_DEFINE(background_wq_stack, CONFIG_TT_BH_ARC_WORK_QUEUE_BACKGROUND_STACK_SIZE);
+K_THREAD_STACK_DEFINE(flash_wq_stack, CONFIG_TT_BH_ARC_WORK_QUEUE_FLASH_STACK_SIZE);
+
+static struct k_work_q work_queues[TT_WORK_QUEUE_COUNT];
+
+struct work_queue_config {
+	k_thread_stack_t *stack;
+	size_t stack_size;
+	int priority;
+	const char *name;
+};
+
+/* clang-format off */
+static const struct work_queue_config work_queue_configs[TT_WORK_QUEUE_COUNT] = {
+	[TT_WORK_QUEUE_CONTROL] = {
+		.stack = control_wq_stack,
+		.stack_size = K_THREAD_STACK_SIZEOF(control_wq_stack),
+		.priority = CONFIG_TT_BH_ARC_WORK_QUEUE_CONTROL_PRIORITY,
+		.name = "tt_wq_control",
+	},
+	[TT_WORK_QUEUE_HOST_MSG] = {
+		.stack = host_msg_wq_stack,
+		.stack_size = K_THREAD_STACK_SIZEOF(host_msg_wq_stack),
+		.priority = CONFIG_TT_BH_ARC_WORK_QUEUE_HOST_MSG_PRIORITY,
+		.name = "tt_wq_host_msg",
+	},
+	[TT_WORK_QUEUE_BACKGROUND] = {
+		.stack = background_wq_stack,
+		.stack_size = K_THREAD_STACK_SIZEOF(background_wq_stack),
+		.priority = CONFIG_TT_BH_ARC_WORK_QUEUE_BACKGROUND_PRIORITY,
+		.name = "tt_wq_background",
+	},
+	[TT_WORK_QUEUE_FLASH] = {
+		.stack = flash_wq_stack,
+		.stack_size = K_THREAD_STACK_SIZEOF(flash_wq_stack),
+		.priority = CONFIG_TT_BH_ARC_WORK_QUEUE_FLASH_PRIORITY,
+		.name = "tt_wq_flash",
+	},
+};
+/* clang-format on */
+
+BUILD_ASSERT(CONFIG_TT_BH_ARC_WORK_QUEUE_CONTROL_PRIORITY <
+		     CONFIG_TT_BH_ARC_WORK_QUEUE_HOST_MSG_PRIORITY,
+	     "Control work queue must have a higher priority than host messages");
+BUILD_ASSERT(CONFIG_TT_BH_ARC_WORK_QUEUE_HOST_MSG_PRIORITY <=
+		     CONFIG_TT_BH_ARC_WORK_QUEUE_BACKGROUND_PRIORITY,
+	     "Host message work queue must not have a lower priority than background work");
+BUILD_ASSERT(CONFIG_TT_BH_ARC_WORK_QUEUE_BACKGROUND_PRIORITY <=
+		     CONFIG_TT_BH_ARC_WORK_QUEUE_FLASH_PRIORITY,
+	     "Flash writes must not have a higher priority than background work");
+/* A cooperative host message queue could never be preempted by the control loop. */
+BUILD_ASSERT(CONFIG_TT_BH_ARC_WORK_QUEUE_HOST_MSG_PRIORITY >= 0,
+	     "Host message work queue must be preemptible");
+
+static int init_work_queues(void)
+{
+	for (int i = 0; i < TT_WORK_QUEUE_COUNT; i++) {
+		const struct work_queue_config *config = &work_queue_configs[i];
+		struct k_work_queue_config cfg = {
+			.name = config->name,
+			.no_yield = false,
+		};
+
+		k_work_queue_start(&work_queues[i], config->stack, config->stack_size,
+				   config->priority, &cfg);
+	}
+
+	return 0;
+}
+SYS_INIT_APP(init_work_queues);
+
+struct k_work_q *tt_work_queue_get(enum tt_work_queue queue)
+{
+	if (queue >= TT_WORK_QUEUE_COUNT) {
+		return &k_sys_work_q;
+	}
+
+	return &work_queues[queue];
+}
+
+#else
+
+struct k_work_q *tt_work_queue_get(enum tt_work_queue queue)
+{
+	ARG_UNUSED(queue);
+
+	return &k_sys_work_q;
+}
+
+#endif
+
+int tt_work_submit(enum tt_work_queue queue, struct k_work *work)
+{
+	return k_work_submit_to_queue(tt_work_queue_get(queue), work);
+}
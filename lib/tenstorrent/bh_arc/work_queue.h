@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef WORK_QUEUE_H
+#define WORK_QUEUE_H
+
+#include <zephyr/kernel.h>
+
+/**
+ * @brief Work queue classes, in decreasing priority order.
+ *
+ * Periodic firmware tasks are submitted to the queue matching their latency requirements so that
+ * a slow task (e.g. an EEPROM write requested by the host) cannot delay the DVFS control loop.
+ */
+enum tt_work_queue {
+	/** @brief Real-time control loops, e.g. DVFS and throttlers */
+	TT_WORK_QUEUE_CONTROL,
+	/** @brief Host message queue processing */
+	TT_WORK_QUEUE_HOST_MSG,
+	/** @brief Background tasks, e.g. telemetry and fan control */
+	TT_WORK_QUEUE_BACKGROUND,
+	/** @brief SPI flash writes, whose sector erases block for milliseconds */
+	TT_WORK_QUEUE_FLASH,
+	TT_WORK_QUEUE_COUNT,
+};
+
+struct k_work_q *tt_work_queue_get(enum tt_work_queue queue);
+int tt_work_submit(enum tt_work_queue queue, struct k_work *work);
+
+#endif
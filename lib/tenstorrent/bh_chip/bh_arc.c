@@ -60,3 +60,8 @@ int bharc_smbus_byte_data_write(const struct bh_arc *dev, uint8_t cmd, uint8_t w
 {
 	return smbus_byte_data_write(dev->smbus.bus, dev->smbus.addr, cmd, word);
 }
+
+int bharc_smbus_byte_data_read(const struct bh_arc *dev, uint8_t cmd, uint8_t *byte)
+{
+	return smbus_byte_data_read(dev->smbus.bus, dev->smbus.addr, cmd, byte);
+}
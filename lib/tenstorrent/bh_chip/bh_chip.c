@@ -12,7 +12,9 @@
 #include <tenstorrent/tt_smbus_regs.h>
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
 #include <zephyr/sys/clock.h>
+#include <zephyr/sys/crc.h>
 #include <zephyr/drivers/i2c.h>
 #include <string.h>
 
@@ -28,6 +30,25 @@ void bh_chip_cancel_bus_transfer_clear(struct bh_chip *chip)
 	smbus_uncancel(chip->config.arc.smbus.bus);
 }
 
+static void cm2dm_bus_error(struct bh_chip *chip, int req_ret, int ack_ret)
+{
+	static k_timepoint_t message_ratelimit;
+	static k_timepoint_t recover_ratelimit;
+
+	if (sys_timepoint_expired(message_ratelimit)) {
+		message_ratelimit = sys_timepoint_calc(K_SECONDS(1));
+
+		LOG_WRN("CM2DM SMBus communication failed. req: %d ack: %d", req_ret, ack_ret);
+	}
+
+	if (req_ret == -EIO && sys_timepoint_expired(recover_ratelimit)) {
+		recover_ratelimit = sys_timepoint_calc(K_MSEC(250));
+
+		i2c_recover_bus(chip->config.arc.smbus.bus);
+		smbus_uncancel(chip->config.arc.smbus.bus);
+	}
+}
+
 cm2dmMessageRet bh_chip_get_cm2dm_message(struct bh_chip *chip)
 {
 	cm2dmMessageRet output = {
@@ -54,25 +75,78 @@ cm2dmMessageRet bh_chip_get_cm2dm_message(struct bh_chip *chip)
 	}
 
 	if (output.ret != 0 || (output.msg.msg_id != kCm2DmMsgIdNull && output.ack_ret != 0)) {
-		static k_timepoint_t message_ratelimit;
-		static k_timepoint_t recover_ratelimit;
+		cm2dm_bus_error(chip, output.ret, output.ack_ret);
+	}
 
-		if (sys_timepoint_expired(message_ratelimit)) {
-			message_ratelimit = sys_timepoint_calc(K_SECONDS(1));
+	return output;
+}
 
-			LOG_WRN("CM2DM SMBus communication failed. req: %d ack: %d", output.ret,
-				output.ack_ret);
-		}
+/**
+ * @brief Tell whether a request failed because the CMFW doesn't implement its command
+ *
+ * The CMFW's SMBus target NAKs a command it doesn't implement, which reads as -EIO, the same as a
+ * bus error. CMFW_SMBUS_TEST_READ is implemented by every CMFW and only reads a scratch register,
+ * so if it succeeds right after the NAK, the bus and the CMFW are up and the command was refused.
+ * The probe must not touch the CM2DM or log state, a CMFW_SMBUS_REQ read would take a message.
+ *
+ * @param chip Chip the request was sent to
+ * @param req_ret Return code of the request
+ *
+ * @return true if the CMFW refused the command, false for any other error
+ */
+bool bh_chip_cmd_refused(struct bh_chip *chip, int req_ret)
+{
+	uint8_t scratch;
 
-		if (output.ret == -EIO && sys_timepoint_expired(recover_ratelimit)) {
-			recover_ratelimit = sys_timepoint_calc(K_MSEC(250));
+	if (req_ret != -EIO) {
+		return false;
+	}
 
-			i2c_recover_bus(chip->config.arc.smbus.bus);
-			smbus_uncancel(chip->config.arc.smbus.bus);
-		}
+	return bharc_smbus_byte_data_read(&chip->config.arc, CMFW_SMBUS_TEST_READ, &scratch) == 0;
+}
+
+/**
+ * @brief Read up to CMFW_SMBUS_CM2DM_WINDOW_SIZE CM2DM messages in one transaction
+ *
+ * The same transaction acks the messages up to chip->data.last_cm2dm_seq_num, so the caller
+ * updates it as it processes the messages. Messages that aren't acked are returned again.
+ *
+ * @param chip Chip to read from
+ * @param msgs Buffer receiving the messages in sequence order
+ * @param count Receives the number of messages
+ * @param more Receives whether more messages are waiting for space in the window
+ *
+ * @return 0 on success, a negative error code otherwise
+ */
+int bh_chip_get_cm2dm_window(struct bh_chip *chip, cm2dmMessage msgs[CMFW_SMBUS_CM2DM_WINDOW_SIZE],
+			     uint8_t *count, bool *more)
+{
+	uint8_t ack[3] = {
+		chip->data.last_cm2dm_seq_num_valid ? CMFW_SMBUS_CM2DM_ACK_VALID : 0,
+		chip->data.last_cm2dm_seq_num,
+		~chip->data.last_cm2dm_seq_num,
+	};
+	uint8_t rcv_count;
+	uint8_t buf[255]; /* Max SMBus block read */
+	int ret;
+
+	ret = bharc_smbus_block_write_block_read(&chip->config.arc, CMFW_SMBUS_REQ_WINDOW,
+						 sizeof(ack), ack, &rcv_count, buf);
+	if (ret == 0 && (rcv_count < 2 || buf[0] > CMFW_SMBUS_CM2DM_WINDOW_SIZE ||
+			 rcv_count != 2 + buf[0] * sizeof(cm2dmMessage))) {
+		ret = -EBADMSG;
 	}
 
-	return output;
+	if (ret != 0) {
+		cm2dm_bus_error(chip, ret, 0);
+		return ret;
+	}
+
+	*count = buf[0];
+	*more = buf[1] & CMFW_SMBUS_CM2DM_MORE_PENDING;
+	memcpy(msgs, &buf[2], *count * sizeof(cm2dmMessage));
+
+	return 0;
 }
 
 int bh_chip_set_static_info(struct bh_chip *chip, dmStaticInfo *info)
@@ -135,6 +209,79 @@ void bh_chip_auto_reset(struct k_timer *timer)
 	tt_event_post(TT_EVENT_WATCHDOG_EXPIRED);
 }
 
+static void bh_chip_run_jobs(struct bh_chip *chip)
+{
+	uint32_t jobs = atomic_clear(&chip->jobs);
+
+	if (jobs == 0) {
+		/* Already run along with an earlier submission */
+		return;
+	}
+
+	k_mutex_lock(&chip->lock, K_FOREVER);
+	chip->job_handler(chip, jobs);
+	k_mutex_unlock(&chip->lock);
+}
+
+/**
+ * @brief Set the handler running the jobs submitted for a chip
+ *
+ * Until bh_chip_worker_start is called, or without CONFIG_TT_BH_CHIP_WORKER, jobs run in the
+ * thread that submits them.
+ */
+void bh_chip_jobs_init(struct bh_chip *chip, bh_chip_job_handler_t handler)
+{
+	k_mutex_init(&chip->lock);
+	atomic_clear(&chip->jobs);
+	chip->job_handler = handler;
+}
+
+/**
+ * @brief Run jobs for a chip, on its worker if it has one
+ *
+ * Jobs submitted again before they run are only run once. The handler runs with chip->lock held.
+ *
+ * @param chip Chip to run the jobs for
+ * @param jobs Bitmask of jobs, passed to the handler
+ */
+void bh_chip_jobs_submit(struct bh_chip *chip, uint32_t jobs)
+{
+	atomic_or(&chip->jobs, jobs);
+
+#ifdef CONFIG_TT_BH_CHIP_WORKER
+	if (chip->worker_started) {
+		k_work_submit_to_queue(&chip->worker, &chip->job_work);
+		return;
+	}
+#endif
+
+	bh_chip_run_jobs(chip);
+}
+
+#ifdef CONFIG_TT_BH_CHIP_WORKER
+static void bh_chip_job_work(struct k_work *work)
+{
+	bh_chip_run_jobs(CONTAINER_OF(work, struct bh_chip, job_work));
+}
+
+/**
+ * @brief Start a work queue running the jobs of a chip
+ *
+ * @param chip Chip, set up with bh_chip_jobs_init
+ * @param stack Stack of the work queue thread
+ * @param stack_size Size of the stack, at least CONFIG_TT_BH_CHIP_WORKER_STACK_SIZE
+ */
+void bh_chip_worker_start(struct bh_chip *chip, k_thread_stack_t *stack, size_t stack_size)
+{
+	const struct k_work_queue_config cfg = {.name = "bh_chip"};
+
+	k_work_init(&chip->job_work, bh_chip_job_work);
+	k_work_queue_start(&chip->worker, stack, stack_size, CONFIG_TT_BH_CHIP_WORKER_PRIORITY,
+			   &cfg);
+	chip->worker_started = true;
+}
+#endif
+
 int bh_chip_write_logs(struct bh_chip *chip, char *log_data, size_t log_size)
 {
 	int ret;
@@ -149,6 +296,64 @@ int bh_chip_write_logs(struct bh_chip *chip, char *log_data, size_t log_size)
 	return ret;
 }
 
+/**
+ * @brief Send a chunk of DMC log with CMFW_SMBUS_DMC_LOG_BULK
+ *
+ * Until the CMFW's last sequence number is known, sends no log bytes and only reads it. The
+ * caller sends a chunk that failed again as it was, the CMFW ignores it if it took it already.
+ * chip->data.dmc_log_credits receives how many log bytes the CMFW has room for.
+ *
+ * @param chip Chip to send to
+ * @param dropped Count of log bytes the DMC dropped since boot
+ * @param log_data Log bytes
+ * @param log_size Number of log bytes, at most CMFW_SMBUS_DMC_LOG_CHUNK_SIZE
+ *
+ * @return Number of log bytes sent, or a negative error code
+ */
+int bh_chip_write_log_chunk(struct bh_chip *chip, uint32_t dropped, const uint8_t *log_data,
+			    size_t log_size)
+{
+	uint8_t chunk[4 + CMFW_SMBUS_DMC_LOG_CHUNK_SIZE];
+	uint8_t seq_num = chip->data.dmc_log_seq_num;
+	uint8_t rcv_count;
+	uint8_t buf[255]; /* Max SMBus block read */
+	int ret;
+
+	if (log_size > CMFW_SMBUS_DMC_LOG_CHUNK_SIZE) {
+		return -ENOBUFS;
+	}
+
+	chunk[0] = seq_num;
+	sys_put_le16(dropped, &chunk[1]);
+	if (!chip->data.dmc_log_seq_num_valid) {
+		log_size = 0;
+	} else if (log_size > 0) {
+		memcpy(&chunk[3], log_data, log_size);
+	}
+	chunk[3 + log_size] = crc8(chunk, 3 + log_size, 0x7, 0U, false);
+
+	ret = bharc_smbus_block_write_block_read(&chip->config.arc, CMFW_SMBUS_DMC_LOG_BULK,
+						 4 + log_size, chunk, &rcv_count, buf);
+	if (ret == 0 && (rcv_count != 3 || (log_size > 0 && buf[0] != seq_num))) {
+		ret = -EBADMSG;
+	}
+
+	if (ret != 0) {
+		return ret;
+	}
+
+	chip->data.dmc_log_credits = sys_get_le16(&buf[1]);
+
+	if (!chip->data.dmc_log_seq_num_valid) {
+		chip->data.dmc_log_seq_num = buf[0] + 1;
+		chip->data.dmc_log_seq_num_valid = true;
+	} else if (log_size > 0) {
+		chip->data.dmc_log_seq_num++;
+	}
+
+	return log_size;
+}
+
 void bh_chip_assert_asic_reset(const struct bh_chip *chip)
 {
 	gpio_pin_set_dt(&chip->config.asic_reset, 1);
@@ -174,6 +379,10 @@ int bh_chip_reset_chip(struct bh_chip *chip, bool force_reset)
 	int ret, ret2;
 
 	chip->data.last_cm2dm_seq_num_valid = false;
+	chip->data.cm2dm_window_unsupported = false;
+	chip->data.cm2dm_window_refusals = 0;
+	chip->data.dmc_log_bulk_unsupported = false;
+	chip->data.dmc_log_bulk_refusals = 0;
 	ret = bharc_disable_i2cbus(&chip->config.arc);
 	if (ret != 0) {
 		bharc_enable_i2cbus(&chip->config.arc);
@@ -16,6 +16,7 @@
 #include <zephyr/logging/log_core.h>
 #include <zephyr/logging/log_output.h>
 #include <zephyr/logging/log_backend_std.h>
+#include <zephyr/sys/atomic.h>
 
 /*
  * We have a ringbuffer outside of the log framework, so this one can
@@ -26,6 +27,9 @@ static uint32_t log_format_current = CONFIG_LOG_BACKEND_RINGBUF_OUTPUT_DEFAULT;
 
 RING_BUF_DECLARE(ringbuf_output_buf, CONFIG_LOG_BACKEND_RINGBUF_BUFFER_SIZE);
 
+/* Bytes of log output dropped or overwritten since boot */
+static atomic_t dropped_bytes;
+
 /**
  * Get address of ring buffer log backend buffer.
  * internally calls `ring_buf_get_claim()` on the logging ring buffer.
@@ -61,6 +65,12 @@ size_t log_backend_ringbuf_get_used(void)
 	return ring_buf_size_get(&ringbuf_output_buf);
 }
 
+/* And how much log output was lost for lack of space */
+uint32_t log_backend_ringbuf_get_dropped(void)
+{
+	return atomic_get(&dropped_bytes);
+}
+
 static int char_out(uint8_t *data, size_t length, void *ctx)
 {
 	ARG_UNUSED(ctx);
@@ -69,11 +79,13 @@ static int char_out(uint8_t *data, size_t length, void *ctx)
 		/* If drop mode is enabled, drop the message if there isn't enough space */
 		if (ring_buf_space_get(&ringbuf_output_buf) < length) {
 			/* Simply lie to the logging framework that we sent the message */
+			atomic_add(&dropped_bytes, length);
 			return length;
 		}
 	} else if (IS_ENABLED(CONFIG_LOG_BACKEND_RINGBUF_MODE_OVERWRITE)) {
 		if (ring_buf_space_get(&ringbuf_output_buf) < length) {
 			/* Drop existing data and start logging to front of buffer */
+			atomic_add(&dropped_bytes, ring_buf_size_get(&ringbuf_output_buf));
 			ring_buf_reset(&ringbuf_output_buf);
 		}
 	}
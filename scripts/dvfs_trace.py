@@ -0,0 +1,201 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2026 Tenstorrent AI ULC
+# SPDX-License-Identifier: Apache-2.0
+
+"""
+Decode the SMC DVFS decision trace.
+
+Every DVFS iteration (1 ms) the SMC records the target AICLK, the arbiter
+that chose it, the requested and target voltage, and the time taken by each
+stage into a ring buffer (see lib/tenstorrent/bh_arc/dvfs_trace.h). This
+script reads the ring over PCIe, or decodes a raw copy of it from a file,
+and prints the records oldest first.
+"""
+
+import argparse
+import struct
+import sys
+
+import pcie_utils
+
+# Telemetry tag holding the address of the trace buffer
+TAG_DVFS_TRACE = 75
+DVFS_TRACE_VERSION = 1
+
+HEADER = struct.Struct("<4I")  # version, capacity, record_size, head
+RECORD = struct.Struct("<I3H2B4H")
+
+# enum dvfs_trace_stage
+STAGES = ["throttlers", "arbitration", "voltage", "transition"]
+
+# enum targ_freq_reason
+REASONS = ["min_arb", "max_arb", "fmin", "sweep", "forced"]
+
+# enum aiclk_arb_min
+MIN_ARBITERS = ["fmin", "busy"]
+
+# enum aiclk_arb_max
+MAX_ARBITERS = [
+    "fmax",
+    "tdp",
+    "fast_tdc",
+    "tdc",
+    "thm",
+    "board_power",
+    "voltage",
+    "gddr_thm",
+    "doppler_slow",
+    "doppler_critical",
+    "host_fmax",
+    "doppler_predict",
+]
+
+
+def limiter_name(reason, arbiter):
+    """Name of what limited AICLK, e.g. "max_arb:tdp" """
+    if reason >= len(REASONS):
+        return f"reason{reason}"
+    name = REASONS[reason]
+    arbiters = {0: MIN_ARBITERS, 1: MAX_ARBITERS}.get(reason)
+    if arbiters is None:
+        return name
+    return f"{name}:{arbiters[arbiter] if arbiter < len(arbiters) else arbiter}"
+
+
+def decode_record(data, offset=0):
+    """Decode one struct dvfs_trace_record into a dict"""
+    fields = RECORD.unpack_from(data, offset)
+    timestamp_us, targ_freq, aiclk_voltage, targ_voltage, reason, arbiter = fields[:6]
+    return {
+        "timestamp_us": timestamp_us,
+        "targ_freq": targ_freq,
+        "aiclk_voltage": aiclk_voltage,
+        "targ_voltage": targ_voltage,
+        "reason": reason,
+        "arbiter": arbiter,
+        "limiter": limiter_name(reason, arbiter),
+        "stage_us": dict(zip(STAGES, fields[6:])),
+    }
+
+
+def decode_header(data):
+    version, capacity, record_size, head = HEADER.unpack_from(data)
+    if version != DVFS_TRACE_VERSION:
+        raise ValueError(f"Unsupported DVFS trace version {version}")
+    if record_size != RECORD.size:
+        raise ValueError(f"Unexpected DVFS trace record size {record_size}")
+    return capacity, head
+
+
+def decode_trace(data, head=None):
+    """
+    Decode a raw copy of struct dvfs_trace, oldest record first.
+
+    head is the head count read again after the copy, if the buffer was
+    copied while the SMC was writing it. Records not newer than head minus
+    capacity may have been overwritten during the copy and are dropped:
+    the slot of record head - capacity is the one the SMC writes next.
+    """
+    capacity, copied_head = decode_header(data)
+    if head is None:
+        first = copied_head - capacity
+    elif head < copied_head:
+        # The trace was cleared during the copy
+        return []
+    else:
+        first = head - capacity + 1
+
+    records = []
+    for index in range(max(0, first), copied_head):
+        offset = HEADER.size + (index % capacity) * RECORD.size
+        records.append(decode_record(data, offset))
+    return records
+
+
+def read_trace(chip):
+    """Copy the DVFS trace from the SMC over PCIe and decode it"""
+    _, telemetry = pcie_utils.read_telemetry_snapshot(chip)
+    addr = telemetry.get(TAG_DVFS_TRACE, 0)
+    if addr == 0:
+        raise RuntimeError("SMC firmware was built without the DVFS trace")
+
+    capacity = chip.axi_read32(addr + 4)
+    size = HEADER.size + capacity * RECORD.size
+    data = bytearray()
+    for offset in range(0, size, 4):
+        data += struct.pack("<I", chip.axi_read32(addr + offset))
+    head = chip.axi_read32(addr + 12)
+
+    return decode_trace(bytes(data), head)
+
+
+def print_records(records, csv=False):
+    if csv:
+        print(
+            "timestamp_us,targ_freq,aiclk_voltage,targ_voltage,limiter,"
+            + ",".join(f"{stage}_us" for stage in STAGES)
+        )
+    else:
+        print(
+            f"{'time_us':>12} {'delta':>6} {'MHz':>5} {'req_mV':>6} {'targ_mV':>7} "
+            f"{'limiter':<20} "
+            + " ".join(f"{stage:>11}" for stage in STAGES)
+        )
+
+    last = None
+    for record in records:
+        stages = [record["stage_us"][stage] for stage in STAGES]
+        if csv:
+            print(
+                f"{record['timestamp_us']},{record['targ_freq']},"
+                f"{record['aiclk_voltage']},{record['targ_voltage']},"
+                f"{record['limiter']},"
+                + ",".join(str(us) for us in stages)
+            )
+        else:
+            # The timestamp is the low 32 bits of the uptime in us
+            delta = "" if last is None else (record["timestamp_us"] - last) & 0xFFFFFFFF
+            print(
+                f"{record['timestamp_us']:>12} {delta:>6} {record['targ_freq']:>5} "
+                f"{record['aiclk_voltage']:>6} {record['targ_voltage']:>7} "
+                f"{record['limiter']:<20} "
+                + " ".join(f"{us:>11}" for us in stages)
+            )
+        last = record["timestamp_us"]
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description="Decode the SMC DVFS decision trace.", allow_abbrev=False
+    )
+    parser.add_argument(
+        "--asic-id",
+        type=int,
+        default=0,
+        help="Specify which ASIC to read the trace from (default: 0).",
+    )
+    parser.add_argument(
+        "--file",
+        type=argparse.FileType("rb"),
+        help="Decode a raw copy of the trace buffer instead of reading it over PCIe.",
+    )
+    parser.add_argument("--csv", action="store_true", help="Print the records as CSV.")
+    return parser.parse_args()
+
+
+def main():
+    args = parse_args()
+
+    if args.file:
+        records = decode_trace(args.file.read())
+    else:
+        chip = pcie_utils.get_chip(args.asic_id)
+        records = read_trace(chip)
+
+    print_records(records, args.csv)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -17,6 +17,12 @@ DMC_PING_MSG = 0xC0
 # Common SMC register used for connectivity checks
 SMC_POSTCODE_REG = 0x80030060
 
+# Scratch register holding the address of the SMC telemetry table
+TELEMETRY_TABLE_REG = 0x80030434
+# Telemetry tag incremented by the SMC before and after each telemetry update
+TAG_TELEM_GENERATION = 71
+TELEMETRY_SNAPSHOT_RETRIES = 100
+
 logger = logging.getLogger(Path(__file__).stem)
 
 # Optional pyluwen import
@@ -194,3 +200,38 @@ def wait_for_enum(asic_id=0, timeout=60, delay=2):
         "Timed out after %ds waiting for card %d to enumerate", timeout, asic_id
     )
     return False
+
+
+def read_telemetry_snapshot(chip, retries=TELEMETRY_SNAPSHOT_RETRIES):
+    """
+    Read a consistent snapshot of the SMC telemetry table over PCIe.
+
+    The generation tag is odd while the SMC is updating telemetry, so the
+    read is retried until the generation is even and unchanged across the
+    read. Returns (generation, {tag: value}).
+    """
+    table = chip.axi_read32(TELEMETRY_TABLE_REG)
+    entry_count = chip.axi_read32(table + 4)
+    tag_table = table + 8
+    data = tag_table + entry_count * 4
+
+    offsets = {}
+    for i in range(entry_count):
+        entry = chip.axi_read32(tag_table + i * 4)
+        offsets[entry & 0xFFFF] = entry >> 16
+
+    if TAG_TELEM_GENERATION not in offsets:
+        raise RuntimeError("SMC firmware does not publish a telemetry generation")
+    generation_addr = data + offsets[TAG_TELEM_GENERATION] * 4
+
+    for _ in range(retries):
+        start = chip.axi_read32(generation_addr)
+        if start & 1:
+            continue
+        values = {
+            tag: chip.axi_read32(data + offset * 4) for tag, offset in offsets.items()
+        }
+        if chip.axi_read32(generation_addr) == start:
+            return start, values
+
+    raise TimeoutError(f"No stable telemetry snapshot after {retries} reads")
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include "clock_control_tt_bh_slew.h"
+
+/* AICLK = REFCLK_MHZ * fbdiv / (refdiv 2 * effective postdiv 4) */
+#define REFCLK_MHZ  50
+#define AICLK_DIV   8
+#define FBDIV_MIN   32  /* 200 MHz */
+#define FBDIV_MAX   224 /* 1400 MHz */
+#define STEP_FACTOR 32  /* No write may change the VCO by more than 1/32 */
+
+/* A PLL that checks every feedback divider write against the previous one */
+struct pll_mock {
+	uint32_t fbdiv;
+	uint32_t writes;
+	uint32_t settle_ns;
+	int direction;
+};
+
+static void pll_mock_write(void *user_data, uint32_t fbdiv, uint32_t settle_ns)
+{
+	struct pll_mock *pll = user_data;
+	uint32_t lower = MIN(pll->fbdiv, fbdiv);
+	uint32_t step = MAX(pll->fbdiv, fbdiv) - lower;
+	const struct tt_bh_pll_slew_range *range = tt_bh_pll_slew_range_get(lower);
+
+	zassert_true(step > 0, "fbdiv %u written again", fbdiv);
+	zassert_true(step <= range->max_step, "fbdiv %u -> %u: step above %u", pll->fbdiv,
+		     fbdiv, range->max_step);
+	zassert_true(step * STEP_FACTOR <= lower, "fbdiv %u -> %u: slope too steep", pll->fbdiv,
+		     fbdiv);
+	zassert_true(settle_ns >= range->settle_ns);
+	/* Intermediate frequencies are between the start and the target */
+	zassert_equal(fbdiv > pll->fbdiv ? 1 : -1, pll->direction);
+
+	pll->fbdiv = fbdiv;
+	pll->writes++;
+	pll->settle_ns += settle_ns;
+}
+
+static void slew(struct pll_mock *pll, uint32_t from, uint32_t to)
+{
+	*pll = (struct pll_mock){.fbdiv = from, .direction = to > from ? 1 : -1};
+
+	zassert_equal(tt_bh_pll_slew(from, to, pll_mock_write, pll), pll->writes);
+	zassert_equal(pll->fbdiv, to);
+}
+
+ZTEST(clock_control_tt_bh_slew, test_table)
+{
+	uint32_t fbdiv_min = 0;
+
+	for (size_t i = 0; i < tt_bh_pll_slew_num_ranges; i++) {
+		const struct tt_bh_pll_slew_range *range = &tt_bh_pll_slew_ranges[i];
+
+		zassert_true(range->fbdiv_max >= fbdiv_min);
+		if (i > 0) {
+			zassert_true(range->max_step >= tt_bh_pll_slew_ranges[i - 1].max_step);
+			zassert_true(range->max_step * STEP_FACTOR <= fbdiv_min);
+		}
+		fbdiv_min = range->fbdiv_max + 1;
+	}
+	zassert_equal(tt_bh_pll_slew_ranges[tt_bh_pll_slew_num_ranges - 1].fbdiv_max, UINT16_MAX);
+}
+
+ZTEST(clock_control_tt_bh_slew, test_all_transitions)
+{
+	struct pll_mock pll;
+
+	for (uint32_t from = FBDIV_MIN; from <= FBDIV_MAX; from++) {
+		for (uint32_t to = FBDIV_MIN; to <= FBDIV_MAX; to++) {
+			slew(&pll, from, to);
+		}
+	}
+}
+
+ZTEST(clock_control_tt_bh_slew, test_small_change)
+{
+	struct pll_mock pll;
+
+	slew(&pll, 128, 129);
+	zassert_equal(pll.writes, 1);
+	slew(&pll, 128, 127);
+	zassert_equal(pll.writes, 1);
+	slew(&pll, 128, 128);
+	zassert_equal(pll.writes, 0);
+}
+
+ZTEST(clock_control_tt_bh_slew, test_transition_time)
+{
+	/* One fbdiv per write with 100 ns in between */
+	const uint32_t unit_writes = FBDIV_MAX - FBDIV_MIN;
+	const uint32_t unit_ns = unit_writes * 100;
+	struct pll_mock up, down;
+
+	slew(&up, FBDIV_MIN, FBDIV_MAX);
+	slew(&down, FBDIV_MAX, FBDIV_MIN);
+
+	TC_PRINT("%u -> %u MHz: %u writes, %u ns (one fbdiv per write: %u writes, %u ns)\n",
+		 REFCLK_MHZ * FBDIV_MIN / AICLK_DIV, REFCLK_MHZ * FBDIV_MAX / AICLK_DIV, up.writes,
+		 up.settle_ns, unit_writes, unit_ns);
+
+	zassert_equal(up.writes, down.writes);
+	zassert_equal(up.settle_ns, down.settle_ns);
+	if (IS_ENABLED(CONFIG_CLOCK_CONTROL_TT_BH_SLEW_RANGES)) {
+		zassert_true(up.settle_ns * 2 < unit_ns);
+	} else {
+		zassert_equal(up.writes, unit_writes);
+		zassert_equal(up.settle_ns, unit_ns);
+	}
+}
+
+ZTEST_SUITE(clock_control_tt_bh_slew, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/clock_control.h>
+#include <zephyr/drivers/clock_control/clock_control_tt_bh.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/sys_io.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/sys_clock.h>
+#include <zephyr/ztest.h>
+
+/*
+ * A PLL behind mocked registers. Only the registers of the AICLK path are modelled: PLL_CNTL_1
+ * with refdiv 2 and the feedback divider, and postdiv0 of 3 (divide by 4), so that
+ * AICLK = 50 MHz * fbdiv / 8. The fbdivs used are multiples of 4, whose rates are whole MHz.
+ */
+#define PLL_BASE        0x80020100
+#define PLL_NUM_REGS    (0x100 / sizeof(uint32_t))
+#define REFCLK_MHZ      50
+#define AICLK_MHZ(fbdiv) (REFCLK_MHZ * (fbdiv) / 8)
+#define MAX_WRITES      64
+#define PLL_CNTL_1_ADDR (PLL_BASE + 0x04)
+
+static uint32_t pll_regs[PLL_NUM_REGS];
+
+/* Feedback dividers written to PLL_CNTL_1 and the time waited after each */
+static struct {
+	uint32_t fbdiv;
+	uint32_t settle_ns;
+} pll_writes[MAX_WRITES];
+static size_t num_pll_writes;
+static uint32_t stray_writes;
+
+static uint32_t pll_mock_read32(mm_reg_t addr)
+{
+	zassert_true(IN_RANGE(addr, PLL_BASE, PLL_BASE + sizeof(pll_regs) - 1),
+		     "read of 0x%lx outside the PLL", (unsigned long)addr);
+
+	return pll_regs[(addr - PLL_BASE) / sizeof(uint32_t)];
+}
+
+static void pll_mock_write32(uint32_t val, mm_reg_t addr)
+{
+	uint32_t old;
+
+	if (!IN_RANGE(addr, PLL_BASE, PLL_BASE + sizeof(pll_regs) - 1)) {
+		stray_writes++;
+		return;
+	}
+
+	old = pll_regs[(addr - PLL_BASE) / sizeof(uint32_t)];
+	pll_regs[(addr - PLL_BASE) / sizeof(uint32_t)] = val;
+
+	if (addr != PLL_CNTL_1_ADDR) {
+		stray_writes++;
+		return;
+	}
+
+	/* Only the feedback divider moves, refdiv and postdiv are written back as they were */
+	zassert_equal(old & 0xFFFF, val & 0xFFFF, "PLL_CNTL_1 0x%08x -> 0x%08x", old, val);
+	zassert_true(num_pll_writes < MAX_WRITES);
+	pll_writes[num_pll_writes].fbdiv = val >> 16;
+	pll_writes[num_pll_writes++].settle_ns = 0;
+}
+
+static void pll_mock_busy_wait_ns(uint32_t ns)
+{
+	zassert_true(num_pll_writes > 0, "wait before the first write");
+	pll_writes[num_pll_writes - 1].settle_ns += ns;
+}
+
+#undef sys_read32
+#undef sys_write32
+#undef k_busy_wait_ns
+#define sys_read32     pll_mock_read32
+#define sys_write32    pll_mock_write32
+#define k_busy_wait_ns pll_mock_busy_wait_ns
+
+/*
+ * The driver is built against the mocks above. It has no instance in the native_sim devicetree,
+ * the device is defined below, so its init function is left unused.
+ */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-function"
+#include "clock_control_tt_bh.c"
+#pragma GCC diagnostic pop
+
+static const struct clock_control_tt_bh_config pll_config = {
+	.inst = 0,
+	.refclk_rate = REFCLK_MHZ,
+	.base = PLL_BASE,
+	.size = sizeof(pll_regs),
+};
+static struct clock_control_tt_bh_data pll_data;
+static const struct device pll_dev = {
+	.name = "pll_mock",
+	.config = &pll_config,
+	.api = &clock_control_tt_bh_api,
+	.data = &pll_data,
+};
+
+#define AICLK ((clock_control_subsys_t)(uintptr_t)CLOCK_CONTROL_TT_BH_CLOCK_AICLK)
+
+static void pll_reset(uint32_t fbdiv)
+{
+	const union tt_bh_pll_cntl_1_reg pll_cntl_1 = {
+		.f.refdiv = 2,
+		.f.postdiv = 1,
+		.f.fbdiv = fbdiv,
+	};
+	const union tt_bh_pll_cntl_5_reg pll_cntl_5 = {.f.postdiv0 = 3};
+	const union tt_bh_pll_use_postdiv_reg use_postdiv = {.f.pll_use_postdiv0 = 1};
+
+	memset(pll_regs, 0, sizeof(pll_regs));
+	pll_regs[PLL_CNTL_1_OFFSET / sizeof(uint32_t)] = pll_cntl_1.val;
+	pll_regs[PLL_CNTL_5_OFFSET / sizeof(uint32_t)] = pll_cntl_5.val;
+	pll_regs[PLL_USE_POSTDIV_OFFSET / sizeof(uint32_t)] = use_postdiv.val;
+	num_pll_writes = 0;
+	stray_writes = 0;
+}
+
+/* Set AICLK to the rate of to_fbdiv and check the feedback dividers written on the way */
+static void check_set_rate(uint32_t to_fbdiv, const uint32_t *expected, size_t num_expected)
+{
+	uint32_t rate;
+
+	num_pll_writes = 0;
+	zassert_ok(clock_control_set_rate(&pll_dev, AICLK,
+					  (clock_control_subsys_rate_t)(uintptr_t)AICLK_MHZ(to_fbdiv)));
+
+	zassert_equal(num_pll_writes, num_expected, "%zu writes, expected %zu", num_pll_writes,
+		      num_expected);
+	for (size_t i = 0; i < num_expected; i++) {
+		zassert_equal(pll_writes[i].fbdiv, expected[i], "write %zu: fbdiv %u, expected %u",
+			      i, pll_writes[i].fbdiv, expected[i]);
+		zassert_equal(pll_writes[i].settle_ns, 100, "write %zu: %u ns settle", i,
+			      pll_writes[i].settle_ns);
+	}
+	zassert_equal(stray_writes, 0);
+
+	zassert_ok(clock_control_get_rate(&pll_dev, AICLK, &rate));
+	zassert_equal(rate, AICLK_MHZ(to_fbdiv));
+}
+
+/* 375 -> 425 -> 400 MHz */
+#ifdef CONFIG_CLOCK_CONTROL_TT_BH_SLEW_RANGES
+#define UP_STEPS   61, 62, 63, 64, 66, 68
+#define DOWN_STEPS 66, 64
+#else
+#define UP_STEPS   61, 62, 63, 64, 65, 66, 67, 68
+#define DOWN_STEPS 67, 66, 65, 64
+#endif
+static const uint32_t up_steps[] = {UP_STEPS};
+static const uint32_t down_steps[] = {DOWN_STEPS};
+
+ZTEST(clock_control_tt_bh_set_rate, test_steps)
+{
+	if (!IS_ENABLED(CONFIG_CLOCK_CONTROL_TT_BH_SLEW_RANGES)) {
+		/* One fbdiv per write whatever the rate, 800 -> 850 MHz */
+		pll_reset(128);
+		check_set_rate(136, (const uint32_t[]){129, 130, 131, 132, 133, 134, 135, 136}, 8);
+		check_set_rate(132, (const uint32_t[]){135, 134, 133, 132}, 4);
+		return;
+	}
+
+	/* Through the 1 and 2 fbdiv steps and back, 375 -> 425 -> 375 MHz */
+	pll_reset(60);
+	check_set_rate(68, (const uint32_t[]){61, 62, 63, 64, 66, 68}, 6);
+	check_set_rate(60, (const uint32_t[]){66, 64, 63, 62, 61, 60}, 6);
+
+	/* 4 fbdiv steps, 800 -> 850 MHz */
+	pll_reset(128);
+	check_set_rate(136, (const uint32_t[]){132, 136}, 2);
+
+	/* 8 fbdiv steps, 1600 -> 1675 MHz, and a partial step at the end */
+	pll_reset(256);
+	check_set_rate(268, (const uint32_t[]){264, 268}, 2);
+
+	/* Stepping down into the range below takes that range's step */
+	check_set_rate(248, (const uint32_t[]){260, 256, 252, 248}, 4);
+}
+
+ZTEST(clock_control_tt_bh_set_rate, test_stats)
+{
+	struct clock_control_tt_bh_slew_stats stats;
+
+	pll_reset(60);
+	check_set_rate(68, up_steps, ARRAY_SIZE(up_steps));
+	check_set_rate(64, down_steps, ARRAY_SIZE(down_steps));
+
+	zassert_ok(clock_control_tt_bh_get_slew_stats(&pll_dev, &stats));
+	zassert_equal(stats.transitions, 2);
+	zassert_equal(stats.steps, ARRAY_SIZE(up_steps) + ARRAY_SIZE(down_steps));
+	zassert_equal(stats.last_steps, ARRAY_SIZE(down_steps));
+	zassert_true(stats.max_ns >= stats.last_ns);
+
+	/* Setting the rate the PLL is already at isn't a transition */
+	check_set_rate(64, NULL, 0);
+	zassert_ok(clock_control_tt_bh_get_slew_stats(&pll_dev, &stats));
+	zassert_equal(stats.transitions, 2);
+	zassert_equal(stats.steps, ARRAY_SIZE(up_steps) + ARRAY_SIZE(down_steps));
+	zassert_equal(stats.last_steps, ARRAY_SIZE(down_steps));
+}
+
+ZTEST(clock_control_tt_bh_set_rate, test_out_of_range)
+{
+	struct clock_control_tt_bh_slew_stats stats;
+	/* Rates that round to fbdiv 0 and that don't fit in the 16-bit fbdiv field */
+	const uint32_t rates[] = {0, AICLK_MHZ(1) - 1, AICLK_MHZ(UINT16_MAX + 1), UINT32_MAX / 8};
+	uint32_t rate;
+
+	pll_reset(128);
+
+	for (size_t i = 0; i < ARRAY_SIZE(rates); i++) {
+		zassert_equal(clock_control_set_rate(&pll_dev, AICLK,
+						     (clock_control_subsys_rate_t)(uintptr_t)rates[i]),
+			      -EINVAL, "rate %u MHz", rates[i]);
+	}
+
+	/* The PLL and the stats are left as they were */
+	zassert_equal(num_pll_writes, 0);
+	zassert_equal(stray_writes, 0);
+	zassert_ok(clock_control_get_rate(&pll_dev, AICLK, &rate));
+	zassert_equal(rate, AICLK_MHZ(128));
+	zassert_ok(clock_control_tt_bh_get_slew_stats(&pll_dev, &stats));
+	zassert_equal(stats.transitions, 0);
+}
+
+static void set_rate_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	memset(&pll_data, 0, sizeof(pll_data));
+}
+
+ZTEST_SUITE(clock_control_tt_bh_set_rate, NULL, NULL, set_rate_before, NULL, NULL);
@@ -0,0 +1,121 @@
+# Copyright (c) 2026 Tenstorrent AI ULC
+# SPDX-License-Identifier: Apache-2.0
+
+from pathlib import Path
+import sys
+
+import pytest
+
+# Add to import path so we can import pcie_utils
+TEST_ROOT = Path(__file__).parent.resolve()
+MODULE_ROOT = TEST_ROOT.parents[4]
+sys.path.append(str(MODULE_ROOT / "scripts"))
+import pcie_utils  # noqa: E402
+
+TABLE_ADDR = 0x10000000
+TAG_A = 10
+TAG_B = 20
+TAGS = [TAG_A, pcie_utils.TAG_TELEM_GENERATION, TAG_B]
+
+
+class FakeChip:
+    """
+    SMC telemetry table in the layout published by the firmware. Writes
+    scheduled with at() are applied just before the given read, so a test can
+    place a writer anywhere in the reader's sequence of reads.
+    """
+
+    def __init__(self, tags):
+        self.mem = {pcie_utils.TELEMETRY_TABLE_REG: TABLE_ADDR}
+        self.mem[TABLE_ADDR + 4] = len(tags)
+        self.data = TABLE_ADDR + 8 + len(tags) * 4
+        self.offsets = {}
+        for i, tag in enumerate(tags):
+            self.mem[TABLE_ADDR + 8 + i * 4] = (i << 16) | tag
+            self.offsets[tag] = i
+            self.mem[self.data + i * 4] = 0
+        self.reads = 0
+        self.writes = {}
+
+    def set(self, tag, value):
+        self.mem[self.data + self.offsets[tag] * 4] = value
+
+    def get(self, tag):
+        return self.mem[self.data + self.offsets[tag] * 4]
+
+    def at(self, read, write):
+        self.writes.setdefault(read, []).append(write)
+
+    def axi_read32(self, addr):
+        for write in self.writes.pop(self.reads, []):
+            write()
+        self.reads += 1
+        return self.mem[addr]
+
+
+def schedule_update(chip, first_read, value):
+    """Update TAG_A and TAG_B to value, one read apart, under the generation"""
+    gen = pcie_utils.TAG_TELEM_GENERATION
+    chip.at(first_read, lambda: chip.set(gen, chip.get(gen) + 1))
+    chip.at(first_read + 1, lambda: chip.set(TAG_A, value))
+    chip.at(first_read + 2, lambda: chip.set(TAG_B, value))
+    chip.at(first_read + 3, lambda: chip.set(gen, chip.get(gen) + 1))
+
+
+def test_snapshot_without_updates():
+    chip = FakeChip(TAGS)
+    chip.set(TAG_A, 5)
+    chip.set(TAG_B, 5)
+
+    generation, values = pcie_utils.read_telemetry_snapshot(chip)
+
+    assert generation == 0
+    assert values[TAG_A] == values[TAG_B] == 5
+
+
+@pytest.mark.parametrize("first_read", range(16))
+def test_update_during_snapshot(first_read):
+    """Whichever read the update starts at, the snapshot is never torn"""
+    chip = FakeChip(TAGS)
+    chip.set(TAG_A, 1)
+    chip.set(TAG_B, 1)
+    schedule_update(chip, first_read, 2)
+
+    generation, values = pcie_utils.read_telemetry_snapshot(chip)
+
+    assert values[TAG_A] == values[TAG_B]
+    assert generation == (0 if values[TAG_A] == 1 else 2)
+    assert values[pcie_utils.TAG_TELEM_GENERATION] == generation
+
+
+def test_half_written_record_is_retried():
+    """The generation is odd and only TAG_A is written when the reader starts"""
+    chip = FakeChip(TAGS)
+    chip.set(pcie_utils.TAG_TELEM_GENERATION, 1)
+    chip.set(TAG_A, 2)
+    chip.set(TAG_B, 1)
+    # The writer finishes after the reader has seen the odd generation a few times
+    chip.at(
+        20,
+        lambda: (chip.set(TAG_B, 2), chip.set(pcie_utils.TAG_TELEM_GENERATION, 2)),
+    )
+
+    generation, values = pcie_utils.read_telemetry_snapshot(chip)
+
+    assert generation == 2
+    assert values[TAG_A] == values[TAG_B] == 2
+
+
+def test_update_in_progress_times_out():
+    chip = FakeChip(TAGS)
+    chip.set(pcie_utils.TAG_TELEM_GENERATION, 1)
+
+    with pytest.raises(TimeoutError):
+        pcie_utils.read_telemetry_snapshot(chip, retries=10)
+
+
+def test_firmware_without_generation():
+    chip = FakeChip([TAG_A, TAG_B])
+
+    with pytest.raises(RuntimeError):
+        pcie_utils.read_telemetry_snapshot(chip)
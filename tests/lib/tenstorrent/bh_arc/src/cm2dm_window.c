@@ -0,0 +1,461 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/ztest.h>
+
+#include <tenstorrent/bh_arc.h>
+#include <tenstorrent/tt_smbus_regs.h>
+#include "cm2dm_msg.h"
+
+/*
+ * The DMC side of CMFW_SMBUS_REQ_WINDOW is modelled here as in process_cm2dm_window, with the
+ * same cm2dm_seq_is_next, over a link that loses, repeats and reorders replies.
+ */
+
+/* SMBus standard mode, the slowest of the DMC to CMFW buses, 9 bit times per byte */
+#define SMBUS_BYTES_PER_SEC (100000 / 9)
+
+enum link_fault {
+	LINK_OK,
+	LINK_LOSE_ACK,   /* the write is corrupted, the CMFW rejects the transaction */
+	LINK_LOSE_REPLY, /* the read fails its PEC at the DMC */
+	LINK_REPEAT,     /* the DMC handles the same reply twice */
+	LINK_REORDER,    /* the messages of the reply come in reverse order */
+	LINK_FAULT_COUNT,
+};
+
+struct dmc_model {
+	uint8_t last_seq;
+	bool last_seq_valid;
+	uint32_t processed;
+	uint32_t data[kCm2DmMsgCount]; /* last data processed per message ID */
+	bool more;
+};
+
+static const struct device *const i2c0_dev = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(i2c0));
+static const uint8_t tt_i2c_addr = 0xA;
+
+/* Messages without side effects on the CMFW, Ready stands in for the others */
+static const Cm2DmMsgId test_ids[] = {
+	kCm2DmMsgIdLedBlink,
+	kCm2DmMsgIdAutoResetTimeoutUpdate,
+	kCm2DmMsgTelemHeartbeatUpdate,
+	kCm2DmMsgIdReady,
+	kCm2DmMsgIdPing,
+};
+
+static uint32_t rand_state;
+
+static uint32_t test_rand(void)
+{
+	/* xorshift32, the same sequence on every run */
+	rand_state ^= rand_state << 13;
+	rand_state ^= rand_state >> 17;
+	rand_state ^= rand_state << 5;
+	return rand_state;
+}
+
+static void drain_legacy(void)
+{
+	uint8_t buf[sizeof(cm2dmMessage)];
+	uint8_t size;
+
+	for (int i = 0; i < 2 * kCm2DmMsgCount; i++) {
+		cm2dmMessage msg;
+
+		Cm2DmMsgReqSmbusHandler(buf, &size);
+		memcpy(&msg, buf, sizeof(msg));
+		if (msg.msg_id == kCm2DmMsgIdNull) {
+			break;
+		}
+
+		cm2dmAck ack = {.msg_id = msg.msg_id, .seq_num = msg.seq_num};
+
+		Cm2DmMsgAckSmbusHandler((const uint8_t *)&ack, sizeof(ack));
+	}
+}
+
+static int window_transfer(const struct dmc_model *dmc, uint8_t reply[CONFIG_SMBUS_MAX_MSG_SIZE],
+			   uint8_t *size)
+{
+	uint8_t ack[3] = {
+		dmc->last_seq_valid ? CMFW_SMBUS_CM2DM_ACK_VALID : 0,
+		dmc->last_seq,
+		~dmc->last_seq,
+	};
+	int ret = Cm2DmMsgWindowAckSmbusHandler(ack, sizeof(ack));
+
+	if (ret != 0) {
+		return ret;
+	}
+
+	return Cm2DmMsgWindowReqSmbusHandler(reply, size);
+}
+
+static void dmc_process(struct dmc_model *dmc, const uint8_t *reply, uint8_t size)
+{
+	uint8_t count = reply[0];
+
+	zassert_equal(size, 2 + count * sizeof(cm2dmMessage));
+	zassert_true(count <= CMFW_SMBUS_CM2DM_WINDOW_SIZE);
+
+	for (uint8_t i = 0; i < count; i++) {
+		cm2dmMessage msg;
+
+		memcpy(&msg, &reply[2 + i * sizeof(msg)], sizeof(msg));
+		if (!cm2dm_seq_is_next(dmc->last_seq, dmc->last_seq_valid, msg.seq_num)) {
+			continue;
+		}
+
+		dmc->last_seq = msg.seq_num;
+		dmc->last_seq_valid = true;
+		dmc->data[msg.msg_id] = msg.data;
+		dmc->processed++;
+	}
+
+	dmc->more = reply[1] & CMFW_SMBUS_CM2DM_MORE_PENDING;
+}
+
+/* One poll of the DMC, returns the number of messages processed */
+static uint32_t dmc_poll(struct dmc_model *dmc, enum link_fault fault)
+{
+	uint8_t reply[CONFIG_SMBUS_MAX_MSG_SIZE];
+	uint8_t size;
+	uint32_t processed = dmc->processed;
+
+	if (fault == LINK_LOSE_ACK) {
+		uint8_t seq = dmc->last_seq + 1;
+		uint8_t bad_ack[3] = {CMFW_SMBUS_CM2DM_ACK_VALID, seq, (uint8_t)~seq ^ 0x80};
+
+		zassert_equal(Cm2DmMsgWindowAckSmbusHandler(bad_ack, sizeof(bad_ack)), -1);
+		return 0;
+	}
+
+	zassert_ok(window_transfer(dmc, reply, &size));
+
+	switch (fault) {
+	case LINK_LOSE_REPLY:
+		break;
+	case LINK_REPEAT:
+		dmc_process(dmc, reply, size);
+		dmc_process(dmc, reply, size);
+		break;
+	case LINK_REORDER:
+		for (uint8_t i = 0; i < reply[0] / 2; i++) {
+			uint8_t *a = &reply[2 + i * sizeof(cm2dmMessage)];
+			uint8_t *b = &reply[2 + (reply[0] - 1 - i) * sizeof(cm2dmMessage)];
+			uint8_t tmp[sizeof(cm2dmMessage)];
+
+			memcpy(tmp, a, sizeof(tmp));
+			memcpy(a, b, sizeof(tmp));
+			memcpy(b, tmp, sizeof(tmp));
+		}
+		dmc_process(dmc, reply, size);
+		break;
+	default:
+		dmc_process(dmc, reply, size);
+		break;
+	}
+
+	return dmc->processed - processed;
+}
+
+/* Poll without faults until the window is empty and acked */
+static void dmc_flush(struct dmc_model *dmc)
+{
+	for (int i = 0; i < 16; i++) {
+		if (dmc_poll(dmc, LINK_OK) == 0 && !dmc->more) {
+			return;
+		}
+	}
+	ztest_test_fail();
+}
+
+static void read_window(struct dmc_model *dmc, cm2dmMessage *msgs, uint8_t *count)
+{
+	uint8_t reply[CONFIG_SMBUS_MAX_MSG_SIZE];
+	uint8_t size;
+
+	zassert_ok(window_transfer(dmc, reply, &size));
+	*count = reply[0];
+	dmc->more = reply[1] & CMFW_SMBUS_CM2DM_MORE_PENDING;
+	memcpy(msgs, &reply[2], *count * sizeof(cm2dmMessage));
+}
+
+ZTEST(cm2dm_window, test_window)
+{
+	struct dmc_model dmc = {0};
+	cm2dmMessage msgs[CMFW_SMBUS_CM2DM_WINDOW_SIZE];
+	uint8_t count;
+
+	for (int i = 0; i < ARRAY_SIZE(test_ids); i++) {
+		PostCm2DmMsg(test_ids[i], 100 + i);
+	}
+
+	/* All pending messages in one read, in sequence order */
+	read_window(&dmc, msgs, &count);
+	zassert_equal(count, ARRAY_SIZE(test_ids));
+	zassert_false(dmc.more);
+	for (uint8_t i = 1; i < count; i++) {
+		zassert_equal(msgs[i].seq_num, (uint8_t)(msgs[0].seq_num + i));
+	}
+
+	/* Not acked yet, so sent again */
+	read_window(&dmc, msgs, &count);
+	zassert_equal(count, ARRAY_SIZE(test_ids));
+
+	/* Acking the third acks the first two as well */
+	dmc.last_seq = msgs[2].seq_num;
+	dmc.last_seq_valid = true;
+	read_window(&dmc, msgs, &count);
+	zassert_equal(count, ARRAY_SIZE(test_ids) - 3);
+	zassert_equal(msgs[0].seq_num, (uint8_t)(dmc.last_seq + 1));
+
+	/* An ack outside of the window changes nothing */
+	dmc.last_seq -= 10;
+	read_window(&dmc, msgs, &count);
+	zassert_equal(count, ARRAY_SIZE(test_ids) - 3);
+	dmc.last_seq += 10;
+
+	dmc_flush(&dmc);
+}
+
+ZTEST(cm2dm_window, test_window_full)
+{
+	struct dmc_model dmc = {0};
+	cm2dmMessage msgs[CMFW_SMBUS_CM2DM_WINDOW_SIZE];
+	uint8_t count;
+
+	/* Fill the window with updates of the same messages */
+	for (int round = 0; round < 2; round++) {
+		for (int i = 0; i < ARRAY_SIZE(test_ids); i++) {
+			PostCm2DmMsg(test_ids[i], round * 10 + i);
+		}
+		read_window(&dmc, msgs, &count);
+	}
+
+	zassert_equal(count, CMFW_SMBUS_CM2DM_WINDOW_SIZE);
+	zassert_true(dmc.more);
+
+	/* The rest follows once the window is acked, and the newest data is delivered */
+	dmc_flush(&dmc);
+	for (int i = 0; i < ARRAY_SIZE(test_ids); i++) {
+		zassert_equal(dmc.data[test_ids[i]], 10 + i);
+	}
+}
+
+ZTEST(cm2dm_window, test_priority)
+{
+	struct dmc_model dmc = {0};
+	cm2dmMessage msgs[CMFW_SMBUS_CM2DM_WINDOW_SIZE];
+	uint8_t count;
+
+	for (int i = 0; i < ARRAY_SIZE(test_ids); i++) {
+		PostCm2DmMsg(test_ids[i], i);
+	}
+	PostCm2DmMsg(kCm2DmMsgIdFanSpeedUpdate, 60);
+	PostCm2DmMsg(kCm2DmMsgIdResetReq, kCm2DmResetLevelAsic);
+
+	/* Posted last, sent first */
+	read_window(&dmc, msgs, &count);
+	zassert_equal(count, ARRAY_SIZE(test_ids) + 2);
+	zassert_true(msgs[0].msg_id == kCm2DmMsgIdResetReq ||
+		     msgs[0].msg_id == kCm2DmMsgIdFanSpeedUpdate);
+	zassert_true(msgs[1].msg_id == kCm2DmMsgIdResetReq ||
+		     msgs[1].msg_id == kCm2DmMsgIdFanSpeedUpdate);
+
+	dmc_flush(&dmc);
+}
+
+/*
+ * Posts messages while the link loses acks and replies, repeats replies and reorders messages.
+ * Every message must be processed once, in sequence order, and the newest data of each message
+ * must arrive.
+ */
+ZTEST(cm2dm_window, test_faults)
+{
+	struct dmc_model dmc = {0};
+	uint32_t posted[kCm2DmMsgCount] = {0};
+	uint32_t faults[LINK_FAULT_COUNT] = {0};
+	uint8_t first_seq = 0;
+
+	rand_state = 0x2545F491;
+
+	for (int i = 0; i < 2000; i++) {
+		for (int n = test_rand() % 4; n > 0; n--) {
+			Cm2DmMsgId id = test_ids[test_rand() % ARRAY_SIZE(test_ids)];
+
+			posted[id] = test_rand();
+			PostCm2DmMsg(id, posted[id]);
+		}
+
+		enum link_fault fault = test_rand() % 3 == 0 ? test_rand() % LINK_FAULT_COUNT
+							      : LINK_OK;
+		uint8_t last_seq = dmc.last_seq;
+		bool last_seq_valid = dmc.last_seq_valid;
+		uint32_t processed = dmc_poll(&dmc, fault);
+
+		if (!last_seq_valid && dmc.last_seq_valid) {
+			first_seq = dmc.last_seq - processed + 1;
+		}
+
+		/* Only ever moves forward by the number of messages processed */
+		if (last_seq_valid) {
+			zassert_equal(dmc.last_seq, (uint8_t)(last_seq + processed));
+		}
+		faults[fault]++;
+	}
+
+	dmc_flush(&dmc);
+
+	TC_PRINT("%u messages, %u lost acks, %u lost replies, %u repeated, %u reordered\n",
+		 dmc.processed, faults[LINK_LOSE_ACK], faults[LINK_LOSE_REPLY], faults[LINK_REPEAT],
+		 faults[LINK_REORDER]);
+
+	zassert_equal(dmc.last_seq, (uint8_t)(first_seq + dmc.processed - 1));
+	for (int i = 0; i < ARRAY_SIZE(test_ids); i++) {
+		zassert_equal(dmc.data[test_ids[i]], posted[test_ids[i]]);
+	}
+}
+
+/* A CMFW_SMBUS_REQ read and its ack, numbered in the same sequence as the window */
+static void legacy_transfer(struct dmc_model *dmc)
+{
+	uint8_t req[] = {CMFW_SMBUS_REQ};
+	uint8_t reply[1 + sizeof(cm2dmMessage) + 1];
+	uint8_t pec = 0;
+
+	zassert_ok(i2c_write_read(i2c0_dev, tt_i2c_addr, req, sizeof(req), reply, sizeof(reply)));
+
+	uint8_t pec_data[] = {tt_i2c_addr << 1, CMFW_SMBUS_ACK, reply[1], reply[2]};
+	uint8_t ack[] = {CMFW_SMBUS_ACK, reply[1], reply[2], 0};
+
+	pec = crc8_ccitt(pec, pec_data, sizeof(pec_data));
+	ack[3] = pec;
+	zassert_ok(i2c_write(i2c0_dev, ack, sizeof(ack), tt_i2c_addr));
+
+	zassert_true(cm2dm_seq_is_next(dmc->last_seq, dmc->last_seq_valid, reply[2]));
+	dmc->last_seq = reply[2];
+	dmc->last_seq_valid = true;
+}
+
+static void window_transfer_i2c(struct dmc_model *dmc, uint8_t count)
+{
+	uint8_t req[] = {
+		CMFW_SMBUS_REQ_WINDOW, 3, dmc->last_seq_valid ? CMFW_SMBUS_CM2DM_ACK_VALID : 0,
+		dmc->last_seq,         ~dmc->last_seq,
+	};
+	uint8_t reply[1 + 2 + CMFW_SMBUS_CM2DM_WINDOW_SIZE * sizeof(cm2dmMessage) + 1];
+	size_t reply_size = 1 + 2 + count * sizeof(cm2dmMessage) + 1;
+
+	zassert_ok(i2c_write_read(i2c0_dev, tt_i2c_addr, req, sizeof(req), reply, reply_size));
+
+	/* PEC covers the whole transaction, ack included */
+	uint8_t pec_data[] = {tt_i2c_addr << 1, req[0], req[1], req[2], req[3], req[4],
+			      tt_i2c_addr << 1 | 1};
+	uint8_t pec = crc8_ccitt(0, pec_data, sizeof(pec_data));
+
+	pec = crc8_ccitt(pec, reply, reply_size - 1);
+	zassert_equal(pec, reply[reply_size - 1]);
+	zassert_equal(reply[1], count);
+
+	dmc_process(dmc, &reply[1], reply_size - 2);
+}
+
+/*
+ * Messages per second per chip over a 100 kHz bus, counting an address byte per (repeated)
+ * start plus the data and PEC. One at a time, each message costs a block read of CMFW_SMBUS_REQ
+ * and a word write of CMFW_SMBUS_ACK. Windowed, N messages cost one block write-block read that
+ * also acks the previous ones.
+ */
+ZTEST(cm2dm_window, test_messages_per_sec)
+{
+	struct dmc_model dmc = {0};
+	uint32_t legacy = 1 + 1 + 1 + 1 + sizeof(cm2dmMessage) + 1 + 1 + 1 + 2 + 1;
+
+	for (uint8_t n = 1; n <= ARRAY_SIZE(test_ids); n++) {
+		uint32_t window = 1 + 1 + 1 + 3 + 1 + 1 + 2 + n * sizeof(cm2dmMessage) + 1;
+
+		for (uint8_t i = 0; i < n; i++) {
+			PostCm2DmMsg(test_ids[i], i);
+		}
+		window_transfer_i2c(&dmc, n);
+		zassert_equal(dmc.processed, n);
+		dmc.processed = 0;
+
+		/* Ack the window, the messages read one at a time follow on from it */
+		window_transfer_i2c(&dmc, 0);
+		for (uint8_t i = 0; i < n; i++) {
+			PostCm2DmMsg(test_ids[i], i);
+			legacy_transfer(&dmc);
+		}
+
+		TC_PRINT("%u messages: %3u bytes one at a time (%4u msg/s), %3u bytes windowed "
+			 "(%4u msg/s)\n",
+			 n, legacy * n, SMBUS_BYTES_PER_SEC / legacy, window,
+			 SMBUS_BYTES_PER_SEC * n / window);
+		if (n > 1) {
+			zassert_true(window * 2 < legacy * n);
+		}
+	}
+
+	/* Ack the last window */
+	window_transfer_i2c(&dmc, 0);
+}
+
+/*
+ * A window read that fails is followed by the probe bh_chip_cmd_refused sends to tell a refusal
+ * from a bus error, then by the next window read. Neither the probe nor a CMFW_SMBUS_REQ read in
+ * between may take a message out of the sequence the window goes on with.
+ */
+ZTEST(cm2dm_window, test_probe_between_windows)
+{
+	struct dmc_model dmc = {0};
+	uint8_t probe_req[] = {CMFW_SMBUS_TEST_READ};
+	uint8_t probe_reply[2];
+	uint8_t legacy[sizeof(cm2dmMessage)];
+	uint8_t size;
+	uint8_t last_seq;
+
+	/* Start a window session */
+	PostCm2DmMsg(test_ids[0], 0);
+	dmc_flush(&dmc);
+	zassert_true(dmc.last_seq_valid);
+	last_seq = dmc.last_seq;
+
+	for (int i = 0; i < ARRAY_SIZE(test_ids); i++) {
+		PostCm2DmMsg(test_ids[i], 200 + i);
+	}
+	zassert_equal(dmc_poll(&dmc, LINK_LOSE_REPLY), 0);
+
+	zassert_ok(i2c_write_read(i2c0_dev, tt_i2c_addr, probe_req, sizeof(probe_req), probe_reply,
+				  sizeof(probe_reply)));
+	zassert_ok(Cm2DmMsgReqSmbusHandler(legacy, &size));
+
+	zassert_equal(dmc_poll(&dmc, LINK_OK), ARRAY_SIZE(test_ids));
+	zassert_equal(dmc.last_seq, (uint8_t)(last_seq + ARRAY_SIZE(test_ids)));
+	for (int i = 0; i < ARRAY_SIZE(test_ids); i++) {
+		zassert_equal(dmc.data[test_ids[i]], 200 + i);
+	}
+
+	dmc_flush(&dmc);
+}
+
+static void cm2dm_window_before(void *fixture)
+{
+	drain_legacy();
+}
+
+static void cm2dm_window_after(void *fixture)
+{
+	drain_legacy();
+}
+
+ZTEST_SUITE(cm2dm_window, NULL, NULL, cm2dm_window_before, cm2dm_window_after, NULL);
@@ -0,0 +1,480 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/ztest.h>
+
+#include <tenstorrent/tt_smbus_regs.h>
+#include <tenstorrent/uart_tt_virt.h>
+#include "cm2dm_msg.h"
+#include "telemetry.h"
+
+/*
+ * The DMC side of CMFW_SMBUS_DMC_LOG_BULK is modelled here as in send_logs_to_smc and
+ * bh_chip_write_log_chunk, and the host side reads the DMC vUART as tt-smi does.
+ */
+
+/* SMBus standard mode, the slowest of the DMC to CMFW buses, 9 bit times per byte */
+#define SMBUS_BYTES_PER_SEC (100000 / 9)
+#define SMBUS_BYTE_US       (1000000 / SMBUS_BYTES_PER_SEC)
+
+/* As in app/dmc/prj.conf */
+#define DMC_LOG_RINGBUF_SIZE 3072
+
+/* vuart2 in app.overlay */
+#define VUART_TX_CAP 512
+
+#define SIM_SECONDS 2
+
+enum link_fault {
+	LINK_OK,
+	LINK_LOSE_WRITE, /* the chunk is corrupted, the CMFW rejects it */
+	LINK_LOSE_REPLY, /* the reply fails its PEC at the DMC */
+};
+
+struct dmc_model {
+	uint8_t seq_num;
+	bool seq_num_valid;
+	uint16_t credits;
+
+	/* The chunk taken from the log ring buffer, kept until the CMFW takes it */
+	uint8_t chunk[CMFW_SMBUS_DMC_LOG_CHUNK_SIZE];
+	size_t chunk_size;
+	uint16_t chunk_dropped;
+
+	/* The DMC's log ring buffer, filled with a running count of the bytes kept */
+	uint32_t produced;
+	uint32_t taken;
+	uint32_t dropped;
+};
+
+static const struct device *const dmc_vuart_dev = DEVICE_DT_GET(DT_ALIAS(dmc_vuart));
+static const struct device *const i2c0_dev = DEVICE_DT_GET_OR_NULL(DT_NODELABEL(i2c0));
+static const uint8_t tt_i2c_addr = 0xA;
+
+/* The DMC counts dropped bytes from its own reset, which the tests don't model */
+static uint32_t dmc_dropped;
+
+/* Next byte the host expects to read from the vUART */
+static uint8_t host_next;
+
+static void dmc_init(struct dmc_model *dmc)
+{
+	memset(dmc, 0, sizeof(*dmc));
+	dmc->dropped = dmc_dropped;
+}
+
+static void dmc_fini(struct dmc_model *dmc)
+{
+	dmc_dropped = dmc->dropped;
+}
+
+static void dmc_log(struct dmc_model *dmc, uint32_t bytes)
+{
+	uint32_t room = DMC_LOG_RINGBUF_SIZE - (dmc->produced - dmc->taken);
+	uint32_t kept = MIN(room, bytes);
+
+	/* The log backend drops what doesn't fit */
+	dmc->produced += kept;
+	dmc->dropped += bytes - kept;
+}
+
+static uint32_t dmc_log_used(const struct dmc_model *dmc)
+{
+	return dmc->produced - dmc->taken;
+}
+
+/* Returns the number of log bytes the CMFW took, or a negative error code */
+static int dmc_send_chunk(struct dmc_model *dmc, enum link_fault fault)
+{
+	uint8_t buf[4 + CMFW_SMBUS_DMC_LOG_CHUNK_SIZE];
+	uint8_t reply[CONFIG_SMBUS_MAX_MSG_SIZE];
+	uint8_t reply_size;
+	size_t size;
+
+	if (dmc->chunk_size == 0) {
+		dmc->chunk_dropped = dmc->dropped;
+		if (dmc->seq_num_valid) {
+			dmc->chunk_size = MIN(MIN(dmc->credits, CMFW_SMBUS_DMC_LOG_CHUNK_SIZE),
+					      dmc_log_used(dmc));
+			for (size_t i = 0; i < dmc->chunk_size; i++) {
+				dmc->chunk[i] = dmc->taken++;
+			}
+		}
+	}
+
+	size = dmc->seq_num_valid ? dmc->chunk_size : 0;
+	buf[0] = dmc->seq_num;
+	sys_put_le16(dmc->chunk_dropped, &buf[1]);
+	memcpy(&buf[3], dmc->chunk, size);
+	buf[3 + size] = crc8(buf, 3 + size, 0x7, 0U, false);
+
+	if (fault == LINK_LOSE_WRITE) {
+		buf[1] ^= 0x40;
+		zassert_equal(Dm2CmDMCLogBulkHandler(buf, 4 + size), -1);
+		return -EIO;
+	}
+
+	zassert_ok(Dm2CmDMCLogBulkHandler(buf, 4 + size));
+	zassert_ok(Dm2CmDMCLogBulkReplyHandler(reply, &reply_size));
+	zassert_equal(reply_size, 3);
+
+	if (fault == LINK_LOSE_REPLY) {
+		return -EBADMSG;
+	}
+
+	dmc->credits = sys_get_le16(&reply[1]);
+	if (!dmc->seq_num_valid) {
+		dmc->seq_num = reply[0] + 1;
+		dmc->seq_num_valid = true;
+		return 0;
+	}
+
+	zassert_true(size == 0 || reply[0] == dmc->seq_num);
+	if (size > 0) {
+		dmc->seq_num++;
+	}
+	dmc->chunk_size = 0;
+
+	return size;
+}
+
+/* Reads up to max bytes from the vUART, checks they are the running count, returns how many */
+static uint32_t host_read(uint32_t max)
+{
+	volatile struct tt_vuart *vuart = uart_tt_virt_get(dmc_vuart_dev);
+	unsigned char ch;
+	uint32_t n;
+
+	for (n = 0; n < max; n++) {
+		if (tt_vuart_poll_in(vuart, &ch, TT_VUART_ROLE_HOST) == -1) {
+			break;
+		}
+		zassert_equal(ch, host_next, "byte %u", n);
+		host_next++;
+	}
+
+	return n;
+}
+
+static void host_flush(void)
+{
+	volatile struct tt_vuart *vuart = uart_tt_virt_get(dmc_vuart_dev);
+	unsigned char ch;
+
+	while (tt_vuart_poll_in(vuart, &ch, TT_VUART_ROLE_HOST) != -1) {
+	}
+}
+
+static uint32_t vuart_used(void)
+{
+	volatile struct tt_vuart *vuart = uart_tt_virt_get(dmc_vuart_dev);
+
+	return vuart->tx_tail - vuart->tx_head;
+}
+
+ZTEST(dmc_log, test_chunk)
+{
+	struct dmc_model dmc;
+
+	dmc_init(&dmc);
+	dmc_log(&dmc, 100);
+
+	/* The first chunk only learns the sequence number and the credits */
+	zassert_equal(dmc_send_chunk(&dmc, LINK_OK), 0);
+	zassert_true(dmc.seq_num_valid);
+	zassert_equal(dmc.credits, VUART_TX_CAP);
+
+	zassert_equal(dmc_send_chunk(&dmc, LINK_OK), CMFW_SMBUS_DMC_LOG_CHUNK_SIZE);
+	zassert_equal(dmc.credits, VUART_TX_CAP - CMFW_SMBUS_DMC_LOG_CHUNK_SIZE);
+	zassert_equal(vuart_used(), CMFW_SMBUS_DMC_LOG_CHUNK_SIZE);
+
+	while (dmc_log_used(&dmc) > 0) {
+		zassert_true(dmc_send_chunk(&dmc, LINK_OK) > 0);
+	}
+	zassert_equal(host_read(UINT32_MAX), 100);
+	dmc_fini(&dmc);
+}
+
+ZTEST(dmc_log, test_faults)
+{
+	struct dmc_model dmc;
+
+	dmc_init(&dmc);
+	zassert_equal(dmc_send_chunk(&dmc, LINK_OK), 0);
+	dmc_log(&dmc, 3 * CMFW_SMBUS_DMC_LOG_CHUNK_SIZE);
+
+	/* A rejected chunk isn't logged, the resend is */
+	zassert_equal(dmc_send_chunk(&dmc, LINK_LOSE_WRITE), -EIO);
+	zassert_equal(vuart_used(), 0);
+	zassert_equal(dmc_send_chunk(&dmc, LINK_OK), CMFW_SMBUS_DMC_LOG_CHUNK_SIZE);
+
+	/* A chunk whose reply was lost is taken, the resend is ignored */
+	zassert_equal(dmc_send_chunk(&dmc, LINK_LOSE_REPLY), -EBADMSG);
+	zassert_equal(vuart_used(), 2 * CMFW_SMBUS_DMC_LOG_CHUNK_SIZE);
+	zassert_equal(dmc_send_chunk(&dmc, LINK_OK), CMFW_SMBUS_DMC_LOG_CHUNK_SIZE);
+	zassert_equal(vuart_used(), 2 * CMFW_SMBUS_DMC_LOG_CHUNK_SIZE);
+
+	zassert_equal(dmc_send_chunk(&dmc, LINK_OK), CMFW_SMBUS_DMC_LOG_CHUNK_SIZE);
+	zassert_equal(host_read(UINT32_MAX), 3 * CMFW_SMBUS_DMC_LOG_CHUNK_SIZE);
+	dmc_fini(&dmc);
+}
+
+ZTEST(dmc_log, test_credits)
+{
+	struct dmc_model dmc;
+	uint32_t overrun = GetTelemetryTag(TAG_DMC_LOG_OVERRUN);
+
+	dmc_init(&dmc);
+	zassert_equal(dmc_send_chunk(&dmc, LINK_OK), 0);
+	dmc_log(&dmc, 2 * VUART_TX_CAP);
+
+	/* Without a host reading the vUART, the DMC stops when it runs out of credits */
+	while (dmc_send_chunk(&dmc, LINK_OK) > 0) {
+	}
+	zassert_equal(dmc.credits, 0);
+	zassert_equal(vuart_used(), VUART_TX_CAP);
+	zassert_equal(dmc_log_used(&dmc), VUART_TX_CAP);
+	zassert_equal(GetTelemetryTag(TAG_DMC_LOG_OVERRUN), overrun);
+
+	/* And carries on once it has read some */
+	zassert_equal(host_read(100), 100);
+	zassert_equal(dmc_send_chunk(&dmc, LINK_OK), 0);
+	zassert_equal(dmc.credits, 100);
+
+	/* A DMC that ignores the credits loses what doesn't fit, and it's counted */
+	dmc.credits = CMFW_SMBUS_DMC_LOG_CHUNK_SIZE;
+	for (int i = 0; i < 4; i++) {
+		dmc_send_chunk(&dmc, LINK_OK);
+		dmc.credits = CMFW_SMBUS_DMC_LOG_CHUNK_SIZE;
+	}
+	zassert_equal(GetTelemetryTag(TAG_DMC_LOG_OVERRUN),
+		      overrun + 4 * CMFW_SMBUS_DMC_LOG_CHUNK_SIZE - 100);
+
+	/* What was forwarded is still in order */
+	zassert_equal(host_read(UINT32_MAX), VUART_TX_CAP);
+	dmc_fini(&dmc);
+}
+
+ZTEST(dmc_log, test_dropped)
+{
+	struct dmc_model dmc;
+	uint32_t dropped;
+
+	dmc_init(&dmc);
+	zassert_equal(dmc_send_chunk(&dmc, LINK_OK), 0);
+	dropped = GetTelemetryTag(TAG_DMC_LOG_DROPPED);
+
+	/* Only the low 16 bits go over the bus, the CMFW counts past them */
+	for (int i = 0; i < 5; i++) {
+		dmc_log(&dmc, DMC_LOG_RINGBUF_SIZE + 20000);
+		zassert_true(dmc_send_chunk(&dmc, LINK_OK) > 0);
+		zassert_equal(host_read(UINT32_MAX), CMFW_SMBUS_DMC_LOG_CHUNK_SIZE);
+
+		/* Skip the rest of the ring buffer */
+		dmc.taken = dmc.produced;
+		host_next = dmc.taken;
+	}
+	zassert_equal(GetTelemetryTag(TAG_DMC_LOG_DROPPED), dropped + 5 * 20000);
+	dmc_fini(&dmc);
+}
+
+/* A CMFW_SMBUS_REQ_WINDOW transaction that acks up to last_seq, returns the newest message */
+static cm2dmMessage cm2dm_window(uint8_t last_seq, bool last_seq_valid, cm2dmMessage *first)
+{
+	uint8_t ack[3] = {last_seq_valid ? CMFW_SMBUS_CM2DM_ACK_VALID : 0, last_seq, ~last_seq};
+	uint8_t reply[CONFIG_SMBUS_MAX_MSG_SIZE];
+	uint8_t size;
+	cm2dmMessage last;
+
+	zassert_ok(Cm2DmMsgWindowAckSmbusHandler(ack, sizeof(ack)));
+	zassert_ok(Cm2DmMsgWindowReqSmbusHandler(reply, &size));
+	zassert_true(reply[0] > 0);
+	memcpy(first, &reply[2], sizeof(*first));
+	memcpy(&last, &reply[2 + (reply[0] - 1) * sizeof(last)], sizeof(last));
+
+	return last;
+}
+
+/*
+ * The DMC follows a chunk the bus NAKed with the probe of bh_chip_cmd_refused. The log channel
+ * shares the bus with the CM2DM messages, the probe must leave their window as it was.
+ */
+ZTEST(dmc_log, test_error_keeps_cm2dm)
+{
+	struct dmc_model dmc;
+	uint8_t probe_req[] = {CMFW_SMBUS_TEST_READ};
+	uint8_t probe_reply[2];
+	uint8_t reply[CONFIG_SMBUS_MAX_MSG_SIZE];
+	uint8_t size;
+	cm2dmMessage first;
+	cm2dmMessage last;
+	uint8_t last_seq;
+
+	/* A window session, the DMC has processed every message so far */
+	PostCm2DmMsg(kCm2DmMsgIdLedBlink, 1);
+	last = cm2dm_window(0, false, &first);
+	zassert_equal(last.msg_id, kCm2DmMsgIdLedBlink);
+
+	dmc_init(&dmc);
+	zassert_equal(dmc_send_chunk(&dmc, LINK_OK), 0);
+	dmc_log(&dmc, CMFW_SMBUS_DMC_LOG_CHUNK_SIZE);
+	zassert_equal(dmc_send_chunk(&dmc, LINK_LOSE_WRITE), -EIO);
+	zassert_ok(i2c_write_read(i2c0_dev, tt_i2c_addr, probe_req, sizeof(probe_req), probe_reply,
+				  sizeof(probe_reply)));
+
+	/* The next window follows on from the DMC's last message */
+	PostCm2DmMsg(kCm2DmMsgIdLedBlink, 2);
+	last_seq = last.seq_num;
+	last = cm2dm_window(last_seq, true, &first);
+	zassert_equal(first.seq_num, (uint8_t)(last_seq + 1));
+	zassert_equal(last.msg_id, kCm2DmMsgIdLedBlink);
+	zassert_equal(last.data, 2);
+
+	/* Ack it, with no more messages posted the window is empty */
+	uint8_t ack[3] = {CMFW_SMBUS_CM2DM_ACK_VALID, last.seq_num, ~last.seq_num};
+
+	zassert_ok(Cm2DmMsgWindowAckSmbusHandler(ack, sizeof(ack)));
+	zassert_ok(Cm2DmMsgWindowReqSmbusHandler(reply, &size));
+	zassert_equal(reply[0], 0);
+
+	/* And the chunk goes through when it is sent again */
+	zassert_equal(dmc_send_chunk(&dmc, LINK_OK), CMFW_SMBUS_DMC_LOG_CHUNK_SIZE);
+	zassert_equal(host_read(UINT32_MAX), CMFW_SMBUS_DMC_LOG_CHUNK_SIZE);
+	dmc_fini(&dmc);
+}
+
+struct log_sim_result {
+	uint32_t delivered; /* bytes/s */
+	uint32_t dropped;   /* bytes */
+	uint32_t max_power_wait_us;
+};
+
+/*
+ * SIM_SECONDS of a DMC logging rate bytes/s while it sends its board power every ms, over a
+ * 100 kHz bus, with the host reading the vUART every 10 ms. Bus time counts an address byte per
+ * (repeated) start plus the data and PEC. The board power update is a word write. A legacy
+ * CMFW_SMBUS_DMC_LOG is a block write of up to 32 bytes, on the 20 ms timer. A
+ * CMFW_SMBUS_DMC_LOG_BULK chunk is a block write-block read that is sent again on the next pass
+ * of the event loop while there are credits, or on the timer to ask for credits.
+ */
+static void log_sim(uint32_t rate, bool bulk, struct log_sim_result *res)
+{
+	const uint32_t power_us = (1 + 1 + 2 + 1) * SMBUS_BYTE_US;
+	const uint32_t legacy_max = 32;
+	struct dmc_model dmc;
+	uint32_t t = 0;
+	uint32_t next_power = 0;
+	uint32_t next_timer = 0;
+	uint32_t next_host = 0;
+	uint32_t logged = 0;
+	bool log_event = false;
+	uint32_t dropped;
+
+	dmc_init(&dmc);
+	host_next = 0;
+	dropped = dmc.dropped;
+	memset(res, 0, sizeof(*res));
+
+	while (t < SIM_SECONDS * USEC_PER_SEC) {
+		uint32_t due = (uint64_t)t * rate / USEC_PER_SEC;
+
+		dmc_log(&dmc, due - logged);
+		logged = due;
+
+		if (t >= next_host) {
+			res->delivered += host_read(UINT32_MAX);
+			next_host += 10 * USEC_PER_MSEC;
+		}
+
+		if (t >= next_timer) {
+			log_event = true;
+			next_timer += 20 * USEC_PER_MSEC;
+		}
+
+		/*
+		 * Jobs posted meanwhile go first, the log goes last. Power updates posted again
+		 * before they ran are merged into one.
+		 */
+		if (t >= next_power) {
+			res->max_power_wait_us = MAX(res->max_power_wait_us, t - next_power);
+			t += power_us;
+			next_power = ROUND_UP(t + 1, USEC_PER_MSEC);
+		} else if (log_event && !bulk) {
+			uint32_t size = MIN(legacy_max, dmc_log_used(&dmc));
+			uint8_t buf[32];
+
+			for (uint32_t i = 0; i < size; i++) {
+				buf[i] = dmc.taken++;
+			}
+			if (size > 0) {
+				zassert_ok(Dm2CmDMCLogHandler(buf, size));
+				t += (1 + 1 + 1 + size + 1) * SMBUS_BYTE_US;
+			}
+			log_event = false;
+		} else if (log_event) {
+			int ret = dmc_send_chunk(&dmc, LINK_OK);
+
+			zassert_true(ret >= 0);
+			log_event = dmc.credits > 0 && dmc_log_used(&dmc) > 0;
+			t += (1 + 1 + 1 + 3 + ret + 1 + 1 + 1 + 3 + 1) * SMBUS_BYTE_US;
+		} else {
+			t = MIN(MIN(next_power, next_timer), next_host);
+		}
+	}
+
+	res->delivered += host_read(UINT32_MAX);
+	res->delivered /= SIM_SECONDS;
+	res->dropped = dmc.dropped - dropped;
+	dmc_fini(&dmc);
+}
+
+/*
+ * Sustained log throughput, and how long the board power updates wait for the log, for a DMC
+ * logging at a quiet rate and during a fault storm.
+ */
+ZTEST(dmc_log, test_throughput)
+{
+	static const uint32_t rates[] = {500, 1000, 2000, 4000};
+	struct log_sim_result legacy;
+	struct log_sim_result bulk;
+
+	for (int i = 0; i < ARRAY_SIZE(rates); i++) {
+		log_sim(rates[i], false, &legacy);
+		log_sim(rates[i], true, &bulk);
+
+		TC_PRINT("%4u B/s logged: legacy %4u B/s (%4u dropped, power waits %4u us), "
+			 "bulk %4u B/s (%4u dropped, power waits %4u us)\n",
+			 rates[i], legacy.delivered, legacy.dropped, legacy.max_power_wait_us,
+			 bulk.delivered, bulk.dropped, bulk.max_power_wait_us);
+
+		/* Kilobytes per second of log, without losing any */
+		zassert_equal(bulk.dropped, 0);
+		zassert_true(bulk.delivered + DMC_LOG_RINGBUF_SIZE / 8 >= rates[i]);
+
+		/* A power update waits for no more than a chunk */
+		zassert_true(bulk.max_power_wait_us <=
+			     (12 + CMFW_SMBUS_DMC_LOG_CHUNK_SIZE) * SMBUS_BYTE_US);
+	}
+
+	/* The legacy path falls behind above 32 bytes per 20 ms */
+	zassert_true(legacy.dropped > 0);
+	zassert_true(bulk.delivered > 2 * legacy.delivered);
+}
+
+static void dmc_log_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	host_flush();
+	host_next = 0;
+}
+
+ZTEST_SUITE(dmc_log, NULL, NULL, dmc_log_before, NULL, NULL);
@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+
+#include "aiclk_ppm.h"
+#include "dvfs_trace.h"
+#include "vf_curve.h"
+#include "voltage.h"
+
+#define DEPTH CONFIG_TT_BH_ARC_DVFS_TRACE_DEPTH
+
+/* Arbiter settings for one DVFS iteration and the decision expected from them */
+struct script_step {
+	uint32_t busy;
+	uint32_t tdp;
+	uint32_t thm;
+	uint32_t targ_freq;
+	enum targ_freq_reason reason;
+	uint32_t arbiter;
+};
+
+static uint32_t fmin;
+static uint32_t fmax;
+static VoltageArbiter saved_voltage_arbiter;
+
+static const struct dvfs_trace_record *record_at(const struct dvfs_trace *trace, uint32_t index)
+{
+	return &trace->records[index % trace->capacity];
+}
+
+/* The arbitration and voltage stages of DVFSChange, recorded as if stage i took (i + 1) * 100 us */
+static void replay(const struct script_step *step)
+{
+	uint32_t stage_cycles[DVFS_TRACE_STAGE_COUNT + 1] = {0};
+
+	for (int i = 0; i < DVFS_TRACE_STAGE_COUNT; i++) {
+		stage_cycles[i + 1] = stage_cycles[i] + k_us_to_cyc_ceil32((i + 1) * 100);
+	}
+
+	SetAiclkArbMin(aiclk_arb_min_busy, step->busy);
+	SetAiclkArbMax(aiclk_arb_max_tdp, step->tdp);
+	SetAiclkArbMax(aiclk_arb_max_thm, step->thm);
+
+	CalculateTargAiclk();
+
+	uint32_t aiclk_voltage = VFCurve(GetAiclkTarg());
+
+	VoltageArbRequest(VoltageReqAiclk, aiclk_voltage);
+	CalculateTargVoltage();
+
+	dvfs_trace_sample(aiclk_voltage, voltage_arbiter.targ_voltage, stage_cycles);
+}
+
+static uint32_t send_trace_request(uint8_t flags, struct response *rsp)
+{
+	union request req = {0};
+
+	req.dvfs_trace.command_code = TT_SMC_MSG_DVFS_TRACE;
+	req.dvfs_trace.flags = flags;
+
+	*rsp = (struct response){0};
+	msgqueue_request_push(0, &req);
+	process_message_queues();
+	msgqueue_response_pop(0, rsp);
+
+	return rsp->data[0];
+}
+
+ZTEST(dvfs_trace, test_layout)
+{
+	const struct dvfs_trace *trace = dvfs_trace_get();
+
+	zassert_equal(trace->version, DVFS_TRACE_VERSION);
+	zassert_equal(trace->capacity, DEPTH);
+	zassert_equal(trace->record_size, sizeof(struct dvfs_trace_record));
+	zassert_equal((uintptr_t)trace, dvfs_trace_addr());
+	zassert_equal(trace->head, 0);
+}
+
+ZTEST(dvfs_trace, test_replay)
+{
+	/* A busy workload that is throttled by TDP, then by temperature, then goes idle */
+	const struct script_step script[] = {
+		{fmax, fmax, fmax, fmax, limit_reason_min_arb, aiclk_arb_min_busy},
+		{fmax, 1000, fmax, 1000, limit_reason_max_arb, aiclk_arb_max_tdp},
+		{fmax, 1000, 900, 900, limit_reason_max_arb, aiclk_arb_max_thm},
+		{fmax, fmax, 900, 900, limit_reason_max_arb, aiclk_arb_max_thm},
+		{fmax, fmax, fmin / 2, fmin, limit_reason_fmin, 0},
+		{fmin, fmax, fmax, fmin, limit_reason_min_arb, aiclk_arb_min_busy},
+	};
+	const struct dvfs_trace *trace = dvfs_trace_get();
+	uint32_t last_timestamp = 0;
+
+	for (int i = 0; i < ARRAY_SIZE(script); i++) {
+		replay(&script[i]);
+		k_busy_wait(USEC_PER_MSEC);
+	}
+
+	zassert_equal(trace->head, ARRAY_SIZE(script));
+
+	for (int i = 0; i < ARRAY_SIZE(script); i++) {
+		const struct dvfs_trace_record *record = record_at(trace, i);
+		uint32_t voltage = CLAMP(VFCurve(script[i].targ_freq), voltage_arbiter.vdd_min,
+					 voltage_arbiter.vdd_max);
+
+		zassert_equal(record->targ_freq, script[i].targ_freq, "step %d", i);
+		zassert_equal(record->reason, script[i].reason, "step %d", i);
+		zassert_equal(record->arbiter, script[i].arbiter, "step %d", i);
+		zassert_equal(record->aiclk_voltage, VFCurve(script[i].targ_freq), "step %d", i);
+		zassert_equal(record->targ_voltage, voltage, "step %d", i);
+		zassert_true(record->timestamp_us > last_timestamp, "step %d", i);
+		last_timestamp = record->timestamp_us;
+
+		for (int j = 0; j < DVFS_TRACE_STAGE_COUNT; j++) {
+			zassert_within(record->stage_us[j], (j + 1) * 100, 1, "step %d", i);
+		}
+	}
+}
+
+ZTEST(dvfs_trace, test_stage_saturation)
+{
+	const struct dvfs_trace *trace = dvfs_trace_get();
+	uint32_t stage_cycles[DVFS_TRACE_STAGE_COUNT + 1] = {0};
+
+	stage_cycles[DVFS_TRACE_STAGE_COUNT] = k_ms_to_cyc_ceil32(100);
+
+	dvfs_trace_sample(800, 800, stage_cycles);
+
+	zassert_equal(trace->head, 1);
+	zassert_equal(trace->records[0].stage_us[DVFS_TRACE_STAGE_THROTTLERS], 0);
+	zassert_equal(trace->records[0].stage_us[DVFS_TRACE_STAGE_TRANSITION], UINT16_MAX);
+}
+
+ZTEST(dvfs_trace, test_wraparound)
+{
+	const struct dvfs_trace *trace = dvfs_trace_get();
+	uint32_t total = DEPTH * 2 + DEPTH / 2;
+
+	for (uint32_t i = 0; i < total; i++) {
+		struct dvfs_trace_record record = {.timestamp_us = i, .targ_freq = i % 1400};
+
+		dvfs_trace_push(&record);
+	}
+
+	zassert_equal(trace->head, total);
+
+	/* Only the newest DEPTH records are retained, in order */
+	for (uint32_t i = total - DEPTH; i < total; i++) {
+		zassert_equal(record_at(trace, i)->timestamp_us, i, "record %u", i);
+		zassert_equal(record_at(trace, i)->targ_freq, i % 1400, "record %u", i);
+	}
+}
+
+ZTEST(dvfs_trace, test_handler)
+{
+	const struct dvfs_trace *trace = dvfs_trace_get();
+	const struct script_step step = {fmax, 1000, fmax, 1000, limit_reason_max_arb,
+					 aiclk_arb_max_tdp};
+	struct response rsp;
+
+	zassert_equal(send_trace_request(0, &rsp), 0);
+	zassert_equal(rsp.data[1], dvfs_trace_addr());
+	zassert_equal(rsp.data[2], DEPTH);
+	zassert_equal(rsp.data[3], 0);
+	zassert_equal(rsp.data[4], 1);
+
+	replay(&step);
+	replay(&step);
+
+	/* Stopping keeps the records, but no new ones are added */
+	zassert_equal(send_trace_request(DVFS_TRACE_FLAG_STOP, &rsp), 0);
+	zassert_equal(rsp.data[3], 2);
+	zassert_equal(rsp.data[4], 0);
+	replay(&step);
+	zassert_equal(trace->head, 2);
+
+	zassert_not_equal(send_trace_request(DVFS_TRACE_FLAG_STOP | DVFS_TRACE_FLAG_START, &rsp),
+			  0);
+
+	/* Clear and restart in one request */
+	zassert_equal(send_trace_request(DVFS_TRACE_FLAG_CLEAR | DVFS_TRACE_FLAG_START, &rsp), 0);
+	zassert_equal(rsp.data[3], 0);
+	zassert_equal(rsp.data[4], 1);
+	replay(&step);
+	zassert_equal(trace->head, 1);
+	zassert_equal(trace->records[0].arbiter, aiclk_arb_max_tdp);
+}
+
+static void *dvfs_trace_setup(void)
+{
+	fmin = GetAiclkFmin();
+	fmax = GetAiclkFmax();
+
+	return NULL;
+}
+
+static void dvfs_trace_before(void *fixture)
+{
+	saved_voltage_arbiter = voltage_arbiter;
+	voltage_arbiter.vdd_min = 700;
+	voltage_arbiter.vdd_max = 900;
+	voltage_arbiter.forced_voltage = 0;
+	voltage_arbiter.req_voltage[VoltageReqL2CPU] = 700;
+
+	for (int i = 0; i < aiclk_arb_max_count; i++) {
+		SetAiclkArbMax(i, fmax);
+		EnableArbMax(i, i == aiclk_arb_max_tdp || i == aiclk_arb_max_thm);
+	}
+	for (int i = 0; i < aiclk_arb_min_count; i++) {
+		SetAiclkArbMin(i, fmin);
+		EnableArbMin(i, true);
+	}
+
+	dvfs_trace_enable(true);
+	dvfs_trace_clear();
+}
+
+static void dvfs_trace_after(void *fixture)
+{
+	voltage_arbiter = saved_voltage_arbiter;
+
+	for (int i = 0; i < aiclk_arb_max_count; i++) {
+		SetAiclkArbMax(i, fmax);
+		EnableArbMax(i, i != aiclk_arb_max_host_fmax);
+	}
+	for (int i = 0; i < aiclk_arb_min_count; i++) {
+		SetAiclkArbMin(i, fmin);
+		EnableArbMin(i, true);
+	}
+	CalculateTargAiclk();
+
+	dvfs_trace_enable(true);
+	dvfs_trace_clear();
+}
+
+ZTEST_SUITE(dvfs_trace, NULL, dvfs_trace_setup, dvfs_trace_before, dvfs_trace_after, NULL);
@@ -0,0 +1,465 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "asic_state.h"
+#include "dw_apb_i2c.h"
+#include "reg_mock.h"
+
+/*
+ * Model of a DW APB I2C master with one PMBus target behind it. Time advances by
+ * REG_ACCESS_NS for every register access and the bus moves one byte every BYTE_NS, so polling
+ * costs register accesses in proportion to the bus time, as it does on the ARC.
+ */
+#define I2C_ID        1
+#define I2C_BASE      0x80090000
+#define REFCLK_LO     0x800300E0
+#define REFCLK_HI     0x800300E4
+#define TARGET_ADDR   0x64
+#define FIFO_DEPTH    8
+#define REG_ACCESS_NS 25
+#define BYTE_NS       22500 /* 9 bits at 400 kHz */
+
+#define IC_DATA_CMD       0x10
+#define IC_INTR_STAT      0x2C
+#define IC_INTR_MASK      0x30
+#define IC_RAW_INTR_STAT  0x34
+#define IC_RX_TL          0x38
+#define IC_TX_TL          0x3C
+#define IC_CLR_TX_ABRT    0x54
+#define IC_CLR_STOP_DET   0x60
+#define IC_STATUS         0x70
+#define IC_TX_ABRT_SOURCE 0x80
+#define IC_TAR            0x04
+
+#define INTR_RX_FULL  BIT(2)
+#define INTR_TX_EMPTY BIT(4)
+#define INTR_TX_ABRT  BIT(6)
+#define INTR_STOP_DET BIT(9)
+
+#define CMD_READ BIT(8)
+#define CMD_STOP BIT(9)
+
+/* Abort code of dw_apb_i2c.c for a transaction that timed out */
+#define IC_TIMEOUT BIT(24)
+
+static struct {
+	uint64_t now_ns;
+	uint64_t next_byte_ns;
+	uint32_t tx_fifo[FIFO_DEPTH];
+	uint32_t tx_head;
+	uint32_t tx_count;
+	uint8_t rx_fifo[FIFO_DEPTH];
+	uint32_t rx_head;
+	uint32_t rx_count;
+	uint32_t latched_intr;
+	uint32_t intr_mask;
+	uint32_t rx_tl;
+	uint32_t tx_tl;
+	uint32_t tar;
+	uint32_t abrt_source;
+	bool in_transfer;
+	bool rx_overflow;
+	/* Target: the first byte written is the PMBus command, then data */
+	bool have_cmd;
+	uint8_t cmd;
+	uint8_t ptr;
+	uint8_t regs[256][16];
+	uint32_t accesses;
+} m;
+
+static bool deliver_irq;
+
+static uint32_t raw_intr(void)
+{
+	uint32_t raw = m.latched_intr;
+
+	if (m.tx_count <= m.tx_tl) {
+		raw |= INTR_TX_EMPTY;
+	}
+	if (m.rx_count > m.rx_tl) {
+		raw |= INTR_RX_FULL;
+	}
+	return raw;
+}
+
+static void bus_byte(void)
+{
+	uint32_t entry = m.tx_fifo[m.tx_head];
+
+	m.tx_head = (m.tx_head + 1) % FIFO_DEPTH;
+	m.tx_count--;
+
+	if (!m.in_transfer) {
+		if (m.tar != TARGET_ADDR) {
+			/* Address NACK: the FIFO is flushed and a stop is sent */
+			m.abrt_source = BIT(0);
+			m.tx_count = 0;
+			m.latched_intr |= INTR_TX_ABRT | INTR_STOP_DET;
+			return;
+		}
+		m.in_transfer = true;
+		m.have_cmd = false;
+	}
+
+	if (entry & CMD_READ) {
+		if (m.rx_count == FIFO_DEPTH) {
+			m.rx_overflow = true;
+		} else {
+			m.rx_fifo[(m.rx_head + m.rx_count++) % FIFO_DEPTH] =
+				m.regs[m.cmd][m.ptr++ % sizeof(m.regs[0])];
+		}
+	} else if (!m.have_cmd) {
+		m.cmd = entry & 0xFF;
+		m.ptr = 0;
+		m.have_cmd = true;
+	} else {
+		m.regs[m.cmd][m.ptr++ % sizeof(m.regs[0])] = entry & 0xFF;
+	}
+
+	if (entry & CMD_STOP) {
+		m.in_transfer = false;
+		m.latched_intr |= INTR_STOP_DET;
+	}
+}
+
+static void bus_advance(uint64_t now_ns)
+{
+	m.now_ns = now_ns;
+	while (m.tx_count > 0 && m.next_byte_ns <= m.now_ns) {
+		bus_byte();
+		m.next_byte_ns += BYTE_NS;
+	}
+	if (m.tx_count == 0) {
+		m.next_byte_ns = m.now_ns + BYTE_NS;
+	}
+}
+
+static uint32_t model_read(uint32_t addr)
+{
+	uint32_t offset = addr - I2C_BASE;
+	uint32_t val = 0;
+
+	m.accesses++;
+	bus_advance(m.now_ns + REG_ACCESS_NS);
+
+	if (addr == REFCLK_LO) {
+		return (uint32_t)(m.now_ns / 20);
+	} else if (addr == REFCLK_HI) {
+		return (uint32_t)((m.now_ns / 20) >> 32);
+	}
+
+	switch (offset) {
+	case IC_STATUS:
+		/* TFNF, TFE, RFNE and MST_ACTIVITY */
+		val |= m.tx_count < FIFO_DEPTH ? 0x2 : 0;
+		val |= m.tx_count == 0 ? 0x4 : 0;
+		val |= m.rx_count > 0 ? 0x8 : 0;
+		val |= (m.in_transfer || m.tx_count > 0) ? 0x20 : 0;
+		break;
+	case IC_DATA_CMD:
+		if (m.rx_count > 0) {
+			val = m.rx_fifo[m.rx_head];
+			m.rx_head = (m.rx_head + 1) % FIFO_DEPTH;
+			m.rx_count--;
+		}
+		break;
+	case IC_RAW_INTR_STAT:
+		val = raw_intr();
+		break;
+	case IC_INTR_STAT:
+		val = raw_intr() & m.intr_mask;
+		break;
+	case IC_INTR_MASK:
+		val = m.intr_mask;
+		break;
+	case IC_TX_ABRT_SOURCE:
+		val = m.abrt_source;
+		break;
+	case IC_CLR_TX_ABRT:
+		m.abrt_source = 0;
+		m.latched_intr &= ~INTR_TX_ABRT;
+		break;
+	case IC_CLR_STOP_DET:
+		m.latched_intr &= ~INTR_STOP_DET;
+		break;
+	default:
+		break;
+	}
+
+	return val;
+}
+
+static void model_write(uint32_t addr, uint32_t val)
+{
+	m.accesses++;
+	bus_advance(m.now_ns + REG_ACCESS_NS);
+
+	switch (addr - I2C_BASE) {
+	case IC_DATA_CMD:
+		zassert_true(m.tx_count < FIFO_DEPTH, "TX FIFO overflow");
+		m.tx_fifo[(m.tx_head + m.tx_count++) % FIFO_DEPTH] = val;
+		break;
+	case IC_INTR_MASK:
+		m.intr_mask = val;
+		break;
+	case IC_RX_TL:
+		m.rx_tl = val;
+		break;
+	case IC_TX_TL:
+		m.tx_tl = val;
+		break;
+	case IC_TAR:
+		m.tar = val;
+		break;
+	default:
+		break;
+	}
+}
+
+/* Let the bus run for ns while the CPU does something else, raising interrupts as they come */
+static void model_run(uint64_t ns)
+{
+	bus_advance(m.now_ns + ns);
+
+	while (deliver_irq && (raw_intr() & m.intr_mask)) {
+		I2CAsyncIsr(I2C_ID);
+	}
+}
+
+static void bus_timer_handler(struct k_timer *timer)
+{
+	model_run(1000000);
+}
+
+static K_TIMER_DEFINE(bus_timer, bus_timer_handler, NULL);
+
+static void select_target(uint32_t addr)
+{
+	I2CInit(I2CMst, addr, I2CFastMode, I2C_ID);
+	m.accesses = 0;
+}
+
+struct async_result {
+	uint32_t calls;
+	uint32_t ic_error;
+	uint32_t order;
+};
+
+static uint32_t completions;
+
+static void async_done(uint32_t id, uint32_t ic_error, void *user_data)
+{
+	struct async_result *result = user_data;
+
+	zassert_equal(id, I2C_ID);
+	result->calls++;
+	result->ic_error = ic_error;
+	result->order = completions++;
+}
+
+static void run_until_done(const struct async_result *result)
+{
+	for (int i = 0; i < 1000 && result->calls == 0; i++) {
+		model_run(BYTE_NS);
+	}
+	zassert_equal(result->calls, 1);
+}
+
+ZTEST(dw_apb_i2c, test_async_write_read)
+{
+	const uint8_t write[] = {0x21, 0x5A, 0xA5};
+	const uint8_t cmd = 0x21;
+	uint8_t read[2] = {0};
+	struct async_result wr_result = {0};
+	struct async_result rd_result = {0};
+	struct i2c_async_request wr = {
+		.write_data = write,
+		.write_len = sizeof(write),
+		.callback = async_done,
+		.user_data = &wr_result,
+	};
+	struct i2c_async_request rd = {
+		.write_data = &cmd,
+		.write_len = 1,
+		.read_data = read,
+		.read_len = sizeof(read),
+		.callback = async_done,
+		.user_data = &rd_result,
+	};
+
+	select_target(TARGET_ADDR);
+	I2CAsyncEnable(I2C_ID, true);
+
+	/* The read queues behind the write */
+	zassert_ok(I2CTransactionAsync(I2C_ID, &wr));
+	zassert_ok(I2CTransactionAsync(I2C_ID, &rd));
+	run_until_done(&rd_result);
+
+	zassert_equal(wr_result.calls, 1);
+	zassert_equal(wr_result.ic_error, 0);
+	zassert_equal(rd_result.ic_error, 0);
+	zassert_true(wr_result.order < rd_result.order);
+	zassert_equal(read[0], 0x5A);
+	zassert_equal(read[1], 0xA5);
+	zassert_equal(m.intr_mask, 0);
+}
+
+ZTEST(dw_apb_i2c, test_async_long_read)
+{
+	const uint8_t cmd = 0x30;
+	uint8_t read[sizeof(m.regs[0])];
+	struct async_result result = {0};
+	struct i2c_async_request req = {
+		.write_data = &cmd,
+		.write_len = 1,
+		.read_data = read,
+		.read_len = sizeof(read),
+		.callback = async_done,
+		.user_data = &result,
+	};
+
+	for (int i = 0; i < sizeof(read); i++) {
+		m.regs[cmd][i] = i * 3;
+	}
+
+	select_target(TARGET_ADDR);
+	I2CAsyncEnable(I2C_ID, true);
+
+	/* More bytes than the RX FIFO holds */
+	zassert_ok(I2CTransactionAsync(I2C_ID, &req));
+	run_until_done(&result);
+
+	zassert_equal(result.ic_error, 0);
+	zassert_false(m.rx_overflow);
+	for (int i = 0; i < sizeof(read); i++) {
+		zassert_equal(read[i], i * 3);
+	}
+}
+
+ZTEST(dw_apb_i2c, test_async_nack)
+{
+	const uint8_t cmd = 0x8B;
+	uint8_t read[2];
+	struct async_result result = {0};
+	struct i2c_async_request req = {
+		.write_data = &cmd,
+		.write_len = 1,
+		.read_data = read,
+		.read_len = sizeof(read),
+		.callback = async_done,
+		.user_data = &result,
+	};
+
+	select_target(TARGET_ADDR + 1);
+	I2CAsyncEnable(I2C_ID, true);
+
+	zassert_ok(I2CTransactionAsync(I2C_ID, &req));
+	run_until_done(&result);
+	zassert_equal(result.ic_error, BIT(0));
+}
+
+ZTEST(dw_apb_i2c, test_async_disabled)
+{
+	const uint8_t cmd = 0x8B;
+	struct i2c_async_request req = {.write_data = &cmd, .write_len = 1};
+
+	zassert_equal(I2CTransactionAsync(I2C_ID, &req), -EINVAL);
+
+	I2CAsyncEnable(I2C_ID, true);
+	set_asic_state(A3State);
+	zassert_equal(I2CTransactionAsync(I2C_ID, &req), -EIO);
+}
+
+ZTEST(dw_apb_i2c, test_blocking_wrapper)
+{
+	uint16_t vout = 0x0320;
+	uint16_t readback = 0;
+
+	select_target(TARGET_ADDR);
+	I2CAsyncEnable(I2C_ID, true);
+	k_timer_start(&bus_timer, K_MSEC(1), K_MSEC(1));
+
+	zassert_equal(I2CWriteBytes(I2C_ID, 0x21, 1, (uint8_t *)&vout, sizeof(vout)), 0);
+	zassert_equal(I2CReadBytes(I2C_ID, 0x21, 1, (uint8_t *)&readback, sizeof(readback), 0),
+		      0);
+	zassert_equal(readback, vout);
+
+	k_timer_stop(&bus_timer);
+}
+
+ZTEST(dw_apb_i2c, test_blocking_timeout)
+{
+	uint16_t readback = 0;
+
+	Z_TEST_SKIP_IFNDEF(CONFIG_TT_BH_ARC_I2C_TIMEOUT);
+
+	select_target(TARGET_ADDR);
+	I2CAsyncEnable(I2C_ID, true);
+
+	/* Without the bus timer the bus never moves, the timeout is an abort code, not -ETIMEDOUT */
+	zassert_equal(I2CReadBytes(I2C_ID, 0x21, 1, (uint8_t *)&readback, sizeof(readback), 0),
+		      IC_TIMEOUT);
+}
+
+ZTEST(dw_apb_i2c, test_cpu_time_per_transaction)
+{
+	/* A PMBus READ_IOUT: command byte, restart, two data bytes */
+	const uint8_t cmd = 0x8C;
+	uint8_t read[2];
+	struct async_result result = {0};
+	struct i2c_async_request req = {
+		.write_data = &cmd,
+		.write_len = 1,
+		.read_data = read,
+		.read_len = sizeof(read),
+		.callback = async_done,
+		.user_data = &result,
+	};
+
+	select_target(TARGET_ADDR);
+	uint64_t start_ns = m.now_ns;
+
+	zassert_equal(I2CTransaction(I2C_ID, &cmd, 1, read, sizeof(read)), 0);
+	uint32_t polled = m.accesses;
+	uint64_t polled_bus_ns = m.now_ns - start_ns;
+
+	select_target(TARGET_ADDR);
+	I2CAsyncEnable(I2C_ID, true);
+	zassert_ok(I2CTransactionAsync(I2C_ID, &req));
+	run_until_done(&result);
+	uint32_t async = m.accesses;
+
+	TC_PRINT("register accesses per transaction: polled %u (%llu ns CPU), "
+		 "interrupt-driven %u (%u ns CPU), bus time %llu ns\n",
+		 polled, (unsigned long long)polled * REG_ACCESS_NS, async, async * REG_ACCESS_NS,
+		 (unsigned long long)polled_bus_ns);
+	zassert_true(async * 10 < polled);
+}
+
+static void dw_apb_i2c_before(void *fixture)
+{
+	memset(&m, 0, sizeof(m));
+	ReadReg_fake.custom_fake = model_read;
+	WriteReg_fake.custom_fake = model_write;
+	deliver_irq = true;
+	completions = 0;
+	set_asic_state(A0State);
+}
+
+static void dw_apb_i2c_after(void *fixture)
+{
+	k_timer_stop(&bus_timer);
+	I2CAsyncEnable(I2C_ID, false);
+	deliver_irq = false;
+	set_asic_state(A0State);
+}
+
+ZTEST_SUITE(dw_apb_i2c, NULL, NULL, dw_apb_i2c_before, dw_apb_i2c_after, NULL);
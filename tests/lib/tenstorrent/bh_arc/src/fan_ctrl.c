@@ -8,7 +8,63 @@
 
 #include <zephyr/ztest.h>
 
+#include "fan_ctrl.h"
+
 extern uint32_t fan_curve(float max_asic_temp, float max_gddr_temp);
+extern uint32_t fan_ctrl_step(float asic_temp, float gddr_temp, uint32_t dt_ms);
+extern void fan_ctrl_reset(float asic_temp, float gddr_temp);
+
+/*
+ * Thermal plant of a card under a bursty load: 300 W for 5 s out of every 15 s, 60 W otherwise.
+ * The thermal resistance drops with the fan speed, and the fan takes a few seconds to spin up.
+ */
+#define PLANT_AMBIENT    35.0f   /* degC */
+#define PLANT_TAU_MS     3000.0f /* thermal time constant */
+#define PLANT_FAN_TAU_MS 3000.0f /* fan spin up time constant */
+#define PLANT_DURATION   60000   /* ms */
+#define PLANT_SETTLE     30000   /* ms, left out of the metrics */
+
+#define PID_TARGET 75.0f
+
+struct plant_metrics {
+	float peak_temp;
+	uint32_t over_target_ms;
+};
+
+static const FwTable_FanTable empty_table;
+
+static float plant_power(uint32_t ms)
+{
+	return ms % 15000 < 5000 ? 300.0f : 60.0f;
+}
+
+static struct plant_metrics plant_run(uint32_t interval_ms)
+{
+	struct plant_metrics m = {0};
+	float temp = PLANT_AMBIENT;
+	float fan = 35.0f;
+	uint32_t speed = 35;
+
+	fan_ctrl_reset(temp, 0);
+
+	for (uint32_t ms = 0; ms < PLANT_DURATION; ms++) {
+		if (ms % interval_ms == 0) {
+			speed = fan_ctrl_step(temp, 0, interval_ms);
+		}
+
+		float r_th = 0.12f + 0.25f * (1.0f - fan / 100.0f);
+
+		fan += (speed - fan) / PLANT_FAN_TAU_MS;
+		temp += (PLANT_AMBIENT + plant_power(ms) * r_th - temp) / PLANT_TAU_MS;
+
+		if (ms >= PLANT_SETTLE) {
+			m.peak_temp = MAX(m.peak_temp, temp);
+			m.over_target_ms += temp > PID_TARGET;
+		}
+	}
+
+	return m;
+}
 
 ZTEST(fan_ctrl, test_fan_curve)
 {
@@ -68,4 +124,135 @@ ZTEST(fan_ctrl, test_fan_curve)
 	}
 }
 
-ZTEST_SUITE(fan_ctrl, NULL, NULL, NULL, NULL, NULL);
+ZTEST(fan_ctrl, test_piecewise_curve)
+{
+	FwTable_FanTable table = {
+		.asic_curve_count = 3,
+		.asic_curve = {{40, 30}, {60, 50}, {80, 100}},
+		.gddr_curve_count = 2,
+		.gddr_curve = {{50, 20}, {90, 80}},
+	};
+
+	zassert_ok(LoadFanTable(&table));
+
+	/* Flat outside of the points, linear between them */
+	zassert_equal(fan_curve(25, 25), 30);
+	zassert_equal(fan_curve(40, 25), 30);
+	zassert_equal(fan_curve(50, 25), 40);
+	zassert_equal(fan_curve(60, 25), 50);
+	zassert_equal(fan_curve(70, 25), 75);
+	zassert_equal(fan_curve(80, 25), 100);
+	zassert_equal(fan_curve(120, 25), 100);
+
+	/* The higher of the two curves */
+	zassert_equal(fan_curve(25, 70), 50);
+	zassert_equal(fan_curve(25, 100), 80);
+	zassert_equal(fan_curve(70, 70), 75);
+
+	/* An unreadable temperature runs the fan at the top of the curve */
+	zassert_equal(fan_curve(NAN, 25), 100);
+	zassert_equal(fan_curve(25, NAN), 80);
+
+	/* The P150 curve applies to a curve the table leaves empty */
+	table.gddr_curve_count = 0;
+	zassert_ok(LoadFanTable(&table));
+	zassert_equal(fan_curve(25, 75), 78);
+}
+
+ZTEST(fan_ctrl, test_invalid_table)
+{
+	const FwTable_FanTable valid = {
+		.asic_curve_count = 2,
+		.asic_curve = {{40, 30}, {80, 100}},
+	};
+	static const FwTable_FanTable invalid[] = {
+		/* Temperatures not strictly increasing */
+		{.asic_curve_count = 2, .asic_curve = {{60, 30}, {60, 100}}},
+		/* Speed decreasing */
+		{.gddr_curve_count = 2, .gddr_curve = {{40, 60}, {80, 50}}},
+		/* Speed over 100% */
+		{.asic_curve_count = 1, .asic_curve = {{40, 101}}},
+		{.asic_curve_count = 1, .asic_curve = {{NAN, 50}}},
+		/* Negative or non-finite gains */
+		{.pid_target_temp = PID_TARGET, .pid_p_gain = -1},
+		{.pid_target_temp = PID_TARGET, .pid_i_gain = INFINITY},
+		{.pid_target_temp = PID_TARGET, .pid_d_gain = NAN},
+		/* No target for the gains */
+		{.pid_p_gain = 1},
+	};
+
+	zassert_ok(LoadFanTable(&valid));
+
+	for (size_t i = 0; i < ARRAY_SIZE(invalid); i++) {
+		zassert_equal(LoadFanTable(&invalid[i]), -EINVAL, "table %zu", i);
+		/* The previous table stays in place */
+		zassert_equal(fan_curve(60, 25), 65, "table %zu", i);
+	}
+}
+
+/*
+ * The PID on top of the curve, updated every 100 ms, has to hold the bursts closer to the target
+ * than the curve alone at the former 1 s update interval, and than the same PID at 1 s.
+ */
+ZTEST(fan_ctrl, test_pid_plant)
+{
+	FwTable_FanTable table = {
+		.pid_target_temp = PID_TARGET,
+		.pid_p_gain = 5.0f,
+		.pid_i_gain = 0.2f,
+		.pid_d_gain = 40.0f,
+	};
+	struct plant_metrics legacy = plant_run(1000);
+
+	zassert_ok(LoadFanTable(&table));
+
+	struct plant_metrics pid_slow = plant_run(1000);
+	struct plant_metrics pid_fast = plant_run(100);
+
+	TC_PRINT("curve, 1000 ms: peak %d.%d degC, %u ms over target\n", (int)legacy.peak_temp,
+		 (int)(legacy.peak_temp * 10) % 10, legacy.over_target_ms);
+	TC_PRINT("PID,   1000 ms: peak %d.%d degC, %u ms over target\n", (int)pid_slow.peak_temp,
+		 (int)(pid_slow.peak_temp * 10) % 10, pid_slow.over_target_ms);
+	TC_PRINT("PID,    100 ms: peak %d.%d degC, %u ms over target\n", (int)pid_fast.peak_temp,
+		 (int)(pid_fast.peak_temp * 10) % 10, pid_fast.over_target_ms);
+
+	zassert_true(pid_fast.peak_temp + 10.0f < legacy.peak_temp);
+	zassert_true(pid_fast.peak_temp + 2.0f < pid_slow.peak_temp);
+	zassert_true(pid_fast.over_target_ms < pid_slow.over_target_ms);
+	zassert_true(pid_slow.over_target_ms < legacy.over_target_ms);
+}
+
+ZTEST(fan_ctrl, test_history)
+{
+	const struct fan_history *history = fan_history_get();
+	uint32_t head = history->head;
+
+	zassert_equal(history->version, FAN_HISTORY_VERSION);
+	zassert_equal(history->capacity, CONFIG_TT_BH_ARC_FAN_CTRL_HISTORY_DEPTH);
+	zassert_equal(history->record_size, sizeof(struct fan_history_record));
+
+	fan_ctrl_reset(60.0f, 50.0f);
+	zassert_equal(fan_ctrl_step(60.0f, 50.0f, 100), 39);
+	zassert_equal(history->head, head + 1);
+
+	const struct fan_history_record *record =
+		&history->records[head & (history->capacity - 1)];
+
+	zassert_equal(record->asic_temp, 600);
+	zassert_equal(record->gddr_temp, 500);
+	zassert_equal(record->speed, 39);
+	zassert_equal(record->flags, 0);
+}
+
+static void fan_ctrl_before(void *fixture)
+{
+	zassert_ok(LoadFanTable(&empty_table));
+}
+
+static void fan_ctrl_after(void *fixture)
+{
+	LoadFanTable(&empty_table);
+	fan_ctrl_reset(0, 0);
+}
+
+ZTEST_SUITE(fan_ctrl, NULL, NULL, fan_ctrl_before, fan_ctrl_after, NULL);
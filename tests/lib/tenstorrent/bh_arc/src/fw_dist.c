@@ -0,0 +1,314 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <zephyr/drivers/flash.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/ztest.h>
+
+#include "eth.h"
+#include "fw_dist.h"
+#include "gddr.h"
+#include "noc.h"
+#include "noc2axi.h"
+#include "reg_mock.h"
+
+#define FLASH_NODE       DT_NODELABEL(flashcontroller0)
+#define FLASH_IMAGE_ADDR 0x100000
+
+/* Not a multiple of the buffer, nor of a word */
+#define IMAGE_SIZE (20 * 1024 + 3)
+#define BUF_SIZE   512
+
+#define TILE_ADDR     (1ULL << 37)
+#define TILE_MEM_SIZE (24 * 1024)
+#define MAX_TILES     24
+
+static const struct device *const flash = DEVICE_DT_GET(FLASH_NODE);
+
+/*
+ * The memory of the tiles written to, found by decoding the TLB a write to a window goes
+ * through. Writes outside of [TILE_ADDR, TILE_ADDR + TILE_MEM_SIZE) are counted as stray.
+ */
+static struct {
+	uint8_t ring;
+	uint8_t x;
+	uint8_t y;
+	uint8_t mem[TILE_MEM_SIZE];
+} tiles[MAX_TILES];
+static size_t num_tiles;
+static uint32_t stray_writes;
+
+static uint8_t image[ROUND_UP(IMAGE_SIZE, 8)];
+static int flash_rc;
+static uint8_t buf[BUF_SIZE] __aligned(sizeof(uint32_t));
+
+static uint8_t *tile_mem(uint8_t ring, uint8_t x, uint8_t y)
+{
+	for (size_t i = 0; i < num_tiles; i++) {
+		if ((tiles[i].ring == ring) && (tiles[i].x == x) && (tiles[i].y == y)) {
+			return tiles[i].mem;
+		}
+	}
+
+	return NULL;
+}
+
+static void tile_write(uint8_t ring, uint8_t x, uint8_t y, uint64_t addr, uint32_t val)
+{
+	uint8_t *mem = tile_mem(ring, x, y);
+
+	if ((addr < TILE_ADDR) || (addr + sizeof(val) > TILE_ADDR + TILE_MEM_SIZE)) {
+		stray_writes++;
+		return;
+	}
+
+	if (mem == NULL) {
+		zassert_true(num_tiles < MAX_TILES);
+		tiles[num_tiles].ring = ring;
+		tiles[num_tiles].x = x;
+		tiles[num_tiles].y = y;
+		mem = tiles[num_tiles++].mem;
+	}
+
+	memcpy(&mem[addr - TILE_ADDR], &val, sizeof(val));
+}
+
+static void write_reg_fake_noc(uint32_t addr, uint32_t val)
+{
+	uint8_t ring = (addr >= ARC_NOC1_BASE_ADDR) ? 1 : 0;
+	uint32_t base = (ring == 0) ? ARC_NOC0_BASE_ADDR : ARC_NOC1_BASE_ADDR;
+	Noc2AxiTlbSetup setup;
+	uint64_t noc_addr;
+
+	zassert_true(addr >= ARC_NOC0_BASE_ADDR);
+
+	NOC2AXIReadTlbSetup(ring, (addr - base) >> NOC_TLB_LOG_SIZE, &setup);
+	noc_addr = setup.addr + (addr & NOC_TLB_WINDOW_ADDR_MASK);
+
+	if (!setup.multicast) {
+		tile_write(ring, setup.x_end, setup.y_end, noc_addr, val);
+		return;
+	}
+
+	for (uint8_t x = setup.x_start; x <= setup.x_end; x++) {
+		for (uint8_t y = setup.y_start; y <= setup.y_end; y++) {
+			tile_write(ring, x, y, noc_addr, val);
+		}
+	}
+}
+
+static void check_tile(uint8_t ring, uint8_t x, uint8_t y, const uint8_t *expected, size_t size)
+{
+	uint8_t *mem = tile_mem(ring, x, y);
+
+	zassert_not_null(mem, "tile (%u, %u) on NOC %u not written", x, y, ring);
+	zassert_mem_equal(mem, expected, size, "tile (%u, %u) on NOC %u differs", x, y, ring);
+}
+
+static void print_stats(const char *tag)
+{
+	const struct fw_dist_stats *stats = fw_dist_get_stats(tag);
+
+	zassert_not_null(stats);
+	TC_PRINT("%-8s %6u bytes to %2u targets: %3u flash reads, %u us (%u us reading)\n",
+		 stats->tag, stats->image_size, stats->num_targets, stats->flash_reads,
+		 stats->total_us, stats->read_us);
+}
+
+ZTEST(fw_dist, test_gddr)
+{
+	struct fw_dist_target targets[NUM_GDDR];
+	const struct fw_dist_dest dest = {
+		.targets = targets,
+		.num_targets = NUM_GDDR,
+		.ring = 0,
+		.tlb = 13,
+	};
+
+	for (uint8_t gddr_inst = 0; gddr_inst < NUM_GDDR; gddr_inst++) {
+		uint8_t x, y;
+
+		GetGddrNocCoords(gddr_inst, 0, 0, &x, &y);
+		targets[gddr_inst] = fw_dist_unicast(x, y, TILE_ADDR);
+	}
+
+	zassert_ok(fw_dist_load("memfw", flash, FLASH_IMAGE_ADDR, IMAGE_SIZE, &dest, buf,
+				sizeof(buf)));
+
+	for (uint8_t gddr_inst = 0; gddr_inst < NUM_GDDR; gddr_inst++) {
+		check_tile(0, targets[gddr_inst].x_end, targets[gddr_inst].y_end, image,
+			   IMAGE_SIZE);
+	}
+
+	/* Each part is read once and each word written once per instance */
+	zassert_equal(num_tiles, NUM_GDDR);
+	zassert_equal(stray_writes, 0);
+	zassert_equal(WriteReg_fake.call_count, NUM_GDDR * DIV_ROUND_UP(IMAGE_SIZE, 4));
+	zassert_equal(fw_dist_get_stats("memfw")->flash_reads,
+		      DIV_ROUND_UP(IMAGE_SIZE, BUF_SIZE));
+	print_stats("memfw");
+
+	/* Telemetry reports the load time, 0 for images that were never loaded */
+	zassert_equal(fw_dist_get_load_us("memfw"), fw_dist_get_stats("memfw")->total_us);
+	zassert_equal(fw_dist_get_load_us("l2cpufw"), 0);
+}
+
+ZTEST(fw_dist, test_eth)
+{
+	/* Harvested, and loaded over NOC 1 */
+	const uint32_t eth_enabled = BIT_MASK(MAX_ETH_INSTANCES) & ~(BIT(3) | BIT(10));
+	struct fw_dist_target targets[MAX_ETH_INSTANCES];
+	struct fw_dist_dest dest = {
+		.targets = targets,
+		.ring = 1,
+		.tlb = 0,
+	};
+
+	for (uint8_t eth_inst = 0; eth_inst < MAX_ETH_INSTANCES; eth_inst++) {
+		if (IS_BIT_SET(eth_enabled, eth_inst)) {
+			uint8_t x, y;
+
+			GetEthNocCoords(eth_inst, 1, &x, &y);
+			targets[dest.num_targets++] = fw_dist_unicast(x, y, TILE_ADDR);
+		}
+	}
+
+	zassert_ok(fw_dist_load("ethfw", flash, FLASH_IMAGE_ADDR, IMAGE_SIZE, &dest, buf,
+				sizeof(buf)));
+
+	for (size_t i = 0; i < dest.num_targets; i++) {
+		check_tile(1, targets[i].x_end, targets[i].y_end, image, IMAGE_SIZE);
+	}
+
+	zassert_equal(num_tiles, MAX_ETH_INSTANCES - 2);
+	zassert_equal(stray_writes, 0);
+	print_stats("ethfw");
+}
+
+ZTEST(fw_dist, test_multicast)
+{
+	/* One write reaches the 16 tiles of the rectangle, a second one the unicast target */
+	const struct fw_dist_target targets[] = {
+		{
+			.addr = TILE_ADDR,
+			.x_start = 1,
+			.y_start = 2,
+			.x_end = 4,
+			.y_end = 5,
+			.multicast = true,
+		},
+		fw_dist_unicast(9, 7, TILE_ADDR),
+	};
+	const struct fw_dist_dest dest = {
+		.targets = targets,
+		.num_targets = ARRAY_SIZE(targets),
+		.ring = 0,
+		.tlb = 2,
+	};
+
+	zassert_ok(fw_dist_load("mcast", flash, FLASH_IMAGE_ADDR, IMAGE_SIZE, &dest, buf,
+				sizeof(buf)));
+
+	for (uint8_t x = 1; x <= 4; x++) {
+		for (uint8_t y = 2; y <= 5; y++) {
+			check_tile(0, x, y, image, IMAGE_SIZE);
+		}
+	}
+	check_tile(0, 9, 7, image, IMAGE_SIZE);
+
+	zassert_equal(num_tiles, 17);
+	zassert_equal(stray_writes, 0);
+	zassert_equal(WriteReg_fake.call_count, 2 * DIV_ROUND_UP(IMAGE_SIZE, 4));
+	print_stats("mcast");
+}
+
+ZTEST(fw_dist, test_write)
+{
+	/* A config image, patched once in memory and written to every instance */
+	static uint8_t cfg[256] __aligned(sizeof(uint32_t));
+	struct fw_dist_target targets[4];
+	const struct fw_dist_dest dest = {
+		.targets = targets,
+		.num_targets = ARRAY_SIZE(targets),
+		.ring = 0,
+		.tlb = 0,
+	};
+
+	for (uint8_t i = 0; i < ARRAY_SIZE(targets); i++) {
+		targets[i] = fw_dist_unicast(i + 1, 1, TILE_ADDR + 0x3C00);
+	}
+
+	memcpy(cfg, image, sizeof(cfg));
+	sys_put_le32(0xC0FFEE, &cfg[4]);
+
+	zassert_ok(fw_dist_write("memfwcfg", cfg, sizeof(cfg), &dest));
+
+	for (uint8_t i = 0; i < ARRAY_SIZE(targets); i++) {
+		uint8_t *mem = tile_mem(0, i + 1, 1);
+
+		zassert_not_null(mem);
+		zassert_mem_equal(&mem[0x3C00], cfg, sizeof(cfg));
+	}
+
+	zassert_equal(stray_writes, 0);
+	zassert_equal(fw_dist_get_stats("memfwcfg")->flash_reads, 0);
+	print_stats("memfwcfg");
+}
+
+ZTEST(fw_dist, test_errors)
+{
+	/* A part would run past the end of the TLB window */
+	const struct fw_dist_target target =
+		fw_dist_unicast(1, 1, TILE_ADDR + BIT(NOC_TLB_LOG_SIZE) - 64);
+	struct fw_dist_dest dest = {
+		.targets = &target,
+		.num_targets = 1,
+		.ring = 0,
+		.tlb = 0,
+	};
+
+	zassert_equal(fw_dist_load("wrap", flash, FLASH_IMAGE_ADDR, IMAGE_SIZE, &dest, buf,
+				   sizeof(buf)),
+		      -EINVAL);
+	zassert_equal(fw_dist_write("wrap", image, 128, &dest), -EINVAL);
+	zassert_is_null(fw_dist_get_stats("wrap"));
+
+	/* Nothing to write to */
+	dest.num_targets = 0;
+	zassert_ok(fw_dist_load("none", flash, FLASH_IMAGE_ADDR, IMAGE_SIZE, &dest, buf,
+				sizeof(buf)));
+	zassert_equal(WriteReg_fake.call_count, 0);
+}
+
+static void *fw_dist_setup(void)
+{
+	for (size_t i = 0; i < sizeof(image); i++) {
+		image[i] = i * 13 + (i >> 9);
+	}
+
+	flash_rc = flash_erase(flash, FLASH_IMAGE_ADDR, ROUND_UP(sizeof(image), 4096));
+	if (flash_rc == 0) {
+		flash_rc = flash_write(flash, FLASH_IMAGE_ADDR, image, sizeof(image));
+	}
+
+	return NULL;
+}
+
+static void fw_dist_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	zassert_ok(flash_rc);
+
+	memset(tiles, 0, sizeof(tiles));
+	num_tiles = 0;
+	stray_writes = 0;
+	WriteReg_fake.custom_fake = write_reg_fake_noc;
+}
+
+ZTEST_SUITE(fw_dist, NULL, fw_dist_setup, fw_dist_before, NULL, NULL);
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+
+#define TEST_MSG_DEFERRED 0x79
+#define TEST_MSG_FAST     0x7A
+
+#define FAST_REPLY     0xF00D
+#define SYNC_REPLY     0x5E7C
+#define DEFERRED_REPLY 0xD1FF
+
+static struct msgqueue_token slow_token;
+static int cancel_count;
+static struct msgqueue_token cancelled_token;
+
+static void deferred_cancel(struct msgqueue_token token, void *user_data)
+{
+	int *count = user_data;
+
+	(*count)++;
+	cancelled_token = token;
+}
+
+static uint8_t deferred_handler(const union request *req, struct response *rsp)
+{
+	if (msgqueue_defer_response(&slow_token, deferred_cancel, &cancel_count) != 0) {
+		rsp->data[1] = SYNC_REPLY;
+	}
+
+	return 0;
+}
+
+static uint8_t fast_handler(const union request *req, struct response *rsp)
+{
+	rsp->data[1] = FAST_REPLY;
+	return 0;
+}
+
+static void push_code(uint32_t queue, uint8_t code)
+{
+	union request req = {0};
+
+	req.command_code = code;
+	zassert_ok(msgqueue_request_push(queue, &req));
+}
+
+static void complete_slow(uint8_t exit_code)
+{
+	struct response rsp = {0};
+
+	rsp.data[1] = DEFERRED_REPLY;
+	zassert_ok(msgqueue_complete_response(slow_token, &rsp, exit_code));
+}
+
+ZTEST(msgqueue_async, test_fast_message_while_slow_in_flight)
+{
+	struct response rsp;
+
+	push_code(0, TEST_MSG_DEFERRED);
+	push_code(1, TEST_MSG_FAST);
+	process_message_queues();
+
+	/* Queue 1 is answered even though the queue 0 response is outstanding */
+	zassert_not_ok(msgqueue_response_pop(0, &rsp));
+	zassert_ok(msgqueue_response_pop(1, &rsp));
+	zassert_equal(rsp.data[0], 0);
+	zassert_equal(rsp.data[1], FAST_REPLY);
+
+	complete_slow(0);
+	zassert_ok(msgqueue_response_pop(0, &rsp));
+	zassert_equal(rsp.data[0], 0);
+	zassert_equal(rsp.data[1], DEFERRED_REPLY);
+}
+
+ZTEST(msgqueue_async, test_same_queue_ordering)
+{
+	struct response rsp;
+
+	push_code(0, TEST_MSG_DEFERRED);
+	push_code(0, TEST_MSG_FAST);
+	process_message_queues();
+
+	/* The fast message waits behind the deferred one */
+	zassert_not_ok(msgqueue_response_pop(0, &rsp));
+	process_message_queues();
+	zassert_not_ok(msgqueue_response_pop(0, &rsp));
+
+	complete_slow(5);
+	process_message_queues();
+
+	zassert_ok(msgqueue_response_pop(0, &rsp));
+	zassert_equal(rsp.data[0], 5);
+	zassert_equal(rsp.data[1], DEFERRED_REPLY);
+
+	zassert_ok(msgqueue_response_pop(0, &rsp));
+	zassert_equal(rsp.data[0], 0);
+	zassert_equal(rsp.data[1], FAST_REPLY);
+
+	zassert_not_ok(msgqueue_response_pop(0, &rsp));
+}
+
+ZTEST(msgqueue_async, test_complete_twice)
+{
+	struct response rsp;
+
+	push_code(0, TEST_MSG_DEFERRED);
+	process_message_queues();
+
+	complete_slow(0);
+	zassert_equal(msgqueue_complete_response(slow_token, NULL, 0), -ECANCELED);
+
+	zassert_ok(msgqueue_response_pop(0, &rsp));
+	zassert_not_ok(msgqueue_response_pop(0, &rsp));
+
+	struct msgqueue_token bad = {.msgqueue_id = NUM_MSG_QUEUES};
+
+	zassert_equal(msgqueue_complete_response(bad, NULL, 0), -EINVAL);
+}
+
+ZTEST(msgqueue_async, test_cancel_on_reset)
+{
+	struct response rsp;
+
+	push_code(2, TEST_MSG_DEFERRED);
+	process_message_queues();
+	zassert_equal(cancel_count, 0);
+
+	struct msgqueue_token token = slow_token;
+
+	zassert_ok(msgqueue_reset_queue(2));
+	zassert_equal(cancel_count, 1);
+	zassert_equal(cancelled_token.msgqueue_id, token.msgqueue_id);
+	zassert_equal(cancelled_token.generation, token.generation);
+
+	/* A completion racing with the reset is dropped */
+	zassert_equal(msgqueue_complete_response(token, NULL, 0), -ECANCELED);
+	zassert_not_ok(msgqueue_response_pop(2, &rsp));
+
+	/* The queue is usable again */
+	push_code(2, TEST_MSG_FAST);
+	process_message_queues();
+	zassert_ok(msgqueue_response_pop(2, &rsp));
+	zassert_equal(rsp.data[1], FAST_REPLY);
+
+	zassert_equal(msgqueue_reset_queue(NUM_MSG_QUEUES), -EINVAL);
+}
+
+ZTEST(msgqueue_async, test_no_deferral_in_batch)
+{
+	struct response rsp;
+	uint32_t num_entries;
+	struct msgqueue_batch_entry *entries = msgqueue_batch_entries(0, &num_entries);
+	union request req = {0};
+
+	entries[0] = (struct msgqueue_batch_entry){0};
+	entries[0].request.command_code = TEST_MSG_DEFERRED;
+
+	req.batch.command_code = TT_SMC_MSG_BATCH;
+	req.batch.num_entries = 1;
+	zassert_ok(msgqueue_request_push(0, &req));
+	process_message_queues();
+
+	/* The handler falls back to a synchronous response */
+	zassert_ok(msgqueue_response_pop(0, &rsp));
+	zassert_equal(rsp.data[1], 1);
+	zassert_equal(entries[0].response.data[1], SYNC_REPLY);
+	zassert_equal(cancel_count, 0);
+}
+
+static void *msgqueue_async_setup(void)
+{
+	msgqueue_register_handler(TEST_MSG_DEFERRED, deferred_handler);
+	msgqueue_register_handler(TEST_MSG_FAST, fast_handler);
+
+	return NULL;
+}
+
+static void msgqueue_async_before(void *fixture)
+{
+	for (uint32_t i = 0; i < NUM_MSG_QUEUES; i++) {
+		msgqueue_reset_queue(i);
+	}
+	cancel_count = 0;
+}
+
+ZTEST_SUITE(msgqueue_async, NULL, msgqueue_async_setup, msgqueue_async_before, NULL, NULL);
@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+
+#define TEST_MSG_INC  0x77
+#define TEST_MSG_FAIL 0x78
+
+#define BENCH_OPS 16
+
+static struct msgqueue_batch_entry *entries;
+static uint32_t num_entries;
+/* Requests the host pushed and rang the doorbell for, each one a round trip over PCIe */
+static uint32_t round_trips;
+static uint32_t handler_calls;
+
+static uint8_t inc_handler(const union request *req, struct response *rsp)
+{
+	handler_calls++;
+	rsp->data[1] = req->data[1] + 1;
+	return 0;
+}
+
+static uint8_t fail_handler(const union request *req, struct response *rsp)
+{
+	return 3;
+}
+
+static void send_msg(const union request *req, struct response *rsp)
+{
+	round_trips++;
+
+	zassert_ok(msgqueue_request_push(0, req));
+	process_message_queues();
+	zassert_ok(msgqueue_response_pop(0, rsp));
+}
+
+static void batch_request(union request *req, uint16_t first, uint16_t count, uint32_t flags)
+{
+	*req = (union request){0};
+	req->batch.command_code = TT_SMC_MSG_BATCH;
+	req->batch.first_entry = first;
+	req->batch.num_entries = count;
+	req->batch.flags = flags;
+}
+
+static void send_batch(uint16_t first, uint16_t count, uint32_t flags, struct response *rsp)
+{
+	union request req;
+
+	batch_request(&req, first, count, flags);
+	send_msg(&req, rsp);
+}
+
+static void fill_queue_entry(struct msgqueue_batch_entry *queue_entries, uint32_t idx,
+			     uint8_t code, uint32_t value)
+{
+	memset(&queue_entries[idx], 0, sizeof(queue_entries[idx]));
+	queue_entries[idx].request.command_code = code;
+	queue_entries[idx].request.data[1] = value;
+	/* Poison the response to check it is written back */
+	queue_entries[idx].response.data[0] = 0xdeadbeef;
+}
+
+static void fill_entry(uint32_t idx, uint8_t code, uint32_t value)
+{
+	fill_queue_entry(entries, idx, code, value);
+}
+
+ZTEST(msgqueue_batch, test_batch_runs_all_entries)
+{
+	struct response rsp;
+
+	zassert_true(num_entries >= 8);
+	for (uint32_t i = 0; i < 8; i++) {
+		fill_entry(i, TEST_MSG_INC, i * 10);
+	}
+
+	send_batch(0, 8, 0, &rsp);
+
+	zassert_equal(rsp.data[0], 0);
+	zassert_equal(rsp.data[1], 8);
+	zassert_equal(rsp.data[2], 0);
+	for (uint32_t i = 0; i < 8; i++) {
+		zassert_equal(entries[i].response.data[0], 0);
+		zassert_equal(entries[i].response.data[1], i * 10 + 1);
+	}
+}
+
+ZTEST(msgqueue_batch, test_batch_sub_request_errors)
+{
+	struct response rsp;
+
+	fill_entry(0, TEST_MSG_INC, 1);
+	fill_entry(1, TEST_MSG_FAIL, 0);
+	fill_entry(2, TT_SMC_MSG_BATCH, 0);
+	fill_entry(3, TT_SMC_MSG_TEST, 0);
+	fill_entry(4, TEST_MSG_INC, 2);
+
+	send_batch(0, 5, 0, &rsp);
+
+	zassert_equal(rsp.data[0], 0);
+	zassert_equal(rsp.data[1], 5);
+	zassert_equal(rsp.data[2], 3);
+	zassert_equal(entries[1].response.data[0], 3);
+	/* Nested batches and queue-level messages are not dispatched */
+	zassert_equal(entries[2].response.data[0], 0xff);
+	zassert_equal(entries[3].response.data[0], 0xff);
+	zassert_equal(entries[4].response.data[1], 3);
+
+	fill_entry(4, TEST_MSG_INC, 2);
+	send_batch(0, 5, BATCH_FLAG_STOP_ON_ERROR, &rsp);
+
+	zassert_equal(rsp.data[1], 2);
+	zassert_equal(rsp.data[2], 1);
+	zassert_equal(entries[4].response.data[0], 0xdeadbeef);
+}
+
+ZTEST(msgqueue_batch, test_batch_bounds)
+{
+	struct response rsp;
+
+	send_batch(num_entries, 1, 0, &rsp);
+	zassert_not_equal(rsp.data[0], 0);
+
+	send_batch(1, num_entries, 0, &rsp);
+	zassert_not_equal(rsp.data[0], 0);
+
+	send_batch(0, 0, 0, &rsp);
+	zassert_equal(rsp.data[0], 0);
+	zassert_equal(rsp.data[1], 0);
+}
+
+/* Batches sent on two queues at once each run their own queue's entries */
+ZTEST(msgqueue_batch, test_batch_per_queue)
+{
+	struct msgqueue_batch_entry *other;
+	uint32_t other_entries;
+	union request req;
+	struct response rsp;
+
+	zassert_true(NUM_MSG_QUEUES > 1);
+	other = msgqueue_batch_entries(1, &other_entries);
+	zassert_not_null(other);
+	zassert_equal(other_entries, num_entries);
+	zassert_true(other != entries);
+	zassert_is_null(msgqueue_batch_entries(NUM_MSG_QUEUES, &other_entries));
+
+	for (uint32_t i = 0; i < 4; i++) {
+		fill_entry(i, TEST_MSG_INC, i);
+		fill_queue_entry(other, i, TEST_MSG_INC, 100 + i);
+	}
+
+	batch_request(&req, 0, 4, 0);
+	zassert_ok(msgqueue_request_push(0, &req));
+	zassert_ok(msgqueue_request_push(1, &req));
+	process_message_queues();
+
+	for (uint32_t q = 0; q < 2; q++) {
+		zassert_ok(msgqueue_response_pop(q, &rsp));
+		zassert_equal(rsp.data[0], 0);
+		zassert_equal(rsp.data[1], 4);
+	}
+	for (uint32_t i = 0; i < 4; i++) {
+		zassert_equal(entries[i].response.data[1], i + 1);
+		zassert_equal(other[i].response.data[1], 100 + i + 1);
+	}
+}
+
+/* The same sub-requests, one message each and in one batch */
+ZTEST(msgqueue_batch, test_batch_round_trips)
+{
+	union request req = {0};
+	struct response rsp;
+	uint32_t ops = MIN(BENCH_OPS, num_entries);
+	uint32_t single_round_trips;
+	uint32_t single_handler_calls;
+
+	round_trips = 0;
+	handler_calls = 0;
+	for (uint32_t i = 0; i < ops; i++) {
+		req.command_code = TEST_MSG_INC;
+		req.data[1] = i;
+		send_msg(&req, &rsp);
+		zassert_equal(rsp.data[1], i + 1);
+	}
+	single_round_trips = round_trips;
+	single_handler_calls = handler_calls;
+
+	round_trips = 0;
+	handler_calls = 0;
+	for (uint32_t i = 0; i < ops; i++) {
+		fill_entry(i, TEST_MSG_INC, i);
+	}
+	send_batch(0, ops, 0, &rsp);
+	zassert_equal(rsp.data[1], ops);
+	for (uint32_t i = 0; i < ops; i++) {
+		zassert_equal(entries[i].response.data[1], i + 1);
+	}
+
+	TC_PRINT("%u ops: single %u round trips, batch %u round trips\n", ops, single_round_trips,
+		 round_trips);
+
+	/* The handlers run as often either way, the batch saves all but one round trip */
+	zassert_equal(single_handler_calls, ops);
+	zassert_equal(handler_calls, ops);
+	zassert_equal(single_round_trips, ops);
+	zassert_equal(round_trips, 1);
+}
+
+static void *msgqueue_batch_setup(void)
+{
+	entries = msgqueue_batch_entries(0, &num_entries);
+	msgqueue_register_handler(TEST_MSG_INC, inc_handler);
+	msgqueue_register_handler(TEST_MSG_FAIL, fail_handler);
+
+	return NULL;
+}
+
+static void msgqueue_batch_before(void *fixture)
+{
+	for (uint32_t i = 0; i < NUM_MSG_QUEUES; i++) {
+		msgqueue_reset_queue(i);
+	}
+}
+
+ZTEST_SUITE(msgqueue_batch, NULL, msgqueue_batch_setup, msgqueue_batch_before, NULL, NULL);
@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+#include "msgqueue_stats.h"
+
+#define TEST_MSG_FAST 0x75
+#define TEST_MSG_SLOW 0x76
+#define SLOW_US       1000
+
+static uint8_t fast_handler(const union request *req, struct response *rsp)
+{
+	return 0;
+}
+
+static uint8_t slow_handler(const union request *req, struct response *rsp)
+{
+	k_busy_wait(SLOW_US);
+	return 0;
+}
+
+static void send_msg(union request *req, struct response *rsp)
+{
+	zassert_ok(msgqueue_request_push(0, req));
+	process_message_queues();
+	zassert_ok(msgqueue_response_pop(0, rsp));
+}
+
+static void send_code(uint8_t code)
+{
+	union request req = {0};
+	struct response rsp = {0};
+
+	req.command_code = code;
+	send_msg(&req, &rsp);
+	zassert_equal(rsp.data[0], 0);
+}
+
+static uint32_t hist_sum(const uint32_t *hist)
+{
+	uint32_t sum = 0;
+
+	for (int i = 0; i < MSGQUEUE_STATS_NUM_BUCKETS; i++) {
+		sum += hist[i];
+	}
+
+	return sum;
+}
+
+ZTEST(msgqueue_stats, test_bucket_boundaries)
+{
+	zassert_equal(msgqueue_stats_bucket(0), 0);
+	zassert_equal(msgqueue_stats_bucket(BIT(MSGQUEUE_STATS_BUCKET_SHIFT) - 1), 0);
+	zassert_equal(msgqueue_stats_bucket(BIT(MSGQUEUE_STATS_BUCKET_SHIFT)), 1);
+	zassert_equal(msgqueue_stats_bucket(BIT(MSGQUEUE_STATS_BUCKET_SHIFT + 1) - 1), 1);
+	zassert_equal(msgqueue_stats_bucket(BIT(MSGQUEUE_STATS_BUCKET_SHIFT + 1)), 2);
+	zassert_equal(msgqueue_stats_bucket(UINT32_MAX), MSGQUEUE_STATS_NUM_BUCKETS - 1);
+}
+
+ZTEST(msgqueue_stats, test_record_accounting)
+{
+	struct msgqueue_stats stats;
+
+	zassert_false(msgqueue_stats_get(TEST_MSG_FAST, &stats));
+
+	msgqueue_stats_record(TEST_MSG_FAST, 10, 100);
+	msgqueue_stats_record(TEST_MSG_FAST, 20, 200);
+	msgqueue_stats_record(TEST_MSG_FAST, 3000, 50);
+
+	zassert_true(msgqueue_stats_get(TEST_MSG_FAST, &stats));
+	zassert_equal(stats.count, 3);
+	zassert_equal(stats.max_cycles[MSGQUEUE_STATS_HIST_WAIT], 3000);
+	zassert_equal(stats.max_cycles[MSGQUEUE_STATS_HIST_EXEC], 200);
+	zassert_equal(stats.total_cycles[MSGQUEUE_STATS_HIST_WAIT], 3030);
+	zassert_equal(stats.total_cycles[MSGQUEUE_STATS_HIST_EXEC], 350);
+
+	/* 10 and 20 are below the first bucket boundary, 3000 is in [2048, 4096) */
+	zassert_equal(stats.hist[MSGQUEUE_STATS_HIST_WAIT][0], 2);
+	zassert_equal(stats.hist[MSGQUEUE_STATS_HIST_WAIT][msgqueue_stats_bucket(2048)], 1);
+	/* 50 is in bucket 0, 100 in [64, 128) and 200 in [128, 256) */
+	zassert_equal(stats.hist[MSGQUEUE_STATS_HIST_EXEC][0], 1);
+	zassert_equal(stats.hist[MSGQUEUE_STATS_HIST_EXEC][1], 1);
+	zassert_equal(stats.hist[MSGQUEUE_STATS_HIST_EXEC][2], 1);
+}
+
+ZTEST(msgqueue_stats, test_slot_exhaustion)
+{
+	struct msgqueue_stats stats;
+
+	for (int i = 0; i < CONFIG_TT_BH_ARC_MSGQUEUE_STATS_SLOTS; i++) {
+		msgqueue_stats_record(i, 1, 1);
+	}
+	zassert_equal(msgqueue_stats_dropped(), 0);
+
+	msgqueue_stats_record(CONFIG_TT_BH_ARC_MSGQUEUE_STATS_SLOTS, 1, 1);
+	zassert_equal(msgqueue_stats_dropped(), 1);
+	zassert_false(msgqueue_stats_get(CONFIG_TT_BH_ARC_MSGQUEUE_STATS_SLOTS, &stats));
+
+	/* Message codes that already own a slot keep being recorded */
+	msgqueue_stats_record(0, 1, 1);
+	zassert_true(msgqueue_stats_get(0, &stats));
+	zassert_equal(stats.count, 2);
+
+	msgqueue_stats_clear();
+	zassert_equal(msgqueue_stats_dropped(), 0);
+	zassert_false(msgqueue_stats_get(0, &stats));
+}
+
+ZTEST(msgqueue_stats, test_dispatch_mock_handlers)
+{
+	struct msgqueue_stats fast;
+	struct msgqueue_stats slow;
+	uint32_t slow_cycles = k_us_to_cyc_floor32(SLOW_US);
+
+	for (int i = 0; i < 4; i++) {
+		send_code(TEST_MSG_FAST);
+	}
+	send_code(TEST_MSG_SLOW);
+	send_code(TEST_MSG_SLOW);
+
+	zassert_true(msgqueue_stats_get(TEST_MSG_FAST, &fast));
+	zassert_true(msgqueue_stats_get(TEST_MSG_SLOW, &slow));
+
+	zassert_equal(fast.count, 4);
+	zassert_equal(slow.count, 2);
+	for (int h = 0; h < MSGQUEUE_STATS_HIST_COUNT; h++) {
+		zassert_equal(hist_sum(fast.hist[h]), fast.count);
+		zassert_equal(hist_sum(slow.hist[h]), slow.count);
+	}
+
+	/* The slow handler lands in the bucket of its busy-wait, or the next if it overran */
+	unsigned int bucket = msgqueue_stats_bucket(slow_cycles);
+
+	zassert_true(slow.max_cycles[MSGQUEUE_STATS_HIST_EXEC] >= slow_cycles);
+	zassert_equal(slow.hist[MSGQUEUE_STATS_HIST_EXEC][bucket] +
+			      slow.hist[MSGQUEUE_STATS_HIST_EXEC][bucket + 1],
+		      2);
+	zassert_true(fast.max_cycles[MSGQUEUE_STATS_HIST_EXEC] < slow_cycles);
+}
+
+ZTEST(msgqueue_stats, test_stats_message)
+{
+	union request req = {0};
+	struct response rsp = {0};
+	struct msgqueue_stats stats;
+
+	for (int i = 0; i < 3; i++) {
+		send_code(TEST_MSG_FAST);
+	}
+
+	req.msgqueue_stats.command_code = TT_SMC_MSG_GET_MSGQUEUE_STATS;
+	req.msgqueue_stats.msg_code = TEST_MSG_FAST;
+	req.msgqueue_stats.select = MSGQUEUE_STATS_SELECT_SUMMARY;
+	send_msg(&req, &rsp);
+	zassert_equal(rsp.data[0], 0);
+	zassert_equal(rsp.data[1], 3);
+	zassert_true(rsp.data[3] >= rsp.data[5]);
+	zassert_equal(rsp.data[7], sys_clock_hw_cycles_per_sec() / 1000);
+
+	/* Read the whole execution histogram, seven buckets at a time */
+	uint32_t sum = 0;
+
+	req.msgqueue_stats.select = MSGQUEUE_STATS_SELECT_EXEC_HIST;
+	for (int offset = 0; offset < MSGQUEUE_STATS_NUM_BUCKETS; offset += RESPONSE_MSG_LEN - 1) {
+		req.msgqueue_stats.bucket_offset = offset;
+		send_msg(&req, &rsp);
+		zassert_equal(rsp.data[0], 0);
+
+		for (int i = 1; i < RESPONSE_MSG_LEN; i++) {
+			sum += rsp.data[i];
+		}
+	}
+	zassert_equal(sum, 3);
+
+	req.msgqueue_stats.bucket_offset = MSGQUEUE_STATS_NUM_BUCKETS;
+	send_msg(&req, &rsp);
+	zassert_not_equal(rsp.data[0], 0);
+
+	req.msgqueue_stats.select = MSGQUEUE_STATS_SELECT_SUMMARY;
+	req.msgqueue_stats.bucket_offset = 0;
+	req.msgqueue_stats.flags = MSGQUEUE_STATS_FLAG_CLEAR;
+	send_msg(&req, &rsp);
+	zassert_equal(rsp.data[1], 3);
+	zassert_false(msgqueue_stats_get(TEST_MSG_FAST, &stats));
+}
+
+static void msgqueue_stats_before(void *fixture)
+{
+	msgqueue_register_handler(TEST_MSG_FAST, fast_handler);
+	msgqueue_register_handler(TEST_MSG_SLOW, slow_handler);
+	msgqueue_stats_clear();
+}
+
+ZTEST_SUITE(msgqueue_stats, NULL, NULL, msgqueue_stats_before, NULL, NULL);
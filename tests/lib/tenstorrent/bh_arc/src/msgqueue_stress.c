@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <tenstorrent/msgqueue.h>
+#include "work_queue.h"
+
+#define TEST_MSG_ECHO      0x7B
+#define MSGS_PER_QUEUE     1000
+/* Modelled handler cost, so that simulated time advances */
+#define HANDLER_US         1
+#define HOST_STACK_SIZE    1024
+#define HOST_PRIORITY      K_PRIO_PREEMPT(5)
+
+struct host_thread {
+	struct k_thread thread;
+	uint32_t queue;
+	uint32_t received;
+	uint32_t max_outstanding;
+	bool out_of_order;
+};
+
+static K_THREAD_STACK_ARRAY_DEFINE(host_stacks, NUM_MSG_QUEUES, HOST_STACK_SIZE);
+static struct host_thread hosts[NUM_MSG_QUEUES];
+
+static uint8_t echo_handler(const union request *req, struct response *rsp)
+{
+	k_busy_wait(HANDLER_US);
+	rsp->data[1] = req->data[1];
+	return 0;
+}
+
+static void doorbell_work_handler(struct k_work *work)
+{
+	process_message_queues();
+}
+static K_WORK_DEFINE(doorbell_work, doorbell_work_handler);
+
+static uint32_t tag(uint32_t queue, uint32_t seq)
+{
+	return (queue << 24) | seq;
+}
+
+/* One host client per queue: fill the queue, ring its doorbell, drain the responses. */
+static void host_thread_entry(void *p1, void *p2, void *p3)
+{
+	struct host_thread *host = p1;
+	union request req = {0};
+	struct response rsp;
+	uint32_t sent = 0;
+
+	req.command_code = TEST_MSG_ECHO;
+
+	while (host->received < MSGS_PER_QUEUE) {
+		uint32_t burst = 0;
+
+		while (sent < MSGS_PER_QUEUE) {
+			req.data[1] = tag(host->queue, sent);
+			if (msgqueue_request_push(host->queue, &req) != 0) {
+				break;
+			}
+			sent++;
+			burst++;
+		}
+
+		if (burst > 0) {
+			host->max_outstanding = MAX(host->max_outstanding, sent - host->received);
+			tt_work_submit(TT_WORK_QUEUE_HOST_MSG, &doorbell_work);
+		}
+
+		while (msgqueue_response_pop(host->queue, &rsp) == 0) {
+			if (rsp.data[0] != 0 || rsp.data[1] != tag(host->queue, host->received)) {
+				host->out_of_order = true;
+			}
+			host->received++;
+		}
+
+		k_yield();
+	}
+}
+
+ZTEST(msgqueue_stress, test_flood_all_queues)
+{
+	for (uint32_t i = 0; i < NUM_MSG_QUEUES; i++) {
+		zassert_ok(msgqueue_reset_queue(i));
+		hosts[i] = (struct host_thread){.queue = i};
+	}
+
+	int64_t start = k_uptime_ticks();
+
+	for (uint32_t i = 0; i < NUM_MSG_QUEUES; i++) {
+		k_thread_create(&hosts[i].thread, host_stacks[i], HOST_STACK_SIZE,
+				host_thread_entry, &hosts[i], NULL, NULL, HOST_PRIORITY, 0, K_NO_WAIT);
+	}
+
+	for (uint32_t i = 0; i < NUM_MSG_QUEUES; i++) {
+		zassert_ok(k_thread_join(&hosts[i].thread, K_SECONDS(30)));
+	}
+
+	uint64_t elapsed_us = k_ticks_to_us_ceil64(k_uptime_ticks() - start);
+	uint32_t total = NUM_MSG_QUEUES * MSGS_PER_QUEUE;
+
+	TC_PRINT("%u queues x %u deep: %u messages in %llu us, %llu messages/s\n",
+		 NUM_MSG_QUEUES, MSG_QUEUE_SIZE, total, elapsed_us,
+		 total * USEC_PER_SEC / MAX(elapsed_us, 1));
+
+	for (uint32_t i = 0; i < NUM_MSG_QUEUES; i++) {
+		zassert_equal(hosts[i].received, MSGS_PER_QUEUE, "queue %u", i);
+		zassert_false(hosts[i].out_of_order, "queue %u", i);
+		/* Every queue was filled to its full depth */
+		zassert_equal(hosts[i].max_outstanding, MSG_QUEUE_SIZE, "queue %u", i);
+	}
+}
+
+ZTEST(msgqueue_stress, test_full_queue)
+{
+	union request req = {0};
+
+	zassert_ok(msgqueue_reset_queue(0));
+
+	req.command_code = TEST_MSG_ECHO;
+	for (uint32_t i = 0; i < MSG_QUEUE_SIZE; i++) {
+		zassert_ok(msgqueue_request_push(0, &req));
+	}
+	zassert_not_ok(msgqueue_request_push(0, &req));
+
+	/* Resetting the queue drops the requests */
+	zassert_ok(msgqueue_reset_queue(0));
+	zassert_ok(msgqueue_request_push(0, &req));
+	zassert_ok(msgqueue_reset_queue(0));
+}
+
+static void *msgqueue_stress_setup(void)
+{
+	msgqueue_register_handler(TEST_MSG_ECHO, echo_handler);
+
+	return NULL;
+}
+
+ZTEST_SUITE(msgqueue_stress, NULL, msgqueue_stress_setup, NULL, NULL, NULL);
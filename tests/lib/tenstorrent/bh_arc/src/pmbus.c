@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "asic_state.h"
+#include "dw_apb_i2c.h"
+#include "pmbus.h"
+#include "reg_mock.h"
+#include "regulator.h"
+
+/* An I2C master that completes every transfer immediately and reads back RX_DATA */
+#define I2C_BASE    0x80090000
+#define REFCLK_LO   0x800300E0
+#define IC_TAR      0x04
+#define IC_DATA_CMD 0x10
+#define IC_STATUS   0x70
+#define RX_DATA     0x40
+
+#define IC_STATUS_IDLE 0x0E /* TX FIFO not full and empty, RX FIFO not empty */
+#define CMD_STOP       BIT(9)
+
+static uint32_t refclk;
+static uint32_t inits;
+static uint32_t transactions;
+
+static uint32_t bus_read(uint32_t addr)
+{
+	switch (addr) {
+	case REFCLK_LO:
+		refclk += 100;
+		return refclk;
+	case I2C_BASE + IC_STATUS:
+		return IC_STATUS_IDLE;
+	case I2C_BASE + IC_DATA_CMD:
+		return RX_DATA;
+	default:
+		return 0;
+	}
+}
+
+static void bus_write(uint32_t addr, uint32_t val)
+{
+	if (addr == I2C_BASE + IC_TAR) {
+		inits++;
+	} else if (addr == I2C_BASE + IC_DATA_CMD && (val & CMD_STOP)) {
+		transactions++;
+	}
+}
+
+static struct pmbus_sensor sensors[3];
+
+static struct pmbus_regulator reg = {
+	.addr = 0x30,
+	.num_sensors = ARRAY_SIZE(sensors),
+	.sensors = sensors,
+};
+
+ZTEST(pmbus, test_select_target)
+{
+	I2CLock(PMBUS_MST_ID);
+	zassert_true(I2CSelectTarget(PMBUS_MST_ID, 0x64, I2CFastMode));
+	zassert_false(I2CSelectTarget(PMBUS_MST_ID, 0x64, I2CFastMode));
+	zassert_true(I2CSelectTarget(PMBUS_MST_ID, 0x65, I2CFastMode));
+	zassert_true(I2CSelectTarget(PMBUS_MST_ID, 0x65, I2CStandardMode));
+	zassert_false(I2CSelectTarget(PMBUS_MST_ID, 0x65, I2CStandardMode));
+
+	/* A reset loses the configuration */
+	I2CReset();
+	zassert_true(I2CSelectTarget(PMBUS_MST_ID, 0x65, I2CStandardMode));
+
+	/* I2CInit done by anyone else is tracked too */
+	I2CInit(I2CMst, 0x64, I2CFastMode, PMBUS_MST_ID);
+	zassert_false(I2CSelectTarget(PMBUS_MST_ID, 0x64, I2CFastMode));
+	I2CUnlock(PMBUS_MST_ID);
+
+	zassert_equal(inits, 5);
+}
+
+ZTEST(pmbus, test_read_write)
+{
+	uint8_t data[2];
+	struct pmbus_stats stats;
+
+	for (int i = 0; i < 3; i++) {
+		zassert_ok(PMBusRead(0x64, 0x8B, data, sizeof(data)));
+		zassert_equal(data[0], RX_DATA);
+	}
+	zassert_ok(PMBusWrite(0x65, 0x21, data, sizeof(data)));
+
+	zassert_equal(inits, 2);
+	zassert_equal(transactions, 4);
+
+	PMBusGetStats(&stats);
+	zassert_equal(stats.transactions, 4);
+	zassert_equal(stats.target_switches, 2);
+}
+
+ZTEST(pmbus, test_staleness)
+{
+	zassert_equal(PMBusReadSensor(&reg, 0, 10), RX_DATA << 8 | RX_DATA);
+	zassert_equal(PMBusReadSensor(&reg, 0, 10), RX_DATA << 8 | RX_DATA);
+	zassert_equal(transactions, 1);
+
+	k_msleep(10);
+	PMBusReadSensor(&reg, 0, 10);
+	zassert_equal(transactions, 2);
+
+	/* 0 always goes to the bus */
+	PMBusReadSensor(&reg, 0, 0);
+	zassert_equal(transactions, 3);
+
+	PMBusInvalidate(&reg);
+	PMBusReadSensor(&reg, 0, 10);
+	zassert_equal(transactions, 4);
+}
+
+ZTEST(pmbus, test_read_error)
+{
+	PMBusReadSensor(&reg, 0, 100);
+	zassert_equal(transactions, 1);
+
+	/* A failed read keeps the old value, but isn't cached */
+	set_asic_state(A3State);
+	zassert_equal(PMBusReadSensor(&reg, 0, 0), RX_DATA << 8 | RX_DATA);
+	set_asic_state(A0State);
+
+	PMBusReadSensor(&reg, 0, 100);
+	zassert_equal(transactions, 2);
+}
+
+/* Busy wait into the next uptime millisecond, so that the schedule is exact */
+static void next_ms(void)
+{
+	int64_t now = k_uptime_get();
+
+	while (k_uptime_get() == now) {
+		k_busy_wait(100);
+	}
+}
+
+/* Sensor 0 is read every ms and sensor 1 every 10 ms */
+static void run_readers(uint32_t ms)
+{
+	for (uint32_t t = 0; t < ms; t++) {
+		if (t % 10 == 5) {
+			PMBusReadSensor(&reg, 1, 1);
+		}
+		PMBusReadSensor(&reg, 0, 1);
+		next_ms();
+	}
+}
+
+ZTEST(pmbus, test_sweep)
+{
+	struct pmbus_stats stats;
+
+	PMBusReadSensor(&reg, 2, 1);
+	run_readers(100);
+
+	/* Once the periods are known, sensor 1 is read in the same sweep as sensor 0 */
+	int64_t sensor2_updated = sensors[2].updated;
+
+	PMBusResetStats();
+	transactions = 0;
+	run_readers(100);
+
+	PMBusGetStats(&stats);
+	zassert_equal(stats.sweeps, 100);
+	zassert_equal(stats.transactions, 110);
+	zassert_equal(transactions, 110);
+	zassert_equal(stats.target_switches, 0);
+	/* Sensor 2 was only asked for once, it isn't polled */
+	zassert_equal(sensors[2].updated, sensor2_updated);
+}
+
+/*
+ * One 100 ms telemetry cycle: DVFS reads Vcore every ms, telemetry reads Vcore, Vcorem and the
+ * Vcore current and power once.
+ */
+static void telemetry_cycle(void)
+{
+	for (uint32_t t = 0; t < 100; t++) {
+		if (t == 50) {
+			get_vcore();
+			get_vcorem();
+			GetVcoreCurrent();
+			GetVcorePower();
+		}
+		get_vcore();
+		next_ms();
+	}
+}
+
+ZTEST(pmbus, test_telemetry_cycle)
+{
+	struct pmbus_stats stats;
+
+	/* Without the scheduler every read is an I2CInit and a transaction */
+	const uint32_t unscheduled = 100 + 4;
+
+	telemetry_cycle();
+	telemetry_cycle();
+
+	inits = 0;
+	transactions = 0;
+	PMBusResetStats();
+	telemetry_cycle();
+	PMBusGetStats(&stats);
+
+	TC_PRINT("per telemetry cycle: %u I2CInit, %u transactions (unscheduled %u, %u)\n", inits,
+		 transactions, unscheduled, unscheduled);
+
+	/* Only switching to Vcorem and back */
+	zassert_equal(inits, 2);
+	zassert_equal(stats.target_switches, 2);
+	/* The current and power are read in the Vcore sweep of the same ms */
+	zassert_equal(transactions, unscheduled - 1);
+}
+
+static void pmbus_before(void *fixture)
+{
+	ReadReg_fake.custom_fake = bus_read;
+	WriteReg_fake.custom_fake = bus_write;
+	set_asic_state(A0State);
+
+	I2CReset();
+	memset(sensors, 0, sizeof(sensors));
+	sensors[0] = (struct pmbus_sensor)PMBUS_SENSOR(0x8B, 2);
+	sensors[1] = (struct pmbus_sensor)PMBUS_SENSOR(0x8C, 2);
+	sensors[2] = (struct pmbus_sensor)PMBUS_SENSOR(0x96, 2);
+
+	PMBusResetStats();
+	inits = 0;
+	transactions = 0;
+}
+
+ZTEST_SUITE(pmbus, NULL, NULL, pmbus_before, NULL, NULL);
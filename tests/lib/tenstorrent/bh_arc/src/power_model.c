@@ -0,0 +1,338 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <math.h>
+
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include "aiclk_ppm.h"
+#include "power_model.h"
+#include "throttler.h"
+#include "vf_curve.h"
+
+/*
+ * Evaluation of the Doppler power prediction on a plant model of a card behind a 150 W cable.
+ * Each workload is replayed through UpdateThrottlers and CalculateTargAiclk, once with the
+ * prediction arbiter enabled and once without, and the power excursions and AICLK compared.
+ *
+ * The plant deliberately differs from the model's built-in constants (regulator efficiency, the
+ * rest of the board, and for the leaky part the leakage), as parts on silicon do.
+ */
+
+#define POWER_LIMIT 150
+
+struct plant_params {
+	float ambient;        /* degC */
+	float r_th;           /* degC/W, junction to ambient */
+	float tau_ms;         /* thermal time constant */
+	float c_dyn;          /* W/(V^2 MHz) at full activity */
+	float leak_25;        /* W of leakage at 25 degC and 0.8 V */
+	float leak_coeff;     /* 1/degC, exponential leakage increase with temperature */
+	float vr_efficiency;  /* Vcore regulator efficiency */
+	float board_overhead; /* W, input power not drawn through Vcore */
+};
+
+struct plant {
+	float temperature;
+	float voltage; /* mV */
+	float power;
+	float input_power;
+};
+
+struct workload {
+	const char *name;
+	float (*activity)(uint32_t ms);
+	uint32_t duration_ms;
+};
+
+struct doppler_metrics {
+	uint32_t over_t2_ms;    /* input power above the Doppler T2 threshold */
+	uint32_t critical_ms;   /* Doppler critical throttling, AICLK at fmin */
+	float avg_aiclk;        /* MHz */
+	float avg_input_power;  /* W */
+	float peak_input_power; /* W */
+};
+
+/* Leakage as assumed by the model */
+static const struct plant_params nominal_card = {
+	.ambient = 35.0f,
+	.r_th = 0.15f,
+	.tau_ms = 1000.0f,
+	.c_dyn = 0.22f,
+	.leak_25 = 15.0f,
+	.leak_coeff = 0.02f,
+	.vr_efficiency = 0.88f,
+	.board_overhead = 45.0f,
+};
+
+/* A third more leakage at 25 degC, and more sensitive to temperature */
+static const struct plant_params card = {
+	.ambient = 35.0f,
+	.r_th = 0.15f,
+	.tau_ms = 1000.0f,
+	.c_dyn = 0.22f,
+	.leak_25 = 20.0f,
+	.leak_coeff = 0.025f,
+	.vr_efficiency = 0.88f,
+	.board_overhead = 45.0f,
+};
+
+static uint32_t aiclk_fmin;
+static uint32_t aiclk_fmax;
+static float default_board_power_limit;
+static float default_doppler_limit;
+
+/* 100 ms of full activity every 400 ms, e.g. a compute bound layer in an inference loop */
+static float activity_burst(uint32_t ms)
+{
+	return ms % 400 < 100 ? 1.0f : 0.15f;
+}
+
+/* A light load that turns into a heavy one after 3 s */
+static float activity_step(uint32_t ms)
+{
+	return ms < 3000 ? 0.1f : 1.0f;
+}
+
+/* 300 ms of full activity every 3 s, long enough idle for the activity estimate to decay */
+static float activity_sparse(uint32_t ms)
+{
+	return ms % 3000 < 300 ? 1.0f : 0.05f;
+}
+
+static const struct workload workloads[] = {
+	{"burst", activity_burst, 8000},
+	{"step", activity_step, 8000},
+	{"sparse", activity_sparse, 9000},
+};
+
+static void plant_step(const struct plant_params *p, struct plant *s, uint32_t aiclk,
+		       float activity)
+{
+	float v;
+
+	s->voltage = VFCurve(aiclk);
+	v = s->voltage / 1000.0f;
+	s->power = p->c_dyn * v * v * aiclk * activity +
+		   p->leak_25 * (v / 0.8f) * expf(p->leak_coeff * (s->temperature - 25.0f));
+	s->input_power = s->power / p->vr_efficiency + p->board_overhead;
+	s->temperature += (p->ambient + p->r_th * s->power - s->temperature) / p->tau_ms;
+}
+
+static bool critical_throttling(void)
+{
+	return get_enabled_arb_max_bitmask() & BIT(aiclk_arb_max_doppler_critical);
+}
+
+static struct doppler_metrics doppler_run(const struct workload *w, bool predict)
+{
+	struct plant s = {.temperature = card.ambient};
+	struct doppler_metrics m = {0};
+	uint32_t aiclk = aiclk_fmax;
+	float aiclk_sum = 0;
+	float power_sum = 0;
+
+	ResetThrottlers();
+	SetAiclkArbMax(aiclk_arb_max_doppler_slow, aiclk_fmax);
+	EnableArbMax(aiclk_arb_max_doppler_predict, predict);
+
+	plant_step(&card, &s, aiclk, w->activity(0));
+
+	for (uint32_t ms = 0; ms < w->duration_ms; ms++) {
+		ThrottlerInputs inputs = {
+			.vcore_power = s.power,
+			.vcore_current = s.power / s.voltage * 1000.0f,
+			.asic_temperature = s.temperature,
+			.input_power = s.input_power,
+			.gddr_temperature = 50.0f,
+			.aiclk = aiclk,
+			.vcore_voltage = s.voltage,
+		};
+
+		UpdateThrottlers(&inputs);
+		CalculateTargAiclk();
+
+		if (critical_throttling()) {
+			m.critical_ms++;
+		}
+
+		aiclk = GetAiclkTarg();
+		plant_step(&card, &s, aiclk, w->activity(ms));
+
+		if (s.input_power > 2 * POWER_LIMIT) {
+			m.over_t2_ms++;
+		}
+		m.peak_input_power = MAX(m.peak_input_power, s.input_power);
+		aiclk_sum += aiclk;
+		power_sum += s.input_power;
+	}
+
+	m.avg_aiclk = aiclk_sum / w->duration_ms;
+	m.avg_input_power = power_sum / w->duration_ms;
+
+	return m;
+}
+
+static void doppler_print(const struct workload *w, bool predict, const struct doppler_metrics *m)
+{
+	TC_PRINT("%-6s %s: > 2x limit %4u ms, critical %4u ms, avg AICLK %4d MHz, "
+		 "avg %3d W, peak %3d W\n",
+		 w->name, predict ? "predicted" : "reactive ", m->over_t2_ms, m->critical_ms,
+		 (int)m->avg_aiclk, (int)m->avg_input_power, (int)m->peak_input_power);
+}
+
+/* Fit at a fixed activity and temperature while AICLK sweeps, as DVFS does under throttling */
+static void fit(const struct plant_params *p, float activity, float temperature)
+{
+	struct plant s;
+
+	for (int i = 0; i < 2000; i++) {
+		uint32_t aiclk = aiclk_fmin + (i * 7) % (aiclk_fmax - aiclk_fmin);
+
+		s.temperature = temperature;
+		plant_step(p, &s, aiclk, activity);
+		power_model_update(aiclk, s.voltage, temperature, s.power, s.input_power);
+	}
+}
+
+static float plant_input_power(const struct plant_params *p, uint32_t aiclk, float activity,
+			       float temperature)
+{
+	struct plant s = {.temperature = temperature};
+
+	plant_step(p, &s, aiclk, activity);
+	return s.input_power;
+}
+
+ZTEST(power_model, test_fit)
+{
+	fit(&nominal_card, 0.6f, 60.0f);
+
+	/* The regulator efficiency and the rest of the board are fitted */
+	for (uint32_t aiclk = aiclk_fmin; aiclk <= aiclk_fmax; aiclk += 100) {
+		float actual = plant_input_power(&nominal_card, aiclk, 0.6f, 60.0f);
+
+		zassert_within(power_model_predict(aiclk, 60.0f), actual, 0.01f * actual,
+			       "%u MHz", aiclk);
+	}
+
+	/* The highest AICLK within a limit is the one the prediction crosses it at */
+	uint32_t max_aiclk = power_model_max_aiclk(250.0f, 60.0f);
+
+	zassert_true(max_aiclk > aiclk_fmin && max_aiclk < aiclk_fmax);
+	zassert_true(power_model_predict(max_aiclk, 60.0f) <= 250.0f);
+	zassert_true(power_model_predict(max_aiclk + 1, 60.0f) > 250.0f);
+
+	zassert_equal(power_model_max_aiclk(1000.0f, 60.0f), aiclk_fmax);
+	zassert_equal(power_model_max_aiclk(10.0f, 60.0f), aiclk_fmin);
+}
+
+ZTEST(power_model, test_fit_leaky)
+{
+	fit(&card, 0.6f, 60.0f);
+
+	/*
+	 * The leakage the model doesn't know about is taken for activity, mostly at low AICLK
+	 * where it is the larger part of the power, and held as the peak. The prediction errs on
+	 * the high side, apart from a few percent at fmin.
+	 */
+	for (uint32_t aiclk = aiclk_fmin; aiclk <= aiclk_fmax; aiclk += 100) {
+		float actual = plant_input_power(&card, aiclk, 0.6f, 60.0f);
+
+		zassert_true(power_model_predict(aiclk, 60.0f) >= 0.95f * actual, "%u MHz", aiclk);
+	}
+}
+
+ZTEST(power_model, test_bad_inputs)
+{
+	float before = power_model_predict(aiclk_fmax, 50.0f);
+
+	/* Measurements at 0 MHz or 0 mV are ignored */
+	power_model_update(0, 800, 50, 100, 200);
+	power_model_update(800, 0, 50, 100, 200);
+	zassert_equal(power_model_predict(aiclk_fmax, 50.0f), before);
+
+	/* A non-finite measurement resets the model rather than poisoning it */
+	power_model_update(800, 800, 50, NAN, 200);
+	zassert_true(isfinite(power_model_predict(aiclk_fmax, 50.0f)));
+	power_model_update(800, 800, 50, 100, INFINITY);
+	zassert_true(isfinite(power_model_predict(aiclk_fmax, 50.0f)));
+}
+
+/*
+ * Regression bounds for the prediction against the reactive Doppler loop alone. It has to keep
+ * bursts away from critical throttling without giving up much AICLK.
+ */
+ZTEST(power_model, test_doppler)
+{
+	for (int i = 0; i < ARRAY_SIZE(workloads); i++) {
+		const struct workload *w = &workloads[i];
+		struct doppler_metrics reactive = doppler_run(w, false);
+		struct doppler_metrics predicted = doppler_run(w, true);
+
+		doppler_print(w, false, &reactive);
+		doppler_print(w, true, &predicted);
+
+		zassert_true(reactive.critical_ms > 0, "%s", w->name);
+		zassert_equal(predicted.critical_ms, 0, "%s", w->name);
+		zassert_true(predicted.over_t2_ms * 10 <= reactive.over_t2_ms, "%s", w->name);
+		zassert_true(predicted.avg_aiclk >= 0.95f * reactive.avg_aiclk, "%s", w->name);
+		zassert_true(predicted.avg_input_power <= reactive.avg_input_power, "%s", w->name);
+	}
+}
+
+static void *power_model_setup(void)
+{
+	aiclk_fmin = GetAiclkFmin();
+	aiclk_fmax = GetAiclkFmax();
+	default_board_power_limit = GetThrottlerLimit(kThrottlerBoardPower);
+	default_doppler_limit = GetThrottlerLimit(kThrottlerDopplerSlow);
+
+	return NULL;
+}
+
+static void power_model_before(void *fixture)
+{
+	for (int i = 0; i < aiclk_arb_max_count; i++) {
+		SetAiclkArbMax(i, aiclk_fmax);
+		EnableArbMax(i, false);
+	}
+	EnableArbMin(aiclk_arb_min_fmin, false);
+	SetAiclkArbMin(aiclk_arb_min_busy, aiclk_fmax);
+	EnableArbMin(aiclk_arb_min_busy, true);
+
+	SetAiclkArbMax(aiclk_arb_max_doppler_critical, aiclk_fmin);
+	EnableDoppler(true);
+	SetBoardPowerLimit(POWER_LIMIT);
+	power_model_reset();
+}
+
+static void power_model_after(void *fixture)
+{
+	EnableDoppler(false);
+	SetBoardPowerLimit(0);
+	ResetThrottlers();
+
+	if (default_board_power_limit > 0) {
+		SetThrottlerLimit(kThrottlerBoardPower, default_board_power_limit);
+	}
+	if (default_doppler_limit > 0) {
+		SetThrottlerLimit(kThrottlerDopplerSlow, default_doppler_limit);
+	}
+
+	for (int i = 0; i < aiclk_arb_max_count; i++) {
+		SetAiclkArbMax(i, aiclk_fmax);
+		EnableArbMax(i, i != aiclk_arb_max_host_fmax);
+	}
+	for (int i = 0; i < aiclk_arb_min_count; i++) {
+		SetAiclkArbMin(i, aiclk_fmin);
+		EnableArbMin(i, true);
+	}
+	CalculateTargAiclk();
+}
+
+ZTEST_SUITE(power_model, NULL, power_model_setup, power_model_before, power_model_after, NULL);
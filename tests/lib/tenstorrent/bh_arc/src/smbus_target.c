@@ -7,6 +7,8 @@
 #include <zephyr/ztest.h>
 #include <zephyr/drivers/i2c.h>
 #include <zephyr/fff.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
 #include <tenstorrent/tt_smbus_regs.h>
 #include <zephyr/drivers/i2c.h>
 #include "reg_mock.h"
@@ -248,4 +250,142 @@ ZTEST(smbus_target, test_block_write_block_read_with_pec)
 	zexpect_equal(4, read_data[0]);
 }
 
+static int telem_bulk_read(uint8_t first_tag, uint32_t bitmap, uint8_t *read_data,
+			   size_t read_size)
+{
+	uint8_t write_data[7] = {CMFW_SMBUS_TELEMETRY_BULK_READ, 5U, first_tag};
+
+	sys_put_le32(bitmap, &write_data[3]);
+
+	return i2c_write_read(i2c0_dev, tt_i2c_addr, write_data, sizeof(write_data), read_data,
+			      read_size);
+}
+
+ZTEST(smbus_target, test_telem_bulk_read)
+{
+	uint8_t read_data[1 + 4 + 2 * 4 + 1];
+	uint32_t generation;
+
+	UpdateDmFwVersion(0x01020304, 0x05060708);
+	generation = GetTelemetryTag(TAG_TELEM_GENERATION);
+
+	/* TAG_DM_APP_FW_VERSION and TAG_DM_BL_FW_VERSION */
+	zassert_equal(0, telem_bulk_read(TAG_DM_APP_FW_VERSION, BIT(0) | BIT(1), read_data,
+					 sizeof(read_data)));
+	zexpect_equal(12U, read_data[0]);
+	zexpect_equal(2U, read_data[1]);
+	zexpect_equal(0U, read_data[2]);
+	zexpect_equal((uint16_t)generation, sys_get_le16(&read_data[3]));
+	zexpect_equal(0x05060708, sys_get_le32(&read_data[5]));
+	zexpect_equal(0x01020304, sys_get_le32(&read_data[9]));
+
+	/* PEC covers the whole transaction, including the header */
+	uint8_t pec_data[] = {tt_i2c_addr << 1, CMFW_SMBUS_TELEMETRY_BULK_READ, 5U,
+			      TAG_DM_APP_FW_VERSION, 0x3, 0, 0, 0, tt_i2c_addr << 1 | 1};
+	uint8_t pec = crc8_ccitt(0, pec_data, sizeof(pec_data));
+
+	pec = crc8_ccitt(pec, read_data, 13);
+	zexpect_equal(pec, read_data[13]);
+}
+
+ZTEST(smbus_target, test_telem_bulk_read_sparse)
+{
+	uint8_t read_data[1 + 4 + 2 * 4 + 1];
+
+	/* Tags are returned in ascending order, skipping unselected ones */
+	zassert_equal(0, telem_bulk_read(TAG_BOARD_ID_HIGH, BIT(0) | BIT(30), read_data,
+					 sizeof(read_data)));
+	zexpect_equal(2U, read_data[1]);
+	zexpect_equal(GetTelemetryTag(TAG_BOARD_ID_HIGH), sys_get_le32(&read_data[5]));
+	zexpect_equal(GetTelemetryTag(TAG_BOARD_ID_HIGH + 30), sys_get_le32(&read_data[9]));
+}
+
+ZTEST(smbus_target, test_telem_bulk_read_bad_selection)
+{
+	uint8_t read_data[CONFIG_SMBUS_MAX_MSG_SIZE + 2];
+
+	/* Nothing selected */
+	zassert_equal(-1, telem_bulk_read(0, 0, read_data, sizeof(read_data)));
+	tear_down_tc(NULL);
+	/* More tags than fit in one block */
+	zassert_equal(-1, telem_bulk_read(0, BIT_MASK(CMFW_SMBUS_TELEMETRY_BULK_MAX_TAGS + 1),
+					  read_data, sizeof(read_data)));
+	tear_down_tc(NULL);
+	/* Past the end of the telemetry table */
+	zassert_equal(-1, telem_bulk_read(TAG_COUNT - 1, BIT(1), read_data, sizeof(read_data)));
+	tear_down_tc(NULL);
+
+	/* The largest selection fits */
+	zassert_equal(0, telem_bulk_read(0, BIT_MASK(CMFW_SMBUS_TELEMETRY_BULK_MAX_TAGS),
+					 read_data, 6 + 4 * CMFW_SMBUS_TELEMETRY_BULK_MAX_TAGS));
+	zexpect_equal(CMFW_SMBUS_TELEMETRY_BULK_MAX_TAGS, read_data[1]);
+}
+
+ZTEST(smbus_target, test_telem_bulk_read_keeps_selection)
+{
+	uint8_t read_data[1 + 4 + 2 * 4 + 1];
+	uint8_t bad_selection[5] = {TAG_COUNT - 2};
+	uint8_t data[CONFIG_SMBUS_MAX_MSG_SIZE];
+	uint8_t size;
+
+	UpdateDmFwVersion(0x01020304, 0x05060708);
+	zassert_equal(0, telem_bulk_read(TAG_DM_APP_FW_VERSION, BIT(0) | BIT(1), read_data,
+					 sizeof(read_data)));
+
+	/* The first tag is valid, the second is past the end of the telemetry table */
+	sys_put_le32(BIT(0) | BIT(2), &bad_selection[1]);
+	zassert_equal(-1, SMBusTelemBulkRegHandler(bad_selection, sizeof(bad_selection)));
+
+	/* The earlier selection is returned, whole */
+	zassert_ok(SMBusTelemBulkDataHandler(data, &size));
+	zassert_equal(size, 4 + 2 * 4);
+	zexpect_equal(2U, data[0]);
+	zexpect_equal(0x05060708, sys_get_le32(&data[4]));
+	zexpect_equal(0x01020304, sys_get_le32(&data[8]));
+}
+
+ZTEST(smbus_target, test_telem_bulk_read_bytes_per_tag)
+{
+	uint8_t bulk_read[6 + 4 * CMFW_SMBUS_TELEMETRY_BULK_MAX_TAGS];
+	uint8_t reg_write[3] = {0x26};
+	uint8_t data_write[] = {0x27};
+	uint8_t data_read[9];
+
+	for (uint32_t n = 1; n <= CMFW_SMBUS_TELEMETRY_BULK_MAX_TAGS; n++) {
+		/* Bytes on the wire: an address byte per (repeated) start, plus the data. The bulk
+		 * write is the command, count, first tag and bitmap, the read adds count, header and
+		 * PEC to the values.
+		 */
+		uint32_t legacy = 0;
+		uint32_t bulk = 1 + 7 + 1 + 6 + 4 * n;
+
+		zassert_equal(0, telem_bulk_read(0, BIT_MASK(n), bulk_read, 6 + 4 * n));
+		zexpect_equal(n, bulk_read[1]);
+
+		/* The same tags, one at a time through 0x26 and 0x27 */
+		for (uint8_t tag = 0; tag < n; tag++) {
+			uint8_t pec_data[] = {tt_i2c_addr << 1, reg_write[0], tag};
+
+			reg_write[1] = tag;
+			reg_write[2] = crc8_ccitt(0, pec_data, sizeof(pec_data));
+			zassert_equal(0, i2c_write(i2c0_dev, reg_write, sizeof(reg_write),
+						   tt_i2c_addr));
+			zassert_equal(0, i2c_write_read(i2c0_dev, tt_i2c_addr, data_write,
+							sizeof(data_write), data_read,
+							sizeof(data_read)));
+			zexpect_equal(sys_get_le32(&bulk_read[6 + 4 * tag]),
+				      sys_get_le32(&data_read[4]));
+			legacy += 1 + sizeof(reg_write) + 1 + sizeof(data_write) + 1 + sizeof(data_read);
+		}
+
+		TC_PRINT("%2u tags: %3u bytes one at a time (%u.%u/tag), %3u bytes bulk "
+			 "(%u.%u/tag)\n",
+			 n, legacy, legacy / n, legacy * 10 / n % 10, bulk, bulk / n,
+			 bulk * 10 / n % 10);
+		if (n > 1) {
+			zexpect_true(bulk < legacy);
+		}
+	}
+}
+
 ZTEST_SUITE(smbus_target, NULL, NULL, NULL, tear_down_tc, NULL);
@@ -0,0 +1,407 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/sys/crc.h>
+#include <tenstorrent/bh_arc.h>
+#include <tenstorrent/smbus_target.h>
+#include <tenstorrent/tt_smbus_regs.h>
+
+#include "asic_state.h"
+#include "dw_apb_i2c.h"
+#include "fan_ctrl.h"
+#include "reg_mock.h"
+
+/*
+ * Model of the DW APB I2C controller facing the DMC, as a target, with the DMC replaying the
+ * transactions of its main loop. As in the dw_apb_i2c tests, time advances by REG_ACCESS_NS
+ * for every register access and the bus moves one byte every BYTE_NS. The controller holds
+ * the clock while its RX FIFO is full or a read request waits for data, and the time the DMC
+ * is held is the service latency of a transaction.
+ */
+#define I2C_ID         0
+#define I2C_BASE       0x80060000
+#define REFCLK_LO      0x800300E0
+#define REFCLK_HI      0x800300E4
+#define TARGET_ADDR    0x0A
+#define FIFO_DEPTH     8
+#define REG_ACCESS_NS  25
+#define BYTE_NS        22500 /* 9 bits at 400 kHz */
+#define IRQ_LATENCY_NS 2000
+#define POLL_PERIOD_NS 100000
+#define STEP_NS        500
+#define ROUNDS         20
+
+#define IC_DATA_CMD      0x10
+#define IC_INTR_MASK     0x30
+#define IC_RAW_INTR_STAT 0x34
+#define IC_RX_TL         0x38
+#define IC_CLR_RX_OVER   0x48
+#define IC_CLR_RD_REQ    0x50
+#define IC_CLR_TX_ABRT   0x54
+#define IC_CLR_STOP_DET  0x60
+#define IC_STATUS        0x70
+
+#define INTR_RX_FULL  BIT(2)
+#define INTR_RD_REQ   BIT(5)
+#define INTR_STOP_DET BIT(9)
+
+/* A transaction of the DMC: the bytes it writes, then a read after a restart */
+struct dmc_transaction {
+	uint8_t write_len;
+	uint8_t write[8];
+	/* Bytes read, PEC included. 0xFF for a block read, where the first byte is the count. */
+	uint8_t read_len;
+};
+
+#define BLOCK_READ 0xFF
+
+/* Captured from the DMC main loop: board power every millisecond, fan RPM and CM2DM polls */
+static const struct dmc_transaction dmc_session[] = {
+	{4, {CMFW_SMBUS_POWER_INSTANT, 0x96, 0x00, 0x23}},
+	{4, {CMFW_SMBUS_FAN_RPM, 0x60, 0x09, 0x0B}},
+	{5, {CMFW_SMBUS_REQ_WINDOW, 3, 0x00, 0x00, 0xFF}, BLOCK_READ},
+	{1, {CMFW_SMBUS_PING_V2}, 3},
+	{4, {CMFW_SMBUS_POWER_INSTANT, 0xB4, 0x00, 0xA7}},
+};
+
+enum service {
+	SERVICE_POLL,
+	SERVICE_IRQ,
+};
+
+static struct {
+	uint64_t now_ns;
+	/* End of the byte on the bus, pushed out while the clock is held */
+	uint64_t byte_done_ns;
+	uint64_t held_ns;
+	const struct dmc_transaction *t;
+	/* Bytes of the transaction done on the bus, address bytes included */
+	uint32_t pos;
+	uint32_t read_len;
+	uint8_t read[64];
+	bool active;
+	bool rd_req_raised;
+	uint8_t rx_fifo[FIFO_DEPTH];
+	uint32_t rx_head;
+	uint32_t rx_count;
+	uint8_t tx_fifo[FIFO_DEPTH];
+	uint32_t tx_head;
+	uint32_t tx_count;
+	uint32_t latched_intr;
+	uint32_t intr_mask;
+	uint32_t rx_tl;
+	uint32_t rd_reqs;
+} m;
+
+static uint32_t raw_intr(void)
+{
+	return m.latched_intr | (m.rx_count > m.rx_tl ? INTR_RX_FULL : 0);
+}
+
+/* Positions in the transaction: address, write bytes, then address and read bytes */
+static bool is_read_byte(uint32_t pos)
+{
+	return m.read_len > 0 && pos > m.t->write_len + 1;
+}
+
+static bool byte_ready(void)
+{
+	if (is_read_byte(m.pos)) {
+		if (m.tx_count == 0) {
+			if (!m.rd_req_raised) {
+				m.latched_intr |= INTR_RD_REQ;
+				m.rd_req_raised = true;
+				m.rd_reqs++;
+			}
+			return false;
+		}
+	} else if (m.pos > 0 && m.pos <= m.t->write_len) {
+		return m.rx_count < FIFO_DEPTH;
+	}
+	return true;
+}
+
+static void byte_done(void)
+{
+	if (is_read_byte(m.pos)) {
+		uint32_t i = m.pos - m.t->write_len - 2;
+
+		m.read[i] = m.tx_fifo[m.tx_head];
+		m.tx_head = (m.tx_head + 1) % FIFO_DEPTH;
+		m.tx_count--;
+		m.rd_req_raised = false;
+
+		if (i == 0 && m.t->read_len == BLOCK_READ) {
+			/* Count, data and PEC */
+			m.read_len = MIN(2 + m.read[0], sizeof(m.read));
+		}
+	} else if (m.pos > 0 && m.pos <= m.t->write_len) {
+		m.rx_fifo[(m.rx_head + m.rx_count++) % FIFO_DEPTH] = m.t->write[m.pos - 1];
+	}
+
+	m.pos++;
+	if (m.pos == 1 + m.t->write_len + (m.read_len > 0 ? 1 + m.read_len : 0)) {
+		m.active = false;
+		m.latched_intr |= INTR_STOP_DET;
+	}
+}
+
+static void bus_advance(uint64_t now_ns)
+{
+	m.now_ns = now_ns;
+
+	while (m.active && m.byte_done_ns - BYTE_NS <= m.now_ns) {
+		if (!byte_ready()) {
+			/* The byte can't start, hold the clock */
+			m.held_ns += m.now_ns + BYTE_NS - m.byte_done_ns;
+			m.byte_done_ns = m.now_ns + BYTE_NS;
+			break;
+		}
+		if (m.byte_done_ns > m.now_ns) {
+			break;
+		}
+		byte_done();
+		m.byte_done_ns += BYTE_NS;
+	}
+}
+
+static uint32_t model_read(uint32_t addr)
+{
+	uint32_t val = 0;
+
+	bus_advance(m.now_ns + REG_ACCESS_NS);
+
+	if (addr == REFCLK_LO) {
+		return (uint32_t)(m.now_ns / 20);
+	} else if (addr == REFCLK_HI) {
+		return (uint32_t)((m.now_ns / 20) >> 32);
+	}
+
+	switch (addr - I2C_BASE) {
+	case IC_STATUS:
+		/* TFNF, TFE and RFNE */
+		val |= m.tx_count < FIFO_DEPTH ? 0x2 : 0;
+		val |= m.tx_count == 0 ? 0x4 : 0;
+		val |= m.rx_count > 0 ? 0x8 : 0;
+		break;
+	case IC_DATA_CMD:
+		if (m.rx_count > 0) {
+			val = m.rx_fifo[m.rx_head];
+			m.rx_head = (m.rx_head + 1) % FIFO_DEPTH;
+			m.rx_count--;
+		}
+		break;
+	case IC_RAW_INTR_STAT:
+		val = raw_intr();
+		break;
+	case IC_CLR_RD_REQ:
+		m.latched_intr &= ~INTR_RD_REQ;
+		break;
+	case IC_CLR_STOP_DET:
+		m.latched_intr &= ~INTR_STOP_DET;
+		break;
+	case IC_CLR_RX_OVER:
+	case IC_CLR_TX_ABRT:
+		zassert_unreachable("no errors are injected");
+		break;
+	default:
+		break;
+	}
+
+	return val;
+}
+
+static void model_write(uint32_t addr, uint32_t val)
+{
+	bus_advance(m.now_ns + REG_ACCESS_NS);
+
+	switch (addr - I2C_BASE) {
+	case IC_DATA_CMD:
+		zassert_true(m.tx_count < FIFO_DEPTH, "TX FIFO overflow");
+		m.tx_fifo[(m.tx_head + m.tx_count++) % FIFO_DEPTH] = val & 0xFF;
+		break;
+	case IC_INTR_MASK:
+		m.intr_mask = val;
+		break;
+	case IC_RX_TL:
+		m.rx_tl = val;
+		break;
+	default:
+		break;
+	}
+}
+
+struct service_stats {
+	uint32_t transactions;
+	uint64_t held_sum_ns;
+	uint64_t held_max_ns;
+	uint32_t calls;
+	uint32_t events;
+};
+
+/* Let the CPU serve the target until the DMC's transaction is done and the stop handled */
+static void serve(enum service service, struct service_stats *stats)
+{
+	uint64_t next_poll_ns = m.now_ns;
+
+	while (m.active || raw_intr()) {
+		if (service == SERVICE_IRQ) {
+			if (raw_intr() & m.intr_mask) {
+				bus_advance(m.now_ns + IRQ_LATENCY_NS);
+				stats->events += I2CTargetIsr(I2C_ID);
+				stats->calls++;
+			} else {
+				bus_advance(m.now_ns + STEP_NS);
+			}
+		} else if (m.now_ns >= next_poll_ns) {
+			PollI2CSlave(I2C_ID);
+			stats->calls++;
+			next_poll_ns += POLL_PERIOD_NS;
+		} else {
+			bus_advance(MIN(m.now_ns + STEP_NS, next_poll_ns));
+		}
+	}
+}
+
+static uint8_t pec_crc_8(uint8_t crc, uint8_t data)
+{
+	return crc8(&data, 1, 0x7, crc, false);
+}
+
+static void check_response(const struct dmc_transaction *t)
+{
+	uint8_t pec = 0;
+
+	if (m.read_len == 0) {
+		return;
+	}
+
+	pec = pec_crc_8(pec, TARGET_ADDR << 1);
+	for (uint32_t i = 0; i < t->write_len; i++) {
+		pec = pec_crc_8(pec, t->write[i]);
+	}
+	pec = pec_crc_8(pec, TARGET_ADDR << 1 | 1);
+	for (uint32_t i = 0; i < m.read_len - 1; i++) {
+		pec = pec_crc_8(pec, m.read[i]);
+	}
+	zassert_equal(m.read[m.read_len - 1], pec, "bad PEC for command 0x%02x", t->write[0]);
+
+	if (t->write[0] == CMFW_SMBUS_PING_V2) {
+		zassert_equal(m.read[0], 0xA5);
+		zassert_equal(m.read[1], 0xA5);
+	} else if (t->write[0] == CMFW_SMBUS_REQ_WINDOW) {
+		zassert_equal(m.read[0], 2 + m.read[1] * sizeof(cm2dmMessage));
+	}
+}
+
+static void replay(enum service service, struct service_stats *stats)
+{
+	memset(stats, 0, sizeof(*stats));
+
+	for (int i = 0; i < ROUNDS; i++) {
+		ARRAY_FOR_EACH_PTR(dmc_session, t) {
+			m.t = t;
+			m.pos = 0;
+			m.read_len = t->read_len == BLOCK_READ ? 1 : t->read_len;
+			m.held_ns = 0;
+			m.byte_done_ns = m.now_ns + BYTE_NS;
+			m.active = true;
+
+			serve(service, stats);
+			check_response(t);
+
+			stats->transactions++;
+			stats->held_sum_ns += m.held_ns;
+			stats->held_max_ns = MAX(stats->held_max_ns, m.held_ns);
+
+			/* Idle bus until the next transaction */
+			bus_advance(m.now_ns + 10 * BYTE_NS);
+		}
+	}
+
+	zassert_equal(GetFanRPM(), 2400);
+}
+
+static void print_stats(const char *name, const struct service_stats *stats)
+{
+	TC_PRINT("%s: DMC held %llu ns per transaction on average, %llu ns at most, "
+		 "%u calls for %u transactions\n",
+		 name, (unsigned long long)(stats->held_sum_ns / stats->transactions),
+		 (unsigned long long)stats->held_max_ns, stats->calls, stats->transactions);
+}
+
+ZTEST(smbus_target_irq, test_replay_irq)
+{
+	struct service_stats stats;
+
+	replay(SERVICE_IRQ, &stats);
+
+	/* The DMC is only held on read requests, for the interrupt latency and the handler */
+	zassert_true(stats.held_sum_ns < m.rd_reqs * 2 * IRQ_LATENCY_NS);
+	zassert_true(stats.events >= stats.calls);
+}
+
+ZTEST(smbus_target_irq, test_replay_poll)
+{
+	struct service_stats stats;
+
+	replay(SERVICE_POLL, &stats);
+}
+
+/* Service latency of the DMC's transactions, polled or served from interrupts */
+ZTEST(smbus_target_irq, test_latency)
+{
+	struct service_stats irq;
+	struct service_stats poll;
+
+	replay(SERVICE_POLL, &poll);
+	print_stats("polling every 100 us", &poll);
+	replay(SERVICE_IRQ, &irq);
+	print_stats("interrupts", &irq);
+	TC_PRINT("%u events in %u interrupts\n", irq.events, irq.calls);
+
+	zassert_true(irq.held_sum_ns * 10 < poll.held_sum_ns);
+	zassert_true(irq.held_max_ns < poll.held_max_ns);
+}
+
+static void *smbus_target_irq_setup(void)
+{
+	static const struct device *const smbus_target_dev =
+		DEVICE_DT_GET_OR_NULL(DT_NODELABEL(smbus_target0));
+
+	zassert_true(device_is_ready(smbus_target_dev));
+	return smbus_target_get_config(smbus_target_dev);
+}
+
+static void smbus_target_irq_before(void *fixture)
+{
+	struct i2c_target_config *cfg = fixture;
+
+	memset(&m, 0, sizeof(m));
+	ReadReg_fake.custom_fake = model_read;
+	WriteReg_fake.custom_fake = model_write;
+	set_asic_state(A0State);
+
+	zassert_ok(I2CTargetRegister(I2C_ID, cfg));
+	zassert_equal(m.intr_mask & (INTR_RX_FULL | INTR_RD_REQ | INTR_STOP_DET),
+		      INTR_RX_FULL | INTR_RD_REQ | INTR_STOP_DET);
+}
+
+static void smbus_target_irq_after(void *fixture)
+{
+	struct i2c_target_config *cfg = fixture;
+
+	/* Leave the target idle for the tests on the emulated bus */
+	cfg->callbacks->stop(cfg);
+}
+
+ZTEST_SUITE(smbus_target_irq, NULL, smbus_target_irq_setup, smbus_target_irq_before,
+	    smbus_target_irq_after, NULL);
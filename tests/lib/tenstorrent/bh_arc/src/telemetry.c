@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "telemetry.h"
+
+#define UPDATES         2000
+#define WRITER_STACK    1024
+#define READER_STACK    1024
+#define WRITER_PRIORITY K_PRIO_PREEMPT(6)
+#define READER_PRIORITY K_PRIO_PREEMPT(5)
+
+extern k_spinlock_key_t telemetry_write_begin(void);
+extern void telemetry_write_end(k_spinlock_key_t key);
+extern uint32_t telemetry_read_begin(void);
+extern bool telemetry_read_retry(uint32_t start);
+
+static struct k_thread writer_thread;
+static struct k_thread reader_thread;
+static K_THREAD_STACK_DEFINE(writer_stack, WRITER_STACK);
+static K_THREAD_STACK_DEFINE(reader_stack, READER_STACK);
+
+static atomic_t writer_done;
+static uint32_t snapshots;
+static uint32_t torn_snapshots;
+static uint32_t torn_tag_reads;
+static uint32_t generation_regressions;
+static uint32_t isr_snapshots;
+static uint32_t isr_torn_snapshots;
+
+/* Every update writes the same value to two tags, so a torn read shows up as a mismatch. */
+static void writer_entry(void *p1, void *p2, void *p3)
+{
+	for (uint32_t i = 1; i <= UPDATES; i++) {
+		UpdateDmFwVersion(i, i);
+		/* Let simulated time advance so that the reader and the timer get to run */
+		k_busy_wait(10);
+	}
+
+	atomic_set(&writer_done, 1);
+}
+
+static void reader_entry(void *p1, void *p2, void *p3)
+{
+	static uint32_t values[TAG_COUNT];
+	uint32_t last_generation = 0;
+
+	while (!atomic_get(&writer_done)) {
+		uint32_t generation = ReadTelemetrySnapshot(values);
+
+		if (values[TAG_DM_BL_FW_VERSION] != values[TAG_DM_APP_FW_VERSION]) {
+			torn_snapshots++;
+		}
+		if (generation < last_generation) {
+			generation_regressions++;
+		}
+		last_generation = generation;
+		snapshots++;
+
+		/* Two single-tag reads from the same generation must also match */
+		uint32_t gen_bl;
+		uint32_t gen_app;
+		uint32_t bl = GetTelemetryTagSnapshot(TAG_DM_BL_FW_VERSION, &gen_bl);
+		uint32_t app = GetTelemetryTagSnapshot(TAG_DM_APP_FW_VERSION, &gen_app);
+
+		if (gen_bl == gen_app && bl != app) {
+			torn_tag_reads++;
+		}
+
+		k_sleep(K_USEC(15));
+	}
+}
+
+static void isr_reader(struct k_timer *timer)
+{
+	static uint32_t values[TAG_COUNT];
+
+	ReadTelemetrySnapshot(values);
+	if (values[TAG_DM_BL_FW_VERSION] != values[TAG_DM_APP_FW_VERSION]) {
+		isr_torn_snapshots++;
+	}
+	isr_snapshots++;
+}
+static K_TIMER_DEFINE(isr_reader_timer, isr_reader, NULL);
+
+ZTEST(telemetry, test_concurrent_snapshots)
+{
+	uint32_t values[TAG_COUNT];
+
+	atomic_set(&writer_done, 0);
+	k_timer_start(&isr_reader_timer, K_USEC(100), K_USEC(100));
+
+	k_thread_create(&writer_thread, writer_stack, WRITER_STACK, writer_entry, NULL, NULL,
+			NULL, WRITER_PRIORITY, 0, K_NO_WAIT);
+	k_thread_create(&reader_thread, reader_stack, READER_STACK, reader_entry, NULL, NULL,
+			NULL, READER_PRIORITY, 0, K_NO_WAIT);
+
+	zassert_ok(k_thread_join(&writer_thread, K_SECONDS(30)));
+	zassert_ok(k_thread_join(&reader_thread, K_SECONDS(30)));
+	k_timer_stop(&isr_reader_timer);
+
+	TC_PRINT("%u thread snapshots, %u isr snapshots\n", snapshots, isr_snapshots);
+
+	zassert_true(snapshots > 0);
+	zassert_true(isr_snapshots > 0);
+	zassert_equal(torn_snapshots, 0);
+	zassert_equal(torn_tag_reads, 0);
+	zassert_equal(isr_torn_snapshots, 0);
+	zassert_equal(generation_regressions, 0);
+
+	/* The final update is visible and the generation is left even */
+	uint32_t generation = ReadTelemetrySnapshot(values);
+
+	zassert_equal(values[TAG_DM_BL_FW_VERSION], UPDATES);
+	zassert_equal(values[TAG_DM_APP_FW_VERSION], UPDATES);
+	zassert_equal(values[TAG_TELEM_GENERATION], generation);
+	zassert_equal(generation & 1, 0);
+}
+
+ZTEST(telemetry, test_generation_advances)
+{
+	uint32_t before;
+	uint32_t after;
+
+	GetTelemetryTagSnapshot(TAG_HOST_AICLK_LIMIT, &before);
+	UpdateTelemetryHostAiclkLimit(1234);
+	zassert_equal(GetTelemetryTagSnapshot(TAG_HOST_AICLK_LIMIT, &after), 1234);
+
+	/* One update bumps the generation twice: odd while writing, even when done */
+	zassert_equal(after, before + 2);
+}
+
+/* The threads above may never interleave badly, so step through the races by hand */
+ZTEST(telemetry, test_torn_read)
+{
+	uint32_t start;
+	uint32_t bl;
+	uint32_t app;
+
+	UpdateDmFwVersion(1, 1);
+
+	/* An update publishes between the two halves of the read */
+	start = telemetry_read_begin();
+	bl = GetTelemetryTag(TAG_DM_BL_FW_VERSION);
+	UpdateDmFwVersion(2, 2);
+	app = GetTelemetryTag(TAG_DM_APP_FW_VERSION);
+	zassert_not_equal(bl, app);
+	zassert_true(telemetry_read_retry(start));
+
+	/* The read starts while an update is in progress */
+	k_spinlock_key_t key = telemetry_write_begin();
+
+	start = telemetry_read_begin();
+	zassert_true(telemetry_read_retry(start));
+	telemetry_write_end(key);
+	zassert_true(telemetry_read_retry(start));
+
+	/* A read that no update overlaps is accepted */
+	start = telemetry_read_begin();
+	bl = GetTelemetryTag(TAG_DM_BL_FW_VERSION);
+	app = GetTelemetryTag(TAG_DM_APP_FW_VERSION);
+	zassert_false(telemetry_read_retry(start));
+	zassert_equal(bl, 2);
+	zassert_equal(app, 2);
+}
+
+ZTEST_SUITE(telemetry, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/fff.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+#include "telemetry.h"
+#include "telemetry_events.h"
+
+DEFINE_FAKE_VOID_FUNC(mock_msi, uint8_t /*pcie_inst*/, uint32_t /*vector_id*/);
+
+static uint32_t ring_start;
+
+static const struct telemetry_event_record *event(uint32_t n)
+{
+	const struct telemetry_event_ring *ring = telemetry_events_get();
+
+	return &ring->records[(ring_start + n) % ring->capacity];
+}
+
+static uint32_t new_events(void)
+{
+	return telemetry_events_get()->head - ring_start;
+}
+
+static void feed(uint16_t tag, uint32_t value)
+{
+	telemetry_events_check(tag, value);
+	/* Let the host message work queue deliver the MSI */
+	k_msleep(1);
+}
+
+ZTEST(telemetry_events, test_rising_threshold)
+{
+	struct telemetry_event_subscription sub = {
+		.tag = TAG_INPUT_POWER,
+		.flags = TELEMETRY_EVENT_FLAG_ENABLE,
+		.pcie_inst = 0,
+		.msi_vector = 3,
+		.threshold = 150,
+		.hysteresis = 10,
+	};
+
+	zassert_ok(telemetry_events_subscribe(0, &sub));
+
+	feed(TAG_INPUT_POWER, 100);
+	zassert_equal(mock_msi_fake.call_count, 0);
+
+	feed(TAG_INPUT_POWER, 155);
+	zassert_equal(mock_msi_fake.call_count, 1);
+	zassert_equal(mock_msi_fake.arg0_val, 0);
+	zassert_equal(mock_msi_fake.arg1_val, 3);
+	zassert_equal(new_events(), 1);
+	zassert_equal(event(0)->tag, TAG_INPUT_POWER);
+	zassert_equal(event(0)->subscription, 0);
+	zassert_equal(event(0)->flags, TELEMETRY_EVENT_RECORD_ASSERTED);
+	zassert_equal(event(0)->value, 155);
+
+	/* Staying above, or dropping within the hysteresis, raises nothing new */
+	feed(TAG_INPUT_POWER, 160);
+	feed(TAG_INPUT_POWER, 141);
+	zassert_equal(mock_msi_fake.call_count, 1);
+
+	feed(TAG_INPUT_POWER, 139);
+	zassert_equal(mock_msi_fake.call_count, 2);
+	zassert_equal(new_events(), 2);
+	zassert_equal(event(1)->flags, 0);
+	zassert_equal(event(1)->value, 139);
+}
+
+ZTEST(telemetry_events, test_falling_threshold)
+{
+	struct telemetry_event_subscription sub = {
+		.tag = TAG_AICLK,
+		.flags = TELEMETRY_EVENT_FLAG_ENABLE | TELEMETRY_EVENT_FLAG_FALLING,
+		.msi_vector = 1,
+		.threshold = 1000,
+		.hysteresis = 0,
+	};
+
+	zassert_ok(telemetry_events_subscribe(1, &sub));
+
+	feed(TAG_AICLK, 1350);
+	feed(TAG_AICLK, 1000);
+	feed(TAG_AICLK, 800);
+	feed(TAG_AICLK, 1001);
+
+	zassert_equal(mock_msi_fake.call_count, 2);
+	zassert_equal(new_events(), 2);
+	zassert_equal(event(0)->value, 1000);
+	zassert_equal(event(1)->value, 1001);
+}
+
+ZTEST(telemetry_events, test_signed_temperature)
+{
+	struct telemetry_event_subscription sub = {
+		.tag = TAG_ASIC_TEMPERATURE,
+		.flags = TELEMETRY_EVENT_FLAG_ENABLE | TELEMETRY_EVENT_FLAG_FALLING,
+		.threshold = ConvertFloatToTelemetry(0.0f),
+	};
+
+	zassert_ok(telemetry_events_subscribe(0, &sub));
+
+	feed(TAG_ASIC_TEMPERATURE, ConvertFloatToTelemetry(25.0f));
+	zassert_equal(new_events(), 0);
+	feed(TAG_ASIC_TEMPERATURE, ConvertFloatToTelemetry(-2.5f));
+	zassert_equal(new_events(), 1);
+}
+
+ZTEST(telemetry_events, test_disabled_and_invalid)
+{
+	struct telemetry_event_subscription sub = {
+		.tag = TAG_TDP,
+		.threshold = 10,
+	};
+
+	zassert_ok(telemetry_events_subscribe(0, &sub));
+	feed(TAG_TDP, 100);
+	zassert_equal(mock_msi_fake.call_count, 0);
+
+	sub.tag = TAG_COUNT;
+	zassert_not_ok(telemetry_events_subscribe(0, &sub));
+	sub.tag = TAG_TDP;
+	zassert_not_ok(
+		telemetry_events_subscribe(CONFIG_TT_BH_ARC_TELEMETRY_EVENT_SUBSCRIPTIONS, &sub));
+}
+
+ZTEST(telemetry_events, test_sample)
+{
+	struct telemetry_event_subscription sub = {
+		.tag = TAG_TDC,
+		.flags = TELEMETRY_EVENT_FLAG_ENABLE,
+		.threshold = 200,
+	};
+	TelemetryInternalData data = {.vcore_current = 150.0f};
+
+	/* Two subscriptions to the same tag both see the sample */
+	zassert_ok(telemetry_events_subscribe(0, &sub));
+	sub.threshold = 100;
+	zassert_ok(telemetry_events_subscribe(1, &sub));
+
+	telemetry_events_sample(&data);
+	k_msleep(1);
+	zassert_equal(new_events(), 1);
+	zassert_equal(event(0)->subscription, 1);
+
+	data.vcore_current = 250.0f;
+	telemetry_events_sample(&data);
+	k_msleep(1);
+	zassert_equal(new_events(), 2);
+	zassert_equal(event(1)->subscription, 0);
+	zassert_equal(mock_msi_fake.call_count, 2);
+}
+
+ZTEST(telemetry_events, test_subscribe_msg)
+{
+	union request req = {0};
+	struct response rsp = {0};
+
+	req.telemetry_event.command_code = TT_SMC_MSG_TELEMETRY_EVENT_SUBSCRIBE;
+	req.telemetry_event.subscription = 2;
+	req.telemetry_event.tag = TAG_AICLK_THROTTLE_MASK;
+	req.telemetry_event.flags = TELEMETRY_EVENT_FLAG_ENABLE;
+	req.telemetry_event.threshold = 1;
+	req.telemetry_event.msi_vector = 5;
+
+	zassert_ok(msgqueue_request_push(0, &req));
+	process_message_queues();
+	zassert_ok(msgqueue_response_pop(0, &rsp));
+
+	zassert_equal(rsp.data[0], 0);
+	zassert_equal(rsp.data[1], telemetry_events_addr());
+	zassert_equal(rsp.data[2], CONFIG_TT_BH_ARC_TELEMETRY_EVENT_RING_SIZE);
+
+	feed(TAG_AICLK_THROTTLE_MASK, BIT(3));
+	zassert_equal(mock_msi_fake.call_count, 1);
+	zassert_equal(mock_msi_fake.arg1_val, 5);
+}
+
+static void telemetry_events_before(void *fixture)
+{
+	struct telemetry_event_subscription none = {0};
+
+	for (uint32_t i = 0; i < CONFIG_TT_BH_ARC_TELEMETRY_EVENT_SUBSCRIPTIONS; i++) {
+		telemetry_events_subscribe(i, &none);
+	}
+
+	RESET_FAKE(mock_msi);
+	telemetry_events_set_notify(mock_msi);
+	ring_start = telemetry_events_get()->head;
+}
+
+static void telemetry_events_after(void *fixture)
+{
+	telemetry_events_set_notify(NULL);
+}
+
+ZTEST_SUITE(telemetry_events, NULL, NULL, telemetry_events_before, telemetry_events_after,
+	    NULL);
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+#include "telemetry.h"
+#include "telemetry_history.h"
+
+#define DEPTH CONFIG_TT_BH_ARC_TELEMETRY_HISTORY_DEPTH
+
+static const uint8_t test_tags[] = {TAG_TDP, TAG_TDC, TAG_VCORE};
+
+static uint64_t record_timestamp(const struct telemetry_history_record *record)
+{
+	return ((uint64_t)record->timestamp_hi << 32) | record->timestamp_lo;
+}
+
+static const struct telemetry_history_record *record_at(const struct telemetry_history *history,
+							uint32_t index)
+{
+	return &history->records[index % history->capacity];
+}
+
+ZTEST(telemetry_history, test_layout)
+{
+	const struct telemetry_history *history = telemetry_history_get();
+
+	zassert_equal(history->version, TELEMETRY_HISTORY_VERSION);
+	zassert_equal(history->capacity, DEPTH);
+	zassert_equal(history->record_size, sizeof(struct telemetry_history_record));
+	zassert_equal(history->num_tags, ARRAY_SIZE(test_tags));
+	zassert_equal((uintptr_t)history, telemetry_history_addr());
+}
+
+ZTEST(telemetry_history, test_wraparound)
+{
+	const struct telemetry_history *history = telemetry_history_get();
+	uint32_t total = DEPTH * 2 + DEPTH / 2;
+
+	for (uint32_t i = 0; i < total; i++) {
+		uint32_t values[] = {i, i + 1, i + 2};
+
+		telemetry_history_push(1000 + i, values);
+	}
+
+	zassert_equal(history->head, total);
+
+	/* Only the newest DEPTH records are retained, in order */
+	for (uint32_t i = total - DEPTH; i < total; i++) {
+		const struct telemetry_history_record *record = record_at(history, i);
+
+		zassert_equal(record_timestamp(record), 1000 + i, "record %u", i);
+		zassert_equal(record->values[0], i, "record %u", i);
+		zassert_equal(record->values[2], i + 2, "record %u", i);
+	}
+}
+
+ZTEST(telemetry_history, test_timestamps_monotonic)
+{
+	const struct telemetry_history *history = telemetry_history_get();
+	TelemetryInternalData data = {
+		.vcore_voltage = 750.0f,
+		.vcore_power = 120.0f,
+		.vcore_current = 160.0f,
+	};
+
+	/* Enough samples to wrap, so that ordering is checked across the end of the buffer */
+	for (uint32_t i = 0; i < DEPTH + DEPTH / 4; i++) {
+		telemetry_history_sample(&data);
+		k_busy_wait(USEC_PER_MSEC);
+	}
+
+	zassert_equal(history->head, DEPTH + DEPTH / 4);
+
+	for (uint32_t i = history->head - DEPTH + 1; i < history->head; i++) {
+		zassert_true(record_timestamp(record_at(history, i)) >
+				     record_timestamp(record_at(history, i - 1)),
+			     "record %u", i);
+	}
+
+	const struct telemetry_history_record *newest = record_at(history, history->head - 1);
+
+	zassert_equal(newest->values[0], 120);
+	zassert_equal(newest->values[1], 160);
+	zassert_equal(newest->values[2], 750);
+}
+
+ZTEST(telemetry_history, test_period)
+{
+	const struct telemetry_history *history = telemetry_history_get();
+	TelemetryInternalData data = {0};
+
+	zassert_ok(telemetry_history_configure(test_tags, ARRAY_SIZE(test_tags), 5));
+
+	for (uint32_t i = 0; i < 50; i++) {
+		telemetry_history_sample(&data);
+	}
+	zassert_equal(history->head, 10);
+
+	/* A period of 0 stops recording */
+	zassert_ok(telemetry_history_configure(test_tags, ARRAY_SIZE(test_tags), 0));
+	telemetry_history_sample(&data);
+	zassert_equal(history->head, 0);
+}
+
+ZTEST(telemetry_history, test_configure_msg)
+{
+	union request req = {0};
+	struct response rsp = {0};
+
+	req.telemetry_history.command_code = TT_SMC_MSG_CONFIGURE_TELEMETRY_HISTORY;
+	req.telemetry_history.num_tags = 2;
+	req.telemetry_history.period_ms = 1;
+	req.telemetry_history.tags[0] = TAG_AICLK;
+	req.telemetry_history.tags[1] = TAG_INPUT_POWER;
+
+	msgqueue_request_push(0, &req);
+	process_message_queues();
+	msgqueue_response_pop(0, &rsp);
+
+	zassert_equal(rsp.data[0], 0);
+	zassert_equal(rsp.data[1], telemetry_history_addr());
+	zassert_equal(rsp.data[2], DEPTH);
+	zassert_equal(telemetry_history_get()->num_tags, 2);
+	zassert_equal(telemetry_history_get()->tags[1], TAG_INPUT_POWER);
+
+	/* Unknown tags and too many tags are rejected */
+	req.telemetry_history.tags[1] = TAG_COUNT;
+	msgqueue_request_push(0, &req);
+	process_message_queues();
+	msgqueue_response_pop(0, &rsp);
+	zassert_not_equal(rsp.data[0], 0);
+
+	req.telemetry_history.num_tags = CONFIG_TT_BH_ARC_TELEMETRY_HISTORY_MAX_TAGS + 1;
+	zassert_not_ok(telemetry_history_configure(req.telemetry_history.tags,
+						   req.telemetry_history.num_tags, 1));
+}
+
+static void telemetry_history_before(void *fixture)
+{
+	zassert_ok(telemetry_history_configure(test_tags, ARRAY_SIZE(test_tags), 1));
+}
+
+ZTEST_SUITE(telemetry_history, NULL, NULL, telemetry_history_before, NULL, NULL);
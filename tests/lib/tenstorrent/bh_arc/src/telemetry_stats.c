@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+#include "telemetry.h"
+#include "telemetry_stats.h"
+
+#define UPDATE_SAMPLES 10000
+
+static void send_msg(union request *req, struct response *rsp)
+{
+	zassert_ok(msgqueue_request_push(0, req));
+	process_message_queues();
+	zassert_ok(msgqueue_response_pop(0, rsp));
+}
+
+ZTEST(telemetry_stats, test_aggregation)
+{
+	static const uint32_t samples[] = {150, 90, 210, 180, 120};
+	struct telemetry_stats stats;
+
+	for (int i = 0; i < ARRAY_SIZE(samples); i++) {
+		zassert_true(telemetry_stats_record(TAG_TDP, samples[i]));
+	}
+
+	zassert_true(telemetry_stats_get(TAG_TDP, &stats, false));
+	zassert_equal(stats.count, 5);
+	zassert_equal(stats.min, 90);
+	zassert_equal(stats.max, 210);
+	zassert_equal(telemetry_stats_mean(&stats), 150);
+
+	/* Other tags have their own windows */
+	zassert_true(telemetry_stats_get(TAG_TDC, &stats, false));
+	zassert_equal(stats.count, 0);
+}
+
+ZTEST(telemetry_stats, test_signed_values)
+{
+	struct telemetry_stats stats;
+
+	/* ASIC temperature is signed 16.16 */
+	telemetry_stats_record(TAG_ASIC_TEMPERATURE, ConvertFloatToTelemetry(-5.0f));
+	telemetry_stats_record(TAG_ASIC_TEMPERATURE, ConvertFloatToTelemetry(45.0f));
+
+	zassert_true(telemetry_stats_get(TAG_ASIC_TEMPERATURE, &stats, false));
+	zassert_equal(stats.min, (int32_t)ConvertFloatToTelemetry(-5.0f));
+	zassert_equal(stats.max, (int32_t)ConvertFloatToTelemetry(45.0f));
+	zassert_equal(telemetry_stats_mean(&stats), (int32_t)ConvertFloatToTelemetry(20.0f));
+}
+
+ZTEST(telemetry_stats, test_reset_on_read)
+{
+	struct telemetry_stats stats;
+
+	telemetry_stats_record(TAG_AICLK, 800);
+	telemetry_stats_record(TAG_AICLK, 1000);
+
+	/* Reading without reset keeps the window */
+	zassert_true(telemetry_stats_get(TAG_AICLK, &stats, false));
+	zassert_true(telemetry_stats_get(TAG_AICLK, &stats, true));
+	zassert_equal(stats.count, 2);
+
+	zassert_true(telemetry_stats_get(TAG_AICLK, &stats, false));
+	zassert_equal(stats.count, 0);
+
+	/* The new window does not remember the old extremes */
+	telemetry_stats_record(TAG_AICLK, 900);
+	zassert_true(telemetry_stats_get(TAG_AICLK, &stats, false));
+	zassert_equal(stats.min, 900);
+	zassert_equal(stats.max, 900);
+}
+
+ZTEST(telemetry_stats, test_untracked_tag)
+{
+	struct telemetry_stats stats;
+
+	zassert_false(telemetry_stats_record(TAG_BOARD_ID_HIGH, 1));
+	zassert_false(telemetry_stats_get(TAG_BOARD_ID_HIGH, &stats, false));
+}
+
+ZTEST(telemetry_stats, test_sample)
+{
+	TelemetryInternalData data = {
+		.vcore_voltage = 800.0f,
+		.vcore_power = 100.0f,
+		.vcore_current = 125.0f,
+	};
+	struct telemetry_stats stats;
+
+	telemetry_stats_sample(&data);
+	data.vcore_power = 200.0f;
+	telemetry_stats_sample(&data);
+
+	zassert_true(telemetry_stats_get(TAG_TDP, &stats, false));
+	zassert_equal(stats.count, 2);
+	zassert_equal(stats.min, 100);
+	zassert_equal(stats.max, 200);
+	zassert_true(telemetry_stats_get(TAG_VCORE, &stats, false));
+	zassert_equal(telemetry_stats_mean(&stats), 800);
+}
+
+ZTEST(telemetry_stats, test_msg)
+{
+	union request req = {0};
+	struct response rsp = {0};
+
+	telemetry_stats_record(TAG_TDC, 40);
+	telemetry_stats_record(TAG_TDC, 60);
+	k_msleep(10);
+
+	req.telemetry_stats.command_code = TT_SMC_MSG_GET_TELEMETRY_STATS;
+	req.telemetry_stats.tag = TAG_TDC;
+	req.telemetry_stats.flags = TELEMETRY_STATS_FLAG_RESET;
+	send_msg(&req, &rsp);
+
+	zassert_equal(rsp.data[0], 0);
+	zassert_equal(rsp.data[1], 40);
+	zassert_equal(rsp.data[2], 60);
+	zassert_equal(rsp.data[3], 50);
+	zassert_equal(rsp.data[4], 2);
+	zassert_true(rsp.data[5] >= 10);
+
+	send_msg(&req, &rsp);
+	zassert_equal(rsp.data[4], 0);
+
+	req.telemetry_stats.tag = TAG_BOARD_ID_HIGH;
+	send_msg(&req, &rsp);
+	zassert_not_equal(rsp.data[0], 0);
+}
+
+/*
+ * Cycle counts don't advance during computation on native_sim, so bound the work of a control
+ * loop update instead: one record per tracked tag and nothing else.
+ */
+ZTEST(telemetry_stats, test_update_work)
+{
+	static const uint16_t tags[] = {
+		TAG_VCORE, TAG_TDP, TAG_TDC, TAG_ASIC_TEMPERATURE, TAG_AICLK, TAG_INPUT_POWER,
+	};
+	TelemetryInternalData data = {.vcore_power = 100.0f};
+	struct telemetry_stats stats;
+
+	for (int i = 0; i < UPDATE_SAMPLES; i++) {
+		telemetry_stats_sample(&data);
+	}
+
+	for (int i = 0; i < ARRAY_SIZE(tags); i++) {
+		zassert_true(telemetry_stats_get(tags[i], &stats, false));
+		zassert_equal(stats.count, UPDATE_SAMPLES, "tag %u", tags[i]);
+	}
+	zassert_true(telemetry_stats_get(TAG_TDP, &stats, false));
+	zassert_equal(stats.sum, 100LL * UPDATE_SAMPLES);
+}
+
+static void telemetry_stats_before(void *fixture)
+{
+	telemetry_stats_reset();
+}
+
+ZTEST_SUITE(telemetry_stats, NULL, NULL, telemetry_stats_before, NULL, NULL);
@@ -0,0 +1,502 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <math.h>
+
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include "aiclk_ppm.h"
+#include "throttler.h"
+
+/*
+ * Closed-loop simulation of the throttlers against a plant model of the chip. Every 1 ms step
+ * runs the first half of DVFSChange (UpdateThrottlers and CalculateTargAiclk) on the previous
+ * step's measurements, then advances the plant at the new AICLK. The second half of DVFSChange
+ * only programs the PLL and regulator, which the plant treats as instantaneous.
+ */
+
+#define SIM_MAX_MS 8000
+
+struct plant_params {
+	float ambient;        /* degC */
+	float r_th;           /* degC/W, junction to ambient */
+	float tau_ms;         /* thermal time constant */
+	float c_dyn;          /* W/(V^2 MHz) at full activity */
+	float leak_25;        /* W of leakage at 25 degC and 0.8 V */
+	float leak_coeff;     /* 1/degC, exponential leakage increase with temperature */
+	float vr_efficiency;  /* Vcore regulator efficiency */
+	float board_overhead; /* W, input power not drawn through Vcore */
+	float gddr_temperature;
+};
+
+struct plant {
+	const struct plant_params *p;
+	float temperature;
+	float power;
+	float current;
+	float input_power;
+};
+
+/* Which plant output a trace is judged on */
+enum sim_watch {
+	WatchPower,
+	WatchCurrent,
+	WatchTemperature,
+	WatchInputPower,
+};
+
+struct sim_trace {
+	const char *name;
+	const struct plant_params *plant;
+	float (*activity)(uint32_t ms);
+	uint32_t duration_ms;
+	uint32_t step_ms; /* when the workload steps up, metrics are taken from here */
+	ThrottlerId throttler;
+	enum sim_watch watch;
+};
+
+struct sim_metrics {
+	float overshoot;   /* % of the limit, worst excursion above it */
+	float settling_ms; /* until the watched value stays near its final value */
+	float lost_mhz;    /* mean AICLK below the best frequency that respects all limits */
+};
+
+/* The plant models a card with an 1 s thermal time constant at ~300 W full load */
+static const struct plant_params card = {
+	.ambient = 35.0f,
+	.r_th = 0.15f,
+	.tau_ms = 1000.0f,
+	.c_dyn = 0.22f,
+	.leak_25 = 15.0f,
+	.leak_coeff = 0.02f,
+	.vr_efficiency = 0.9f,
+	.board_overhead = 40.0f,
+	.gddr_temperature = 60.0f,
+};
+
+static const struct plant_params fast_thermal_card = {
+	.ambient = 35.0f,
+	.r_th = 0.15f,
+	.tau_ms = 500.0f,
+	.c_dyn = 0.22f,
+	.leak_25 = 15.0f,
+	.leak_coeff = 0.02f,
+	.vr_efficiency = 0.9f,
+	.board_overhead = 40.0f,
+	.gddr_temperature = 60.0f,
+};
+
+static float aiclk_fmin;
+static float aiclk_fmax;
+static float watched[SIM_MAX_MS];
+
+static const ThrottlerId sim_throttlers[] = {
+	kThrottlerTDP, kThrottlerFastTDC,    kThrottlerTDC,
+	kThrottlerThm, kThrottlerBoardPower, kThrottlerGDDRThm,
+};
+
+static const enum aiclk_arb_max sim_arbs[] = {
+	aiclk_arb_max_tdp, aiclk_arb_max_fast_tdc,    aiclk_arb_max_tdc,
+	aiclk_arb_max_thm, aiclk_arb_max_board_power, aiclk_arb_max_gddr_thm,
+};
+
+static ThrottlerParams default_params[kThrottlerCount];
+static float default_limits[kThrottlerCount];
+
+/* The arbiters as the suite found them, sim_reset takes over all of them */
+static float saved_arb_max[aiclk_arb_max_count];
+static uint32_t saved_arb_max_mask;
+static uint32_t saved_arb_min_mask;
+
+static float ramp(uint32_t ms, uint32_t start, uint32_t len, float from, float to)
+{
+	if (ms < start) {
+		return from;
+	} else if (ms >= start + len) {
+		return to;
+	}
+	return from + (to - from) * (ms - start) / len;
+}
+
+/* Kernels launching across the grid: 20% to 100% activity over 50 ms */
+static float activity_step(uint32_t ms)
+{
+	return ramp(ms, 100, 50, 0.2f, 1.0f);
+}
+
+/* 100 ms bursts of full activity with 10 ms edges */
+static float activity_burst(uint32_t ms)
+{
+	uint32_t phase = ms % 200;
+
+	return phase < 100 ? ramp(phase, 0, 10, 0.3f, 1.0f) : ramp(phase, 100, 10, 1.0f, 0.3f);
+}
+
+/* A sustained 80% load that heats the chip up */
+static float activity_soak(uint32_t ms)
+{
+	return ramp(ms, 100, 50, 0.2f, 0.8f);
+}
+
+/* Linear approximation of the VF curve, in V */
+static float plant_voltage(float freq)
+{
+	return 0.7f + 0.2f * (freq - aiclk_fmin) / (aiclk_fmax - aiclk_fmin);
+}
+
+static float plant_power(const struct plant_params *p, float freq, float activity, float temp)
+{
+	float v = plant_voltage(freq);
+	float dynamic = p->c_dyn * v * v * freq * activity;
+	float leakage = p->leak_25 * (v / 0.8f) * expf(p->leak_coeff * (temp - 25.0f));
+
+	return dynamic + leakage;
+}
+
+/* Temperature the chip settles at for a fixed frequency and activity */
+static float plant_steady_temperature(const struct plant_params *p, float freq, float activity)
+{
+	float temp = p->ambient;
+
+	for (int i = 0; i < 50; i++) {
+		temp = p->ambient + p->r_th * plant_power(p, freq, activity, temp);
+	}
+	return temp;
+}
+
+static void plant_step(struct plant *s, float freq, float activity)
+{
+	const struct plant_params *p = s->p;
+
+	s->power = plant_power(p, freq, activity, s->temperature);
+	s->current = s->power / plant_voltage(freq);
+	s->input_power = s->power / p->vr_efficiency + p->board_overhead;
+	s->temperature += (p->ambient + p->r_th * s->power - s->temperature) / p->tau_ms;
+}
+
+static bool plant_within_limits(const struct plant *s, float freq, float activity)
+{
+	float power = plant_power(s->p, freq, activity, s->temperature);
+	float current = power / plant_voltage(freq);
+
+	return power <= GetThrottlerLimit(kThrottlerTDP) &&
+	       current <= GetThrottlerLimit(kThrottlerFastTDC) &&
+	       current <= GetThrottlerLimit(kThrottlerTDC) &&
+	       power / s->p->vr_efficiency + s->p->board_overhead <=
+		       GetThrottlerLimit(kThrottlerBoardPower) &&
+	       plant_steady_temperature(s->p, freq, activity) <= GetThrottlerLimit(kThrottlerThm);
+}
+
+/* The highest AICLK that an oracle would run at in the current plant state */
+static float ideal_aiclk(const struct plant *s, float activity)
+{
+	float lo = aiclk_fmin;
+	float hi = aiclk_fmax;
+
+	if (plant_within_limits(s, aiclk_fmax, activity)) {
+		return aiclk_fmax;
+	}
+
+	for (int i = 0; i < 16; i++) {
+		float mid = (lo + hi) / 2;
+
+		if (plant_within_limits(s, mid, activity)) {
+			lo = mid;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+static float plant_watched(const struct plant *s, enum sim_watch watch)
+{
+	switch (watch) {
+	case WatchPower:
+		return s->power;
+	case WatchCurrent:
+		return s->current;
+	case WatchTemperature:
+		return s->temperature;
+	default:
+		return s->input_power;
+	}
+}
+
+static void sim_reset(void)
+{
+	ResetThrottlers();
+
+	for (int i = 0; i < aiclk_arb_max_count; i++) {
+		SetAiclkArbMax(i, aiclk_fmax);
+		EnableArbMax(i, false);
+	}
+	for (int i = 0; i < ARRAY_SIZE(sim_arbs); i++) {
+		EnableArbMax(sim_arbs[i], true);
+	}
+
+	EnableArbMin(aiclk_arb_min_fmin, false);
+	SetAiclkArbMin(aiclk_arb_min_busy, aiclk_fmax);
+	EnableArbMin(aiclk_arb_min_busy, true);
+}
+
+static struct sim_metrics sim_run(const struct sim_trace *trace)
+{
+	struct plant s = {.p = trace->plant, .temperature = trace->plant->ambient};
+	struct sim_metrics m = {0};
+	float limit = GetThrottlerLimit(trace->throttler);
+	float lost = 0;
+
+	__ASSERT_NO_MSG(trace->duration_ms <= SIM_MAX_MS);
+
+	sim_reset();
+	plant_step(&s, aiclk_fmax, trace->activity(0));
+
+	for (uint32_t ms = 0; ms < trace->duration_ms; ms++) {
+		float activity = trace->activity(ms);
+		ThrottlerInputs inputs = {
+			.vcore_power = s.power,
+			.vcore_current = s.current,
+			.asic_temperature = s.temperature,
+			.input_power = s.input_power,
+			.gddr_temperature = s.p->gddr_temperature,
+		};
+
+		UpdateThrottlers(&inputs);
+		CalculateTargAiclk();
+
+		float aiclk = GetAiclkTarg();
+
+		lost += MAX(0.0f, ideal_aiclk(&s, activity) - aiclk);
+		plant_step(&s, aiclk, activity);
+
+		watched[ms] = plant_watched(&s, trace->watch);
+		if (ms >= trace->step_ms) {
+			m.overshoot = MAX(m.overshoot, (watched[ms] - limit) / limit * 100.0f);
+		}
+	}
+
+	/* Settled once the watched value stays within 2% of the limit of its final value */
+	uint32_t tail = trace->duration_ms / 10;
+	float final = 0;
+
+	for (uint32_t ms = trace->duration_ms - tail; ms < trace->duration_ms; ms++) {
+		final += watched[ms];
+	}
+	final /= tail;
+
+	uint32_t settled = trace->step_ms;
+
+	for (uint32_t ms = trace->duration_ms; ms-- > trace->step_ms;) {
+		if (fabsf(watched[ms] - final) > 0.02f * limit) {
+			settled = ms + 1;
+			break;
+		}
+	}
+
+	m.settling_ms = settled - trace->step_ms;
+	m.lost_mhz = lost / trace->duration_ms;
+
+	return m;
+}
+
+static float sim_cost(const struct sim_metrics *m)
+{
+	return m->lost_mhz + 10.0f * m->overshoot + 0.05f * m->settling_ms;
+}
+
+static void sim_print(const char *what, const struct sim_trace *trace,
+		      const struct sim_metrics *m)
+{
+	TC_PRINT("%s %s: overshoot %d.%02d%%, settling %d ms, lost %d MHz\n", what, trace->name,
+		 (int)m->overshoot, (int)(m->overshoot * 100) % 100, (int)m->settling_ms,
+		 (int)m->lost_mhz);
+}
+
+/*
+ * Grid search over the gains of one throttler around the current ones. The gains are left at
+ * the best point found, which is returned through best.
+ */
+static struct sim_metrics sim_tune(const struct sim_trace *trace, ThrottlerParams *best)
+{
+	static const float p_scale[] = {0.25f, 0.5f, 1.0f, 2.0f, 4.0f};
+	static const float d_scale[] = {0.0f, 0.5f, 1.0f, 2.0f};
+	ThrottlerParams base;
+	struct sim_metrics best_metrics;
+	float best_cost = INFINITY;
+
+	GetThrottlerParams(trace->throttler, &base);
+
+	for (int i = 0; i < ARRAY_SIZE(p_scale); i++) {
+		for (int j = 0; j < ARRAY_SIZE(d_scale); j++) {
+			ThrottlerParams params = base;
+
+			params.p_gain = base.p_gain * p_scale[i];
+			/* Also try some D action on throttlers that have none */
+			params.d_gain = base.d_gain > 0 ? base.d_gain * d_scale[j]
+							: 0.05f * d_scale[j];
+			SetThrottlerParams(trace->throttler, &params);
+
+			struct sim_metrics m = sim_run(trace);
+			float cost = sim_cost(&m);
+
+			if (cost < best_cost) {
+				best_cost = cost;
+				best_metrics = m;
+				*best = params;
+			}
+		}
+	}
+
+	SetThrottlerParams(trace->throttler, best);
+	return best_metrics;
+}
+
+static const struct sim_trace tdp_step = {
+	.name = "TDP step",
+	.plant = &card,
+	.activity = activity_step,
+	.duration_ms = 2000,
+	.step_ms = 100,
+	.throttler = kThrottlerTDP,
+	.watch = WatchPower,
+};
+
+static const struct sim_trace tdp_burst = {
+	.name = "TDP burst",
+	.plant = &card,
+	.activity = activity_burst,
+	.duration_ms = 2000,
+	.step_ms = 0,
+	.throttler = kThrottlerTDP,
+	.watch = WatchPower,
+};
+
+static const struct sim_trace thm_soak = {
+	.name = "thermal soak",
+	.plant = &fast_thermal_card,
+	.activity = activity_soak,
+	.duration_ms = 4000,
+	.step_ms = 100,
+	.throttler = kThrottlerThm,
+	.watch = WatchTemperature,
+};
+
+/*
+ * Regression bounds for the default gains. A gain change that makes any of these worse should
+ * come with a reason; one that improves them should tighten the bounds. The default gains give
+ * 30.3% overshoot on the TDP step and 35.7% on the TDP bursts.
+ */
+ZTEST(throttler_sim, test_tdp_step)
+{
+	struct sim_metrics m = sim_run(&tdp_step);
+
+	sim_print("default", &tdp_step, &m);
+	zassert_true(m.overshoot < 32.0f);
+	zassert_true(m.settling_ms < 500.0f);
+	zassert_true(m.lost_mhz < 5.0f);
+}
+
+ZTEST(throttler_sim, test_tdp_burst)
+{
+	struct sim_metrics m = sim_run(&tdp_burst);
+
+	sim_print("default", &tdp_burst, &m);
+	zassert_true(m.overshoot < 38.0f);
+	zassert_true(m.lost_mhz < 25.0f);
+}
+
+ZTEST(throttler_sim, test_thermal_soak)
+{
+	/* Only the thermal throttler should act */
+	SetThrottlerLimit(kThrottlerTDP, 500);
+	SetThrottlerLimit(kThrottlerThm, 70);
+
+	struct sim_metrics m = sim_run(&thm_soak);
+
+	sim_print("default", &thm_soak, &m);
+	zassert_true(m.overshoot < 2.0f);
+	zassert_true(m.settling_ms < 2000.0f);
+	zassert_true(m.lost_mhz < 5.0f);
+}
+
+ZTEST(throttler_sim, test_tune)
+{
+	ThrottlerParams best;
+	struct sim_metrics before = sim_run(&tdp_step);
+	struct sim_metrics after = sim_tune(&tdp_step, &best);
+
+	sim_print("default", &tdp_step, &before);
+	sim_print("tuned", &tdp_step, &after);
+	TC_PRINT("tuned TDP gains: p %d.%04d, d %d.%03d\n", (int)best.p_gain,
+		 (int)(best.p_gain * 10000) % 10000, (int)best.d_gain,
+		 (int)(best.d_gain * 1000) % 1000);
+
+	zassert_true(sim_cost(&after) <= sim_cost(&before));
+
+	/* The tuned gains must not give up the other trace */
+	struct sim_metrics burst = sim_run(&tdp_burst);
+
+	sim_print("tuned", &tdp_burst, &burst);
+	zassert_true(burst.lost_mhz < 25.0f);
+}
+
+static void *throttler_sim_setup(void)
+{
+	aiclk_fmin = GetAiclkFmin();
+	aiclk_fmax = GetAiclkFmax();
+
+	for (int i = 0; i < ARRAY_SIZE(sim_throttlers); i++) {
+		GetThrottlerParams(sim_throttlers[i], &default_params[sim_throttlers[i]]);
+		default_limits[sim_throttlers[i]] = GetThrottlerLimit(sim_throttlers[i]);
+	}
+
+	for (int i = 0; i < aiclk_arb_max_count; i++) {
+		saved_arb_max[i] = GetThrottlerArbMax(i);
+	}
+	saved_arb_max_mask = get_enabled_arb_max_bitmask();
+	saved_arb_min_mask = get_enabled_arb_min_bitmask();
+
+	return NULL;
+}
+
+static void throttler_sim_before(void *fixture)
+{
+	SetThrottlerLimit(kThrottlerTDP, 200);
+	SetThrottlerLimit(kThrottlerFastTDC, 320);
+	SetThrottlerLimit(kThrottlerTDC, 280);
+	SetThrottlerLimit(kThrottlerThm, 90);
+	SetThrottlerLimit(kThrottlerBoardPower, 300);
+	SetThrottlerLimit(kThrottlerGDDRThm, 85);
+}
+
+static void throttler_sim_after(void *fixture)
+{
+	for (int i = 0; i < ARRAY_SIZE(sim_throttlers); i++) {
+		ThrottlerId id = sim_throttlers[i];
+
+		SetThrottlerParams(id, &default_params[id]);
+		if (default_limits[id] > 0) {
+			SetThrottlerLimit(id, default_limits[id]);
+		}
+	}
+
+	for (int i = 0; i < aiclk_arb_max_count; i++) {
+		SetAiclkArbMax(i, saved_arb_max[i]);
+		EnableArbMax(i, saved_arb_max_mask & BIT(i));
+	}
+	for (int i = 0; i < aiclk_arb_min_count; i++) {
+		EnableArbMin(i, saved_arb_min_mask & BIT(i));
+	}
+	/* The busy arbiter follows the busy state, not a saved value */
+	aiclk_update_busy();
+
+	ResetThrottlers();
+}
+
+ZTEST_SUITE(throttler_sim, NULL, throttler_sim_setup, throttler_sim_before, throttler_sim_after,
+	    NULL);
@@ -0,0 +1,304 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include <tenstorrent/msgqueue.h>
+#include <tenstorrent/smc_msg.h>
+
+#include "aiclk_ppm.h"
+#include "telemetry.h"
+#include "throttler.h"
+
+static const enum aiclk_arb_max arbs[kThrottlerCount] = {
+	[kThrottlerTDP] = aiclk_arb_max_tdp,
+	[kThrottlerFastTDC] = aiclk_arb_max_fast_tdc,
+	[kThrottlerTDC] = aiclk_arb_max_tdc,
+	[kThrottlerThm] = aiclk_arb_max_thm,
+	[kThrottlerBoardPower] = aiclk_arb_max_board_power,
+	[kThrottlerGDDRThm] = aiclk_arb_max_gddr_thm,
+	[kThrottlerDopplerSlow] = aiclk_arb_max_doppler_slow,
+};
+
+static ThrottlerParams default_params[kThrottlerCount];
+static float default_limits[kThrottlerCount];
+static uint32_t default_enabled;
+static float arb_start;
+
+/* Inputs that keep every throttler but TDP well below its limit */
+static ThrottlerInputs tdp_inputs(float vcore_power)
+{
+	return (ThrottlerInputs){
+		.vcore_power = vcore_power,
+		.vcore_current = 100,
+		.asic_temperature = 50,
+		.input_power = 100,
+		.gddr_temperature = 50,
+	};
+}
+
+static uint32_t send_params(ThrottlerId id, uint8_t flags, uint32_t limit,
+			    const ThrottlerParams *params, struct response *rsp)
+{
+	union request req = {0};
+
+	req.throttler_params.command_code = TT_SMC_MSG_SET_THROTTLER_PARAMS;
+	req.throttler_params.throttler = id;
+	req.throttler_params.flags = flags;
+	req.throttler_params.limit = limit;
+	if (params != NULL) {
+		req.throttler_params.alpha_filter = ConvertFloatToTelemetry(params->alpha_filter);
+		req.throttler_params.p_gain = ConvertFloatToTelemetry(params->p_gain);
+		req.throttler_params.d_gain = ConvertFloatToTelemetry(params->d_gain);
+	}
+
+	*rsp = (struct response){0};
+	msgqueue_request_push(0, &req);
+	process_message_queues();
+	msgqueue_response_pop(0, rsp);
+
+	return rsp->data[0];
+}
+
+static bool arb_enabled(ThrottlerId id)
+{
+	return get_enabled_arb_max_bitmask() & BIT(arbs[id]);
+}
+
+static void assert_params(ThrottlerId id, const ThrottlerParams *expected)
+{
+	ThrottlerParams params;
+
+	GetThrottlerParams(id, &params);
+	zassert_within(params.alpha_filter, expected->alpha_filter, 0.0001);
+	zassert_within(params.p_gain, expected->p_gain, 0.0001);
+	zassert_within(params.d_gain, expected->d_gain, 0.0001);
+}
+
+ZTEST(throttler_params, test_next_tick)
+{
+	const ThrottlerParams params = {.alpha_filter = 1, .p_gain = 0.1, .d_gain = 0};
+	ThrottlerInputs inputs = tdp_inputs(300);
+	struct response rsp;
+
+	/* The built-in gains: error -0.5, output 0.015 * -0.5 + 0.1 * -0.5 */
+	UpdateThrottlers(&inputs);
+	zassert_within(GetThrottlerArbMax(aiclk_arb_max_tdp), arb_start - 28.75, 0.01);
+
+	zassert_equal(send_params(kThrottlerTDP, THROTTLER_PARAMS_FLAG_ENABLE, 100, &params, &rsp),
+		      0);
+	zassert_equal(rsp.data[1], 100);
+	zassert_equal(rsp.data[5], 1);
+	zassert_within(GetThrottlerLimit(kThrottlerTDP), 100, 0.0001);
+	assert_params(kThrottlerTDP, &params);
+
+	/* The next tick uses the new limit and gains: error -0.5 again, so no derivative term */
+	float arb = GetThrottlerArbMax(aiclk_arb_max_tdp);
+
+	inputs = tdp_inputs(150);
+	UpdateThrottlers(&inputs);
+	zassert_within(GetThrottlerArbMax(aiclk_arb_max_tdp), arb - 25, 0.01);
+}
+
+ZTEST(throttler_params, test_invalid)
+{
+	const ThrottlerParams valid = {.alpha_filter = 0.5, .p_gain = 0.1, .d_gain = 0.1};
+	const ThrottlerParams invalid[] = {
+		{.alpha_filter = 0, .p_gain = 0.1, .d_gain = 0.1},
+		{.alpha_filter = 1.5, .p_gain = 0.1, .d_gain = 0.1},
+		{.alpha_filter = 0.5, .p_gain = -0.1, .d_gain = 0.1},
+		{.alpha_filter = 0.5, .p_gain = 0.1, .d_gain = 3},
+	};
+	struct response rsp;
+
+	for (int i = 0; i < ARRAY_SIZE(invalid); i++) {
+		zassert_not_equal(send_params(kThrottlerThm, 0, 80, &invalid[i], &rsp), 0);
+	}
+
+	/* Limits outside of the supported range are rejected rather than clamped */
+	zassert_not_equal(send_params(kThrottlerThm, 0, 120, &valid, &rsp), 0);
+	zassert_not_equal(send_params(kThrottlerThm, 0, 10, &valid, &rsp), 0);
+
+	zassert_not_equal(send_params(kThrottlerCount, 0, 80, &valid, &rsp), 0);
+	zassert_not_equal(send_params(kThrottlerThm,
+				      THROTTLER_PARAMS_FLAG_ENABLE | THROTTLER_PARAMS_FLAG_DISABLE,
+				      80, &valid, &rsp),
+			  0);
+
+	/* Nothing to roll back */
+	zassert_not_equal(send_params(kThrottlerThm, THROTTLER_PARAMS_FLAG_ROLLBACK, 0, NULL, &rsp),
+			  0);
+
+	assert_params(kThrottlerThm, &default_params[kThrottlerThm]);
+	zassert_within(GetThrottlerLimit(kThrottlerThm), 90, 0.0001);
+	zassert_true(arb_enabled(kThrottlerThm));
+}
+
+ZTEST(throttler_params, test_rollback)
+{
+	const ThrottlerParams first = {.alpha_filter = 0.5, .p_gain = 0.3, .d_gain = 0};
+	const ThrottlerParams second = {.alpha_filter = 1, .p_gain = 0.05, .d_gain = 0.2};
+	struct response rsp;
+
+	zassert_equal(send_params(kThrottlerThm, 0, 80, &first, &rsp), 0);
+	/* A limit of 0 keeps the limit */
+	zassert_equal(send_params(kThrottlerThm, THROTTLER_PARAMS_FLAG_DISABLE, 0, &second, &rsp),
+		      0);
+	zassert_within(GetThrottlerLimit(kThrottlerThm), 80, 0.0001);
+	zassert_false(arb_enabled(kThrottlerThm));
+
+	zassert_equal(send_params(kThrottlerThm, THROTTLER_PARAMS_FLAG_ROLLBACK, 0, NULL, &rsp),
+		      0);
+	assert_params(kThrottlerThm, &first);
+	zassert_within(GetThrottlerLimit(kThrottlerThm), 80, 0.0001);
+	zassert_true(arb_enabled(kThrottlerThm));
+	zassert_equal(rsp.data[1], 80);
+	zassert_equal(rsp.data[3], ConvertFloatToTelemetry(first.p_gain));
+	zassert_equal(rsp.data[5], 1);
+
+	/* Only the last update is saved */
+	zassert_not_equal(send_params(kThrottlerThm, THROTTLER_PARAMS_FLAG_ROLLBACK, 0, NULL, &rsp),
+			  0);
+	assert_params(kThrottlerThm, &first);
+}
+
+ZTEST(throttler_params, test_query)
+{
+	const ThrottlerParams *params = &default_params[kThrottlerTDC];
+	struct response rsp;
+
+	zassert_equal(send_params(kThrottlerTDC, THROTTLER_PARAMS_FLAG_QUERY, 0, NULL, &rsp), 0);
+	zassert_equal(rsp.data[1], 280);
+	zassert_equal(rsp.data[2], ConvertFloatToTelemetry(params->alpha_filter));
+	zassert_equal(rsp.data[3], ConvertFloatToTelemetry(params->p_gain));
+	zassert_equal(rsp.data[4], ConvertFloatToTelemetry(params->d_gain));
+	zassert_equal(rsp.data[5], arb_enabled(kThrottlerTDC));
+
+	/* A query isn't an update, so there is nothing to roll back */
+	zassert_not_equal(send_params(kThrottlerTDC, THROTTLER_PARAMS_FLAG_ROLLBACK, 0, NULL, &rsp),
+			  0);
+}
+
+ZTEST(throttler_params, test_fwtable)
+{
+	FwTable_ThrottlerTable table = {
+		.enable_mask = BIT(kThrottlerTDP) | BIT(kThrottlerThm),
+		.enable_mask_en = true,
+		.thm = {
+			.params_en = true,
+			.alpha_filter = 0.5,
+			.p_gain = 0.3,
+			.d_gain = 0.1,
+			.limit = 80,
+		},
+		/* Invalid gains are ignored, the limit still applies */
+		.tdc = {
+			.params_en = true,
+			.alpha_filter = 2,
+			.limit = 150,
+		},
+		/* Without params_en nothing is applied */
+		.gddr_thm = {
+			.alpha_filter = 0.5,
+			.limit = 60,
+		},
+	};
+	const ThrottlerParams thm = {.alpha_filter = 0.5, .p_gain = 0.3, .d_gain = 0.1};
+
+	LoadThrottlerTable(&table);
+
+	assert_params(kThrottlerThm, &thm);
+	zassert_within(GetThrottlerLimit(kThrottlerThm), 80, 0.0001);
+	assert_params(kThrottlerTDC, &default_params[kThrottlerTDC]);
+	zassert_within(GetThrottlerLimit(kThrottlerTDC), 150, 0.0001);
+	assert_params(kThrottlerGDDRThm, &default_params[kThrottlerGDDRThm]);
+	zassert_within(GetThrottlerLimit(kThrottlerGDDRThm), 85, 0.0001);
+
+	for (ThrottlerId i = 0; i < kThrottlerCount; i++) {
+		zassert_equal(arb_enabled(i), i == kThrottlerTDP || i == kThrottlerThm);
+	}
+}
+
+ZTEST(throttler_params, test_fwtable_doppler)
+{
+	FwTable_ThrottlerTable table = {
+		.enable_mask = BIT_MASK(kThrottlerCount),
+		.enable_mask_en = true,
+	};
+
+	/* A table loaded after Doppler can't turn the throttlers Doppler replaces back on */
+	EnableDoppler(true);
+	LoadThrottlerTable(&table);
+	zassert_false(arb_enabled(kThrottlerTDP));
+	zassert_false(arb_enabled(kThrottlerBoardPower));
+	zassert_true(arb_enabled(kThrottlerDopplerSlow));
+
+	/* A throttler disabled by the table stays disabled when Doppler is switched */
+	table.enable_mask &= ~BIT(kThrottlerTDP);
+	LoadThrottlerTable(&table);
+	EnableDoppler(false);
+	zassert_false(arb_enabled(kThrottlerTDP));
+	zassert_true(arb_enabled(kThrottlerBoardPower));
+	zassert_false(arb_enabled(kThrottlerDopplerSlow));
+}
+
+static void *throttler_params_setup(void)
+{
+	for (ThrottlerId i = 0; i < kThrottlerCount; i++) {
+		GetThrottlerParams(i, &default_params[i]);
+		default_limits[i] = GetThrottlerLimit(i);
+	}
+	default_enabled = get_enabled_arb_max_bitmask();
+	arb_start = (GetAiclkFmin() + GetAiclkFmax()) / 2;
+
+	return NULL;
+}
+
+static void throttler_params_before(void *fixture)
+{
+	SetThrottlerLimit(kThrottlerTDP, 200);
+	SetThrottlerLimit(kThrottlerFastTDC, 320);
+	SetThrottlerLimit(kThrottlerTDC, 280);
+	SetThrottlerLimit(kThrottlerThm, 90);
+	SetThrottlerLimit(kThrottlerBoardPower, 300);
+	SetThrottlerLimit(kThrottlerGDDRThm, 85);
+
+	for (ThrottlerId i = 0; i < kThrottlerCount; i++) {
+		EnableArbMax(arbs[i], true);
+		SetAiclkArbMax(arbs[i], arb_start);
+	}
+	ResetThrottlers();
+}
+
+static void throttler_params_after(void *fixture)
+{
+	const FwTable_ThrottlerTable all_enabled = {
+		.enable_mask = BIT_MASK(kThrottlerCount),
+		.enable_mask_en = true,
+	};
+	struct response rsp;
+
+	/* The enable mask outlives the test, the arbiters are restored below */
+	LoadThrottlerTable(&all_enabled);
+
+	for (ThrottlerId i = 0; i < kThrottlerCount; i++) {
+		/* Drop any saved update, so that the next test can't roll back into this one */
+		send_params(i, THROTTLER_PARAMS_FLAG_ROLLBACK, 0, NULL, &rsp);
+
+		SetThrottlerParams(i, &default_params[i]);
+		if (default_limits[i] > 0) {
+			SetThrottlerLimit(i, default_limits[i]);
+		}
+		EnableArbMax(arbs[i], default_enabled & BIT(arbs[i]));
+		SetAiclkArbMax(arbs[i], GetAiclkFmax());
+	}
+
+	ResetThrottlers();
+}
+
+ZTEST_SUITE(throttler_params, NULL, throttler_params_setup, throttler_params_before,
+	    throttler_params_after, NULL);
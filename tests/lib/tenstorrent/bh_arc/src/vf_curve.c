@@ -7,8 +7,21 @@
 #include <zephyr/ztest.h>
 #include <tenstorrent/smc_msg.h>
 #include <tenstorrent/msgqueue.h>
+#include <math.h>
 #include <stdlib.h>
 
+#include "vf_curve.h"
+
+#define VF_FMIN_MHZ       200
+#define VF_FMAX_MHZ       1400
+#define VF_TABLE_ENTRIES  77
+#define VF_TABLE_STEP_MHZ 16
+
+extern uint32_t vf_model_evals;
+
+/* PROCESS_RO of a slow and a fast part, 0 selects the legacy curve */
+static const uint32_t process_ros[] = {0, 2400, 2700};
+
 ZTEST(vf_curve, test_get_freq_curve_from_voltage_handler)
 {
 	union request req = {0};
@@ -79,4 +92,128 @@ ZTEST(vf_curve, test_voltage_frequency_roundtrip)
 	zassert_true(abs(freq_diff) < 50, "Roundtrip frequency error too large: %d", freq_diff);
 }
 
-ZTEST_SUITE(vf_curve, NULL, NULL, NULL, NULL, NULL);
+/* The table is interpolated in fixed point and rounded up, so it never asks for less voltage than
+ * the model and at most 1 mV (rounding) plus the interpolation error more.
+ */
+static void assert_table_matches_model(void)
+{
+	for (uint32_t freq = VF_FMIN_MHZ; freq <= VF_FMAX_MHZ; freq++) {
+		float model = VFCurveModel(freq);
+		uint32_t voltage = VFCurve(freq);
+
+		zassert_true(voltage >= model - 0.001F, "%u MHz: %u mV below model", freq, voltage);
+		zassert_true(voltage < model + 1.05F, "%u MHz: %u mV above model", freq, voltage);
+	}
+}
+
+ZTEST(vf_curve, test_table_matches_model)
+{
+	const float margins[][2] = {{300, 150}, {0, 0}, {-300, -150}, {120, 30}};
+
+	for (int i = 0; i < ARRAY_SIZE(process_ros); i++) {
+		SetVFCurveProcess(process_ros[i]);
+
+		for (int j = 0; j < ARRAY_SIZE(margins); j++) {
+			SetVFCurveMargins(margins[j][0], margins[j][1]);
+			assert_table_matches_model();
+		}
+	}
+}
+
+ZTEST(vf_curve, test_ff_margin_step)
+{
+	SetVFCurveProcess(2700);
+
+	/* FF parts get 20 mV more margin from 1200 MHz, which must not be interpolated */
+	zassert_true(VFCurve(1200) >= VFCurve(1199) + 20);
+	zassert_true(VFCurve(1199) < VFCurveModel(1199) + 1.05F);
+}
+
+ZTEST(vf_curve, test_margin_change)
+{
+	uint32_t voltage = VFCurve(1000);
+
+	SetVFCurveMargins(300, 100);
+	zassert_within(VFCurve(1000), voltage - 50, 1);
+}
+
+ZTEST(vf_curve, test_outside_table)
+{
+	/* e.g. GetMaxAiclkForVoltage searches up to fmax + 1 */
+	zassert_equal(VFCurve(VF_FMAX_MHZ + 1), (uint32_t)ceilf(VFCurveModel(VF_FMAX_MHZ + 1)));
+	zassert_equal(VFCurve(VF_FMIN_MHZ - 1), (uint32_t)ceilf(VFCurveModel(VF_FMIN_MHZ - 1)));
+}
+
+static void get_vf_table(uint32_t first_entry, struct response *rsp)
+{
+	union request req = {0};
+
+	req.vf_table.command_code = TT_SMC_MSG_GET_VF_TABLE;
+	req.vf_table.first_entry = first_entry;
+	msgqueue_request_push(0, &req);
+	process_message_queues();
+	msgqueue_response_pop(0, rsp);
+}
+
+ZTEST(vf_curve, test_get_vf_table_handler)
+{
+	struct response rsp = {0};
+
+	SetVFCurveProcess(2700);
+
+	get_vf_table(0, &rsp);
+	zassert_equal(rsp.data[0], 0);
+	zassert_equal(rsp.data[1], VF_TABLE_ENTRIES);
+	zassert_equal(rsp.data[2], VF_FMIN_MHZ);
+	zassert_equal(rsp.data[3], VF_TABLE_STEP_MHZ);
+	for (int i = 0; i < 4; i++) {
+		float freq = VF_FMIN_MHZ + i * VF_TABLE_STEP_MHZ;
+
+		zassert_within(rsp.data[4 + i] / 65536.0F, VFCurveModel(freq), 0.01F);
+	}
+
+	/* Entry 63 is 1208 MHz, past the FF margin step */
+	get_vf_table(63, &rsp);
+	zassert_equal(rsp.data[2], 1208);
+	zassert_within(rsp.data[4] / 65536.0F, VFCurveModel(1208), 0.01F);
+
+	get_vf_table(VF_TABLE_ENTRIES - 2, &rsp);
+	zassert_equal(rsp.data[0], 0);
+	zassert_not_equal(rsp.data[5], 0);
+	zassert_equal(rsp.data[6], 0);
+	zassert_equal(rsp.data[7], 0);
+
+	get_vf_table(VF_TABLE_ENTRIES, &rsp);
+	zassert_not_equal(rsp.data[0], 0);
+}
+
+/* Cycle counts don't advance during computation on native_sim, so count model evaluations */
+ZTEST(vf_curve, test_lookups_skip_model)
+{
+	SetVFCurveProcess(2700);
+
+	/* Rebuilding the table evaluates the model once per entry */
+	vf_model_evals = 0;
+	SetVFCurveMargins(300, 150);
+	zassert_equal(vf_model_evals, VF_TABLE_ENTRIES);
+
+	/* Lookups within the AICLK range, as made on every DVFS and power model tick, don't */
+	vf_model_evals = 0;
+	for (uint32_t freq = VF_FMIN_MHZ; freq <= VF_FMAX_MHZ; freq++) {
+		VFCurve(freq);
+	}
+	zassert_equal(vf_model_evals, 0);
+
+	/* Only lookups outside of the table fall back to the model */
+	VFCurve(VF_FMAX_MHZ + 1);
+	zassert_equal(vf_model_evals, 1);
+}
+
+static void vf_curve_after(void *fixture)
+{
+	/* The defaults of vf_curve.c before InitVFCurve */
+	SetVFCurveProcess(0);
+	SetVFCurveMargins(300, 150);
+}
+
+ZTEST_SUITE(vf_curve, NULL, NULL, NULL, vf_curve_after, NULL);
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <tenstorrent/msgqueue.h>
+#include "work_queue.h"
+
+#define TEST_MSG_SLOW     0x74
+#define SLOW_HANDLER_MS   50
+#define CONTROL_PERIOD_MS 1
+#define MAX_CONTROL_TICKS 128
+
+/* A DVFS tick may be late by at most one period while a slow host message is handled. */
+#define MAX_CONTROL_INTERVAL_US (2 * CONTROL_PERIOD_MS * USEC_PER_MSEC)
+
+static int64_t control_timestamps[MAX_CONTROL_TICKS];
+static atomic_t control_count;
+static K_SEM_DEFINE(host_msg_done, 0, 1);
+
+static void control_work_handler(struct k_work *work)
+{
+	atomic_val_t idx = atomic_inc(&control_count);
+
+	if (idx < MAX_CONTROL_TICKS) {
+		control_timestamps[idx] = k_ticks_to_us_floor64(k_uptime_ticks());
+	}
+}
+static K_WORK_DEFINE(control_work, control_work_handler);
+
+static void control_timer_handler(struct k_timer *timer)
+{
+	tt_work_submit(TT_WORK_QUEUE_CONTROL, &control_work);
+}
+static K_TIMER_DEFINE(control_timer, control_timer_handler, NULL);
+
+static void host_msg_work_handler(struct k_work *work)
+{
+	process_message_queues();
+	k_sem_give(&host_msg_done);
+}
+static K_WORK_DEFINE(host_msg_work, host_msg_work_handler);
+
+static uint8_t slow_handler(const union request *req, struct response *rsp)
+{
+	/* Model a slow handler such as an EEPROM write, which busy-waits on hardware. */
+	k_busy_wait(SLOW_HANDLER_MS * USEC_PER_MSEC);
+	return 0;
+}
+
+ZTEST(work_queue, test_queue_priorities)
+{
+	zassert_not_equal(tt_work_queue_get(TT_WORK_QUEUE_CONTROL),
+			  tt_work_queue_get(TT_WORK_QUEUE_HOST_MSG));
+	zassert_not_equal(tt_work_queue_get(TT_WORK_QUEUE_HOST_MSG),
+			  tt_work_queue_get(TT_WORK_QUEUE_BACKGROUND));
+	zassert_not_equal(tt_work_queue_get(TT_WORK_QUEUE_BACKGROUND),
+			  tt_work_queue_get(TT_WORK_QUEUE_FLASH));
+
+	int control_prio = k_thread_priority_get(
+		k_work_queue_thread_get(tt_work_queue_get(TT_WORK_QUEUE_CONTROL)));
+	int host_msg_prio = k_thread_priority_get(
+		k_work_queue_thread_get(tt_work_queue_get(TT_WORK_QUEUE_HOST_MSG)));
+	int background_prio = k_thread_priority_get(
+		k_work_queue_thread_get(tt_work_queue_get(TT_WORK_QUEUE_BACKGROUND)));
+	int flash_prio = k_thread_priority_get(
+		k_work_queue_thread_get(tt_work_queue_get(TT_WORK_QUEUE_FLASH)));
+
+	zassert_true(control_prio < host_msg_prio);
+	zassert_true(host_msg_prio <= background_prio);
+	zassert_true(background_prio <= flash_prio);
+}
+
+ZTEST(work_queue, test_control_jitter_with_slow_message)
+{
+	union request req = {0};
+	struct response rsp = {0};
+	struct k_work_sync sync;
+
+	msgqueue_register_handler(TEST_MSG_SLOW, slow_handler);
+	atomic_set(&control_count, 0);
+
+	k_timer_start(&control_timer, K_MSEC(CONTROL_PERIOD_MS), K_MSEC(CONTROL_PERIOD_MS));
+
+	req.data[0] = TEST_MSG_SLOW;
+	msgqueue_request_push(0, &req);
+	tt_work_submit(TT_WORK_QUEUE_HOST_MSG, &host_msg_work);
+
+	zassert_ok(k_sem_take(&host_msg_done, K_MSEC(10 * SLOW_HANDLER_MS)));
+	k_timer_stop(&control_timer);
+	k_work_flush(&control_work, &sync);
+
+	msgqueue_response_pop(0, &rsp);
+	zassert_equal(rsp.data[0], 0);
+
+	int count = MIN(atomic_get(&control_count), MAX_CONTROL_TICKS);
+
+	/* The control loop must have kept running while the slow handler was busy */
+	zassert_true(count >= SLOW_HANDLER_MS / CONTROL_PERIOD_MS / 2,
+		     "only %d control ticks during a %d ms handler", count, SLOW_HANDLER_MS);
+
+	for (int i = 1; i < count; i++) {
+		int64_t interval = control_timestamps[i] - control_timestamps[i - 1];
+
+		zassert_true(interval <= MAX_CONTROL_INTERVAL_US,
+			     "control tick %d delayed by %lld us", i, interval);
+	}
+}
+
+ZTEST_SUITE(work_queue, NULL, NULL, NULL, NULL, NULL);
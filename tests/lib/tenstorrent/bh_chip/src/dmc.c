@@ -0,0 +1,535 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <app_version.h>
+#include <tenstorrent/bist.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/drivers/smbus.h>
+#include <zephyr/drivers/jtag.h>
+#include <zephyr/drivers/mfd/max6639.h>
+#include <zephyr/drivers/pwm.h>
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/sys/reboot.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/dfu/mcuboot.h>
+#include <zephyr/ztest.h>
+
+#include <tenstorrent/bh_chip.h>
+#include <tenstorrent/bh_arc.h>
+#include <tenstorrent/event.h>
+#include <tenstorrent/jtag_bootrom.h>
+#include <tenstorrent/log_backend_ringbuf.h>
+#include <tenstorrent/tt_smbus_regs.h>
+
+/*
+ * The DMC's job handler and main-thread chip handling, app/dmc/src/main.c, against emulated
+ * chips. main.c is built below with the chips' SMBus requests going to an emulated CMFW per chip,
+ * which takes as long as the transfer takes on a 100 kHz bus. Jobs run on the chip workers as in
+ * the DMC, so that the chip lock and fan_speed_lock are exercised by real concurrent jobs.
+ */
+
+#define MAX_CHIPS BH_CHIP_COUNT
+
+/* 9 bit times per byte at 100 kHz */
+#define BYTE_US 90
+/* CMFW_SMBUS_REQ_WINDOW with no or one message, and a word write */
+#define CM2DM_POLL_BYTES(n) (11 + 6 * (n))
+#define WORD_WRITE_BYTES    5
+/* A duty cycle write to the MAX6639 */
+#define PWM_WRITE_BYTES     3
+
+#define POLL_PERIOD_MS    20
+#define MESSAGE_PERIOD_MS 3
+#define RUN_MS            2000
+
+struct emul_cmfw {
+	/* A CM2DM message is waiting for the DMC, posted at posted_ticks */
+	atomic_t pending;
+	cm2dmMessage msg;
+	int64_t posted_ticks;
+	uint8_t seq_num;
+
+	/* Extra time every transfer takes, like a CMFW stretching the clock */
+	uint32_t stall_us;
+	/* A transfer is on the bus */
+	atomic_t busy;
+
+	uint32_t messages;
+	uint64_t latency_sum_us;
+	uint32_t latency_max_us;
+
+	uint16_t fan_speed;
+	uint16_t input_power;
+	/* Resets by the main thread, and whether one came in the middle of a transfer */
+	uint32_t resets;
+	bool reset_while_busy;
+};
+
+struct latency {
+	uint32_t mean_us;
+	uint32_t max_us;
+};
+
+static struct emul_cmfw cmfws[MAX_CHIPS];
+static size_t chip_count;
+static uint32_t next_post;
+
+/* Chips whose jobs run in the submitting thread, BH_CHIPS get a worker each */
+static struct bh_chip serial_chips[MAX_CHIPS];
+
+/* Last duty cycle written to the fan controller */
+static uint32_t fan_pwm;
+
+static struct emul_cmfw *emul_cmfw(const struct bh_chip *chip)
+{
+	if (chip >= BH_CHIPS && chip < BH_CHIPS + MAX_CHIPS) {
+		return &cmfws[chip - BH_CHIPS];
+	}
+
+	return &cmfws[chip - serial_chips];
+}
+
+static void bus_transfer(struct emul_cmfw *cmfw, uint32_t bytes)
+{
+	atomic_set(&cmfw->busy, true);
+	/* The SMBus driver sleeps on the transfer, other threads run meanwhile */
+	k_sleep(K_USEC(bytes * BYTE_US + cmfw->stall_us));
+	atomic_set(&cmfw->busy, false);
+}
+
+static void emul_post(struct emul_cmfw *cmfw, uint8_t msg_id, uint32_t data)
+{
+	/* Messages wait in the CMFW until the DMC reads them */
+	if (atomic_get(&cmfw->pending)) {
+		return;
+	}
+
+	cmfw->msg.msg_id = msg_id;
+	cmfw->msg.seq_num = ++cmfw->seq_num;
+	cmfw->msg.data = data;
+	cmfw->posted_ticks = k_uptime_ticks();
+	atomic_set(&cmfw->pending, true);
+}
+
+static int emul_get_cm2dm_window(struct bh_chip *chip,
+				 cm2dmMessage msgs[CMFW_SMBUS_CM2DM_WINDOW_SIZE], uint8_t *count,
+				 bool *more)
+{
+	struct emul_cmfw *cmfw = emul_cmfw(chip);
+	bool pending = atomic_get(&cmfw->pending);
+
+	bus_transfer(cmfw, CM2DM_POLL_BYTES(pending ? 1 : 0));
+
+	*count = 0;
+	*more = false;
+
+	if (pending) {
+		uint32_t latency_us = k_ticks_to_us_floor32(k_uptime_ticks() - cmfw->posted_ticks);
+
+		msgs[0] = cmfw->msg;
+		*count = 1;
+		atomic_clear(&cmfw->pending);
+
+		cmfw->messages++;
+		cmfw->latency_sum_us += latency_us;
+		cmfw->latency_max_us = MAX(cmfw->latency_max_us, latency_us);
+	}
+
+	return 0;
+}
+
+static int emul_smbus_word_data_write(const struct bh_arc *arc, uint16_t cmd, uint16_t word)
+{
+	struct emul_cmfw *cmfw = emul_cmfw(CONTAINER_OF(arc, struct bh_chip, config.arc));
+
+	bus_transfer(cmfw, WORD_WRITE_BYTES);
+
+	if (cmd == CMFW_SMBUS_FAN_SPEED) {
+		cmfw->fan_speed = word;
+	}
+
+	return 0;
+}
+
+static int emul_set_input_power(struct bh_chip *chip, uint16_t power)
+{
+	struct emul_cmfw *cmfw = emul_cmfw(chip);
+
+	bus_transfer(cmfw, WORD_WRITE_BYTES);
+	cmfw->input_power = power;
+
+	return 0;
+}
+
+/* The emulated transfers can't be cancelled, the main thread waits for them instead */
+static void emul_bus_cancel(struct bh_chip *chip)
+{
+	ARG_UNUSED(chip);
+}
+
+static void emul_reset(struct bh_chip *chip)
+{
+	struct emul_cmfw *cmfw = emul_cmfw(chip);
+
+	cmfw->resets++;
+	cmfw->reset_while_busy |= atomic_get(&cmfw->busy);
+}
+
+static int emul_reset_chip(struct bh_chip *chip, bool force_reset)
+{
+	ARG_UNUSED(force_reset);
+
+	emul_reset(chip);
+
+	return 0;
+}
+
+static int emul_reset_asic(struct bh_chip *chip)
+{
+	emul_reset(chip);
+
+	return 0;
+}
+
+static void emul_set_cable_power_limit(struct bh_chip *chip, uint16_t power_limit)
+{
+	ARG_UNUSED(chip);
+	ARG_UNUSED(power_limit);
+}
+
+static void emul_soft_reset_arc(struct bh_chip *chip)
+{
+	ARG_UNUSED(chip);
+}
+
+static void emul_jtag_teardown(const struct bh_chip *chip)
+{
+	ARG_UNUSED(chip);
+}
+
+static int emul_pwm_set_cycles(const struct device *dev, uint32_t channel, uint32_t period,
+			       uint32_t pulse, pwm_flags_t flags)
+{
+	ARG_UNUSED(dev);
+	ARG_UNUSED(channel);
+	ARG_UNUSED(period);
+	ARG_UNUSED(flags);
+
+	/* An I2C write, the duty cycle computed before it is the one that sticks */
+	k_sleep(K_USEC(PWM_WRITE_BYTES * BYTE_US));
+	fan_pwm = pulse;
+
+	return 0;
+}
+
+/* The tests don't send logs, main.c only needs these to link */
+static uint8_t no_logs[1];
+
+static int emul_ringbuf_get_claim(uint8_t **data, size_t length)
+{
+	ARG_UNUSED(length);
+
+	*data = no_logs;
+	return 0;
+}
+
+static int emul_ringbuf_finish_claim(size_t length)
+{
+	ARG_UNUSED(length);
+
+	return 0;
+}
+
+static size_t emul_ringbuf_get_used(void)
+{
+	return 0;
+}
+
+static uint32_t emul_ringbuf_get_dropped(void)
+{
+	return 0;
+}
+
+static bool emul_boot_is_img_confirmed(void)
+{
+	return true;
+}
+
+static int emul_boot_write_img_confirmed(void)
+{
+	return 0;
+}
+
+#define bh_chip_get_cm2dm_window           emul_get_cm2dm_window
+#define bharc_smbus_word_data_write        emul_smbus_word_data_write
+#define bh_chip_set_input_power            emul_set_input_power
+#define bh_chip_cancel_bus_transfer_set    emul_bus_cancel
+#define bh_chip_cancel_bus_transfer_clear  emul_bus_cancel
+#define bh_chip_reset_chip                 emul_reset_chip
+#define jtag_bootrom_reset_asic            emul_reset_asic
+#define jtag_bootrom_set_cable_power_limit emul_set_cable_power_limit
+#define jtag_bootrom_soft_reset_arc        emul_soft_reset_arc
+#define jtag_bootrom_teardown              emul_jtag_teardown
+#define pwm_set_cycles                     emul_pwm_set_cycles
+#define log_backend_ringbuf_get_claim      emul_ringbuf_get_claim
+#define log_backend_ringbuf_finish_claim   emul_ringbuf_finish_claim
+#define log_backend_ringbuf_get_used       emul_ringbuf_get_used
+#define log_backend_ringbuf_get_dropped    emul_ringbuf_get_dropped
+#define boot_is_img_confirmed              emul_boot_is_img_confirmed
+#define boot_write_img_confirmed           emul_boot_write_img_confirmed
+
+/* The chips in app.overlay have no GPIOs, JTAG or SMBus of their own */
+#undef INIT_CHIP
+#define INIT_CHIP(n, prop, idx)                                                                    \
+	{                                                                                          \
+		.auto_reset_timer = Z_TIMER_INITIALIZER(BH_CHIPS[idx].auto_reset_timer,           \
+							bh_chip_auto_reset, NULL),                 \
+	},
+
+/* ztest has the main() */
+#define main dmc_main
+#include "src/main.c"
+#undef main
+
+static void wait_idle(void)
+{
+	/* Longer than any job */
+	k_sleep(K_MSEC(50));
+}
+
+/* The chip state that the DMC keeps about the CMFW, which starts afresh */
+static void reset_chip_data(struct bh_chip *chip)
+{
+	chip->data.fan_speed = INITIAL_FAN_SPEED;
+	chip->data.fan_speed_forced = false;
+	chip->data.last_cm2dm_seq_num_valid = false;
+	chip->data.telemetry_heartbeat = 0;
+	chip->data.therm_trip_count = 0;
+}
+
+/* The CMFWs post messages in turn, independently of the DMC */
+static void post_message(struct k_timer *timer)
+{
+	struct emul_cmfw *cmfw = &cmfws[next_post++ % chip_count];
+
+	emul_post(cmfw, kCm2DmMsgTelemHeartbeatUpdate, next_post);
+}
+static K_TIMER_DEFINE(post_timer, post_message, NULL);
+
+/* The DMC main loop: a board power update every millisecond, a CM2DM poll every 20 ms */
+static void run_board(struct bh_chip *chips, size_t count, struct latency *result)
+{
+	int64_t start = k_uptime_get();
+	int64_t next_tick = start;
+	int64_t next_poll = start;
+	uint32_t messages = 0;
+	uint64_t latency_sum_us = 0;
+
+	chip_count = count;
+	next_post = 0;
+	memset(cmfws, 0, sizeof(cmfws));
+	result->max_us = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		reset_chip_data(&chips[i]);
+	}
+
+	k_timer_start(&post_timer, K_MSEC(MESSAGE_PERIOD_MS), K_MSEC(MESSAGE_PERIOD_MS));
+
+	while (k_uptime_get() - start < RUN_MS) {
+		uint32_t jobs = CHIP_JOB_BOARD_POWER;
+
+		if (k_uptime_get() >= next_poll) {
+			jobs |= CHIP_JOB_CM2DM;
+			while (next_poll <= k_uptime_get()) {
+				next_poll += POLL_PERIOD_MS;
+			}
+		}
+
+		for (size_t i = 0; i < count; i++) {
+			bh_chip_jobs_submit(&chips[i], jobs);
+		}
+
+		/* Like the 1 ms board power timer, ticks missed while busy are dropped */
+		while (next_tick <= k_uptime_get()) {
+			next_tick++;
+		}
+		k_sleep(K_TIMEOUT_ABS_MS(next_tick));
+	}
+
+	k_timer_stop(&post_timer);
+	wait_idle();
+
+	for (size_t i = 0; i < count; i++) {
+		zassert_true(cmfws[i].messages > 0);
+		messages += cmfws[i].messages;
+		latency_sum_us += cmfws[i].latency_sum_us;
+		result->max_us = MAX(result->max_us, cmfws[i].latency_max_us);
+	}
+	result->mean_us = latency_sum_us / messages;
+}
+
+/*
+ * CM2DM latency, from the CMFW posting a message to the DMC reading it, as the chip count grows.
+ * Polling the chips one after the other, every chip delays the others. With a worker per chip,
+ * the latency doesn't depend on the number of chips.
+ */
+ZTEST(dmc_jobs, test_cm2dm_latency)
+{
+	struct latency serial[MAX_CHIPS];
+
+	for (size_t n = 1; n <= MAX_CHIPS; n++) {
+		run_board(serial_chips, n, &serial[n - 1]);
+		TC_PRINT("%zu chips, one at a time: mean %5u us, max %5u us\n", n,
+			 serial[n - 1].mean_us, serial[n - 1].max_us);
+	}
+
+	zassert_true(serial[MAX_CHIPS - 1].max_us > serial[0].max_us);
+
+#ifdef CONFIG_TT_BH_CHIP_WORKER
+	struct latency parallel[MAX_CHIPS];
+
+	for (size_t n = 1; n <= MAX_CHIPS; n++) {
+		run_board(BH_CHIPS, n, &parallel[n - 1]);
+		TC_PRINT("%zu chips, worker per chip: mean %5u us, max %5u us\n", n,
+			 parallel[n - 1].mean_us, parallel[n - 1].max_us);
+	}
+
+	/* Within a poll transaction of the single chip latency */
+	zassert_true(parallel[MAX_CHIPS - 1].max_us <=
+		     parallel[0].max_us + CM2DM_POLL_BYTES(1) * BYTE_US);
+	zassert_true(parallel[MAX_CHIPS - 1].max_us < serial[MAX_CHIPS - 1].max_us);
+#endif
+}
+
+static void poll_all(void)
+{
+	for (size_t i = 0; i < MAX_CHIPS; i++) {
+		bh_chip_jobs_submit(&BH_CHIPS[i], CHIP_JOB_CM2DM);
+	}
+	wait_idle();
+}
+
+ZTEST(dmc_jobs, test_fan_speed)
+{
+	/* Every chip asks for its own fan speed at once, the fan runs at the highest */
+	for (size_t i = 0; i < MAX_CHIPS; i++) {
+		emul_post(&cmfws[i], kCm2DmMsgIdFanSpeedUpdate, 40 + 10 * i);
+	}
+	poll_all();
+
+	uint8_t fan_speed = 40 + 10 * (MAX_CHIPS - 1);
+
+	zassert_equal(fan_pwm, DIV_ROUND_UP(fan_speed * UINT8_MAX, 100));
+	for (size_t i = 0; i < MAX_CHIPS; i++) {
+		zassert_equal(cmfws[i].fan_speed, fan_speed, "chip %zu told %u%%", i,
+			      cmfws[i].fan_speed);
+	}
+
+	/* A forced speed wins over the automatic ones, even a lower one */
+	emul_post(&cmfws[0], kCm2DmMsgIdForcedFanSpeedUpdate, 20);
+	poll_all();
+
+	zassert_equal(fan_pwm, DIV_ROUND_UP(20 * UINT8_MAX, 100));
+	for (size_t i = 0; i < MAX_CHIPS; i++) {
+		zassert_equal(cmfws[i].fan_speed, 20, "chip %zu told %u%%", i, cmfws[i].fan_speed);
+	}
+}
+
+/* Start a CM2DM poll that keeps the chip's bus busy for a while */
+static void start_slow_poll(size_t i)
+{
+	cmfws[i].stall_us = 10 * USEC_PER_MSEC;
+	emul_post(&cmfws[i], kCm2DmMsgTelemHeartbeatUpdate, 1);
+	bh_chip_jobs_submit(&BH_CHIPS[i], CHIP_JOB_CM2DM);
+	k_sleep(K_MSEC(1));
+}
+
+ZTEST(dmc_jobs, test_therm_trip)
+{
+	struct bh_chip *chip = &BH_CHIPS[1];
+
+	/* The reset waits for the poll in progress */
+	start_slow_poll(1);
+	chip->data.therm_trip_triggered = true;
+	handle_therm_trip();
+
+	zassert_equal(cmfws[1].resets, 1);
+	zassert_false(cmfws[1].reset_while_busy);
+	zassert_equal(chip->data.telemetry_heartbeat, 1);
+	zassert_equal(chip->data.therm_trip_count, 1);
+	zassert_equal(fan_pwm, UINT8_MAX);
+
+	/* The fan stays at full speed whatever the other chips ask for */
+	emul_post(&cmfws[0], kCm2DmMsgIdFanSpeedUpdate, 50);
+	poll_all();
+
+	zassert_equal(fan_pwm, DIV_ROUND_UP(100 * UINT8_MAX, 100));
+	zassert_equal(cmfws[0].fan_speed, 100);
+}
+
+ZTEST(dmc_jobs, test_perst)
+{
+	struct bh_chip *chip = &BH_CHIPS[2];
+
+	/* The reset waits for the poll in progress, which leaves nothing behind */
+	start_slow_poll(2);
+	atomic_set(&chip->data.trigger_reset, true);
+	handle_perst();
+
+	zassert_equal(cmfws[2].resets, 1);
+	zassert_false(cmfws[2].reset_while_busy);
+	zassert_equal(chip->data.telemetry_heartbeat, 1);
+	zassert_false(chip->data.last_cm2dm_seq_num_valid);
+	zassert_false(atomic_get(&chip->data.trigger_reset));
+}
+
+static void dmc_jobs_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	memset(cmfws, 0, sizeof(cmfws));
+	fan_pwm = 0;
+
+	ARRAY_FOR_EACH_PTR(BH_CHIPS, chip) {
+		reset_chip_data(chip);
+	}
+	ARRAY_FOR_EACH_PTR(serial_chips, chip) {
+		reset_chip_data(chip);
+	}
+}
+
+static void *dmc_jobs_setup(void)
+{
+	/* As the DMC's main() does */
+	ARRAY_FOR_EACH_PTR(BH_CHIPS, chip) {
+		bh_chip_jobs_init(chip, run_chip_jobs);
+	}
+	ARRAY_FOR_EACH_PTR(serial_chips, chip) {
+		bh_chip_jobs_init(chip, run_chip_jobs);
+	}
+
+#ifdef CONFIG_TT_BH_CHIP_WORKER
+	for (size_t i = 0; i < BH_CHIP_COUNT; i++) {
+		bh_chip_worker_start(&BH_CHIPS[i], chip_worker_stacks[i],
+				     K_THREAD_STACK_SIZEOF(chip_worker_stacks[i]));
+	}
+#endif
+
+	return NULL;
+}
+
+ZTEST_SUITE(dmc_jobs, NULL, dmc_jobs_setup, dmc_jobs_before, NULL, NULL);
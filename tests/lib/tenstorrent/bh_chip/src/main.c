@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2026 Tenstorrent AI ULC
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <tenstorrent/bh_chip.h>
+
+/*
+ * The job mechanics of bh_chip, against a handler that records how it was called. The DMC's own
+ * handler runs against emulated chips in dmc.c.
+ */
+
+#define MAX_CHIPS 4
+
+enum emul_job {
+	EMUL_JOB_CM2DM = BIT(0),
+	EMUL_JOB_BOARD_POWER = BIT(1),
+	EMUL_JOB_TRANSFER = BIT(2),
+};
+
+struct emul_cmfw {
+	/* Jobs the handler was called with */
+	uint32_t handled_jobs;
+	uint32_t handler_calls;
+	int64_t done_ticks;
+};
+
+struct emul_chip {
+	struct bh_chip chip;
+	struct emul_cmfw *cmfw;
+};
+
+static struct emul_cmfw cmfws[MAX_CHIPS];
+
+/* Chips whose jobs run in the submitting thread, and chips with a worker each */
+static struct emul_chip serial_chips[MAX_CHIPS];
+#ifdef CONFIG_TT_BH_CHIP_WORKER
+static struct emul_chip worker_chips[MAX_CHIPS];
+static K_THREAD_STACK_ARRAY_DEFINE(worker_stacks, MAX_CHIPS, CONFIG_TT_BH_CHIP_WORKER_STACK_SIZE);
+#endif
+
+static void emul_jobs(struct bh_chip *chip, uint32_t jobs)
+{
+	struct emul_cmfw *cmfw = CONTAINER_OF(chip, struct emul_chip, chip)->cmfw;
+
+	cmfw->handled_jobs |= jobs;
+	cmfw->handler_calls++;
+
+	if (jobs & EMUL_JOB_TRANSFER) {
+		/* The SMBus driver sleeps on the transfer, other threads run meanwhile */
+		k_sleep(K_MSEC(10));
+	}
+
+	cmfw->done_ticks = k_uptime_ticks();
+}
+
+static void wait_idle(void)
+{
+	/* Longer than any job */
+	k_sleep(K_MSEC(50));
+}
+
+ZTEST(bh_chip, test_jobs)
+{
+	/* Without a worker, jobs run before bh_chip_jobs_submit returns */
+	bh_chip_jobs_submit(&serial_chips[0].chip, EMUL_JOB_BOARD_POWER);
+	zassert_equal(cmfws[0].handler_calls, 1);
+	zassert_equal(cmfws[0].handled_jobs, EMUL_JOB_BOARD_POWER);
+}
+
+ZTEST(bh_chip, test_worker_jobs)
+{
+#ifdef CONFIG_TT_BH_CHIP_WORKER
+	/* Jobs submitted while the worker is busy are merged into one call */
+	bh_chip_jobs_submit(&worker_chips[0].chip, EMUL_JOB_TRANSFER);
+	k_sleep(K_MSEC(1));
+	bh_chip_jobs_submit(&worker_chips[0].chip, EMUL_JOB_BOARD_POWER);
+	bh_chip_jobs_submit(&worker_chips[0].chip, EMUL_JOB_CM2DM);
+	wait_idle();
+	zassert_equal(cmfws[0].handler_calls, 2);
+	zassert_equal(cmfws[0].handled_jobs,
+		      EMUL_JOB_TRANSFER | EMUL_JOB_BOARD_POWER | EMUL_JOB_CM2DM);
+
+	/* Jobs wait for another thread holding the chip */
+	k_mutex_lock(&worker_chips[1].chip.lock, K_FOREVER);
+	bh_chip_jobs_submit(&worker_chips[1].chip, EMUL_JOB_BOARD_POWER);
+	wait_idle();
+	zassert_equal(cmfws[1].handler_calls, 0);
+	k_mutex_unlock(&worker_chips[1].chip.lock);
+	wait_idle();
+	zassert_equal(cmfws[1].handler_calls, 1);
+
+	/* Chips run their jobs at the same time, each on its own bus */
+	int64_t start = k_uptime_ticks();
+
+	for (size_t i = 0; i < MAX_CHIPS; i++) {
+		bh_chip_jobs_submit(&worker_chips[i].chip, EMUL_JOB_TRANSFER);
+	}
+	wait_idle();
+	for (size_t i = 0; i < MAX_CHIPS; i++) {
+		zassert_true(k_ticks_to_ms_floor64(cmfws[i].done_ticks - start) < 2 * 10);
+	}
+#else
+	ztest_test_skip();
+#endif
+}
+
+static void bh_chip_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	memset(cmfws, 0, sizeof(cmfws));
+}
+
+static void *bh_chip_setup(void)
+{
+	for (size_t i = 0; i < MAX_CHIPS; i++) {
+		serial_chips[i].cmfw = &cmfws[i];
+		bh_chip_jobs_init(&serial_chips[i].chip, emul_jobs);
+
+#ifdef CONFIG_TT_BH_CHIP_WORKER
+		worker_chips[i].cmfw = &cmfws[i];
+		bh_chip_jobs_init(&worker_chips[i].chip, emul_jobs);
+		bh_chip_worker_start(&worker_chips[i].chip, worker_stacks[i],
+				     K_THREAD_STACK_SIZEOF(worker_stacks[i]));
+#endif
+	}
+
+	return NULL;
+}
+
+ZTEST_SUITE(bh_chip, NULL, bh_chip_setup, bh_chip_before, NULL, NULL);